@@ -1,6 +1,30 @@
 -- benchmark_data
 -- @short: Retrieve gathered benchmarking values.
--- @outargs: nticks, tickcosttbl, framecount, frametimetbl, costcount, framecosttbl
+-- @outargs: nticks, tickcosttbl, framecount, frametimetbl, costcount, framecosttbl, countertbl
+-- @note: countertbl holds the engine counters below by name, all of them
+-- are reset by benchmark_enable.
+-- @note: iocount is the number of input events delivered to the scripting
+-- layer since benchmark_enable, and iotime the time in microseconds spent
+-- doing so (including table construction and the script handlers).
+-- @note: culled is the number of 2D objects that were not drawn as they were
+-- fully covered by an opaque object on top of them. This can be disabled
+-- with the video_noocclusion config key.
+-- @note: texthit and textmiss count render_text (and other format string
+-- rendering) calls that were served from the rendered text cache versus
+-- those that had to be parsed and rasterized. The cache budget is set in
+-- kilobytes with the video_textcache config key, 0 disables it.
+-- @note: unifset is the number of shader uniform uploads performed and
+-- unifskip the number avoided because the program already had the value,
+-- divide by framecount for the per-frame figures.
+-- @note: drawn3d and culled3d count 3D models that were submitted versus
+-- those skipped as their bounds fell outside of the camera view frustum.
+-- Culling can be disabled with the video_no3dcull config key. draws3d is
+-- the number of mesh draw calls used for them, which is lower than drawn3d
+-- when instances (see instance_3dmodel) can be drawn together.
+-- @note: glyphhit and glyphmiss count glyph lookups made while rendering
+-- text that were served from the per-font glyph cache versus those that
+-- had to be loaded and rasterized. Render_text calls served from the text
+-- cache do not perform any glyph lookups.
 -- @group: system
 -- @cfunction: getbenchvals
 -- @related: benchmark_enable, benchmark_timestamp
@@ -15,6 +15,9 @@
 -- BLEND_PREMULTIPLIED (one, one-src alpha: the source object has its alpha
 -- values pre-multiplied into the color channels)
 -- @note: The default can be changed by calling ref:switch_default_blendmode.
+-- @note: Visible 3D models that have blending disabled (BLEND_NONE) and
+-- full opacity may be drawn in a different order, grouped by shader and
+-- texture. Models with any other blend mode are drawn in order after them.
 -- @group: image
 -- @cfunction: forceblend
 -- @flags:
@@ -1,7 +1,16 @@
 -- inputanalog_filter
 -- @short: Change filtering / sampling options for a single analog input source.
 -- @inargs: joyid, axisid, deadzone, lower, upper, buffer, modestr
--- @note: accepted modestr values are "drop, pass, average or latest".
+-- @note: accepted modestr values are "drop, pass, average, latest or coalesce".
+-- @note: "coalesce" merges consecutive relative samples within a time window
+-- into one event. This is only supported for mouse axes and touch on some
+-- platforms, and is otherwise treated as "pass". The default window is set
+-- with the event_coalesce platform option. To get every sample at full
+-- resolution for a coalesced device, e.g. for a drawing application, set the
+-- mode to "pass".
+-- @note: touch samples are reported with subid 128 and up, on the evdev
+-- platform *axisid* 128 selects the mode for all touch contacts of the
+-- device. Only "coalesce" and "pass" apply there.
 -- @group: iodev
 -- @cfunction: inputfilteranalog
 -- @related: inputanalog_query, inputanalog_toggle
@@ -18,6 +18,7 @@
 -- mode(pass), emit every sample
 -- mode(avg), average the kernel_size buffer
 -- mode(latest), only emit when buffer full, and keep only most recent value
+-- mode(coalesce), merge relative samples within a time window
 -- @group: iodev
 -- @cfunction: inputanalogquery
 -- @related:
@@ -0,0 +1,41 @@
+-- instance_3dmodel
+-- @short: Create a new object that reuses the geometry of a 3D model
+-- @inargs: vid:model
+-- @outargs: vid
+-- @longdescr: The returned object draws the meshes of *model* but has
+-- its own position, orientation, scale, opacity and texture. It starts out
+-- sharing the texture of *model* and hidden like any other new object.
+-- Geometry is shared, destructive transforms like scale_3dvertices or
+-- swizzle_model on either affect all of them, and it is kept alive until
+-- *model* and all of its instances have been deleted.
+-- Visible instances of the same model that use the same shader, texture
+-- and blend mode, and are fully opaque, are drawn together with one
+-- instanced draw call per mesh when the platform supports it. Custom
+-- shaders need to take the modelview matrix and opacity from the
+-- instance_modelview (mat4) and instance_opacity (float) attributes for
+-- this to apply, otherwise they are drawn one at a time as normal.
+-- @group: 3d
+-- @cfunction: instancemodel
+-- @related: build_3dbox, new_3dmodel, finalize_3dmodel
+-- @flags:
+function main()
+#ifdef MAIN
+	local camera = null_surface(1, 1);
+	camtag_model(camera, 0.1, 100.0, 45.0, 1.33, 1, 1);
+	forward3d_model(camera, -10.0);
+
+	local box = build_3dbox(1, 1, 1);
+	image_sharestorage(fill_surface(32, 32, 255, 0, 0), box);
+	show_image(box);
+
+	for i=1,100 do
+		local vid = instance_3dmodel(box);
+		move3d_model(vid, math.random(-5, 5), math.random(-5, 5), 0);
+		show_image(vid);
+	end
+#endif
+
+#ifdef ERROR1
+	instance_3dmodel(fill_surface(32, 32, 0, 0, 0));
+#endif
+end
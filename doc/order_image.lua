@@ -1,6 +1,7 @@
 -- order_image
 -- @short: Alter the drawing order of the specified image.
 -- @inargs: vid or tblvid, newzv
+-- @inargs: tblvid, tblzv
 -- @longdescr: Every object has an order property that determines
 -- when it should be drawn in respect to other ones. This value
 -- can be changed by calling the order_image function on a video
@@ -9,6 +10,11 @@
 -- this is objects that are linked to others and have their order
 -- being relative to its parent, where negative values are permitted
 -- but will be resolved to a value within the specified range.
+-- If *tblzv* is provided, it should be a table of the same length as
+-- *tblvid* and each vid gets the order at the matching index. This is
+-- the preferred way of restacking many objects at once. Objects are
+-- processed in table order, so for objects that end up with the same
+-- order the later one will be drawn after the earlier one.
 -- @note: This only applies to the active owner of an
 -- image, for images attached to multiple rendertarget,
 -- such changes won't take place until you forcibly attach/detach
@@ -26,6 +32,7 @@ function main()
 
 	show_image({a, b});
 	order_image(a, 2);
+	order_image({a, b}, {4, 3});
 #endif
 
 #ifdef ERROR
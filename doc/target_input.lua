@@ -48,6 +48,12 @@
 -- be less accurate. All permutations of relative, absolute, two samples
 -- or four samples need to be accounted for.
 --
+-- Analog and touch tables that come from the input event handler may
+-- also have the *coalesced* field set. This means that the platform merged
+-- several device samples into one, *coalesced* is then the number of merged
+-- samples. For analog, *span* is the time in microseconds between the first
+-- and the last of them.
+--
 -- If *kind* is set to *digital*, the required additional fields are:
 -- active (true/_false_), if the button is in a pressed state or not
 -- and the possible additional fields are:
@@ -14,6 +14,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include <inttypes.h>
+#include <float.h>
 
 #include <assert.h>
 
@@ -52,7 +53,7 @@ struct geometry {
 	struct geometry* next;
 };
 
-typedef struct {
+typedef struct arcan_3dmodel {
 	pthread_mutex_t lock;
 	int work_count;
 
@@ -85,9 +86,22 @@ typedef struct {
 
 	struct arcan_vr_ctx* vrref;
 
+/* set for instances, geometry and bounds are taken from [source] */
+	struct arcan_3dmodel* source;
+
+/* number of instances that refer to this model, if the owning object
+ * is destroyed before them the model is kept around as an orphan */
+	size_t instances;
+	bool orphan;
+
 	arcan_vobject* parent;
 } arcan_3dmodel;
 
+static inline arcan_3dmodel* geomsrc(arcan_3dmodel* model)
+{
+	return model->source ? model->source : model;
+}
+
 static void build_plane(point min, point max, point step,
 	float** verts, unsigned** indices, float** txcos,
 	size_t* nverts, size_t* nindices, bool vertical)
@@ -156,6 +170,24 @@ static void freemodel(arcan_3dmodel* src)
 		src->vrref = NULL;
 	}
 
+/* instances only own the control structure */
+	if (src->source){
+		arcan_3dmodel* source = src->source;
+		pthread_mutex_destroy(&src->lock);
+		arcan_mem_free(src);
+
+		source->instances--;
+		if (source->orphan && source->instances == 0)
+			freemodel(source);
+		return;
+	}
+
+	if (src->instances > 0){
+		src->orphan = true;
+		src->parent = NULL;
+		return;
+	}
+
 	struct geometry* geom = src->geometry;
 
 /* always make sure the model is loaded before freeing */
@@ -255,24 +287,45 @@ matr[3], matr[7], matr[11], matr[15]);
 /*
  * Render-loops, Pass control, Initialization
  */
-static void rendermodel(arcan_vobject* vobj, arcan_3dmodel* src,
-	agp_shader_id baseprog, surface_properties props, float* view,
-	enum agp_mesh_flags flags)
-{
-	assert(vobj);
 
-	if (props.opa < EPSILON || !src->flags.complete || src->work_count > 0)
-		return;
+/* a model that survived culling, waiting to be drawn */
+struct draw_item {
+	_Alignas(16) float model[16];
+	arcan_vobject* vobj;
+	arcan_3dmodel* src;
+	surface_properties props;
+	agp_shader_id program;
+	struct agp_vstore* vstore;
+	bool blended;
+	size_t seq;
+};
 
+static struct {
+	struct draw_item* items;
+	size_t limit;
+
+/* per-instance attributes, AGP_INSTANCE_STRIDE floats each */
+	float* inst;
+	size_t inst_limit;
+
+/* accumulated until collected through arcan_3d_stats */
+	size_t drawn;
+	size_t culled;
+	size_t draws;
+} drawq;
+
+static void model_matrix(
+	arcan_vobject* vobj, surface_properties* props, float* model)
+{
 /* transform order: scale */
 	float _Alignas(16) scale[16] = {
-		props.scale.x, 0.0, 0.0, 0.0,
-		0.0, props.scale.y, 0.0, 0.0,
-		0.0, 0.0, props.scale.z, 0.0,
-		0.0, 0.0, 0.0,           1.0
+		props->scale.x, 0.0, 0.0, 0.0,
+		0.0, props->scale.y, 0.0, 0.0,
+		0.0, 0.0, props->scale.z, 0.0,
+		0.0, 0.0, 0.0,            1.0
 	};
 
-  float ox = vobj->origo_ofs.x;
+	float ox = vobj->origo_ofs.x;
 	float oy = vobj->origo_ofs.y;
 	float oz = vobj->origo_ofs.z;
 
@@ -281,16 +334,25 @@ static void rendermodel(arcan_vobject* vobj, arcan_3dmodel* src,
 
 /* rotate */
 	float _Alignas(16) orient[16];
-	matr_quatf(props.rotation.quaternion, orient);
-	float _Alignas(16) model[16];
+	matr_quatf(props->rotation.quaternion, orient);
 	multiply_matrix(model, orient, scale);
 
 /* object translation */
 	translate_matrix(model,
-		props.position.x - ox,
-		props.position.y - oy,
-		props.position.z - oz
+		props->position.x - ox,
+		props->position.y - oy,
+		props->position.z - oz
 	);
+}
+
+static void rendermodel(arcan_vobject* vobj, arcan_3dmodel* src,
+	agp_shader_id baseprog, surface_properties props, float* view,
+	float* model, enum agp_mesh_flags flags)
+{
+	assert(vobj);
+
+	if (props.opa < EPSILON || !src->flags.complete || src->work_count > 0)
+		return;
 
 	float _Alignas(16) out[16];
 	multiply_matrix(out, view, model);
@@ -327,6 +389,7 @@ static void rendermodel(arcan_vobject* vobj, arcan_3dmodel* src,
 
 		agp_shader_envv(MODELVIEW_MATR, out, sizeof(float) * 16);
 		agp_submit_mesh(&base->store, flags);
+		drawq.draws++;
 		base = base->next;
 	}
 }
@@ -363,6 +426,195 @@ enum arcan_ffunc_rv arcan_ffunc_3dobj FFUNC_HEAD
 	return 0;
 }
 
+/*
+ * Test the local bounding box of [src], as a sphere transformed by [matr],
+ * against the planes of the view frustum. Models without any known bounds
+ * are never culled.
+ */
+static bool model_culled(arcan_3dmodel* src,
+	surface_properties* props, float* matr, float frustum[6][4])
+{
+	vector ext = sub_vector(src->bbmax, src->bbmin);
+	if (ext.x <= 0.0 && ext.y <= 0.0 && ext.z <= 0.0)
+		return false;
+
+	_Alignas(16) float center[4] = {
+		src->bbmin.x + ext.x * 0.5,
+		src->bbmin.y + ext.y * 0.5,
+		src->bbmin.z + ext.z * 0.5,
+		1.0
+	};
+	_Alignas(16) float wpos[4];
+	mult_matrix_vecf(matr, center, wpos);
+
+	float sf = fabsf(props->scale.x);
+	sf = fabsf(props->scale.y) > sf ? fabsf(props->scale.y) : sf;
+	sf = fabsf(props->scale.z) > sf ? fabsf(props->scale.z) : sf;
+
+	return frustum_sphere(frustum, wpos[0], wpos[1], wpos[2],
+		len_vector(ext) * 0.5 * sf) == outside;
+}
+
+static struct draw_item* queue_slot(size_t ind)
+{
+	if (ind < drawq.limit)
+		return &drawq.items[ind];
+
+	size_t limit = drawq.limit ? drawq.limit * 2 : 256;
+	struct draw_item* items = arcan_alloc_mem(sizeof(struct draw_item) * limit,
+		ARCAN_MEM_VSTRUCT, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_SIMD);
+	if (!items)
+		return NULL;
+
+	if (drawq.items){
+		memcpy(items, drawq.items, sizeof(struct draw_item) * drawq.limit);
+		arcan_mem_free(drawq.items);
+	}
+
+	drawq.items = items;
+	drawq.limit = limit;
+	return &drawq.items[ind];
+}
+
+/*
+ * Opaque models first, grouped on program then texture. Blended ones keep
+ * their relative order and go last as the result depends on it. Models are
+ * created with the default (forced) blend mode, so only those that have been
+ * set to BLEND_NONE are actually reordered.
+ */
+static int cmp_item(const void* a, const void* b)
+{
+	const struct draw_item* l = a;
+	const struct draw_item* r = b;
+
+	if (l->blended != r->blended)
+		return l->blended ? 1 : -1;
+
+	if (!l->blended){
+		if (l->program != r->program)
+			return l->program < r->program ? -1 : 1;
+
+		if (l->vstore != r->vstore)
+			return (uintptr_t) l->vstore < (uintptr_t) r->vstore ? -1 : 1;
+
+		if (l->src != r->src)
+			return (uintptr_t) l->src < (uintptr_t) r->src ? -1 : 1;
+	}
+
+	return l->seq < r->seq ? -1 : (l->seq > r->seq);
+}
+
+/*
+ * Items can be drawn as instances of each other if they share geometry and
+ * all the state that rendermodel would otherwise set per object.
+ */
+static bool same_instance(struct draw_item* a, struct draw_item* b)
+{
+	return a->props.opa > 1.0 - EPSILON && b->props.opa > 1.0 - EPSILON &&
+		a->src == b->src &&
+		a->program == b->program &&
+		a->vstore == b->vstore &&
+		a->vobj->blendmode == b->vobj->blendmode &&
+		!a->vobj->frameset && !b->vobj->frameset;
+}
+
+/* per-mesh shader overrides would need one program per instance run */
+static bool instance_geometry(arcan_3dmodel* src)
+{
+	for (struct geometry* geom = src->geometry; geom; geom = geom->next)
+		if (geom->program > 0)
+			return false;
+
+	return src->geometry != NULL;
+}
+
+static float* instance_buffer(size_t n)
+{
+	if (n <= drawq.inst_limit)
+		return drawq.inst;
+
+	size_t limit = drawq.inst_limit ? drawq.inst_limit : 256;
+	while (limit < n)
+		limit *= 2;
+
+	float* inst = arcan_alloc_mem(sizeof(float) * AGP_INSTANCE_STRIDE * limit,
+		ARCAN_MEM_VSTRUCT, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_SIMD);
+	if (!inst)
+		return NULL;
+
+	arcan_mem_free(drawq.inst);
+	drawq.inst = inst;
+	drawq.inst_limit = limit;
+	return inst;
+}
+
+/* one draw per instance of [geom], for when instancing the mesh failed */
+static void render_mesh_each(struct draw_item* items, size_t n,
+	struct geometry* geom, float* inst, enum agp_mesh_flags flags)
+{
+	agp_shader_activate(items->program);
+
+	for (size_t i = 0; i < n; i++){
+		float* cur = &inst[i * AGP_INSTANCE_STRIDE];
+		agp_shader_envv(MODELVIEW_MATR, cur, sizeof(float) * 16);
+		agp_shader_envv(OBJ_OPACITY, &cur[16], sizeof(float));
+		agp_submit_mesh(&geom->store, flags);
+		drawq.draws++;
+	}
+}
+
+/*
+ * Submit [n] queued items with the same geometry in one instanced draw per
+ * mesh. The default program is swapped for its instanced version, custom
+ * ones need to use the instance_ attributes. Returns false with nothing
+ * drawn if that is not possible.
+ */
+static bool render_instanced(struct draw_item* items,
+	size_t n, float* view, enum agp_mesh_flags flags)
+{
+	agp_shader_id prog = items->program;
+	if (prog == agp_default_shader(BASIC_3D))
+		prog = agp_default_shader(BASIC_3D_INSTANCED);
+
+	if (prog == BROKEN_SHADER)
+		return false;
+
+	float* inst = instance_buffer(n);
+	if (!inst)
+		return false;
+
+	for (size_t i = 0; i < n; i++){
+		float _Alignas(16) out[16];
+		multiply_matrix(out, view, items[i].model);
+		memcpy(&inst[i * AGP_INSTANCE_STRIDE], out, sizeof(float) * 16);
+		inst[i * AGP_INSTANCE_STRIDE + 16] = items[i].props.opa;
+	}
+
+	agp_shader_activate(prog);
+	if (agp_shader_vattribute_loc(ATTRIBUTE_INSTANCE_MODELVIEW) == -1)
+		return false;
+
+	agp_blendstate(items->vobj->blendmode);
+	agp_activate_vstore(items->vstore);
+
+/* if a later mesh fails, the ones before it have already been drawn so
+ * finish the rest without instancing rather than redrawing the model */
+	for (struct geometry* geom = items->src->geometry; geom; geom = geom->next){
+		if (agp_submit_mesh_instanced(&geom->store, flags, inst, n)){
+			drawq.draws++;
+			continue;
+		}
+
+		if (geom == items->src->geometry)
+			return false;
+
+		render_mesh_each(items, n, geom, inst, flags);
+		agp_shader_activate(prog);
+	}
+
+	return true;
+}
+
 /* normal scene process, except stops after no objects with infinite
  * flag (skybox, skygeometry etc.) */
 static arcan_vobject_litem* process_scene_infinite(
@@ -394,10 +646,12 @@ static arcan_vobject_litem* process_scene_infinite(
 			break;
 
 		surface_properties dprops;
+		float _Alignas(16) model[16];
 
 		arcan_resolve_vidprop(cvo, lerp, &dprops);
-		rendermodel(cvo,
-			obj3d, cvo->program, dprops, view, flags | MESH_FACING_NODEPTH);
+		model_matrix(cvo, &dprops, model);
+		rendermodel(cvo, geomsrc(obj3d),
+			cvo->program, dprops, view, model, flags | MESH_FACING_NODEPTH);
 
 		current = current->next;
 	}
@@ -405,8 +659,13 @@ static arcan_vobject_litem* process_scene_infinite(
 	return current;
 }
 
-static void process_scene_normal(arcan_vobject_litem* cell,
-	float lerp, float* modelview, enum agp_mesh_flags flags)
+/*
+ * Resolve and cull the 3D part of the pipeline into the draw queue, then
+ * submit it sorted to cut down on program and texture switches. Sorting is
+ * only safe when the depth buffer takes care of visibility.
+ */
+static void process_scene_normal(arcan_vobject_litem* cell, float lerp,
+	float* modelview, float* projection, enum agp_mesh_flags flags)
 {
 	arcan_vobject_litem* current = cell;
 	struct rendertarget* rtgt = arcan_vint_current_rt();
@@ -416,7 +675,14 @@ static void process_scene_normal(arcan_vobject_litem* cell,
 		max = rtgt->max_order;
 	}
 
-	while (current){
+	float frustum[6][4];
+	bool cull = !arcan_video_display.no_3dcull;
+	if (cull)
+		update_frustum(projection, modelview, frustum);
+
+	size_t count = 0;
+
+	for (; current; current = current->next){
 		arcan_vobject* cvo = current->elem;
 
 /* non-negative => 2D part of the pipeline, there's nothing
@@ -425,10 +691,8 @@ static void process_scene_normal(arcan_vobject_litem* cell,
 			break;
 
 		ssize_t abs_o = cvo->order * -1;
-		if (abs_o < min){
-			current = current->next;
+		if (abs_o < min)
 			continue;
-		}
 
 		if (abs_o > max)
 			break;
@@ -439,10 +703,79 @@ static void process_scene_normal(arcan_vobject_litem* cell,
 			dprops = cvo->current;
 		else
 			arcan_resolve_vidprop(cvo, lerp, &dprops);
-		rendermodel(cvo, model, cvo->program, dprops, modelview, flags);
 
-		current = current->next;
+/* instances share geometry (and thus bounds) with their source */
+		arcan_3dmodel* geom = geomsrc(model);
+		if (dprops.opa < EPSILON ||
+			!geom->flags.complete || geom->work_count > 0)
+			continue;
+
+/* out of memory for the queue, fall back to drawing in place */
+		struct draw_item* item = queue_slot(count);
+		if (!item){
+			float _Alignas(16) matr[16];
+			model_matrix(cvo, &dprops, matr);
+			rendermodel(cvo, geom, cvo->program, dprops, modelview, matr, flags);
+			drawq.drawn++;
+			continue;
+		}
+
+		model_matrix(cvo, &dprops, item->model);
+		if (cull && model_culled(geom, &dprops, item->model, frustum)){
+			drawq.culled++;
+			continue;
+		}
+
+		item->vobj = cvo;
+		item->src = geom;
+		item->props = dprops;
+		item->program = geom->geometry && geom->geometry->program > 0 ?
+			geom->geometry->program : cvo->program;
+		item->vstore = cvo->frameset ?
+			cvo->frameset->frames[cvo->frameset->index].frame : cvo->vstore;
+		item->blended =
+			cvo->blendmode != BLEND_NONE || dprops.opa < 1.0 - EPSILON;
+		item->seq = count++;
+	}
+
+	bool batch = !arcan_video_display.no_batch;
+	if (count > 1 && batch && !(flags & MESH_FACING_NODEPTH))
+		qsort(drawq.items, count, sizeof(struct draw_item), cmp_item);
+
+/* runs that share geometry go as one instanced draw, the order within and
+ * between runs is kept so this is safe even without the sort */
+	for (size_t i = 0; i < count;){
+		struct draw_item* item = &drawq.items[i];
+		size_t n = 1;
+
+		if (batch && instance_geometry(item->src))
+			while (i + n < count && same_instance(item, &item[n]))
+				n++;
+
+		if (n == 1 || !render_instanced(item, n, modelview, flags)){
+			for (size_t j = 0; j < n; j++)
+				rendermodel(item[j].vobj, item[j].src, item[j].vobj->program,
+					item[j].props, modelview, item[j].model, flags);
+		}
+
+		i += n;
 	}
+
+	drawq.drawn += count;
+}
+
+void arcan_3d_stats(size_t* drawn, size_t* culled, size_t* draws)
+{
+	if (drawn)
+		*drawn = drawq.drawn;
+
+	if (culled)
+		*culled = drawq.culled;
+
+	if (draws)
+		*draws = drawq.draws;
+
+	drawq.drawn = drawq.culled = drawq.draws = 0;
 }
 
 arcan_errc arcan_3d_bindvr(arcan_vobj_id id, struct arcan_vr_ctx* vrref)
@@ -500,7 +833,7 @@ bool arcan_3d_obj_bb_intersect(arcan_vobj_id cam,
 	vector ray_pos;
 	vector ray_dir;
 
-	float rad = ((arcan_3dmodel*)model->feed.state.ptr)->radius;
+	float rad = geomsrc(model->feed.state.ptr)->radius;
 	arcan_3d_viewray(cam, x, y, arcan_video_display.c_lerp, &ray_pos, &ray_dir);
 
 	float d1, d2;
@@ -557,7 +890,7 @@ arcan_vobject_litem* arcan_3d_refresh(arcan_vobj_id camtag,
 	translate_matrix(dmatr, dprop.position.x, dprop.position.y, dprop.position.z);
 	memcpy(cdata->mvm, dmatr, sizeof(float) * 16);
 
-	process_scene_normal(cell, fract, dmatr, camera->flags);
+	process_scene_normal(cell, fract, dmatr, camera->projection, camera->flags);
 
 	return cell;
 }
@@ -576,6 +909,38 @@ static void minmax_verts(vector* minp, vector* maxp,
 	}
 }
 
+/*
+ * Recalculate the local bounding box and the origin-centred radius (picking)
+ * from the vertices of all geometry. Models that don't have any client-side
+ * vertices keep what the builder set.
+ */
+static void update_bounds(arcan_3dmodel* model)
+{
+	vector minp = {.x =  FLT_MAX, .y =  FLT_MAX, .z =  FLT_MAX};
+	vector maxp = {.x = -FLT_MAX, .y = -FLT_MAX, .z = -FLT_MAX};
+	bool found = false;
+
+	for (struct geometry* geom = model->geometry; geom; geom = geom->next){
+		if (!geom->store.verts ||
+			geom->store.vertex_size != 3 || !geom->store.n_vertices)
+			continue;
+
+		minmax_verts(&minp, &maxp, geom->store.verts, geom->store.n_vertices);
+		found = true;
+	}
+
+	if (!found)
+		return;
+
+	model->bbmin = minp;
+	model->bbmax = maxp;
+	model->radius = len_vector((vector){
+		.x = fabsf(minp.x) > fabsf(maxp.x) ? fabsf(minp.x) : fabsf(maxp.x),
+		.y = fabsf(minp.y) > fabsf(maxp.y) ? fabsf(minp.y) : fabsf(maxp.y),
+		.z = fabsf(minp.z) > fabsf(maxp.z) ? fabsf(minp.z) : fabsf(maxp.z)
+	});
+}
+
 /* Go through the indices of a model and reverse the winding-
  * order of its indices or verts so that front/back facing attribute of
  * each triangle is inverted */
@@ -590,7 +955,7 @@ arcan_errc arcan_3d_swizzlemodel(arcan_vobj_id dst)
 	if (vobj->feed.state.tag != ARCAN_TAG_3DOBJ)
 		return ARCAN_ERRC_UNACCEPTED_STATE;
 
-	arcan_3dmodel* model = (arcan_3dmodel*) vobj->feed.state.ptr;
+	arcan_3dmodel* model = geomsrc(vobj->feed.state.ptr);
 	pthread_mutex_lock(&model->lock);
 	if (model->work_count != 0 || !model->flags.complete){
 		model->deferred.swizzle = true;
@@ -679,12 +1044,11 @@ arcan_vobj_id arcan_3d_pointcloud(size_t count, size_t nmaps)
 		*tbuf++ = (cz + 1.0) / 2.0;
 	}
 
-	newmodel->radius = 1.0;
-
 	vector bbmin = {-1, -1, -1};
 	vector bbmax = { 1,  1,  1};
 	newmodel->bbmin = bbmin;
 	newmodel->bbmax = bbmax;
+	newmodel->radius = len_vector(bbmax);
 	newmodel->flags.complete = true;
 	newmodel->flags.debug = true;
 	newmodel->geometry->nmaps = nmaps;
@@ -885,8 +1249,9 @@ arcan_vobj_id arcan_3d_buildsphere(
 	newmodel->geometry->store.n_vertices = nv / 3;
 	newmodel->geometry->complete = true;
 	newmodel->radius = r;
+	newmodel->bbmin = (vector){.x = -r, .y = -r, .z = -r};
+	newmodel->bbmax = (vector){.x =  r, .y =  r, .z =  r};
 	newmodel->flags.complete = true;
-/* bbmin, bbmax */
 
 /* pass one, base data */
 	float step_l = 1.0f / (float)(l - 1);
@@ -1104,7 +1469,7 @@ arcan_vobj_id arcan_3d_buildbox(float w, float h, float d, size_t nmaps, bool s)
 		newmodel->geometry->complete = true;
 	}
 
-	newmodel->radius = d;
+	newmodel->radius = len_vector(bbmax);
 	newmodel->bbmin = bbmin;
 	newmodel->bbmax = bbmax;
 	newmodel->flags.complete = true;
@@ -1166,8 +1531,7 @@ arcan_vobj_id arcan_3d_buildplane(
 /* though we do know the bounding box and shouldn't need to calculate
  * or iterate, plan is to possibly add transform / lookup functions
  * during creation step, so this is a precaution */
-	minmax_verts(&newmodel->bbmin, &newmodel->bbmax,
-			dst->store.verts, dst->store.n_vertices);
+	update_bounds(newmodel);
 	dst->complete = true;
 	newmodel->flags.complete = true;
 
@@ -1195,7 +1559,7 @@ arcan_errc arcan_3d_meshshader(arcan_vobj_id dst,
 	if (vobj->feed.state.tag != ARCAN_TAG_3DOBJ)
 		return ARCAN_ERRC_UNACCEPTED_STATE;
 
-	struct geometry* cur = ((arcan_3dmodel*)vobj->feed.state.ptr)->geometry;
+	struct geometry* cur = geomsrc(vobj->feed.state.ptr)->geometry;
 	while (cur && slot){
 		cur = cur->next;
 		slot--;
@@ -1333,7 +1697,7 @@ arcan_errc arcan_3d_scalevertices(arcan_vobj_id vid)
 			return ARCAN_ERRC_UNACCEPTED_STATE;
 	}
 
-	arcan_3dmodel* dst = (arcan_3dmodel*) vobj->feed.state.ptr;
+	arcan_3dmodel* dst = geomsrc(vobj->feed.state.ptr);
 
 	pthread_mutex_lock(&dst->lock);
 	if (dst->work_count != 0 || !dst->flags.complete){
@@ -1384,6 +1748,7 @@ arcan_errc arcan_3d_scalevertices(arcan_vobj_id vid)
 		geom = geom->next;
 	}
 
+	update_bounds(dst);
 	pthread_mutex_unlock(&dst->lock);
 	return ARCAN_OK;
 }
@@ -1417,6 +1782,7 @@ arcan_errc arcan_3d_finalizemodel(arcan_vobj_id id)
 
 	if (dstobj->flags.complete == false){
 		dstobj->flags.complete = true;
+		update_bounds(dstobj);
 		push_deferred(dstobj);
 	}
 
@@ -1442,6 +1808,38 @@ arcan_vobj_id arcan_3d_emptymodel()
 	return rv;
 }
 
+arcan_vobj_id arcan_3d_instance(arcan_vobj_id src)
+{
+	arcan_vobject* vobj = arcan_video_getobject(src);
+	if (!vobj || vobj->feed.state.tag != ARCAN_TAG_3DOBJ)
+		return ARCAN_EID;
+
+	arcan_3dmodel* source = geomsrc(vobj->feed.state.ptr);
+	img_cons econs = {0};
+	arcan_3dmodel* newmodel = arcan_alloc_mem(sizeof(arcan_3dmodel),
+		ARCAN_MEM_VTAG, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+	vfunc_state state = {.tag = ARCAN_TAG_3DOBJ, .ptr = newmodel};
+
+	arcan_vobj_id rv = arcan_video_addfobject(FFUNC_3DOBJ, state, econs, 1);
+	if (rv == ARCAN_EID){
+		arcan_mem_free(newmodel);
+		return rv;
+	}
+
+	newmodel->parent = arcan_video_getobject(rv);
+	newmodel->source = source;
+	newmodel->flags.complete = true;
+	pthread_mutex_init(&newmodel->lock, NULL);
+	source->instances++;
+
+/* start out looking like the source, textures can be changed freely */
+	if (vobj->vstore->txmapped != TXSTATE_OFF &&
+		vobj->vstore->vinf.text.glid && !FL_TEST(vobj, FL_PRSIST))
+		arcan_video_shareglstore(src, rv);
+
+	return rv;
+}
+
 arcan_errc arcan_3d_baseorient(arcan_vobj_id dst,
 	float roll, float pitch, float yaw)
 {
@@ -1453,7 +1851,7 @@ arcan_errc arcan_3d_baseorient(arcan_vobj_id dst,
 	if (vobj->feed.state.tag != ARCAN_TAG_3DOBJ)
 		return ARCAN_ERRC_UNACCEPTED_STATE;
 
-	arcan_3dmodel* model = vobj->feed.state.ptr;
+	arcan_3dmodel* model = geomsrc(vobj->feed.state.ptr);
 	pthread_mutex_lock(&model->lock);
 
 	if (model->work_count != 0 || !model->flags.complete){
@@ -1489,6 +1887,7 @@ arcan_errc arcan_3d_baseorient(arcan_vobj_id dst,
 		geom = geom->next;
 	}
 
+	update_bounds(model);
 	pthread_mutex_unlock(&model->lock);
 	return ARCAN_OK;
 }
@@ -120,6 +120,15 @@ void arcan_3d_viewray(arcan_vobj_id camtag,
  * bounding volumes. Only finalized models will be drawn in 3d_refresh */
 arcan_vobj_id arcan_3d_emptymodel();
 
+/*
+ * Create a new object that draws the geometry of [src] with its own
+ * transform, opacity and texture. Geometry is shared, so destructive
+ * transforms on either affect all of them, and it is kept alive until both
+ * [src] and all its instances are gone. Visible instances of the same model
+ * and texture are drawn with a single instanced draw when possible.
+ */
+arcan_vobj_id arcan_3d_instance(arcan_vobj_id src);
+
 /*
  * Mark a model as completed, this is a contract that no-more meshes will be
  * added and that it is safe to calculate values that require the entire model
@@ -190,6 +199,13 @@ arcan_errc arcan_3d_scalevertices(arcan_vobj_id vid);
  */
 arcan_errc arcan_3d_swizzlemodel(arcan_vobj_id model);
 
+/*
+ * Retrieve the number of models submitted [drawn], the number rejected by
+ * the view frustum test [culled] and the number of mesh draw calls this
+ * took [draws] since the last call. Any can be NULL.
+ */
+void arcan_3d_stats(size_t* drawn, size_t* culled, size_t* draws);
+
 #ifdef A3D_PRIVATE
 enum arcan_ffunc_rv arcan_ffunc_3dobj FFUNC_HEAD;
 #endif
@@ -0,0 +1,255 @@
+/*
+ * License: 3-Clause BSD, see COPYING file in arcan source repository.
+ * Reference: http://arcan-fe.com
+ * Description: Planar float mixing kernels for the frameserver audio mixer,
+ * see arcan_amix.h for the overall flow.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "arcan_amix.h"
+
+#define RING_MASK (ARCAN_AMIX_RING - 1)
+
+/* -1 dBFS-ish ceiling for the limiter, and per-block release factor */
+#define LIMIT_CEIL 0.9f
+#define LIMIT_RELEASE 0.05f
+
+size_t arcan_amix_ring_used(const struct arcan_amix_ring* ring)
+{
+	return ring->wpos - ring->rpos;
+}
+
+void arcan_amix_s16_f32(const int16_t* in,
+	size_t frames, float* l, float* r, float l_gain, float r_gain)
+{
+	size_t i = 0;
+	l_gain /= 32767.0f;
+	r_gain /= 32767.0f;
+
+#if defined(__SSE2__)
+	__m128 gain = _mm_setr_ps(l_gain, r_gain, l_gain, r_gain);
+
+/* 4 frames per step, sign-extend, convert and split into L/R */
+	for (; i + 4 <= frames; i += 4){
+		__m128i v = _mm_loadu_si128((const __m128i*) &in[i * 2]);
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		__m128 a = _mm_mul_ps(_mm_cvtepi32_ps(lo), gain);
+		__m128 b = _mm_mul_ps(_mm_cvtepi32_ps(hi), gain);
+		_mm_storeu_ps(&l[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(&r[i], _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 8 <= frames; i += 8){
+		int16x8x2_t v = vld2q_s16(&in[i * 2]);
+		vst1q_f32(&l[i], vmulq_n_f32(
+			vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[0]))), l_gain));
+		vst1q_f32(&l[i+4], vmulq_n_f32(
+			vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[0]))), l_gain));
+		vst1q_f32(&r[i], vmulq_n_f32(
+			vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[1]))), r_gain));
+		vst1q_f32(&r[i+4], vmulq_n_f32(
+			vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[1]))), r_gain));
+	}
+#endif
+
+	for (; i < frames; i++){
+		l[i] = (float) in[i * 2 + 0] * l_gain;
+		r[i] = (float) in[i * 2 + 1] * r_gain;
+	}
+}
+
+void arcan_amix_accum(float* dst, const float* src, size_t n)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(&dst[i],
+			_mm_add_ps(_mm_loadu_ps(&dst[i]), _mm_loadu_ps(&src[i])));
+#elif defined(__ARM_NEON)
+	for (; i + 4 <= n; i += 4)
+		vst1q_f32(&dst[i], vaddq_f32(vld1q_f32(&dst[i]), vld1q_f32(&src[i])));
+#endif
+
+	for (; i < n; i++)
+		dst[i] += src[i];
+}
+
+float arcan_amix_peak(const float* l, const float* r, size_t n)
+{
+	size_t i = 0;
+	float peak = 0;
+
+#if defined(__SSE2__)
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 acc = _mm_setzero_ps();
+	for (; i + 4 <= n; i += 4){
+		acc = _mm_max_ps(acc, _mm_andnot_ps(sign, _mm_loadu_ps(&l[i])));
+		acc = _mm_max_ps(acc, _mm_andnot_ps(sign, _mm_loadu_ps(&r[i])));
+	}
+	float tmp[4];
+	_mm_storeu_ps(tmp, acc);
+	for (size_t j = 0; j < 4; j++)
+		peak = tmp[j] > peak ? tmp[j] : peak;
+#elif defined(__ARM_NEON)
+	float32x4_t acc = vdupq_n_f32(0);
+	for (; i + 4 <= n; i += 4){
+		acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(&l[i])));
+		acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(&r[i])));
+	}
+	float tmp[4];
+	vst1q_f32(tmp, acc);
+	for (size_t j = 0; j < 4; j++)
+		peak = tmp[j] > peak ? tmp[j] : peak;
+#endif
+
+	for (; i < n; i++){
+		float a = fabsf(l[i]);
+		float b = fabsf(r[i]);
+		peak = a > peak ? a : peak;
+		peak = b > peak ? b : peak;
+	}
+
+	return peak;
+}
+
+float arcan_amix_limit(float gain, float peak)
+{
+	float target = peak > LIMIT_CEIL ? LIMIT_CEIL / peak : 1.0f;
+
+	if (target < gain)
+		return target;
+
+	gain += (1.0f - gain) * LIMIT_RELEASE;
+	return gain > target ? target : gain;
+}
+
+void arcan_amix_f32_s16(const float* l, const float* r,
+	size_t frames, float g0, float g1, int16_t* out)
+{
+	size_t i = 0;
+	float step = frames ? (g1 - g0) / (float) frames : 0;
+
+#if defined(__SSE2__)
+	__m128 scale = _mm_set1_ps(32767.0f);
+	__m128 hi = _mm_set1_ps(1.0f);
+	__m128 lo = _mm_set1_ps(-1.0f);
+	__m128 gain = _mm_setr_ps(g0, g0 + step, g0 + 2 * step, g0 + 3 * step);
+	__m128 gstep = _mm_set1_ps(4 * step);
+
+	for (; i + 4 <= frames; i += 4){
+		__m128 a = _mm_mul_ps(_mm_loadu_ps(&l[i]), gain);
+		__m128 b = _mm_mul_ps(_mm_loadu_ps(&r[i]), gain);
+		a = _mm_mul_ps(_mm_max_ps(_mm_min_ps(a, hi), lo), scale);
+		b = _mm_mul_ps(_mm_max_ps(_mm_min_ps(b, hi), lo), scale);
+
+/* interleave and let the saturating pack deal with the last bit */
+		__m128i p0 = _mm_cvtps_epi32(_mm_unpacklo_ps(a, b));
+		__m128i p1 = _mm_cvtps_epi32(_mm_unpackhi_ps(a, b));
+		_mm_storeu_si128((__m128i*) &out[i * 2], _mm_packs_epi32(p0, p1));
+		gain = _mm_add_ps(gain, gstep);
+	}
+#elif defined(__ARM_NEON)
+	float ginit[4] = {g0, g0 + step, g0 + 2 * step, g0 + 3 * step};
+	float32x4_t gain = vld1q_f32(ginit);
+	float32x4_t gstep = vdupq_n_f32(4 * step);
+	float32x4_t hi = vdupq_n_f32(1.0f);
+	float32x4_t lo = vdupq_n_f32(-1.0f);
+
+	for (; i + 4 <= frames; i += 4){
+		float32x4_t a = vmulq_f32(vld1q_f32(&l[i]), gain);
+		float32x4_t b = vmulq_f32(vld1q_f32(&r[i]), gain);
+		a = vmulq_n_f32(vmaxq_f32(vminq_f32(a, hi), lo), 32767.0f);
+		b = vmulq_n_f32(vmaxq_f32(vminq_f32(b, hi), lo), 32767.0f);
+
+		int16x4x2_t v = {{
+			vqmovn_s32(vcvtq_s32_f32(a)),
+			vqmovn_s32(vcvtq_s32_f32(b))
+		}};
+		vst2_s16(&out[i * 2], v);
+		gain = vaddq_f32(gain, gstep);
+	}
+#endif
+
+	for (; i < frames; i++){
+		float g = g0 + step * (float) i;
+		float a = l[i] * g;
+		float b = r[i] * g;
+		a = a > 1.0f ? 1.0f : (a < -1.0f ? -1.0f : a);
+		b = b > 1.0f ? 1.0f : (b < -1.0f ? -1.0f : b);
+		out[i * 2 + 0] = (int16_t) lrintf(a * 32767.0f);
+		out[i * 2 + 1] = (int16_t) lrintf(b * 32767.0f);
+	}
+}
+
+/*
+ * The ring helpers split each request into at most two contiguous spans so
+ * that the kernels above never have to deal with the wrap.
+ */
+size_t arcan_amix_ring_write_s16(struct arcan_amix_ring* ring,
+	const int16_t* in, size_t frames, float l_gain, float r_gain)
+{
+	size_t space = ARCAN_AMIX_RING - arcan_amix_ring_used(ring);
+	if (frames > space)
+		frames = space;
+
+	size_t ofs = ring->wpos & RING_MASK;
+	size_t first = ARCAN_AMIX_RING - ofs;
+	if (first > frames)
+		first = frames;
+
+	arcan_amix_s16_f32(in,
+		first, &ring->l[ofs], &ring->r[ofs], l_gain, r_gain);
+	arcan_amix_s16_f32(&in[first * 2],
+		frames - first, ring->l, ring->r, l_gain, r_gain);
+
+	ring->wpos += frames;
+	return frames;
+}
+
+size_t arcan_amix_ring_write(struct arcan_amix_ring* ring,
+	const float* l, const float* r, size_t frames)
+{
+	size_t space = ARCAN_AMIX_RING - arcan_amix_ring_used(ring);
+	if (frames > space)
+		frames = space;
+
+	size_t ofs = ring->wpos & RING_MASK;
+	size_t first = ARCAN_AMIX_RING - ofs;
+	if (first > frames)
+		first = frames;
+
+	memcpy(&ring->l[ofs], l, first * sizeof(float));
+	memcpy(&ring->r[ofs], r, first * sizeof(float));
+	memcpy(ring->l, &l[first], (frames - first) * sizeof(float));
+	memcpy(ring->r, &r[first], (frames - first) * sizeof(float));
+
+	ring->wpos += frames;
+	return frames;
+}
+
+void arcan_amix_ring_accum(
+	struct arcan_amix_ring* ring, float* l, float* r, size_t frames)
+{
+	size_t ofs = ring->rpos & RING_MASK;
+	size_t first = ARCAN_AMIX_RING - ofs;
+	if (first > frames)
+		first = frames;
+
+	arcan_amix_accum(l, &ring->l[ofs], first);
+	arcan_amix_accum(r, &ring->r[ofs], first);
+	arcan_amix_accum(&l[first], ring->l, frames - first);
+	arcan_amix_accum(&r[first], ring->r, frames - first);
+
+	ring->rpos += frames;
+}
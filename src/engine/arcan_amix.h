@@ -0,0 +1,82 @@
+/*
+ * License: 3-Clause BSD, see COPYING file in arcan source repository.
+ * Reference: http://arcan-fe.com
+ */
+
+#ifndef _HAVE_ARCAN_AMIX
+#define _HAVE_ARCAN_AMIX
+
+/*
+ * Planar float audio mixing kernels used by the frameserver recording mixer.
+ *
+ * Sources are converted from interleaved stereo s16 to planar float with
+ * gain applied, and kept in per-source ring buffers. Mixing sums the rings
+ * and converts back through a peak limiter into interleaved s16.
+ *
+ * The kernels have SSE2 and NEON versions picked at compile time with a
+ * scalar fallback for tails and other architectures. There are no
+ * dependencies on the rest of the engine so that they can be benchmarked
+ * and tested in isolation (see tests/benchmark/amix).
+ */
+
+/* frames per channel in a source ring, must be a power of two */
+#ifndef ARCAN_AMIX_RING
+#define ARCAN_AMIX_RING 4096
+#endif
+
+struct arcan_amix_ring {
+	float l[ARCAN_AMIX_RING];
+	float r[ARCAN_AMIX_RING];
+
+/* monotonic, masked on access */
+	size_t rpos, wpos;
+};
+
+/* number of frames buffered and ready to be mixed */
+size_t arcan_amix_ring_used(const struct arcan_amix_ring* ring);
+
+/*
+ * convert [frames] interleaved L/R s16 frames from [in] with gain and append
+ * to the ring, returns the number of frames that fit, the rest is dropped
+ */
+size_t arcan_amix_ring_write_s16(struct arcan_amix_ring* ring,
+	const int16_t* in, size_t frames, float l_gain, float r_gain);
+
+/* append already converted planar data to the ring, same rules as above */
+size_t arcan_amix_ring_write(struct arcan_amix_ring* ring,
+	const float* l, const float* r, size_t frames);
+
+/*
+ * add [frames] (<= ring_used) from the ring into [l, r] and consume them
+ */
+void arcan_amix_ring_accum(
+	struct arcan_amix_ring* ring, float* l, float* r, size_t frames);
+
+/*
+ * interleaved s16 stereo to planar float with gain, [l, r] need room for
+ * [frames] floats each
+ */
+void arcan_amix_s16_f32(const int16_t* in,
+	size_t frames, float* l, float* r, float l_gain, float r_gain);
+
+/* dst[i] += src[i] */
+void arcan_amix_accum(float* dst, const float* src, size_t n);
+
+/* largest absolute sample value in [l, r] */
+float arcan_amix_peak(const float* l, const float* r, size_t n);
+
+/*
+ * peak limiter, takes the current limiter gain and the peak of the next
+ * block and returns the gain to apply at the end of the block. Attack is
+ * immediate, release is gradual to avoid pumping.
+ */
+float arcan_amix_limit(float gain, float peak);
+
+/*
+ * planar float to interleaved s16, gain is linearly ramped from [g0] to [g1]
+ * across the block and the result is clipped to the valid range
+ */
+void arcan_amix_f32_s16(const float* l, const float* r,
+	size_t frames, float g0, float g1, int16_t* out);
+
+#endif
@@ -19,6 +19,7 @@
 #include <limits.h>
 #include <inttypes.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include <al.h>
 #include <alc.h>
@@ -31,6 +32,8 @@
 #include "arcan_audioint.h"
 #include "arcan_event.h"
 
+#include PLATFORM_HEADER
+
 struct arcan_acontext {
 /* linked list of audio sources, the number of available sources are platform /
  * hw dependant, ranging between 10-100 or so */
@@ -55,11 +58,79 @@ struct arcan_acontext {
 
 static bool _wrap_alError(arcan_aobj*, char*);
 static ssize_t find_bufferind(arcan_aobj* cur, unsigned bufnum);
+static void astream_refill(arcan_aobj* current);
 
 #ifndef CONST_MAX_ASAMPLESZ
 #define CONST_MAX_ASAMPLESZ 1048756
 #endif
 
+/*
+ * Refill period (ms) for the audio thread, 0 falls back to refilling from
+ * the main loop through arcan_audio_refresh. Can be overridden with the
+ * 'audio_period' config key.
+ */
+#ifndef ARCAN_AUDIO_PERIOD
+#define ARCAN_AUDIO_PERIOD 5
+#endif
+
+#ifndef ARCAN_AUDIO_PERIOD_MAX
+#define ARCAN_AUDIO_PERIOD_MAX 100
+#endif
+
+/* events generated on the audio thread that wait for the main thread */
+#define DEFERRED_EVENT_LIMIT 64
+
+/*
+ * With the audio thread active, stream refill and with it the feed and
+ * monitor callbacks run there instead of on the main thread. Frameservers
+ * hand over audio through the shmif buffer ring which is already atomic, and
+ * the recording mix buffer is a single-producer ring (see frameserver.h).
+ *
+ * The object list and the AL state of streaming sources are protected by a
+ * recursive lock as the public functions nest. The main thread only holds it
+ * for short updates so a slow frame does not stall refill. Events can't be
+ * enqueued from the thread, those are deferred and forwarded on the next
+ * refresh or tick from the main thread.
+ */
+static struct {
+	pthread_mutex_t lock;
+	bool lock_init;
+	pthread_t thread;
+	_Atomic bool alive;
+	bool running;
+	unsigned period;
+
+	_Atomic size_t active;
+
+	struct arcan_event deferred[DEFERRED_EVENT_LIMIT];
+	size_t n_deferred;
+} athread;
+
+#define ALOCK() pthread_mutex_lock(&athread.lock)
+#define AUNLOCK() pthread_mutex_unlock(&athread.lock)
+
+void arcan_audio_lockfeeds()
+{
+	if (athread.lock_init)
+		ALOCK();
+}
+
+void arcan_audio_unlockfeeds()
+{
+	if (athread.lock_init)
+		AUNLOCK();
+}
+
+static bool in_athread()
+{
+	return athread.running && pthread_equal(pthread_self(), athread.thread);
+}
+
+bool arcan_audio_isthread()
+{
+	return in_athread();
+}
+
 /* context management here is quite different from video (no push / pop / etc.
  * openAL volatility alongside hardware buffering problems etc. make it too
  * much of a hazzle */
@@ -223,6 +294,8 @@ static arcan_aobj_id arcan_audio_alloc(arcan_aobj** dst, bool defer)
 	arcan_aobj* newcell = arcan_alloc_mem(sizeof(arcan_aobj), ARCAN_MEM_ATAG,
 		ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
 
+	ALOCK();
+
 	newcell->alid = alid;
 	newcell->gain = current_acontext->def_gain;
 
@@ -244,6 +317,7 @@ static arcan_aobj_id arcan_audio_alloc(arcan_aobj** dst, bool defer)
 	else
 		current_acontext->first = newcell;
 
+	AUNLOCK();
 	return newcell->id;
 }
 
@@ -270,7 +344,9 @@ arcan_errc arcan_audio_alterfeed(arcan_aobj_id id, arcan_afunc_cb cb)
 		if (!cb)
 			rv = ARCAN_ERRC_BAD_ARGUMENT;
 		else {
+			ALOCK();
 			obj->feed = cb;
+			AUNLOCK();
 			rv = ARCAN_OK;
 		}
 	}
@@ -281,6 +357,7 @@ arcan_errc arcan_audio_alterfeed(arcan_aobj_id id, arcan_afunc_cb cb)
 static arcan_errc audio_free(arcan_aobj_id id)
 {
 	arcan_errc rv = ARCAN_ERRC_NO_SUCH_OBJECT;
+	ALOCK();
 	arcan_aobj* current = current_acontext->first;
 	arcan_aobj** owner = &(current_acontext->first);
 
@@ -311,11 +388,134 @@ static arcan_errc audio_free(arcan_aobj_id id)
 		rv = ARCAN_OK;
 	}
 
+	AUNLOCK();
 	return rv;
 }
 
+static size_t refresh_streams()
+{
+	arcan_aobj* current = current_acontext->first;
+	size_t rv = 0;
+
+	while(current){
+		if (
+			current->kind == AOBJ_STREAM      ||
+			current->kind == AOBJ_FRAMESTREAM ||
+			current->kind == AOBJ_CAPTUREFEED
+		)
+			astream_refill(current);
+
+		_wrap_alError(current, "audio_refresh()");
+		if (current->used)
+			rv++;
+
+		current = current->next;
+	}
+
+	return rv;
+}
+
+/* main thread only, forward anything the audio thread couldn't emit */
+static void flush_deferred()
+{
+	struct arcan_event evs[DEFERRED_EVENT_LIMIT];
+
+	ALOCK();
+	size_t count = athread.n_deferred;
+	memcpy(evs, athread.deferred, sizeof(struct arcan_event) * count);
+	athread.n_deferred = 0;
+	AUNLOCK();
+
+	for (size_t i = 0; i < count; i++)
+		arcan_event_denqueue(arcan_event_defaultctx(), &evs[i]);
+}
+
+static void emit_event(struct arcan_event* ev)
+{
+	if (!in_athread()){
+		arcan_event_denqueue(arcan_event_defaultctx(), ev);
+		return;
+	}
+
+/* lock is already held by the thread during refill */
+	if (athread.n_deferred < DEFERRED_EVENT_LIMIT)
+		athread.deferred[athread.n_deferred++] = *ev;
+	else
+		arcan_warning("(audio) deferred event queue full, dropping\n");
+}
+
+static void* athread_loop(void* arg)
+{
+	while (atomic_load(&athread.alive)){
+		unsigned long long start = arcan_timemillis();
+
+		ALOCK();
+		if (current_acontext->context && current_acontext->al_active){
+			TRACE_MARK_ENTER("audio", "refill", TRACE_SYS_DEFAULT, 0, 0, "");
+			atomic_store(&athread.active, refresh_streams());
+			TRACE_MARK_EXIT("audio", "refill", TRACE_SYS_DEFAULT, 0, 0, "");
+		}
+		AUNLOCK();
+
+		unsigned long long spent = arcan_timemillis() - start;
+		if (spent < athread.period)
+			arcan_timesleep(athread.period - spent);
+	}
+
+	return NULL;
+}
+
+static void athread_start()
+{
+	uintptr_t tag;
+	cfg_lookup_fun get_config = platform_config_lookup(&tag);
+	char* period = NULL;
+
+	athread.period = ARCAN_AUDIO_PERIOD;
+	if (get_config("audio_period", 0, &period, tag) && period){
+		athread.period = strtoul(period, NULL, 10);
+		free(period);
+	}
+
+	if (athread.period > ARCAN_AUDIO_PERIOD_MAX)
+		athread.period = ARCAN_AUDIO_PERIOD_MAX;
+
+	if (!athread.period)
+		return;
+
+	atomic_store(&athread.alive, true);
+	if (0 != pthread_create(&athread.thread, NULL, athread_loop, NULL)){
+		arcan_warning("(audio) couldn't spawn audio thread, "
+			"refill will be done from the main loop\n");
+		atomic_store(&athread.alive, false);
+		return;
+	}
+
+	athread.running = true;
+}
+
+static void athread_stop()
+{
+	if (!athread.running)
+		return;
+
+	atomic_store(&athread.alive, false);
+	pthread_join(athread.thread, NULL);
+	athread.running = false;
+	flush_deferred();
+}
+
 arcan_errc arcan_audio_setup(bool nosound)
 {
+	if (!athread.lock_init){
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&athread.lock, &attr);
+		pthread_mutexattr_destroy(&attr);
+		athread.lock_init = true;
+	}
+
 	arcan_errc rv = ARCAN_ERRC_NOAUDIO;
 
 /* don't supported repeated calls without shutting down in between */
@@ -347,6 +547,8 @@ arcan_errc arcan_audio_setup(bool nosound)
 		/* just give a slightly "random" base so that
 		 * user scripts don't get locked into hard-coded ids .. */
 		current_acontext->lastid = rand() % 32768;
+
+		athread_start();
 	}
 
 	return rv;
@@ -374,6 +576,8 @@ arcan_errc arcan_audio_shutdown()
 	if (!ctx)
 		return rv;
 
+	athread_stop();
+
 /* there might be more to clean-up here, monitoring /callback buffers/tags */
 
 	alcDestroyContext(ctx);
@@ -412,9 +616,11 @@ arcan_errc arcan_audio_play(
 	}
 /* some kind of streaming source, can't play if it is already active */
 	else if (aobj->active == false && aobj->alid != AL_NONE){
+		ALOCK();
 		alSourcePlay(aobj->alid);
 		_wrap_alError(aobj, "play(alSourcePlay)");
 		aobj->active = true;
+		AUNLOCK();
 	}
 
 	return ARCAN_OK;
@@ -510,11 +716,13 @@ arcan_errc arcan_audio_hookfeed(arcan_aobj_id id, void* tag,
 	if (!aobj)
 		return ARCAN_ERRC_NO_SUCH_OBJECT;
 
+	ALOCK();
 	if (oldtag)
 		*oldtag = aobj->monitortag ? aobj->monitortag : NULL;
 
 	aobj->monitor = hookfun;
 	aobj->monitortag = tag;
+	AUNLOCK();
 
 	return ARCAN_OK;
 }
@@ -522,8 +730,10 @@ arcan_errc arcan_audio_hookfeed(arcan_aobj_id id, void* tag,
 arcan_aobj_id arcan_audio_feed(arcan_afunc_cb feed, void* tag, arcan_errc* errc)
 {
 	arcan_aobj* aobj;
+	ALOCK();
 	arcan_aobj_id rid = arcan_audio_alloc(&aobj, true);
 	if (!aobj){
+		AUNLOCK();
 		if (errc) *errc = ARCAN_ERRC_OUT_OF_SPACE;
 		return ARCAN_EID;
 	}
@@ -537,6 +747,7 @@ arcan_aobj_id arcan_audio_feed(arcan_afunc_cb feed, void* tag, arcan_errc* errc)
 	aobj->feed = feed;
 	aobj->gain = 1.0;
 	aobj->kind = AOBJ_STREAM;
+	AUNLOCK();
 
 	if (errc) *errc = ARCAN_OK;
 	return rid;
@@ -550,6 +761,7 @@ arcan_errc arcan_audio_rebuild(arcan_aobj_id id)
 	if (!aobj || aobj->alid == AL_NONE)
 		return ARCAN_ERRC_NO_SUCH_OBJECT;
 
+	ALOCK();
 	alSourceStop(aobj->alid);
 	_wrap_alError(NULL, "audio_rebuild(stop)");
 
@@ -569,6 +781,7 @@ arcan_errc arcan_audio_rebuild(arcan_aobj_id id)
 	alSourcef(aobj->alid, AL_GAIN, aobj->gain);
 
 	_wrap_alError(NULL, "audio_rebuild(recreate)");
+	AUNLOCK();
 
 	return ARCAN_OK;
 }
@@ -583,6 +796,7 @@ arcan_errc arcan_audio_suspend()
 {
 	arcan_errc rv = ARCAN_ERRC_BAD_ARGUMENT;
 
+	ALOCK();
 	arcan_aobj* current = current_acontext->first;
 
 	while (current) {
@@ -593,6 +807,7 @@ arcan_errc arcan_audio_suspend()
 	}
 
 	current_acontext->al_active = false;
+	AUNLOCK();
 	rv = ARCAN_OK;
 
 	return rv;
@@ -601,6 +816,7 @@ arcan_errc arcan_audio_suspend()
 arcan_errc arcan_audio_resume()
 {
 	arcan_errc rv = ARCAN_ERRC_BAD_ARGUMENT;
+	ALOCK();
 	arcan_aobj* current = current_acontext->first;
 
 	while (current) {
@@ -610,6 +826,7 @@ arcan_errc arcan_audio_resume()
 	}
 
 	current_acontext->al_active = true;
+	AUNLOCK();
 
 	rv = ARCAN_OK;
 
@@ -628,9 +845,11 @@ arcan_errc arcan_audio_pause(arcan_aobj_id id)
  * alSourceUnqueueBuffers(dobj->alid, 1, (unsigned int*) &processed);
  * dobj->used -= processed;
  */
+		ALOCK();
 		alSourceStop(dobj->alid);
 		_wrap_alError(dobj, "audio_pause(get/unqueue/stop)");
 		dobj->active = false;
+		AUNLOCK();
 		rv = ARCAN_OK;
 	}
 
@@ -643,10 +862,11 @@ arcan_errc arcan_audio_stop(arcan_aobj_id id)
 	if (!dobj)
 		return ARCAN_ERRC_NO_SUCH_OBJECT;
 
+	ALOCK();
 	dobj->kind = AOBJ_INVALID;
 	dobj->feed = NULL;
-
 	audio_free(id);
+	AUNLOCK();
 
 	arcan_event newevent = {
 		.category = EVENT_AUDIO,
@@ -902,14 +1122,16 @@ cleanup:
 /* enqueue direct into drain, this might invoke audio callback on the scripting
  * side in order to immediately chain the playback of another sample */
 	newevent.aud.source = current->id;
-	arcan_event_denqueue(arcan_event_defaultctx(), &newevent);
+	emit_event(&newevent);
 }
 
 void arcan_aid_refresh(arcan_aobj_id aid)
 {
+	ALOCK();
 	struct arcan_aobj* obj = arcan_audio_getobj(aid);
 	if (obj)
 		astream_refill(obj);
+	AUNLOCK();
 }
 
 char** arcan_audio_capturelist()
@@ -1010,6 +1232,8 @@ arcan_aobj_id arcan_audio_capturefeed(const char* dev)
 	arcan_aobj* dstobj = NULL;
 	ALCdevice* capture = alcCaptureOpenDevice(dev,
 		ARCAN_SHMIF_SAMPLERATE, AL_FORMAT_STEREO16, 65536);
+
+	ALOCK();
 	arcan_audio_alloc(&dstobj, false);
 
 /* we let OpenAL maintain the capture buffer, we flush it like other feeds
@@ -1025,6 +1249,7 @@ arcan_aobj_id arcan_audio_capturefeed(const char* dev)
 
 		alGenBuffers(dstobj->n_streambuf, dstobj->streambuf);
 		alcCaptureStart(capture);
+		AUNLOCK();
 		return dstobj->id;
 	}
 	else{
@@ -1038,6 +1263,7 @@ arcan_aobj_id arcan_audio_capturefeed(const char* dev)
 			audio_free(dstobj->id);
 	}
 
+	AUNLOCK();
 	return ARCAN_EID;
 }
 
@@ -1046,25 +1272,13 @@ size_t arcan_audio_refresh()
 	if (!current_acontext->context || !current_acontext->al_active)
 		return 0;
 
-	arcan_aobj* current = current_acontext->first;
-	size_t rv = 0;
-
-	while(current){
-		if (
-			current->kind == AOBJ_STREAM      ||
-			current->kind == AOBJ_FRAMESTREAM ||
-			current->kind == AOBJ_CAPTUREFEED
-		)
-			astream_refill(current);
-
-		_wrap_alError(current, "audio_refresh()");
-		if (current->used)
-			rv++;
-
-		current = current->next;
+/* the thread does the actual refilling */
+	if (athread.running){
+		flush_deferred();
+		return atomic_load(&athread.active);
 	}
 
-	return rv;
+	return refresh_streams();
 }
 
 static inline bool step_transform(arcan_aobj* obj)
@@ -1103,6 +1317,7 @@ void arcan_audio_tick(uint8_t ntt)
 	arcan_audio_refresh();
 
 /* update time-dependent transformations */
+	ALOCK();
 	while (ntt-- > 0) {
 		arcan_aobj* current = current_acontext->first;
 
@@ -1121,6 +1336,7 @@ void arcan_audio_tick(uint8_t ntt)
 
 		current_acontext->atick_counter++;
 	}
+	AUNLOCK();
 
 /* scan all streaming buffers and free up those no-longer needed */
 	for (size_t i = 0; i < ARCAN_AUDIO_SLIMIT; i++)
@@ -1149,6 +1365,7 @@ void arcan_audio_tick(uint8_t ntt)
  */
 void arcan_audio_purge(arcan_aobj_id* ids, size_t nids)
 {
+	ALOCK();
 	arcan_aobj* current = _current_acontext.first;
 	arcan_aobj** previous = &_current_acontext.first;
 
@@ -1186,6 +1403,7 @@ void arcan_audio_purge(arcan_aobj_id* ids, size_t nids)
 
 		current = next;
 	}
+	AUNLOCK();
 }
 
 static bool _wrap_alError(arcan_aobj* obj, char* prefix)
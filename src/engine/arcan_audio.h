@@ -132,6 +132,17 @@ arcan_aobj_id arcan_audio_feed(arcan_afunc_cb feed,
  */
 enum aobj_kind arcan_audio_kind(arcan_aobj_id);
 
+/*
+ * Block stream refill (and with it feed callbacks on the audio thread) while
+ * the caller changes state that a feed reads, e.g. a frameserver remapping
+ * its shared memory. Calls nest, keep the section short.
+ */
+void arcan_audio_lockfeeds();
+void arcan_audio_unlockfeeds();
+
+/* true if the caller is the audio refill thread */
+bool arcan_audio_isthread();
+
 /* destroy an audio object and everything associated with it */
 arcan_errc arcan_audio_stop(arcan_aobj_id);
 
@@ -75,9 +75,10 @@ void arcan_conductor_toggle_watchdog()
  *      then we still have the problem of those not being a multiplexable primitives
  *      and needing a separate path for OSX.
  *
- *  [ ] defer GCs to low-load / embarassing pause in thread during synch etc.
+ *  [x] defer GCs to low-load / embarassing pause in thread during synch etc.
  *      since we now 'know' when we are waiting for the GPU to unlock, this is a
  *      good spot to manually step the Lua GCing.
+ *      [ ] same for the memory pools in arcan_mem_tick
  *
  *  [ ] perform readbacks in possible delay periods might break some GPU drivers
  *
@@ -92,12 +93,20 @@ static struct {
 	double transfer_cost;
 	uint8_t timestep;
 	bool in_frame;
+
+/* upper bound (microseconds) for one gc slice, and the accumulated time
+ * spent in gc slices since the last frame */
+	size_t gc_budget;
+	size_t gc_time;
 } conductor = {
 	.render_cost = 4,
 	.transfer_cost = 1,
-	.timestep = 2
+	.timestep = 2,
+	.gc_budget = 1000
 };
 
+extern struct arcan_luactx* main_lua_context;
+
 static ssize_t find_frameserver(struct arcan_frameserver* fsrv);
 
 /*
@@ -177,9 +186,37 @@ static void step_herd(int mode)
 		TRACE_SYS_DEFAULT, mode, conductor.transfer_cost, "step-herd");
 }
 
+/*
+ * Step the Lua GC in a period where we would otherwise be waiting, [left] is
+ * the number of ms until we need to be back in the critical path. One ms is
+ * kept as a safety margin as the step granularity is coarse. Returns the
+ * number of ms consumed.
+ */
+static int gc_slice(int left)
+{
+	if (left <= 1)
+		return 0;
+
+	size_t budget = (left - 1) * 1000;
+	if (budget > conductor.gc_budget)
+		budget = conductor.gc_budget;
+
+	size_t spent = arcan_lua_gcstep(main_lua_context, budget);
+	if (spent){
+		TRACE_MARK_ONESHOT("conductor", "gc",
+			TRACE_SYS_DEFAULT, 0, spent, "gc-step");
+	}
+
+	conductor.gc_time += spent;
+	return spent / 1000;
+}
+
 static void internal_yield()
 {
-	arcan_timesleep(conductor.timestep);
+	int left = conductor.timestep - gc_slice(conductor.timestep);
+	if (left > 0)
+		arcan_timesleep(left);
+
 	TRACE_MARK_ONESHOT("conductor", "yield",
 		TRACE_SYS_DEFAULT, 0, conductor.timestep, "step");
 }
@@ -303,8 +340,18 @@ int arcan_conductor_yield(struct conductor_display* disps, size_t pset_count)
 		}
 	}
 
+/* the platform is waiting on the display or GPU, if it has told us about the
+ * deadline, use the window to step the GC without risking to overshoot */
+	int window = conductor.timestep;
+	if (conductor.set_deadline > 0){
+		int64_t rem = conductor.set_deadline - (int64_t) arcan_timemillis();
+		window = rem < window ? rem : window;
+	}
+
+	int left = conductor.timestep - gc_slice(window);
+
 /* same as other timesleep calls, should be replaced with poll and pollset */
-	return conductor.timestep;
+	return left > 0 ? left : 1;
 }
 
 ssize_t find_frameserver(struct arcan_frameserver* fsrv)
@@ -412,7 +459,6 @@ void arcan_conductor_deregister_frameserver(struct arcan_frameserver* fsrv)
 /* the real work here comes when we do multithreaded processing */
 }
 
-extern struct arcan_luactx* main_lua_context;
 static void process_event(arcan_event* ev, int drain)
 {
 /* [ mutex ]
@@ -531,6 +577,9 @@ static int trigger_video_synch(float frag)
 		0.2 * conductor.render_cost;
 
 	TRACE_MARK_ONESHOT("conductor", "frame-over", TRACE_SYS_DEFAULT, 0, conductor.set_deadline, "");
+	TRACE_MARK_ONESHOT("conductor", "gc",
+		TRACE_SYS_DEFAULT, conductor.tick_count, conductor.gc_time, "frame-gc");
+	conductor.gc_time = 0;
 
 	valid_cycle = true;
 /* if the platform wants us to wait, it'll provide a new deadline at synch */
@@ -12,6 +12,9 @@
 #include <assert.h>
 #include <string.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
 
 #include <sys/types.h>
 #include <unistd.h>
@@ -19,6 +22,7 @@
 #include "arcan_math.h"
 #include "arcan_general.h"
 #include "arcan_db.h"
+#include "external/uthash.h"
 
 #ifdef ARCAN_DB_STANDALONE
 static const char* ARCAN_TBL = "arcan";
@@ -34,6 +38,11 @@ static const char* ARCAN_TBL =
 
 static bool db_init = false;
 
+/* number of prepared statements kept alive per handle */
+#ifndef DB_STMT_CACHE
+#define DB_STMT_CACHE 16
+#endif
+
 #define DB_VERSION_NUM "4"
 
 #define DDL_TARGET "CREATE TABLE target ("\
@@ -133,6 +142,83 @@ static const char* ddls[] = {
 #define DI_INSKV_TARGET_LIBV "INSERT OR REPLACE INTO "\
 	"target_libs(libname, libnote, target) VALUES(?, ?, ?);"
 
+/*
+ * Statements are keyed on the query text so that the per-appl queries that
+ * are built at runtime can be cached the same way as the static ones.
+ */
+struct db_stmt {
+	uint32_t hash;
+	char* qry;
+	sqlite3_stmt* stmt;
+	uint64_t used;
+};
+
+struct stmt_cache {
+	struct db_stmt ent[DB_STMT_CACHE];
+	uint64_t clock;
+};
+
+/*
+ * Queued write for the write-behind worker, [key] binds to 1, [val] to 2
+ * and [id] to 3 (if bind_id) in the prepared [qry], which writes to [tbl].
+ */
+struct db_cmd {
+	char* qry;
+	char* tbl;
+	char* key;
+	char* val;
+	int64_t id;
+	bool bind_id;
+	struct db_cmd* next;
+};
+
+struct db_cmdlist {
+	struct db_cmd* first;
+	struct db_cmd* last;
+};
+
+/*
+ * The worker has its own connection to the same database file, and all
+ * queued writes are committed there. Everything from [queue] to [busy] is
+ * protected by [lock]. The batch being committed stays in [inflight] until
+ * the commit is done so that reads can still find it.
+ */
+struct db_worker {
+	sqlite3* dbh;
+	struct stmt_cache cache;
+	unsigned period;
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+
+	struct db_cmdlist queue;
+	struct db_cmd* inflight;
+	bool alive;
+	bool urgent;
+	bool busy;
+};
+
+/*
+ * In-memory copy of an appl_ table, val == NULL marks a pending delete.
+ * Only transactions leave dirty entries, these are written out in a single
+ * transaction when it ends.
+ */
+struct kv_ent {
+	char* key;
+	char* val;
+	bool dirty;
+	UT_hash_handle hh;
+};
+
+struct kv_mirror {
+	char* appl;
+	struct kv_ent* ht;
+	size_t n_dirty;
+	struct kv_mirror* next;
+};
+
 struct arcan_dbh {
 	sqlite3* dbh;
 
@@ -140,17 +226,28 @@ struct arcan_dbh {
  * some special functions may use a different one, none outside _db.c should */
 	char* applname;
 	char* akv_update;
-	char* akv_get;
 	char* akv_clean;
+	char* akv_table;
 
 	size_t akv_upd_sz;
-	size_t akv_get_sz;
 	size_t akv_clean_sz;
 
 	enum DB_KVTARGET ttype;
 	union arcan_dbtrans_id trid;
 	bool trclean;
 	sqlite3_stmt* transaction;
+	struct kv_mirror* trmirror;
+
+/* transactions are collected here and submitted as one when write-behind */
+	const char* trqry;
+	const char* trtbl;
+	struct db_cmdlist trcmds;
+
+	struct stmt_cache cache;
+	struct db_worker* wb;
+
+	bool mirror;
+	struct kv_mirror* mirrors;
 };
 
 static void setup_ddl(struct arcan_dbh* dbh);
@@ -172,7 +269,7 @@ void arcan_db_set_shared(struct arcan_dbh* new)
  * any query that just returns a list of strings,
  * pack into a dbres (or append to an existing one)
  */
-static struct arcan_strarr db_string_query(struct arcan_dbh* dbh,
+static struct arcan_strarr db_string_rows(
 	sqlite3_stmt* stmt, struct arcan_strarr* opt, off_t ofs)
 {
 	struct arcan_strarr res = {.data = NULL};
@@ -196,6 +293,13 @@ static struct arcan_strarr db_string_query(struct arcan_dbh* dbh,
 		res.data[res.count++] = (arg ? strdup(arg) : NULL);
 	}
 
+	return res;
+}
+
+static struct arcan_strarr db_string_query(struct arcan_dbh* dbh,
+	sqlite3_stmt* stmt, struct arcan_strarr* opt, off_t ofs)
+{
+	struct arcan_strarr res = db_string_rows(stmt, opt, ofs);
 	sqlite3_finalize(stmt);
 	return res;
 }
@@ -247,6 +351,664 @@ static inline void db_void_query(struct arcan_dbh* dbh,
 	sqlite3_finalize(stmt);
 }
 
+static uint32_t db_hash(const char* str)
+{
+	uint32_t hash = 5381;
+	while (*str)
+		hash = ((hash << 5) + hash) + (uint8_t)*str++;
+	return hash;
+}
+
+/*
+ * Get a prepared statement for [qry] from the cache, or prepare and insert
+ * it, evicting the least recently used one. The statement belongs to the
+ * cache and should be returned with db_stmt_done rather than finalized. Do
+ * not hold on to one across other lookups beyond the cache size.
+ */
+static sqlite3_stmt* stmt_cache_get(
+	struct stmt_cache* cache, sqlite3* dbh, const char* qry)
+{
+	uint32_t hash = db_hash(qry);
+	struct db_stmt* slot = &cache->ent[0];
+
+	for (size_t i = 0; i < DB_STMT_CACHE; i++){
+		struct db_stmt* cur = &cache->ent[i];
+		if (cur->stmt && cur->hash == hash && strcmp(cur->qry, qry) == 0){
+			cur->used = ++cache->clock;
+			return cur->stmt;
+		}
+
+		if (!cur->stmt || (slot->stmt && cur->used < slot->used))
+			slot = cur;
+	}
+
+	sqlite3_stmt* stmt = NULL;
+	if (SQLITE_OK != sqlite3_prepare_v2(dbh, qry, -1, &stmt, NULL)){
+		arcan_warning("db_stmt(%s) failed: %s\n", qry, sqlite3_errmsg(dbh));
+		sqlite3_finalize(stmt);
+		return NULL;
+	}
+
+	if (slot->stmt){
+		sqlite3_finalize(slot->stmt);
+		free(slot->qry);
+	}
+
+	*slot = (struct db_stmt){
+		.hash = hash,
+		.qry = strdup(qry),
+		.stmt = stmt,
+		.used = ++cache->clock
+	};
+
+	return stmt;
+}
+
+static void stmt_cache_drop(struct stmt_cache* cache)
+{
+	for (size_t i = 0; i < DB_STMT_CACHE; i++){
+		if (!cache->ent[i].stmt)
+			continue;
+
+		sqlite3_finalize(cache->ent[i].stmt);
+		free(cache->ent[i].qry);
+		cache->ent[i] = (struct db_stmt){0};
+	}
+}
+
+static void db_stmt_done(sqlite3_stmt* stmt)
+{
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
+
+static bool in_transaction(struct arcan_dbh* dbh)
+{
+	return dbh->transaction || dbh->trmirror || dbh->trqry;
+}
+
+/*
+ * Write-behind: writes are turned into db_cmds and queued to a worker that
+ * commits them in batches on its own connection. Single key lookups are
+ * answered from the queued writes when they have the key (wb_lookup), other
+ * reads through the main connection first wait until no queued write touches
+ * the table they read (wb_wait) so that they see their own writes. Mirrored
+ * appl tables are read without waiting.
+ */
+static struct db_cmd* wb_cmd(const char* qry,
+	const char* tbl, const char* key, const char* val)
+{
+	struct db_cmd* res = malloc(sizeof(struct db_cmd));
+	if (!res)
+		return NULL;
+
+	*res = (struct db_cmd){
+		.qry = strdup(qry),
+		.tbl = strdup(tbl),
+		.key = key ? strdup(key) : NULL,
+		.val = val ? strdup(val) : NULL
+	};
+
+	return res;
+}
+
+static void wb_append(struct db_cmdlist* list, struct db_cmd* cmd)
+{
+	if (!cmd)
+		return;
+
+	if (list->last)
+		list->last->next = cmd;
+	else
+		list->first = cmd;
+	list->last = cmd;
+}
+
+static void wb_free(struct db_cmd* cmd)
+{
+	free(cmd->qry);
+	free(cmd->tbl);
+	free(cmd->key);
+	free(cmd->val);
+	free(cmd);
+}
+
+static void wb_submit(struct arcan_dbh* dbh, struct db_cmdlist* list)
+{
+	if (!list->first)
+		return;
+
+	struct db_worker* wb = dbh->wb;
+	pthread_mutex_lock(&wb->lock);
+	if (wb->queue.last)
+		wb->queue.last->next = list->first;
+	else
+		wb->queue.first = list->first;
+	wb->queue.last = list->last;
+	pthread_cond_signal(&wb->wake);
+	pthread_mutex_unlock(&wb->lock);
+
+	*list = (struct db_cmdlist){0};
+}
+
+static bool cmds_table(struct db_cmd* cmd, const char* tbl)
+{
+	for (; cmd; cmd = cmd->next)
+		if (!tbl || strcmp(cmd->tbl, tbl) == 0)
+			return true;
+
+	return false;
+}
+
+/* lock is held, [tbl] == NULL matches any write */
+static bool wb_touches(struct db_worker* wb, const char* tbl)
+{
+	return cmds_table(wb->inflight, tbl) || cmds_table(wb->queue.first, tbl);
+}
+
+/*
+ * Block until no queued or running write touches [tbl] (NULL for all of
+ * them). Writes against other tables are left to the normal batching.
+ */
+static void wb_wait(struct arcan_dbh* dbh, const char* tbl)
+{
+	struct db_worker* wb = dbh->wb;
+	if (!wb)
+		return;
+
+	pthread_mutex_lock(&wb->lock);
+	if (wb_touches(wb, tbl)){
+		wb->urgent = true;
+		pthread_cond_signal(&wb->wake);
+
+		while (wb_touches(wb, tbl))
+			pthread_cond_wait(&wb->done, &wb->lock);
+
+		wb->urgent = false;
+	}
+	pthread_mutex_unlock(&wb->lock);
+}
+
+static void lookup_cmds(struct db_cmd* cmd, const char* tbl,
+	bool bind_id, int64_t id, const char* key, struct db_cmd** out)
+{
+	for (; cmd; cmd = cmd->next){
+		if (!cmd->key || strcmp(cmd->key, key) != 0 ||
+			cmd->bind_id != bind_id || (bind_id && cmd->id != id) ||
+			strcmp(cmd->tbl, tbl) != 0)
+			continue;
+
+		*out = cmd;
+	}
+}
+
+/*
+ * Find the latest queued write of [key] in [tbl] (for [id] if [bind_id]).
+ * Returns false if there is none and the read should go to sqlite, otherwise
+ * [out] is set to a copy of the value, or NULL if the write removes the key
+ * (delete or an empty value that will be cleaned).
+ */
+static bool wb_lookup(struct arcan_dbh* dbh, const char* tbl,
+	bool bind_id, int64_t id, const char* key, char** out)
+{
+	struct db_worker* wb = dbh->wb;
+	if (!wb)
+		return false;
+
+	struct db_cmd* match = NULL;
+
+	pthread_mutex_lock(&wb->lock);
+	lookup_cmds(wb->inflight, tbl, bind_id, id, key, &match);
+	lookup_cmds(wb->queue.first, tbl, bind_id, id, key, &match);
+
+	if (match)
+		*out = match->val && match->val[0] ? strdup(match->val) : NULL;
+	pthread_mutex_unlock(&wb->lock);
+
+	return match != NULL;
+}
+
+static void wb_exec(struct db_worker* wb, struct db_cmd* cmd)
+{
+	sqlite3_exec(wb->dbh, "BEGIN;", NULL, NULL, NULL);
+
+	for (; cmd; cmd = cmd->next){
+		sqlite3_stmt* stmt = stmt_cache_get(&wb->cache, wb->dbh, cmd->qry);
+
+		if (stmt){
+			if (cmd->key)
+				sqlite3_bind_text(stmt, 1, cmd->key, -1, SQLITE_STATIC);
+			if (cmd->val)
+				sqlite3_bind_text(stmt, 2, cmd->val, -1, SQLITE_STATIC);
+			if (cmd->bind_id)
+				sqlite3_bind_int64(stmt, 3, cmd->id);
+
+			if (SQLITE_DONE != sqlite3_step(stmt))
+				arcan_warning("db_worker(%s) failed: %s\n",
+					cmd->qry, sqlite3_errmsg(wb->dbh));
+
+			db_stmt_done(stmt);
+		}
+	}
+
+	if (SQLITE_OK != sqlite3_exec(wb->dbh, "COMMIT;", NULL, NULL, NULL)){
+		arcan_warning("db_worker(), commit failed: %s\n", sqlite3_errmsg(wb->dbh));
+		sqlite3_exec(wb->dbh, "ROLLBACK;", NULL, NULL, NULL);
+	}
+}
+
+static void* wb_worker(void* arg)
+{
+	struct db_worker* wb = arg;
+	pthread_mutex_lock(&wb->lock);
+
+/* keep going after shutdown is requested until the queue is empty */
+	while (wb->alive || wb->queue.first){
+		if (!wb->queue.first){
+			pthread_cond_wait(&wb->wake, &wb->lock);
+			continue;
+		}
+
+/* let more writes accumulate unless someone is waiting for them */
+		if (!wb->urgent && wb->alive){
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += (long)(wb->period % 1000) * 1000000L;
+			ts.tv_sec += wb->period / 1000 + ts.tv_nsec / 1000000000L;
+			ts.tv_nsec %= 1000000000L;
+
+			while (!wb->urgent && wb->alive &&
+				ETIMEDOUT != pthread_cond_timedwait(&wb->wake, &wb->lock, &ts)){}
+		}
+
+		wb->inflight = wb->queue.first;
+		wb->queue = (struct db_cmdlist){0};
+		wb->busy = true;
+		pthread_mutex_unlock(&wb->lock);
+
+		wb_exec(wb, wb->inflight);
+
+		pthread_mutex_lock(&wb->lock);
+		while (wb->inflight){
+			struct db_cmd* next = wb->inflight->next;
+			wb_free(wb->inflight);
+			wb->inflight = next;
+		}
+		wb->busy = false;
+		pthread_cond_broadcast(&wb->done);
+	}
+
+	pthread_mutex_unlock(&wb->lock);
+	return NULL;
+}
+
+static void wb_stop(struct arcan_dbh* dbh)
+{
+	struct db_worker* wb = dbh->wb;
+	if (!wb)
+		return;
+
+	pthread_mutex_lock(&wb->lock);
+	wb->alive = false;
+	pthread_cond_signal(&wb->wake);
+	pthread_mutex_unlock(&wb->lock);
+	pthread_join(wb->thread, NULL);
+
+	stmt_cache_drop(&wb->cache);
+	sqlite3_close(wb->dbh);
+	pthread_mutex_destroy(&wb->lock);
+	pthread_cond_destroy(&wb->wake);
+	pthread_cond_destroy(&wb->done);
+	free(wb);
+	dbh->wb = NULL;
+}
+
+static const char* synch_pragma(enum DB_SYNCH synch)
+{
+	switch (synch){
+	case DB_SYNCH_OFF:
+		return "PRAGMA synchronous=OFF;";
+	case DB_SYNCH_FULL:
+		return "PRAGMA synchronous=FULL;";
+	default:
+		return "PRAGMA synchronous=NORMAL;";
+	}
+}
+
+bool arcan_db_writebehind(struct arcan_dbh* dbh,
+	unsigned period, enum DB_SYNCH synch)
+{
+	if (!dbh || in_transaction(dbh))
+		return false;
+
+	wb_wait(dbh, NULL);
+	wb_stop(dbh);
+
+	if (!period)
+		return true;
+
+/* in-memory databases can't be shared with a second connection */
+	const char* fn = sqlite3_db_filename(dbh->dbh, "main");
+	if (!fn || !fn[0])
+		return false;
+
+	struct db_worker* wb = malloc(sizeof(struct db_worker));
+	if (!wb)
+		return false;
+
+	*wb = (struct db_worker){
+		.period = period,
+		.alive = true
+	};
+
+	if (SQLITE_OK != sqlite3_open_v2(fn, &wb->dbh, SQLITE_OPEN_READWRITE, NULL)){
+		arcan_warning("arcan_db_writebehind(), couldn't open worker connection\n");
+		sqlite3_close(wb->dbh);
+		free(wb);
+		return false;
+	}
+
+/* WAL lets the main connection keep reading while the worker commits */
+	sqlite3_exec(dbh->dbh, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
+	sqlite3_exec(dbh->dbh, synch_pragma(synch), NULL, NULL, NULL);
+	sqlite3_exec(wb->dbh, synch_pragma(synch), NULL, NULL, NULL);
+	sqlite3_exec(wb->dbh, "PRAGMA foreign_keys=ON;", NULL, NULL, NULL);
+	sqlite3_busy_timeout(dbh->dbh, 1000);
+	sqlite3_busy_timeout(wb->dbh, 5000);
+
+	pthread_mutex_init(&wb->lock, NULL);
+	pthread_cond_init(&wb->wake, NULL);
+	pthread_cond_init(&wb->done, NULL);
+
+	if (0 != pthread_create(&wb->thread, NULL, wb_worker, wb)){
+		arcan_warning("arcan_db_writebehind(), couldn't spawn worker\n");
+		sqlite3_close(wb->dbh);
+		pthread_mutex_destroy(&wb->lock);
+		pthread_cond_destroy(&wb->wake);
+		pthread_cond_destroy(&wb->done);
+		free(wb);
+		return false;
+	}
+
+	dbh->wb = wb;
+	return true;
+}
+
+/*
+ * cached statement on the main connection, [tbl] is the table that is read
+ * or NULL if the caller already made sure pending writes can't affect it
+ */
+static sqlite3_stmt* db_stmt(
+	struct arcan_dbh* dbh, const char* qry, const char* tbl)
+{
+	if (tbl)
+		wb_wait(dbh, tbl);
+	return stmt_cache_get(&dbh->cache, dbh->dbh, qry);
+}
+
+/*
+ * one-off statement on the main connection, [tbl] as for db_stmt. Writes on
+ * the main connection wait for all of the queue first (wb_wait(dbh, NULL))
+ * so that they are ordered after the queued ones.
+ */
+static int db_prepare(struct arcan_dbh* dbh,
+	const char* qry, size_t len, sqlite3_stmt** out, const char* tbl)
+{
+	if (tbl)
+		wb_wait(dbh, tbl);
+	return sqlite3_prepare_v2(dbh->dbh, qry, len, out, NULL);
+}
+
+/*
+ * Build the per-appl query [fmt] (with a single %s for the appl name) into
+ * [buf], returns false on truncation.
+ */
+static bool db_applqry(char* buf, size_t buf_sz, const char* fmt, const char* appl)
+{
+	int nw = snprintf(buf, buf_sz, fmt, appl);
+	return nw > 0 && (size_t) nw < buf_sz;
+}
+
+#define KV_UPSERT "INSERT OR REPLACE INTO appl_%s(key, val) VALUES(?, ?);"
+#define KV_DELETE "DELETE FROM appl_%s WHERE key = ?;"
+#define KV_SELECT "SELECT key, val FROM appl_%s;"
+
+static void kv_free(struct kv_ent* ent)
+{
+	free(ent->key);
+	free(ent->val);
+	free(ent);
+}
+
+static void kv_flush(struct arcan_dbh* dbh, struct kv_mirror* mirror)
+{
+	if (!mirror->n_dirty)
+		return;
+
+	char upd[sizeof(KV_UPSERT) + strlen(mirror->appl)];
+	char del[sizeof(KV_DELETE) + strlen(mirror->appl)];
+	char tbl[sizeof("appl_") + strlen(mirror->appl)];
+	db_applqry(upd, sizeof(upd), KV_UPSERT, mirror->appl);
+	db_applqry(del, sizeof(del), KV_DELETE, mirror->appl);
+	db_applqry(tbl, sizeof(tbl), "appl_%s", mirror->appl);
+
+/* the mirror stays authoritative for reads while the worker catches up */
+	if (dbh->wb){
+		struct db_cmdlist list = {0};
+		struct kv_ent* ent, (* tmp);
+
+		HASH_ITER(hh, mirror->ht, ent, tmp){
+			if (!ent->dirty)
+				continue;
+
+			wb_append(&list,
+				wb_cmd(ent->val ? upd : del, tbl, ent->key, ent->val));
+			if (!ent->val){
+				HASH_DEL(mirror->ht, ent);
+				kv_free(ent);
+			}
+			else
+				ent->dirty = false;
+		}
+
+		wb_submit(dbh, &list);
+		mirror->n_dirty = 0;
+		return;
+	}
+
+	sqlite3_stmt* ins_stmt = db_stmt(dbh, upd, NULL);
+	sqlite3_stmt* del_stmt = db_stmt(dbh, del, NULL);
+	if (!ins_stmt || !del_stmt)
+		return;
+
+	sqlite3_exec(dbh->dbh, "BEGIN;", NULL, NULL, NULL);
+
+	struct kv_ent* ent, (* tmp);
+	HASH_ITER(hh, mirror->ht, ent, tmp){
+		if (!ent->dirty)
+			continue;
+
+		sqlite3_stmt* stmt = ent->val ? ins_stmt : del_stmt;
+		sqlite3_bind_text(stmt, 1, ent->key, -1, SQLITE_STATIC);
+		if (ent->val)
+			sqlite3_bind_text(stmt, 2, ent->val, -1, SQLITE_STATIC);
+
+		if (SQLITE_DONE != sqlite3_step(stmt))
+			arcan_warning("kv_flush(%s:%s) failed: %s\n",
+				mirror->appl, ent->key, sqlite3_errmsg(dbh->dbh));
+		db_stmt_done(stmt);
+
+		if (!ent->val){
+			HASH_DEL(mirror->ht, ent);
+			kv_free(ent);
+		}
+		else
+			ent->dirty = false;
+	}
+
+	if (SQLITE_OK != sqlite3_exec(dbh->dbh, "COMMIT;", NULL, NULL, NULL))
+		arcan_warning("kv_flush(), commit failed: %s\n", sqlite3_errmsg(dbh->dbh));
+
+	mirror->n_dirty = 0;
+}
+
+static void kv_drop(struct kv_mirror* mirror)
+{
+	struct kv_ent* ent, (* tmp);
+	HASH_ITER(hh, mirror->ht, ent, tmp){
+		HASH_DEL(mirror->ht, ent);
+		kv_free(ent);
+	}
+	free(mirror->appl);
+	free(mirror);
+}
+
+/*
+ * Find the mirror for [appl], loading the table on first use. Returns NULL
+ * if mirroring is disabled or the table couldn't be read, in which case the
+ * caller falls back to querying sqlite directly.
+ */
+static struct kv_mirror* kv_mirror(struct arcan_dbh* dbh, const char* appl)
+{
+	if (!dbh->mirror || !appl)
+		return NULL;
+
+	for (struct kv_mirror* cur = dbh->mirrors; cur; cur = cur->next)
+		if (strcmp(cur->appl, appl) == 0)
+			return cur;
+
+	char qry[sizeof(KV_SELECT) + strlen(appl)];
+	char tbl[sizeof("appl_") + strlen(appl)];
+	db_applqry(qry, sizeof(qry), KV_SELECT, appl);
+	db_applqry(tbl, sizeof(tbl), "appl_%s", appl);
+
+	sqlite3_stmt* stmt = NULL;
+	if (SQLITE_OK != db_prepare(dbh, qry, -1, &stmt, tbl)){
+		sqlite3_finalize(stmt);
+		return NULL;
+	}
+
+	struct kv_mirror* res = malloc(sizeof(struct kv_mirror));
+	if (!res){
+		sqlite3_finalize(stmt);
+		return NULL;
+	}
+
+	*res = (struct kv_mirror){
+		.appl = strdup(appl),
+		.next = dbh->mirrors
+	};
+
+	while (sqlite3_step(stmt) == SQLITE_ROW){
+		const char* key = (const char*) sqlite3_column_text(stmt, 0);
+		const char* val = (const char*) sqlite3_column_text(stmt, 1);
+		if (!key || !val)
+			continue;
+
+		struct kv_ent* ent = malloc(sizeof(struct kv_ent));
+		if (!ent)
+			break;
+
+		*ent = (struct kv_ent){
+			.key = strdup(key),
+			.val = strdup(val)
+		};
+		HASH_ADD_KEYPTR(hh, res->ht, ent->key, strlen(ent->key), ent);
+	}
+
+	sqlite3_finalize(stmt);
+	dbh->mirrors = res;
+	return res;
+}
+
+/*
+ * [val] == NULL deletes, [dirty] queues the change for kv_flush rather than
+ * the caller writing it through
+ */
+static void kv_set(struct kv_mirror* mirror,
+	const char* key, const char* val, bool dirty)
+{
+	struct kv_ent* ent;
+	HASH_FIND_STR(mirror->ht, key, ent);
+
+	if (!ent){
+		if (!val)
+			return;
+
+		ent = malloc(sizeof(struct kv_ent));
+		if (!ent)
+			return;
+
+		*ent = (struct kv_ent){.key = strdup(key)};
+		HASH_ADD_KEYPTR(hh, mirror->ht, ent->key, strlen(ent->key), ent);
+	}
+
+	free(ent->val);
+	ent->val = val ? strdup(val) : NULL;
+
+	if (!dirty){
+		if (!val && !ent->dirty){
+			HASH_DEL(mirror->ht, ent);
+			kv_free(ent);
+		}
+		return;
+	}
+
+	if (!ent->dirty){
+		ent->dirty = true;
+		mirror->n_dirty++;
+	}
+}
+
+static void kv_forget(struct arcan_dbh* dbh, const char* appl)
+{
+	struct kv_mirror** cur = &dbh->mirrors;
+	while (*cur){
+		if (strcmp((*cur)->appl, appl) == 0){
+			struct kv_mirror* dead = *cur;
+			*cur = dead->next;
+			kv_drop(dead);
+			return;
+		}
+		cur = &(*cur)->next;
+	}
+}
+
+void arcan_db_flush(struct arcan_dbh* dbh)
+{
+	if (!dbh || in_transaction(dbh))
+		return;
+
+	for (struct kv_mirror* cur = dbh->mirrors; cur; cur = cur->next)
+		kv_flush(dbh, cur);
+}
+
+void arcan_db_sync(struct arcan_dbh* dbh)
+{
+	if (!dbh)
+		return;
+
+	arcan_db_flush(dbh);
+	wb_wait(dbh, NULL);
+}
+
+void arcan_db_kvmirror(struct arcan_dbh* dbh, bool enable)
+{
+	if (!dbh || enable == dbh->mirror)
+		return;
+
+	if (!enable){
+		arcan_db_flush(dbh);
+		while (dbh->mirrors){
+			struct kv_mirror* next = dbh->mirrors->next;
+			kv_drop(dbh->mirrors);
+			dbh->mirrors = next;
+		}
+	}
+
+	dbh->mirror = enable;
+}
+
 void arcan_db_dropappl(struct arcan_dbh* dbh, const char* appl)
 {
 	if (!appl || !dbh)
@@ -260,6 +1022,11 @@ void arcan_db_dropappl(struct arcan_dbh* dbh, const char* appl)
 	char dropbuf[sizeof(dropqry) + len + 1];
 	snprintf(dropbuf, sizeof(dropbuf), "%s%s;", dropqry, appl);
 
+/* pending writes would be dropped anyhow */
+	char tbl[sizeof("appl_") + len];
+	db_applqry(tbl, sizeof(tbl), "appl_%s", appl);
+	kv_forget(dbh, appl);
+	wb_wait(dbh, tbl);
 	db_void_query(dbh, dropbuf, true);
 
 /* special case, reset version fields etc. */
@@ -283,11 +1050,12 @@ static void create_appl_group(struct arcan_dbh* dbh, const char* applname)
 		"(key TEXT UNIQUE, val TEXT NOT NULL);";
 	const char kv_ddl[] = "INSERT OR REPLACE INTO "
 		" appl_%s(key, val) VALUES(?, ?);";
-	const char kv_get[] = "SELECT val FROM appl_%s WHERE key = ?;";
 	const char kv_drop[] = "DELETE FROM appl_%s WHERE val = \"\";";
 
-	if (dbh->akv_update)
-		arcan_mem_free(dbh->akv_update);
+	arcan_mem_free(dbh->akv_update);
+	arcan_mem_free(dbh->akv_clean);
+	arcan_mem_free(dbh->akv_table);
+	dbh->akv_update = dbh->akv_clean = dbh->akv_table = NULL;
 
 	size_t len = applname ? strlen(applname) : 0;
 	if (0 == len){
@@ -296,7 +1064,6 @@ static void create_appl_group(struct arcan_dbh* dbh, const char* applname)
 	}
 
 /* cache key insert into app specific table */
-	assert(sizeof(kv_get) < sizeof(kv_ddl));
 	size_t ddl_sz = len + sizeof(kv_ddl);
 	dbh->akv_update = arcan_alloc_mem(
 		ddl_sz, ARCAN_MEM_STRINGBUF, 0, ARCAN_MEMALIGN_NATURAL);
@@ -308,11 +1075,11 @@ static void create_appl_group(struct arcan_dbh* dbh, const char* applname)
 		ddl_sz, ARCAN_MEM_STRINGBUF, 0, ARCAN_MEMALIGN_NATURAL);
 	dbh->akv_clean_sz = snprintf(dbh->akv_clean, ddl_sz, kv_drop, applname);
 
-/* cache key retrieve into app specific table */
-	ddl_sz = strlen(applname) + sizeof(kv_get);
-	dbh->akv_get = arcan_alloc_mem(
+/* name of the table, for matching queued writes */
+	ddl_sz = len + sizeof("appl_");
+	dbh->akv_table = arcan_alloc_mem(
 		ddl_sz, ARCAN_MEM_STRINGBUF, 0, ARCAN_MEMALIGN_NATURAL);
-	dbh->akv_get_sz = snprintf(dbh->akv_get, ddl_sz, kv_get, applname);
+	snprintf(dbh->akv_table, ddl_sz, "appl_%s", applname);
 
 /* create the actual table */
 	char wbuf[ sizeof(ddl) + strlen(applname) ];
@@ -328,7 +1095,8 @@ bool arcan_db_droptarget(struct arcan_dbh* dbh, arcan_targetid id)
 	static const char qry[]  = "DELETE FROM target WHERE tgtid = ?;";
 
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, qry, sizeof(qry)-1, &stmt, NULL);
+	wb_wait(dbh, NULL);
+	db_prepare(dbh, qry, sizeof(qry)-1, &stmt, NULL);
 	sqlite3_bind_int(stmt, 1, id);
 	sqlite3_step(stmt);
 	sqlite3_finalize(stmt);
@@ -341,7 +1109,8 @@ bool arcan_db_dropconfig(struct arcan_dbh* dbh, arcan_configid id)
 	static const char qry[] = "DELETE FROM config WHERE cfgid = ?;";
 
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, qry, sizeof(qry)-1, &stmt, NULL);
+	wb_wait(dbh, NULL);
+	db_prepare(dbh, qry, sizeof(qry)-1, &stmt, NULL);
 	sqlite3_bind_int(stmt, 1, id);
 	sqlite3_step(stmt);
 	sqlite3_finalize(stmt);
@@ -358,7 +1127,8 @@ arcan_targetid arcan_db_addtarget(struct arcan_dbh* dbh,
 		"((select tgtid FROM target where name = ?), ?, ?, ?, ?)";
 
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, ddl, sizeof(ddl)-1, &stmt, NULL);
+	wb_wait(dbh, NULL);
+	db_prepare(dbh, ddl, sizeof(ddl)-1, &stmt, NULL);
 
 	sqlite3_bind_text(stmt, 1, identifier, -1, SQLITE_STATIC);
 	sqlite3_bind_text(stmt, 2, identifier, -1, SQLITE_STATIC);
@@ -373,7 +1143,7 @@ arcan_targetid arcan_db_addtarget(struct arcan_dbh* dbh,
 
 /* delete previous arguments */
 	static const char drop_argv[] = "DELETE FROM target_argv WHERE target = ?;";
-	sqlite3_prepare_v2(dbh->dbh, drop_argv, sizeof(drop_argv) - 1, &stmt, NULL);
+	db_prepare(dbh, drop_argv, sizeof(drop_argv) - 1, &stmt, NULL);
 	sqlite3_bind_int(stmt, 1, newid);
 	sqlite3_step(stmt);
 	sqlite3_finalize(stmt);
@@ -384,7 +1154,7 @@ arcan_targetid arcan_db_addtarget(struct arcan_dbh* dbh,
 
 	static const char add_argv[] = DI_INSARG_TARGET;
 	for (size_t i = 0; i < sz; i++){
-		sqlite3_prepare_v2(dbh->dbh, add_argv, sizeof(add_argv) - 1, &stmt, NULL);
+		db_prepare(dbh, add_argv, sizeof(add_argv) - 1, &stmt, NULL);
 		sqlite3_bind_int(stmt, 1, newid);
 		sqlite3_bind_text(stmt, 2, argv[i], -1, SQLITE_STATIC);
 		sqlite3_step(stmt);
@@ -405,7 +1175,8 @@ arcan_configid arcan_db_addconfig(struct arcan_dbh* dbh,
 		"(NULL, ?, ?, ?, ?)";
 
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, ddl, sizeof(ddl)-1, &stmt, NULL);
+	wb_wait(dbh, NULL);
+	db_prepare(dbh, ddl, sizeof(ddl)-1, &stmt, NULL);
 
 	sqlite3_bind_text(stmt, 1, identifier, -1, SQLITE_STATIC);
 	sqlite3_bind_int(stmt, 2, 0);
@@ -419,7 +1190,7 @@ arcan_configid arcan_db_addconfig(struct arcan_dbh* dbh,
 
 /* delete previous arguments */
 	static const char drop_argv[] = "DELETE FROM config_argv WHERE config = ?;";
-	sqlite3_prepare_v2(dbh->dbh, drop_argv, sizeof(drop_argv) - 1, &stmt, NULL);
+	db_prepare(dbh, drop_argv, sizeof(drop_argv) - 1, &stmt, NULL);
 	sqlite3_bind_int(stmt, 1, newid);
 	sqlite3_step(stmt);
 	sqlite3_finalize(stmt);
@@ -430,7 +1201,7 @@ arcan_configid arcan_db_addconfig(struct arcan_dbh* dbh,
 
 	static const char add_argv[] = DI_INSARG_CONFIG;
 	for (size_t i = 0; i < sz; i++){
-		sqlite3_prepare_v2(dbh->dbh, add_argv, sizeof(add_argv) - 1, &stmt, NULL);
+		db_prepare(dbh, add_argv, sizeof(add_argv) - 1, &stmt, NULL);
 		sqlite3_bind_int(stmt, 1, newid);
 		sqlite3_bind_text(stmt, 2, argv[i], -1, SQLITE_STATIC);
 		sqlite3_step(stmt);
@@ -447,8 +1218,8 @@ bool arcan_db_verifytarget(struct arcan_dbh* dbh, arcan_targetid id)
 	static const char ddl[] = "SELECT COUNT(*) FROM target WHERE tgtid = ?;";
 
 	sqlite3_stmt* stmt = NULL;
-	if (SQLITE_OK == sqlite3_prepare_v2(
-		dbh->dbh, ddl, sizeof(ddl)-1, &stmt, NULL)){
+	if (SQLITE_OK == db_prepare(
+		dbh, ddl, sizeof(ddl)-1, &stmt, "target")){
 		sqlite3_bind_int(stmt, 1, id);
 		sqlite3_step(stmt);
 		return 1 == sqlite3_column_int(stmt, 0);
@@ -464,7 +1235,7 @@ arcan_targetid arcan_db_targetid(struct arcan_dbh* dbh,
 	static const char dql[] = "SELECT tgtid FROM target WHERE name = ?;";
 	sqlite3_stmt* stmt;
 
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target");
 	sqlite3_bind_text(stmt, 1, identifier, -1, SQLITE_STATIC);
 
 	if (SQLITE_ROW == sqlite3_step(stmt))
@@ -479,7 +1250,7 @@ struct arcan_strarr arcan_db_list_appl(struct arcan_dbh* dbh)
 	static const char dql[] = "SELECT name FROM sqlite_master WHERE "
 		"type='table' and NAME like \"appl_%\"";
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "sqlite_master");
 
 	return db_string_query(dbh, stmt, NULL, 0);
 }
@@ -489,7 +1260,7 @@ struct arcan_strarr arcan_db_config_argv(struct arcan_dbh* dbh,arcan_configid id
 	static const char dql[] = "SELECT arg FROM config_argv WHERE "
 		"config = ? ORDER BY argnum ASC;";
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "config_argv");
 	sqlite3_bind_int(stmt, 1, id);
 
 	return db_string_query(dbh, stmt, NULL, 0);
@@ -500,7 +1271,7 @@ struct arcan_strarr arcan_db_target_argv(struct arcan_dbh* dbh,arcan_targetid id
 	static const char dql[] = "SELECT arg FROM target_argv WHERE "
 		"target = ? ORDER BY argnum ASC;";
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target_argv");
 	sqlite3_bind_int(stmt, 1, id);
 
 	return db_string_query(dbh, stmt, NULL, 0);
@@ -510,7 +1281,7 @@ arcan_targetid arcan_db_cfgtarget(struct arcan_dbh* dbh, arcan_configid cfg)
 {
 	static const char dql[] = "SELECT target FROM config WHERE cfgid = ?;";
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "config");
 	sqlite3_bind_int(stmt, 1, cfg);
 	arcan_targetid tid = BAD_TARGET;
 
@@ -529,7 +1300,7 @@ arcan_configid arcan_db_configid(struct arcan_dbh* dbh,
 	sqlite3_stmt* stmt;
 	arcan_configid cid = BAD_CONFIG;
 
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "config");
 	sqlite3_bind_text(stmt, 1, config, strlen(config), SQLITE_STATIC);
 	sqlite3_bind_int(stmt, 2, target);
 
@@ -544,7 +1315,7 @@ struct arcan_strarr arcan_db_target_tags(struct arcan_dbh* dbh)
 {
 	sqlite3_stmt* stmt;
 	static const char dql[] = "SELECT DISTINCT tag FROM target;";
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target");
 	return db_string_query(dbh, stmt, NULL, 0);
 }
 
@@ -553,11 +1324,11 @@ struct arcan_strarr arcan_db_targets(struct arcan_dbh* dbh, const char* tag)
 	sqlite3_stmt* stmt;
 	if (!tag){
 		static const char dql[] = "SELECT name FROM target;";
-		sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+		db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target");
 	}
 	else {
 		static const char dql[] = "SELECT name FROM target WHERE tag=?;";
-		sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+		db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target");
 		sqlite3_bind_text(stmt, 1, tag, strlen(tag), SQLITE_STATIC);
 	}
 	return db_string_query(dbh, stmt, NULL, 0);
@@ -568,7 +1339,7 @@ char* arcan_db_targettag(struct arcan_dbh* dbh, arcan_targetid tid)
 	static const char dql[] = "SELECT tag FROM target WHERE tgtid = ?;";
 	char* resstr = NULL;
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target");
 
 	sqlite3_bind_int(stmt, 1, tid);
 	if (sqlite3_step(stmt) == SQLITE_ROW){
@@ -595,7 +1366,7 @@ char* arcan_db_targetexec(struct arcan_dbh* dbh,
 	static const char dql[] = "SELECT executable, bfmt "
 		"FROM target WHERE tgtid = ?;";
 
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql) - 1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql) - 1, &stmt, "target");
 	sqlite3_bind_int(stmt, 1, tid);
 
 	char* execstr = NULL;
@@ -611,8 +1382,8 @@ char* arcan_db_targetexec(struct arcan_dbh* dbh,
 
 	static const char dql_tgt_argv[] = "SELECT arg FROM target_argv WHERE "
 		"target = ? ORDER BY argnum ASC;";
-	sqlite3_prepare_v2(dbh->dbh, dql_tgt_argv,
-		sizeof(dql_tgt_argv)-1, &stmt, NULL);
+	db_prepare(dbh, dql_tgt_argv,
+		sizeof(dql_tgt_argv)-1, &stmt, "target_argv");
 	sqlite3_bind_int(stmt, 1, tid);
 
 	*argv = db_string_query(dbh, stmt, NULL, 1);
@@ -620,29 +1391,29 @@ char* arcan_db_targetexec(struct arcan_dbh* dbh,
 
 	static const char dql_cfg_argv[] = "SELECT arg FROM config_argv WHERE "
 		"config = ? ORDER BY argnum ASC;";
-	sqlite3_prepare_v2(dbh->dbh, dql_cfg_argv,
-		sizeof(dql_cfg_argv)-1, &stmt, NULL);
+	db_prepare(dbh, dql_cfg_argv,
+		sizeof(dql_cfg_argv)-1, &stmt, "config_argv");
 	sqlite3_bind_int(stmt, 1, configid);
 	*argv = db_string_query(dbh, stmt, argv, 0);
 
 	static const char dql_tgt_env[] = "SELECT key || '=' || val "
 		"FROM target_env WHERE target = ?";
-	sqlite3_prepare_v2(dbh->dbh, dql_tgt_env,
-		sizeof(dql_tgt_env)-1, &stmt, NULL);
+	db_prepare(dbh, dql_tgt_env,
+		sizeof(dql_tgt_env)-1, &stmt, "target_env");
 	sqlite3_bind_int(stmt, 1, tid);
 	*env = db_string_query(dbh, stmt, NULL, 0);
 
 	static const char dql_cfg_env[] = "SELECT key || '=' || val "
 		"FROM config_env WHERE config = ?";
-	sqlite3_prepare_v2(dbh->dbh, dql_cfg_env,
-		sizeof(dql_cfg_env)-1, &stmt, NULL);
+	db_prepare(dbh, dql_cfg_env,
+		sizeof(dql_cfg_env)-1, &stmt, "config_env");
 	sqlite3_bind_int(stmt, 1, tid);
 	db_string_query(dbh, stmt, env, 0);
 
 	static const char dql_tgt_lib[] = "SELECT libname FROM target_libs WHERE "
 		"target = ?;";
-	sqlite3_prepare_v2(dbh->dbh, dql_tgt_lib,
-		sizeof(dql_tgt_lib)-1, &stmt, NULL);
+	db_prepare(dbh, dql_tgt_lib,
+		sizeof(dql_tgt_lib)-1, &stmt, "target_libs");
 	sqlite3_bind_int(stmt, 1, tid);
 	*libs = db_string_query(dbh, stmt, NULL, 0);
 
@@ -658,7 +1429,8 @@ void arcan_db_launch_status(struct arcan_dbh* dbh, arcan_configid cid, bool s)
 		"failed_counter = failed_counter + 1 WHERE config = ?;";
 
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh,
+	wb_wait(dbh, NULL);
+	db_prepare(dbh,
 		(s ? dql_ok : dql_fail), sizeof(dql_ok)-1, &stmt, NULL);
 	sqlite3_bind_int(stmt, 1, cid);
 	sqlite3_step(stmt);
@@ -669,7 +1441,7 @@ struct arcan_strarr arcan_db_configs(struct arcan_dbh* dbh, arcan_targetid tid)
 {
 	static const char dql[] = "SELECT name FROM config WHERE target = ?;";
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "config");
 	sqlite3_bind_int(stmt, 1, tid);
 
 	return db_string_query(dbh, stmt, NULL, 0);
@@ -679,7 +1451,7 @@ char* arcan_db_execname(struct arcan_dbh* dbh, arcan_targetid tid)
 {
 	static const char dql[] = "SELECT executable FROM target WHERE tgtid = ?;";
 	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, dql, sizeof(dql)-1, &stmt, NULL);
+	db_prepare(dbh, dql, sizeof(dql)-1, &stmt, "target");
 	sqlite3_bind_int(stmt, 1, tid);
 
 	char* res = NULL;
@@ -695,54 +1467,63 @@ char* arcan_db_execname(struct arcan_dbh* dbh, arcan_targetid tid)
 void arcan_db_begin_transaction(struct arcan_dbh* dbh,
 	enum DB_KVTARGET kvt, union arcan_dbtrans_id id)
 {
-	if (dbh->transaction)
+	if (in_transaction(dbh))
 		arcan_fatal("arcan_db_begin_transaction()"
 			"	called during a pending transaction\n");
 
-	sqlite3_exec(dbh->dbh, "BEGIN;", NULL, NULL, NULL);
-	int code = SQLITE_OK;
+	dbh->trid = id;
+	dbh->ttype = kvt;
+
+/* appl transactions against a mirrored table just update the mirror */
+	if (kvt == DVT_APPL && (dbh->trmirror = kv_mirror(dbh, dbh->applname)))
+		return;
+
+	const char* qry = NULL;
+	const char* tbl = NULL;
 
 	switch (kvt){
 	case DVT_APPL:
-		code = sqlite3_prepare_v2(dbh->dbh, dbh->akv_update,
-			dbh->akv_upd_sz, &dbh->transaction, NULL);
+		qry = dbh->akv_update;
+		tbl = dbh->akv_table;
 	break;
-
 	case DVT_TARGET:
-		code = sqlite3_prepare_v2(dbh->dbh, DI_INSKV_TARGET,
-			strlen(DI_INSKV_TARGET)+1, &dbh->transaction, NULL);
+		qry = DI_INSKV_TARGET;
+		tbl = "target_kv";
 	break;
-
 	case DVT_CONFIG:
-		code = sqlite3_prepare_v2(dbh->dbh, DI_INSKV_CONFIG,
-			strlen(DI_INSKV_CONFIG)+1, &dbh->transaction, NULL);
+		qry = DI_INSKV_CONFIG;
+		tbl = "config_kv";
 	break;
-
 	case DVT_CONFIG_ENV:
-		code = sqlite3_prepare_v2(dbh->dbh, DI_INSKV_CONFIG_ENV,
-			strlen(DI_INSKV_TARGET_ENV)+1, &dbh->transaction, NULL);
+		qry = DI_INSKV_CONFIG_ENV;
+		tbl = "config_env";
 	break;
-
 	case DVT_TARGET_ENV:
-		code = sqlite3_prepare_v2(dbh->dbh, DI_INSKV_TARGET_ENV,
-			strlen(DI_INSKV_TARGET_ENV)+1, &dbh->transaction, NULL);
+		qry = DI_INSKV_TARGET_ENV;
+		tbl = "target_env";
 	break;
-
 	case DVT_TARGET_LIBV:
-		code = sqlite3_prepare_v2(dbh->dbh, DI_INSKV_TARGET_LIBV,
-			strlen(DI_INSKV_TARGET_LIBV)+1, &dbh->transaction, NULL);
+		qry = DI_INSKV_TARGET_LIBV;
+		tbl = "target_libs";
 	break;
 	case DVT_ENDM:
 	break;
 	}
 
-	if (code != SQLITE_OK){
+	if (qry && dbh->wb){
+		dbh->trqry = qry;
+		dbh->trtbl = tbl;
+		return;
+	}
+
+	sqlite3_exec(dbh->dbh, "BEGIN;", NULL, NULL, NULL);
+	if (qry)
+		dbh->transaction = db_stmt(dbh, qry, NULL);
+
+	if (!dbh->transaction){
 		arcan_warning("arcan_db_begin_transaction(), failed: %s\n",
 			sqlite3_errmsg(dbh->dbh));
 	}
-
-	dbh->trid = id;
-	dbh->ttype = kvt;
 }
 
 struct arcan_strarr arcan_db_getkeys(struct arcan_dbh* dbh,
@@ -754,18 +1535,18 @@ struct arcan_strarr arcan_db_getkeys(struct arcan_dbh* dbh,
 		"SELECT key || '=' || val FROM config_kv WHERE config = ?"
 	};
 
-	const char* qry = NULL;
-	if (tgt >= DVT_TARGET && tgt < DVT_CONFIG)
-		qry = queries[0];
-	else
-		qry = queries[1];
+	bool target = tgt >= DVT_TARGET && tgt < DVT_CONFIG;
+	sqlite3_stmt* stmt = db_stmt(dbh,
+		queries[target ? 0 : 1], target ? "target_kv" : "config_kv");
+	if (!stmt)
+		return (struct arcan_strarr){0};
 
-	sqlite3_stmt * stmt;
-	sqlite3_prepare_v2(dbh->dbh, qry, sizeof(GET_KV_TGT)-1, &stmt, NULL);
 	sqlite3_bind_int(stmt, 1, tgt>=DVT_TARGET && tgt<DVT_CONFIG ? id.tid:id.cid);
 
 #undef GET_KV_TGT
-	return db_string_query(dbh, stmt, NULL, 0);
+	struct arcan_strarr res = db_string_rows(stmt, NULL, 0);
+	db_stmt_done(stmt);
+	return res;
 }
 
 struct arcan_strarr arcan_db_applkeys(struct arcan_dbh* dbh,
@@ -775,38 +1556,47 @@ struct arcan_strarr arcan_db_applkeys(struct arcan_dbh* dbh,
 
 	size_t mk_sz = sizeof(MATCH_APPL) + strlen(applname);
 	char mk_buf[ mk_sz ];
-	ssize_t nw = snprintf(mk_buf, mk_sz, MATCH_APPL, applname);
+	db_applqry(mk_buf, mk_sz, MATCH_APPL, applname);
+
+/* LIKE matching is left to sqlite, so pending writes need to be there */
+	struct kv_mirror* mirror = kv_mirror(dbh, applname);
+	if (mirror && !dbh->trmirror)
+		kv_flush(dbh, mirror);
+
+	char tbl[sizeof("appl_") + strlen(applname)];
+	db_applqry(tbl, sizeof(tbl), "appl_%s", applname);
+
+	sqlite3_stmt* stmt = db_stmt(dbh, mk_buf, tbl);
+	if (!stmt)
+		return (struct arcan_strarr){0};
 
-	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, mk_buf, mk_sz-1, &stmt, NULL);
 	sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
 
-	return db_string_query(dbh, stmt, NULL, 0);
-#undef MATCH_KEY_APPL
+	struct arcan_strarr res = db_string_rows(stmt, NULL, 0);
+	db_stmt_done(stmt);
+	return res;
+#undef MATCH_APPL
 }
 
 struct arcan_strarr arcan_db_matchkey(struct arcan_dbh* dbh,
 	enum DB_KVTARGET tgt, const char* pattern)
 {
-#define MATCH_KEY_TGT "SELECT tgtid ||':'|| value"\
-	" FROM target_kv WHERE key LIKE ?;"
-
 	static const char* const queries[] = {
-		MATCH_KEY_TGT,
-		"SELECT cfgid || ':' || value FROM config_kv WHERE key LIKE ?;"
+		"SELECT target || ':' || val FROM target_kv WHERE key LIKE ?;",
+		"SELECT config || ':' || val FROM config_kv WHERE key LIKE ?;"
 	};
 
-	const char* qry = NULL;
-	if (tgt >= DVT_TARGET && tgt < DVT_CONFIG)
-		qry = queries[0];
-	else
-		qry = queries[1];
+	bool target = tgt >= DVT_TARGET && tgt < DVT_CONFIG;
+	sqlite3_stmt* stmt = db_stmt(dbh,
+		queries[target ? 0 : 1], target ? "target_kv" : "config_kv");
+	if (!stmt)
+		return (struct arcan_strarr){0};
 
-	sqlite3_stmt* stmt;
-	sqlite3_prepare_v2(dbh->dbh, qry, sizeof(MATCH_KEY_TGT)-1, &stmt, NULL);
 	sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
 
-	return db_string_query(dbh, stmt, NULL, 0);
+	struct arcan_strarr res = db_string_rows(stmt, NULL, 0);
+	db_stmt_done(stmt);
+	return res;
 }
 
 char* arcan_db_getvalue(struct arcan_dbh* dbh,
@@ -817,31 +1607,23 @@ char* arcan_db_getvalue(struct arcan_dbh* dbh,
 	assert(DVT_ENDM == 5);
 
 	static const char* queries[] = {
-		"SELECT val FROM target_kv WHERE key = ? AND tgtid = ? LIMIT 1;",
-		"SELECT val FROM config_kv WHERE key = ? AND cfgid = ? LIMIT 1;"
+		"SELECT val FROM target_kv WHERE key = ? AND target = ? LIMIT 1;",
+		"SELECT val FROM config_kv WHERE key = ? AND config = ? LIMIT 1;"
 	};
 
-	const char* qry = NULL;
-	if (tgt >= DVT_TARGET && tgt < DVT_CONFIG)
-		qry = queries[0];
-	else
-		qry = queries[1];
+	if (tgt == DVT_APPL)
+		return arcan_db_appl_val(dbh, dbh->applname, key);
 
-/* assume they all are the same length */
-	static size_t qry_sz;
-	if (qry_sz == 0)
-		qry_sz = strlen(queries[1]);
+	bool target = tgt >= DVT_TARGET && tgt < DVT_CONFIG;
+	if (wb_lookup(dbh, target ? "target_kv" : "config_kv", true, id, key, &res))
+		return res;
 
-	sqlite3_stmt* stmt = NULL;
+	sqlite3_stmt* stmt = db_stmt(dbh, queries[target ? 0 : 1], NULL);
+	if (!stmt)
+		return NULL;
 
-	if (tgt == DVT_APPL){
-		sqlite3_prepare_v2(dbh->dbh, dbh->akv_get, dbh->akv_get_sz, &stmt, NULL);
-	}
-	else {
-		sqlite3_prepare_v2(dbh->dbh, qry, qry_sz, &stmt, NULL);
-		sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
-		sqlite3_bind_int(stmt, 2, id);
-	}
+	sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+	sqlite3_bind_int64(stmt, 2, id);
 
 	if (SQLITE_ROW == sqlite3_step(stmt)){
 		const char* row = (const char*) sqlite3_column_text(stmt, 0);
@@ -849,14 +1631,14 @@ char* arcan_db_getvalue(struct arcan_dbh* dbh,
 			res = strdup(row);
 	}
 
-	sqlite3_finalize(stmt);
+	db_stmt_done(stmt);
 	return res;
 }
 
 void arcan_db_add_kvpair(
 	struct arcan_dbh* dbh, const char* key, const char* val)
 {
-	if (!dbh->transaction)
+	if (!in_transaction(dbh))
 		arcan_fatal("arcan_db_add_kvpair() "
 			"called without any open transaction.");
 
@@ -865,11 +1647,17 @@ void arcan_db_add_kvpair(
 		return;
 	}
 
+/* empty values would be cleaned at the end of the transaction */
+	if (dbh->trmirror){
+		kv_set(dbh->trmirror, key, val[0] ? val : NULL, true);
+		return;
+	}
+
 	if (val[0] == 0)
 		dbh->trclean = true;
 
-	sqlite3_bind_text(dbh->transaction, 1, key, -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(dbh->transaction, 2, val, -1, SQLITE_TRANSIENT);
+	int64_t id = 0;
+	bool bind_id = false;
 
 	switch (dbh->ttype){
 	case DVT_APPL:
@@ -879,15 +1667,32 @@ void arcan_db_add_kvpair(
 	case DVT_TARGET:
 	case DVT_TARGET_ENV:
 	case DVT_TARGET_LIBV:
-		sqlite3_bind_int(dbh->transaction, 3, dbh->trid.tid);
+		id = dbh->trid.tid;
+		bind_id = true;
 	break;
 
 	case DVT_CONFIG:
 	case DVT_CONFIG_ENV:
-		sqlite3_bind_int(dbh->transaction, 3, dbh->trid.cid);
+		id = dbh->trid.cid;
+		bind_id = true;
 	break;
 	}
 
+	if (dbh->trqry){
+		struct db_cmd* cmd = wb_cmd(dbh->trqry, dbh->trtbl, key, val);
+		if (cmd){
+			cmd->id = id;
+			cmd->bind_id = bind_id;
+			wb_append(&dbh->trcmds, cmd);
+		}
+		return;
+	}
+
+	sqlite3_bind_text(dbh->transaction, 1, key, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(dbh->transaction, 2, val, -1, SQLITE_TRANSIENT);
+	if (bind_id)
+		sqlite3_bind_int64(dbh->transaction, 3, id);
+
 	int rc = sqlite3_step(dbh->transaction);
 	if (SQLITE_DONE != rc)
 		arcan_warning("arcan_db_addkvpair(%s=%s), %d failed: %s\n",
@@ -900,22 +1705,29 @@ void arcan_db_add_kvpair(
 
 void arcan_db_end_transaction(struct arcan_dbh* dbh)
 {
-	if (!dbh->transaction)
+	if (dbh->trmirror){
+		struct kv_mirror* mirror = dbh->trmirror;
+		dbh->trmirror = NULL;
+		dbh->trclean = false;
+		kv_flush(dbh, mirror);
+		return;
+	}
+
+	if (!dbh->transaction && !dbh->trqry)
 		arcan_fatal("arcan_db_end_transaction() "
 			"called without any open transaction.");
 
-	sqlite3_finalize(dbh->transaction);
-
+	const char* clean = NULL;
 	if (dbh->trclean){
 		switch (dbh->ttype){
 		case DVT_APPL:
-			sqlite3_exec(dbh->dbh, dbh->akv_clean, NULL, NULL, NULL);
+			clean = dbh->akv_clean;
 		break;
 		case DVT_TARGET:
-			sqlite3_exec(dbh->dbh, DI_DROPKV_TARGET, NULL, NULL, NULL);
+			clean = DI_DROPKV_TARGET;
 		break;
 		case DVT_CONFIG:
-			sqlite3_exec(dbh->dbh, DI_DROPKV_CONFIG, NULL, NULL, NULL);
+			clean = DI_DROPKV_CONFIG;
 		break;
 		default:
 		break;
@@ -923,6 +1735,20 @@ void arcan_db_end_transaction(struct arcan_dbh* dbh)
 		dbh->trclean = false;
 	}
 
+/* the whole transaction goes to the worker as one so it commits as one */
+	if (dbh->trqry){
+		if (clean)
+			wb_append(&dbh->trcmds, wb_cmd(clean, dbh->trtbl, NULL, NULL));
+		wb_submit(dbh, &dbh->trcmds);
+		dbh->trqry = NULL;
+		dbh->trtbl = NULL;
+		return;
+	}
+
+	db_stmt_done(dbh->transaction);
+	if (clean)
+		sqlite3_exec(dbh->dbh, clean, NULL, NULL, NULL);
+
 	if (SQLITE_OK != sqlite3_exec(dbh->dbh, "COMMIT;", NULL, NULL, NULL)){
 		arcan_warning("arcan_db_end_transaction(), failed: %s\n",
 			sqlite3_errmsg(dbh->dbh));
@@ -936,12 +1762,17 @@ bool arcan_db_appl_kv(struct arcan_dbh* dbh,
 {
 	bool rv = false;
 
-	if (dbh->transaction)
-		arcan_fatal("arcan_db_appl_kv() called during a pending transaction\n");
-
 	if (!applname || !dbh || !key)
 		return rv;
 
+	if (in_transaction(dbh))
+		arcan_fatal("arcan_db_appl_kv() called during a pending transaction\n");
+
+/* the mirror only saves the reads, writes still go through */
+	struct kv_mirror* mirror = kv_mirror(dbh, applname);
+	if (mirror)
+		kv_set(mirror, key, value, false);
+
 	const char ddl_insert[] = "INSERT OR REPLACE "
 		"INTO appl_%s(key, val) VALUES(?, ?);";
 	const char k_drop[] = "DELETE FROM appl_%s WHERE key=?;";
@@ -957,15 +1788,28 @@ bool arcan_db_appl_kv(struct arcan_dbh* dbh,
 		upd_sz = sizeof(ddl_insert) + strlen(applname);
 
 	char upd_buf[ upd_sz ];
-	ssize_t nw = snprintf(upd_buf, upd_sz, dqry, applname);
+	db_applqry(upd_buf, upd_sz, dqry, applname);
 
-	sqlite3_stmt* stmt = NULL;
-	sqlite3_prepare_v2(dbh->dbh, upd_buf, nw, &stmt, NULL);
-	sqlite3_bind_text(stmt, 1, key,   -1, SQLITE_TRANSIENT);
-	sqlite3_bind_text(stmt, 2, value, -1, SQLITE_TRANSIENT);
+	if (dbh->wb){
+		char tbl[sizeof("appl_") + strlen(applname)];
+		db_applqry(tbl, sizeof(tbl), "appl_%s", applname);
+
+		struct db_cmdlist list = {0};
+		wb_append(&list, wb_cmd(upd_buf, tbl, key, value));
+		wb_submit(dbh, &list);
+		return true;
+	}
+
+	sqlite3_stmt* stmt = db_stmt(dbh, upd_buf, NULL);
+	if (!stmt)
+		return rv;
+
+	sqlite3_bind_text(stmt, 1, key, -1, SQLITE_TRANSIENT);
+	if (value)
+		sqlite3_bind_text(stmt, 2, value, -1, SQLITE_TRANSIENT);
 
 	rv = sqlite3_step(stmt) == SQLITE_DONE;
-	sqlite3_finalize(stmt);
+	db_stmt_done(stmt);
 
 	return rv;
 }
@@ -973,21 +1817,34 @@ bool arcan_db_appl_kv(struct arcan_dbh* dbh,
 char* arcan_db_appl_val(struct arcan_dbh* dbh,
 	const char* const applname, const char* const key)
 {
-	if (!dbh || !key)
+	if (!dbh || !key || !applname)
 		return NULL;
 
+	struct kv_mirror* mirror = kv_mirror(dbh, applname);
+	if (mirror){
+		struct kv_ent* ent;
+		HASH_FIND_STR(mirror->ht, key, ent);
+		return ent && ent->val ? strdup(ent->val) : NULL;
+	}
+
+	char tbl[sizeof("appl_") + strlen(applname)];
+	char* rv = NULL;
+	db_applqry(tbl, sizeof(tbl), "appl_%s", applname);
+	if (wb_lookup(dbh, tbl, false, 0, key, &rv))
+		return rv;
+
 	const char qry[] = "SELECT val FROM appl_%s WHERE key = ?;";
 
 	size_t wbuf_sz = strlen(applname) + sizeof(qry);
 	char wbuf[ wbuf_sz ];
-	memset(wbuf, '\0', wbuf_sz);
-	snprintf(wbuf, wbuf_sz, qry, applname);
+	db_applqry(wbuf, wbuf_sz, qry, applname);
+
+	sqlite3_stmt* stmt = db_stmt(dbh, wbuf, NULL);
+	if (!stmt)
+		return NULL;
 
-	sqlite3_stmt* stmt = NULL;
-	sqlite3_prepare_v2(dbh->dbh, wbuf, wbuf_sz, &stmt, NULL);
 	sqlite3_bind_text(stmt, 1, (char*) key, -1, SQLITE_TRANSIENT);
 
-	char* rv = NULL;
 	int rc = sqlite3_step(stmt);
 
 	if (rc == SQLITE_ROW){
@@ -997,7 +1854,7 @@ char* arcan_db_appl_val(struct arcan_dbh* dbh,
 			rv = strdup((const char*) rowt);
 	}
 
-	sqlite3_finalize(stmt);
+	db_stmt_done(stmt);
 
 	return rv;
 }
@@ -1047,13 +1904,25 @@ static bool dbh_integrity_check(struct arcan_dbh* dbh){
 
 void arcan_db_close(struct arcan_dbh** ctx)
 {
-	if (!ctx)
+	if (!ctx || !*ctx)
 		return;
 
+/* an open transaction is committed as it is, then pending writes go to the
+ * worker which is stopped once it has finished them, statements need to be
+ * gone or the close will fail */
+	if (in_transaction(*ctx))
+		arcan_db_end_transaction(*ctx);
+
+	arcan_db_kvmirror(*ctx, false);
+	wb_wait(*ctx, NULL);
+	wb_stop(*ctx);
+	stmt_cache_drop(&(*ctx)->cache);
+
 	sqlite3_close((*ctx)->dbh);
 	arcan_mem_free((*ctx)->applname);
 	arcan_mem_free((*ctx)->akv_update);
-	arcan_mem_free((*ctx)->akv_get);
+	arcan_mem_free((*ctx)->akv_clean);
+	arcan_mem_free((*ctx)->akv_table);
 	arcan_mem_free(*ctx);
 	*ctx = NULL;
 }
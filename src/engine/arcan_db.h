@@ -224,8 +224,8 @@ bool arcan_db_verifytarget(struct arcan_dbh* dbh, arcan_targetid);
 void arcan_db_dropappl(struct arcan_dbh* dbh, const char* appl);
 
 /*
- * Synchronously store/retrieve a key-value pair,
- * set to empty value to delete.
+ * Store/retrieve a key-value pair, set to empty value to delete.
+ * Synchronous unless write-behind is enabled (see arcan_db_writebehind).
  */
 bool arcan_db_appl_kv(struct arcan_dbh* dbh, const char* appl,
 	const char* key, const char* value);
@@ -237,6 +237,47 @@ bool arcan_db_appl_kv(struct arcan_dbh* dbh, const char* appl,
 char* arcan_db_appl_val(struct arcan_dbh* dbh,
 	const char* const appl, const char* const key);
 
+/*
+ * Keep an in-memory copy of the appl_ key-value tables that are accessed
+ * through this handle. Reads are served from the copy, writes update it and
+ * go through to the table as without the mirror. Changes made to the tables
+ * through another handle or process while mirrored will not be seen.
+ * Disabled by default.
+ */
+void arcan_db_kvmirror(struct arcan_dbh* dbh, bool enable);
+
+/*
+ * Write out any changes to mirrored tables still pending, no-op during a
+ * transaction. With write-behind enabled this only hands them over to the
+ * worker, use arcan_db_sync to also wait for them to be committed.
+ */
+void arcan_db_flush(struct arcan_dbh* dbh);
+
+/*
+ * Flush and block until every queued write has been committed, for use
+ * before shutdown, handing over to another process or when recovering
+ * from a crash. arcan_db_close implies this.
+ */
+void arcan_db_sync(struct arcan_dbh* dbh);
+
+enum DB_SYNCH {
+	DB_SYNCH_OFF = 0,
+	DB_SYNCH_NORMAL = 1,
+	DB_SYNCH_FULL = 2
+};
+
+/*
+ * Move writes (transactions, appl_kv and mirror flushes) to a worker thread
+ * with its own connection that commits them in batches, coalescing for up
+ * to [period] ms. The database is switched to WAL mode and [synch] sets the
+ * sqlite synchronous level. Reads on the main handle wait for queued writes
+ * to be committed first, mirrored appl tables are served without waiting.
+ * [period] = 0 disables and blocks until the queue is empty. Fails on
+ * in-memory databases.
+ */
+bool arcan_db_writebehind(struct arcan_dbh* dbh,
+	unsigned period, enum DB_SYNCH synch);
+
 /*
  * Any function that returns an struct arcan_strarr should be explicitly
  * freed by calling this function.
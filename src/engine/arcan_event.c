@@ -539,6 +539,62 @@ void arcan_bench_register_frame()
 	lastframe = ftime;
 }
 
+void arcan_bench_register_io(unsigned count, unsigned long long usec)
+{
+	if (benchdata.bench_enabled == false)
+		return;
+
+	benchdata.iocount += count;
+	benchdata.iotime += usec;
+}
+
+void arcan_bench_register_cull(unsigned count)
+{
+	if (benchdata.bench_enabled == false)
+		return;
+
+	benchdata.culled += count;
+}
+
+void arcan_bench_register_uniforms(size_t set, size_t skipped)
+{
+	if (benchdata.bench_enabled == false)
+		return;
+
+	benchdata.unifset += set;
+	benchdata.unifskip += skipped;
+}
+
+void arcan_bench_register_models(size_t drawn, size_t culled, size_t draws)
+{
+	if (benchdata.bench_enabled == false)
+		return;
+
+	benchdata.drawn3d += drawn;
+	benchdata.culled3d += culled;
+	benchdata.draws3d += draws;
+}
+
+void arcan_bench_register_textcache(bool hit)
+{
+	if (benchdata.bench_enabled == false)
+		return;
+
+	if (hit)
+		benchdata.texthit++;
+	else
+		benchdata.textmiss++;
+}
+
+void arcan_bench_register_glyphs(size_t hits, size_t misses)
+{
+	if (benchdata.bench_enabled == false)
+		return;
+
+	benchdata.glyphhit += hits;
+	benchdata.glyphmiss += misses;
+}
+
 void arcan_event_deinit(arcan_evctx* ctx)
 {
 	platform_event_deinit(ctx);
@@ -37,6 +37,9 @@
 
 #include "arcan_event.h"
 #include "arcan_img.h"
+#include "arcan_amix.h"
+
+#include "../frameserver/util/resampler/speex_resampler.h"
 
 /* temporary workaround while migrating */
 typedef struct TTF_Font TTF_Font;
@@ -57,6 +60,78 @@ static int g_buffers_locked;
 
 static inline void emit_deliveredframe(arcan_frameserver* src,
 	unsigned long long pts, unsigned long long framecount);
+static void drop_amixer(arcan_frameserver* dst);
+
+/*
+ * The recording buffer (audb) is filled by audio monitors which may run on
+ * the audio thread, and drained by the readback in avfeedframe on the main
+ * thread. Producer side gets the contiguous writable span and commits what
+ * it used, consumer side copies out and advances the read offset.
+ */
+static size_t audb_span(arcan_frameserver* dst, uint8_t** out)
+{
+	if (!dst->audb)
+		return 0;
+
+	size_t w = atomic_load_explicit(&dst->ofs_audb, memory_order_relaxed);
+	size_t r = atomic_load_explicit(&dst->ofs_audp, memory_order_acquire);
+	size_t space = dst->sz_audb - (w - r);
+	size_t ofs = w & (dst->sz_audb - 1);
+	size_t cont = dst->sz_audb - ofs;
+
+	*out = &dst->audb[ofs];
+	return cont < space ? cont : space;
+}
+
+static void audb_commit(arcan_frameserver* dst, size_t nb)
+{
+	atomic_fetch_add_explicit(&dst->ofs_audb, nb, memory_order_release);
+}
+
+/* all or nothing, split over the wrap if needed */
+static bool audb_write(arcan_frameserver* dst, uint8_t* buf, size_t nb)
+{
+	uint8_t* out;
+	if (!dst->audb)
+		return false;
+
+	size_t w = atomic_load_explicit(&dst->ofs_audb, memory_order_relaxed);
+	size_t r = atomic_load_explicit(&dst->ofs_audp, memory_order_acquire);
+	if (dst->sz_audb - (w - r) < nb)
+		return false;
+
+	size_t first = audb_span(dst, &out);
+	first = first > nb ? nb : first;
+	memcpy(out, buf, first);
+	memcpy(dst->audb, &buf[first], nb - first);
+
+	audb_commit(dst, nb);
+	return true;
+}
+
+static size_t audb_dequeue(arcan_frameserver* dst, uint8_t* out, size_t lim)
+{
+	if (!dst->audb)
+		return 0;
+
+	size_t r = atomic_load_explicit(&dst->ofs_audp, memory_order_relaxed);
+	size_t w = atomic_load_explicit(&dst->ofs_audb, memory_order_acquire);
+	size_t nb = w - r;
+
+/* keep it to whole frames */
+	if (nb > lim)
+		nb = lim & ~(size_t)(sizeof(int16_t) * ARCAN_SHMIF_ACHANNELS - 1);
+
+	size_t ofs = r & (dst->sz_audb - 1);
+	size_t first = dst->sz_audb - ofs;
+	first = first > nb ? nb : first;
+
+	memcpy(out, &dst->audb[ofs], first);
+	memcpy(&out[first], dst->audb, nb - first);
+
+	atomic_store_explicit(&dst->ofs_audp, r + nb, memory_order_release);
+	return nb;
+}
 static inline void emit_droppedframe(arcan_frameserver* src,
 	unsigned long long pts, unsigned long long framecount);
 
@@ -113,6 +188,7 @@ arcan_errc arcan_frameserver_free(arcan_frameserver* src)
 		base++;
 	}
 	src->alocks = NULL;
+	drop_amixer(src);
 
 /* release the font group as well, this has the side effect of a 'pacify-target'
  * call where the frameserver is transformed to a normal video object - no
@@ -126,13 +202,15 @@ arcan_errc arcan_frameserver_free(arcan_frameserver* src)
 	if (!platform_fsrv_lastwords(src, msg, COUNT_OF(msg)))
 		snprintf(msg, COUNT_OF(msg), "Couldn't access metadata (SIGBUS?)");
 
+/* the audio feed may be serviced from the audio thread, so it needs to be
+ * gone before the shared memory is */
+	arcan_audio_stop(aid);
+
 /* will free, so no UAF here - only time the function returns false is when we
  * are somehow running it twice one the same src */
 	if (!platform_fsrv_destroy(src))
 		return ARCAN_ERRC_UNACCEPTED_STATE;
 
-	arcan_audio_stop(aid);
-
 /* make sure there is no other weird dangling state around and forward the
  * client 'last words' as a troubleshooting exit 'status' */
 	vfunc_state emptys = {0};
@@ -534,7 +612,7 @@ enum arcan_ffunc_rv arcan_frameserver_verifyffunc FFUNC_HEAD
 		tgt->aid = arcan_audio_feed((arcan_afunc_cb)
 			arcan_frameserver_audioframe_direct, tgt, &errc);
 		tgt->sz_audb = 0;
-		tgt->ofs_audb = 0;
+		tgt->ofs_audb = tgt->ofs_audp = 0;
 		tgt->audb = NULL;
 /* no point in trying the frame- poll this round, the odds of the other side
  * preempting us, mapping and populating the buffer etc. are not realistic */
@@ -657,6 +735,14 @@ enum arcan_ffunc_rv arcan_frameserver_vdirect FFUNC_HEAD
 		return rv;
 
 	arcan_frameserver* tgt = state.ptr;
+
+/* the audio thread faulted on the page, drop it with the feeds held off */
+	if (atomic_load(&tgt->shm_fault) && tgt->shm.ptr){
+		arcan_audio_lockfeeds();
+		platform_fsrv_dropshared(tgt);
+		arcan_audio_unlockfeeds();
+	}
+
 	struct arcan_shmif_page* shmpage = tgt->shm.ptr;
 	if (!shmpage)
 		return FRV_NOFRAME;
@@ -898,11 +984,9 @@ enum arcan_ffunc_rv arcan_frameserver_avfeedframe FFUNC_HEAD
 	else if (cmd == FFUNC_READBACK){
 		if (src->shm.ptr && !src->shm.ptr->vready){
 			memcpy(src->vbufs[0], buf, buf_sz);
-			if (src->ofs_audb){
-				memcpy(src->abufs[0], src->audb, src->ofs_audb);
-				src->shm.ptr->abufused[0] = src->ofs_audb;
-				src->ofs_audb = 0;
-			}
+			size_t nb = audb_dequeue(src, (uint8_t*) src->abufs[0], src->abuf_sz);
+			if (nb)
+				src->shm.ptr->abufused[0] = nb;
 
 /*
  * it is possible that we deliver more videoframes than we can legitimately
@@ -943,85 +1027,160 @@ no_out:
 	return FRV_NOFRAME;
 }
 
+/* frames per mixing step, bounds the stack scratch buffers */
+#define AMIX_CHUNK 512
+
+static void* amix_resampler(void* state, unsigned* cur, unsigned rate)
+{
+	if (state && *cur == rate)
+		return state;
+
+	if (state)
+		speex_resampler_destroy(state);
+
+	int err;
+	*cur = rate;
+	state = speex_resampler_init(ARCAN_SHMIF_ACHANNELS,
+		rate, ARCAN_SHMIF_SAMPLERATE, SPEEX_RESAMPLER_QUALITY_DEFAULT, &err);
+
+	if (!state)
+		arcan_warning("amixer: couldn't create resampler (%u -> %d)\n",
+			rate, ARCAN_SHMIF_SAMPLERATE);
+
+	return state;
+}
+
+/*
+ * convert, apply gain, resample and append to the source ring, the resampler
+ * works on planar float so conversion is done in chunks on the stack first
+ */
+static void amix_resample(struct frameserver_audsrc* cur,
+	int16_t* buf, size_t frames)
+{
+	float in_l[AMIX_CHUNK], in_r[AMIX_CHUNK];
+	float out_l[AMIX_CHUNK * 2], out_r[AMIX_CHUNK * 2];
+
+	while (frames){
+		spx_uint32_t nin = frames > AMIX_CHUNK ? AMIX_CHUNK : frames;
+		arcan_amix_s16_f32(buf, nin, in_l, in_r, cur->l_gain, cur->r_gain);
+
+		spx_uint32_t in_len = nin, out_len = COUNT_OF(out_l);
+		speex_resampler_process_float(
+			cur->resampler, 0, in_l, &in_len, out_l, &out_len);
+
+		in_len = nin;
+		out_len = COUNT_OF(out_r);
+		speex_resampler_process_float(
+			cur->resampler, 1, in_r, &in_len, out_r, &out_len);
+
+		arcan_amix_ring_write(cur->ring, out_l, out_r, out_len);
+		buf += in_len * 2;
+		frames -= in_len;
+	}
+}
+
 /* assumptions:
  * buf_sz doesn't contain partial samples (% (bytes per sample * channels))
  * dst->amixer inaud is allocated and allocation count matches n_aids */
 static void feed_amixer(arcan_frameserver* dst, arcan_aobj_id srcid,
-	int16_t* buf, int nsamples)
+	int16_t* buf, int nsamples, unsigned frequency)
 {
 /* formats; nsamples (samples in, 2 samples / frame)
- * cur->inbuf; samples converted to float with gain, 2 samples / frame)
+ * cur->ring; planar float with gain applied
  * dst->outbuf; SINT16, in bytes, ofset in bytes */
 	size_t minv = INT_MAX;
+	size_t frames = nsamples >> 1;
 
-/* 1. Convert to float and buffer. Find the lowest common number of samples
- * buffered. Truncate if needed. Assume source feeds L/R */
+/* 1. Convert and buffer. Find the lowest common number of frames buffered.
+ * Overflowing the ring drops the excess. Assume source feeds L/R */
 	for (int i = 0; i < dst->amixer.n_aids; i++){
 		struct frameserver_audsrc* cur = dst->amixer.inaud + i;
 
 		if (cur->src_aid == srcid){
-			int ulim = sizeof(cur->inbuf) / sizeof(float);
-			int count = 0;
+			if (frequency != ARCAN_SHMIF_SAMPLERATE)
+				cur->resampler = amix_resampler(cur->resampler, &cur->rate, frequency);
 
-			while (nsamples-- && cur->inofs < ulim){
-				float val = *buf++;
-				cur->inbuf[cur->inofs++] =
-					(count++ % 2 ? cur->l_gain : cur->r_gain) * (val / 32767.0f);
-			}
+			if (frequency != ARCAN_SHMIF_SAMPLERATE && cur->resampler)
+				amix_resample(cur, buf, frames);
+			else
+				arcan_amix_ring_write_s16(
+					cur->ring, buf, frames, cur->l_gain, cur->r_gain);
 		}
 
-		if (cur->inofs < minv)
-			minv = cur->inofs;
+		size_t used = arcan_amix_ring_used(cur->ring);
+		if (used < minv)
+			minv = used;
 	}
 
 /*
- * 2. If number of samples exceeds some threshold, mix (minv)
- * samples together and store in dst->outb Formulae used:
- * A = float(sampleA) * gainA.
- * B = float(sampleB) * gainB. Z = A + B - A * B
+ * 2. If number of frames exceeds some threshold, sum (minv) frames from each
+ * source, run the peak limiter and store as s16 in dst->audb. The sum is
+ * done in chunks so the scratch stays on the stack.
  */
-		if (minv != INT_MAX && minv > 512 && dst->sz_audb - dst->ofs_audb > 0){
-/* clamp */
-			if (dst->ofs_audb + minv * sizeof(uint16_t) > dst->sz_audb)
-				minv = (dst->sz_audb - dst->ofs_audb) / sizeof(uint16_t);
-
-			for (int sc = 0; sc < minv; sc++){
-				float work_sample = 0;
+	if (minv == INT_MAX || minv < AMIX_CHUNK / 2)
+		return;
 
-			for (int i = 0; i < dst->amixer.n_aids; i++){
-				work_sample += dst->amixer.inaud[i].inbuf[sc] - (work_sample *
-					dst->amixer.inaud[i].inbuf[sc]);
-			}
-/* clip output */
-			int16_t sample_conv = work_sample >= 1.0 ? 32767.0 :
-				(work_sample < -1.0 ? -32768 : work_sample * 32767);
-			memcpy(&dst->audb[dst->ofs_audb], &sample_conv, sizeof(int16_t));
-			dst->ofs_audb += sizeof(int16_t);
-		}
-/* 2b. Reset intermediate buffers, slide if needed. */
-		for (int j = 0; j < dst->amixer.n_aids; j++){
-			struct frameserver_audsrc* cur = dst->amixer.inaud + j;
-			if (cur->inofs > minv){
-				memmove(cur->inbuf, &cur->inbuf[minv], (cur->inofs - minv) *
-					sizeof(float));
-				cur->inofs -= minv;
-			}
-			else
-				cur->inofs = 0;
-		}
+	size_t frame_sz = sizeof(int16_t) * ARCAN_SHMIF_ACHANNELS;
+	float mix_l[AMIX_CHUNK], mix_r[AMIX_CHUNK];
+
+/* anything that doesn't fit in the output stays in the source rings */
+	while (minv){
+		uint8_t* out;
+		size_t step = audb_span(dst, &out) / frame_sz;
+		if (!step)
+			break;
+
+		step = step > minv ? minv : step;
+		step = step > AMIX_CHUNK ? AMIX_CHUNK : step;
+		memset(mix_l, '\0', step * sizeof(float));
+		memset(mix_r, '\0', step * sizeof(float));
+
+		for (int i = 0; i < dst->amixer.n_aids; i++)
+			arcan_amix_ring_accum(dst->amixer.inaud[i].ring, mix_l, mix_r, step);
+
+/* attack applies to the whole block, release ramps across it */
+		float gain = dst->amixer.limit;
+		float next = arcan_amix_limit(gain, arcan_amix_peak(mix_l, mix_r, step));
+		arcan_amix_f32_s16(mix_l, mix_r, step,
+			next < gain ? next : gain, next, (int16_t*) out);
+
+		dst->amixer.limit = next;
+		audb_commit(dst, step * frame_sz);
+		minv -= step;
 	}
-
 }
 
+/* the mixer state is read from the monitor hooks on the audio thread */
 void arcan_frameserver_update_mixweight(arcan_frameserver* dst,
 	arcan_aobj_id src, float left, float right)
 {
+	arcan_audio_lockfeeds();
 	for (int i = 0; i < dst->amixer.n_aids; i++){
 		if (src == 0 || dst->amixer.inaud[i].src_aid == src){
 			dst->amixer.inaud[i].l_gain = left;
 			dst->amixer.inaud[i].r_gain = right;
 		}
 	}
+	arcan_audio_unlockfeeds();
+}
+
+static void drop_amixer(arcan_frameserver* dst)
+{
+	for (int i = 0; i < dst->amixer.n_aids; i++){
+		arcan_mem_free(dst->amixer.inaud[i].ring);
+		if (dst->amixer.inaud[i].resampler)
+			speex_resampler_destroy(dst->amixer.inaud[i].resampler);
+	}
+
+	if (dst->amixer.n_aids)
+		arcan_mem_free(dst->amixer.inaud);
+
+	if (dst->amixer.resampler)
+		speex_resampler_destroy(dst->amixer.resampler);
+
+	dst->amixer.inaud = NULL;
+	dst->amixer.resampler = NULL;
+	dst->amixer.n_aids = 0;
 }
 
 void arcan_frameserver_avfeed_mixer(arcan_frameserver* dst, int n_sources,
@@ -1029,21 +1188,25 @@ void arcan_frameserver_avfeed_mixer(arcan_frameserver* dst, int n_sources,
 {
 	assert(sources != NULL && dst != NULL && n_sources > 0);
 
-	if (dst->amixer.n_aids)
-		arcan_mem_free(dst->amixer.inaud);
+	arcan_audio_lockfeeds();
+	drop_amixer(dst);
 
 	dst->amixer.inaud = arcan_alloc_mem(
 		n_sources * sizeof(struct frameserver_audsrc),
 		ARCAN_MEM_ATAG, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
 
 	for (int i = 0; i < n_sources; i++){
+		dst->amixer.inaud[i].ring = arcan_alloc_mem(
+			sizeof(struct arcan_amix_ring),
+			ARCAN_MEM_ATAG, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_SIMD);
 		dst->amixer.inaud[i].l_gain  = 1.0;
 		dst->amixer.inaud[i].r_gain  = 1.0;
-		dst->amixer.inaud[i].inofs   = 0;
 		dst->amixer.inaud[i].src_aid = *sources++;
 	}
 
+	dst->amixer.limit = 1.0;
 	dst->amixer.n_aids = n_sources;
+	arcan_audio_unlockfeeds();
 }
 
 void arcan_frameserver_avfeedmon(arcan_aobj_id src, uint8_t* buf,
@@ -1052,35 +1215,45 @@ void arcan_frameserver_avfeedmon(arcan_aobj_id src, uint8_t* buf,
 	arcan_frameserver* dst = tag;
 	assert((intptr_t)(buf) % 4 == 0);
 
-/*
- * FIXME: This is a victim of a recent shmif refactor where we started to
- * allow negotating different samplerates. This should be complemented with
- * the speex- resampler that's in the codebase already
- */
-	if (frequency != ARCAN_SHMIF_SAMPLERATE){
-		static bool warn;
-		if (!warn){
-			arcan_warning("arcan_frameserver_avfeedmon(), monitoring an audio feed\n"
-				"with a non-native samplerate, this is >currently< supported for\n"
-				"playback but not for recording (TOFIX).\n");
-			warn = true;
-		}
-	}
-
 /*
  * with no mixing setup (lowest latency path), we just feed the sync buffer
  * shared with the frameserver. otherwise we forward to the amixer that is
  * responsible for pushing as much as has been generated by all the defined
- * sources
+ * sources. Both paths resample if the feed doesn't match the shmif rate.
  */
 	if (dst->amixer.n_aids > 0){
-		feed_amixer(dst, src, (int16_t*) buf, buf_sz >> 1);
+		feed_amixer(dst, src, (int16_t*) buf, buf_sz >> 1, frequency);
+		return;
 	}
-	else if (dst->ofs_audb + buf_sz < dst->sz_audb){
-			memcpy(dst->audb + dst->ofs_audb, buf, buf_sz);
-			dst->ofs_audb += buf_sz;
+
+	if (frequency != ARCAN_SHMIF_SAMPLERATE){
+		dst->amixer.resampler =
+			amix_resampler(dst->amixer.resampler, &dst->amixer.rate, frequency);
+		if (!dst->amixer.resampler)
+			return;
+
+		size_t frame_sz = sizeof(int16_t) * ARCAN_SHMIF_ACHANNELS;
+		int16_t* in = (int16_t*) buf;
+		spx_uint32_t left = buf_sz / frame_sz;
+
+/* at most two spans, before and after the wrap */
+		for (size_t i = 0; i < 2 && left; i++){
+			uint8_t* out;
+			spx_uint32_t out_len = audb_span(dst, &out) / frame_sz;
+			spx_uint32_t in_len = left;
+			if (!out_len)
+				break;
+
+			speex_resampler_process_interleaved_int(dst->amixer.resampler,
+				in, &in_len, (int16_t*) out, &out_len);
+
+			audb_commit(dst, out_len * frame_sz);
+			in += in_len * ARCAN_SHMIF_ACHANNELS;
+			left -= in_len;
+		}
 	}
-	else;
+	else
+		audb_write(dst, buf, buf_sz);
 }
 
 static inline void emit_deliveredframe(arcan_frameserver* src,
@@ -1252,7 +1425,7 @@ arcan_errc arcan_frameserver_audioframe_direct(arcan_aobj* aobj,
 /* we need to switch to an interface where we can retrieve a set number of
  * buffers, matching the number of set bits in amask, then walk from ind-1 and
  * buffering all */
-	if (!src->shm.ptr)
+	if (!src->shm.ptr || atomic_load(&src->shm_fault))
 		return ARCAN_ERRC_UNACCEPTED_STATE;
 
 	TRAMP_GUARD(ARCAN_ERRC_UNACCEPTED_STATE, src);
@@ -1345,7 +1518,12 @@ bool arcan_frameserver_tick_control(
 		arcan_frameserver_close_bufferqueues(src, true, true);
 	}
 
+/* audioframe_direct can run on the audio thread and reads the mapping and
+ * abufs that resynch may move */
+	arcan_audio_lockfeeds();
 	int rzc = platform_fsrv_resynch(src);
+	arcan_audio_unlockfeeds();
+
 	if (rzc <= 0)
 		goto leave;
 	else if (rzc == 2){
@@ -96,11 +96,15 @@ struct arcan_frameserver_meta {
 };
 
 struct frameserver_audsrc {
-	float inbuf[4096];
-	off_t inofs;
+/* planar float, gain already applied (see arcan_amix.h) */
+	struct arcan_amix_ring* ring;
 	arcan_aobj_id src_aid;
 	float l_gain;
 	float r_gain;
+
+/* lazily created when the source doesn't match ARCAN_SHMIF_SAMPLERATE */
+	void* resampler;
+	unsigned rate;
 };
 
 struct arcan_frameserver {
@@ -191,6 +195,13 @@ struct arcan_frameserver {
 		unsigned n_aids;
 		size_t max_bufsz;
 		struct frameserver_audsrc* inaud;
+
+/* current limiter gain for the mixed output */
+		float limit;
+
+/* for single-source monitoring at a non-native samplerate */
+		void* resampler;
+		unsigned rate;
 	} amixer;
 
 /* playstate control and statistics */
@@ -221,11 +232,17 @@ struct arcan_frameserver {
 	} vstream;
 
 /* temporary buffer for aligning queue/dequeue events in audio, can/should
- * be scrapped after the 0.6 audio refactor */
+ * be scrapped after the 0.6 audio refactor. This is a single producer (the
+ * audio monitor, possibly on the audio thread), single consumer (readback)
+ * ring, offsets are monotonic byte counters and sz_audb is a power of two */
 	size_t sz_audb;
-	off_t ofs_audb, ofs_audp;
+	_Atomic size_t ofs_audb, ofs_audp;
 	uint8_t* audb;
 
+/* set when the shared page faulted (SIGBUS) on the audio thread, the page is
+ * owned by the main thread so it is dropped there on the next poll */
+	_Atomic bool shm_fault;
+
 /* local queue of the shared one is full when doing an enqueue of
  * prioritized control commands, re-enqueue is attempted in the poll stage */
 	size_t n_pending;
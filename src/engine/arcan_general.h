@@ -113,6 +113,25 @@ typedef struct {
 
 	unsigned framecost[64], costcount;
 	char costofs;
+
+/* number of io events delivered to the scripting layer and the time spent
+ * (microseconds) doing so, including table construction */
+	unsigned long long iocount, iotime;
+
+/* number of 2D draws skipped as they were fully covered by opaque objects */
+	unsigned long long culled;
+
+/* format strings served from / missing the rendered text cache */
+	unsigned long long texthit, textmiss;
+
+/* glyph lookups served from / missing the per-font glyph caches */
+	unsigned long long glyphhit, glyphmiss;
+
+/* shader uniform uploads performed and avoided as the program had the value */
+	unsigned long long unifset, unifskip;
+
+/* 3D models drawn and rejected by the view frustum test, mesh draw calls */
+	unsigned long long drawn3d, culled3d, draws3d;
 } arcan_benchdata;
 
 /*
@@ -147,6 +166,12 @@ void arcan_state_dump(const char* prefix, const char* key, const char* src);
 void arcan_bench_register_tick(unsigned);
 void arcan_bench_register_cost(unsigned);
 void arcan_bench_register_frame();
+void arcan_bench_register_io(unsigned count, unsigned long long usec);
+void arcan_bench_register_cull(unsigned count);
+void arcan_bench_register_textcache(bool hit);
+void arcan_bench_register_glyphs(size_t hits, size_t misses);
+void arcan_bench_register_uniforms(size_t set, size_t skipped);
+void arcan_bench_register_models(size_t drawn, size_t culled, size_t draws);
 arcan_benchdata* arcan_bench_data();
 
 /*
@@ -257,6 +257,11 @@ typedef int acoord;
 #define LAUNCH_INTERNAL 1
 #endif
 
+/* ticks a partially stepped gc cycle may hold off the automatic collector */
+#ifndef GC_HOLD_TICKS
+#define GC_HOLD_TICKS 4
+#endif
+
 /*
  * disable support for all builtin frameservers
  * which removes most (launch_target and target_alloc remain)
@@ -349,6 +354,22 @@ static struct {
 	uint8_t* trace_buffer;
 	size_t trace_buffer_sz;
 	intptr_t trace_cb;
+
+/* IO events queued for the _input_batch entry point, the registry
+ * reference to the column table that is reused between calls and the
+ * handler resolved when the first event of the pending batch arrived */
+	arcan_ioevent* iobatch;
+	size_t iobatch_used;
+	intptr_t iobatch_ref;
+	intptr_t iobatch_fn;
+	lua_State* iobatch_ctx;
+
+/* memory in use (KiB) when the last explicitly stepped gc cycle finished */
+	int gc_mark;
+
+/* ticks left before a partially stepped cycle is handed back to the
+ * automatic collector, 0 if no such cycle is in progress */
+	size_t gc_hold;
 } luactx = {0};
 
 extern char* _n_strdup(const char* instr, const char* alt);
@@ -968,6 +989,13 @@ void arcan_lua_tick(lua_State* ctx, size_t nticks, size_t global)
 	arcan_lua_setglobalint(ctx, "CLOCK", global);
 	luactx.last_clock = global;
 
+/* no slack to finish the stepped cycle in, let the allocator drive it */
+	if (luactx.gc_hold){
+		luactx.gc_hold = nticks < luactx.gc_hold ? luactx.gc_hold - nticks : 0;
+		if (!luactx.gc_hold)
+			lua_gc(ctx, LUA_GCRESTART, 0);
+	}
+
 /* Many applications misused the callback handler, ignoring the nticks and
  * global fields causing timed tasks to drift more than desired. Switch to
  * have one preferred 'batched' and then one where we emit each tick */
@@ -2284,6 +2312,7 @@ static int imageresizestorage(lua_State* ctx)
 
 	vobj->origw = w;
 	vobj->origh = h;
+	arcan_vint_invalidate(vobj);
 
 	struct rendertarget* rtgt = arcan_vint_findrt(vobj);
 	if (rtgt){
@@ -2494,22 +2523,35 @@ static int scaleimage(lua_State* ctx)
 static int orderimage(lua_State* ctx)
 {
 	LUA_TRACE("order_image");
-	int zv = luaL_checknumber(ctx, 2);
 
 /* array of VIDs or single VID */
 	int argtype = lua_type(ctx, 1);
 	if (argtype == LUA_TNUMBER){
+		int zv = luaL_checknumber(ctx, 2);
 		arcan_vobj_id id = luaL_checkvid(ctx, 1, NULL);
 		arcan_video_setzv(id, zv);
 	}
 	else if (argtype == LUA_TTABLE){
 		int nelems = lua_rawlen(ctx, 1);
+		bool zvtbl = lua_type(ctx, 2) == LUA_TTABLE;
+		int zv = zvtbl ? 0 : luaL_checknumber(ctx, 2);
+
+		if (zvtbl && lua_rawlen(ctx, 2) != nelems)
+			arcan_fatal("order_image(), table of orders (%d) does not "
+				"match the number of VIDs (%d)\n", (int) lua_rawlen(ctx, 2), nelems);
 
 		for (size_t i = 0; i < nelems; i++){
 			lua_rawgeti(ctx, 1, i+1);
 				arcan_vobj_id id = luaL_checkvid(ctx, -1, NULL);
-				arcan_video_setzv(id, zv);
 			lua_pop(ctx, 1);
+
+			if (zvtbl){
+				lua_rawgeti(ctx, 2, i+1);
+					zv = luaL_checknumber(ctx, -1);
+				lua_pop(ctx, 1);
+			}
+
+			arcan_video_setzv(id, zv);
 		}
 	}
 	else
@@ -2916,7 +2958,6 @@ static int imagestate(lua_State* ctx)
 		break;
 
 		case ARCAN_TAG_ASYNCIMGLD:
-		case ARCAN_TAG_ASYNCIMGRD:
 			lua_pushstring(ctx, "asynchronous state");
 		break;
 
@@ -4912,6 +4953,8 @@ static void append_iotable(lua_State* ctx, arcan_ioevent* ev)
 		tblnum(ctx, "size", ev->input.touch.size, top);
 		tblnum(ctx, "x", ev->input.touch.x, top);
 		tblnum(ctx, "y", ev->input.touch.y, top);
+		if (ev->flags & ARCAN_IOFL_COALESCED)
+			tblnum(ctx, "coalesced", ev->input.touch.coalesced, top);
 	break;
 
 	case EVENT_IO_EYES:
@@ -4981,6 +5024,11 @@ static void append_iotable(lua_State* ctx, arcan_ioevent* ev)
 				lua_rawset(ctx, top2);
 			}
 		lua_rawset(ctx, top);
+
+		if (ev->flags & ARCAN_IOFL_COALESCED){
+			tblnum(ctx, "coalesced", ev->input.analog.axisval[2], top);
+			tblnum(ctx, "span", ev->input.analog.axisval[3], top);
+		}
 	break;
 
 	case EVENT_IO_BUTTON:
@@ -5026,6 +5074,213 @@ static void append_iotable(lua_State* ctx, arcan_ioevent* ev)
 	}
 }
 
+/*
+ * Batched delivery for the _input_batch entry point. Rather than building a
+ * table per event, the events are unpacked into a table of columns (one array
+ * per field, indexed by event number) that is kept in the registry and reused
+ * between calls, so steady-state input does not produce any garbage. Entries
+ * beyond the count argument are left over from earlier batches. Rare event
+ * kinds (status, eyes) still go through append_iotable into the 'table' column.
+ */
+#define IOBATCH_LIMIT 1024
+
+enum iobatch_column {
+	IOB_KIND = 0,
+	IOB_SOURCE,
+	IOB_DEVID,
+	IOB_SUBID,
+	IOB_ACTIVE,
+	IOB_RELATIVE,
+	IOB_COUNT,
+	IOB_A1,
+	IOB_A2,
+	IOB_A3,
+	IOB_A4,
+	IOB_UTF8,
+	IOB_COALESCED,
+	IOB_TABLE,
+	IOB_LIMIT
+};
+
+static const char* iobatch_columns[] = {
+	"kind", "source", "devid", "subid", "active", "relative", "count",
+	"a1", "a2", "a3", "a4", "utf8", "coalesced", "table"
+};
+
+static void iobatch_num(lua_State* ctx, int* cols, int col, size_t i, double v)
+{
+	lua_pushnumber(ctx, v);
+	lua_rawseti(ctx, cols[col], i);
+}
+
+static void iobatch_bool(lua_State* ctx, int* cols, int col, size_t i, bool v)
+{
+	lua_pushboolean(ctx, v);
+	lua_rawseti(ctx, cols[col], i);
+}
+
+static void iobatch_str(
+	lua_State* ctx, int* cols, int col, size_t i, const char* v)
+{
+	lua_pushstring(ctx, v);
+	lua_rawseti(ctx, cols[col], i);
+}
+
+static void iobatch_unpack(lua_State* ctx, int* cols, size_t i, arcan_ioevent* ev)
+{
+	double av[4] = {0};
+	const char* kind = "unknown";
+	bool active = false;
+	int count = 0;
+
+	switch (ev->kind){
+	case EVENT_IO_TOUCH:
+		kind = "touch";
+		active = ev->input.touch.active;
+		av[0] = ev->input.touch.x;
+		av[1] = ev->input.touch.y;
+		av[2] = ev->input.touch.pressure;
+		av[3] = ev->input.touch.size;
+		count = 4;
+	break;
+	case EVENT_IO_AXIS_MOVE:
+		kind = "analog";
+		active = true;
+		count = ev->input.analog.nvalues > 4 ? 4 : ev->input.analog.nvalues;
+		for (size_t j = 0; j < count; j++)
+			av[j] = ev->input.analog.axisval[j];
+	break;
+	case EVENT_IO_BUTTON:
+		if (ev->devkind == EVENT_IDEVKIND_KEYBOARD){
+			kind = "translated";
+			active = ev->input.translated.active;
+			av[0] = ev->input.translated.keysym;
+			av[1] = ev->input.translated.modifiers;
+			av[2] = ev->input.translated.scancode;
+			count = 3;
+		}
+		else {
+			kind = "digital";
+			active = ev->input.digital.active;
+		}
+	break;
+	case EVENT_IO_STATUS:
+		kind = "status";
+	break;
+	case EVENT_IO_EYES:
+		kind = "eyes";
+	break;
+	default:
+	break;
+	}
+
+	iobatch_str(ctx, cols, IOB_KIND, i, kind);
+	iobatch_str(ctx, cols, IOB_SOURCE, i, kindstr(ev->devkind));
+	iobatch_num(ctx, cols, IOB_DEVID, i, ev->devid);
+	iobatch_num(ctx, cols, IOB_SUBID, i, ev->subid);
+	iobatch_bool(ctx, cols, IOB_ACTIVE, i, active);
+	iobatch_bool(ctx, cols, IOB_RELATIVE, i,
+		ev->kind == EVENT_IO_AXIS_MOVE && ev->input.analog.gotrel);
+	iobatch_num(ctx, cols, IOB_COUNT, i, count);
+	iobatch_num(ctx, cols, IOB_A1, i, av[0]);
+	iobatch_num(ctx, cols, IOB_A2, i, av[1]);
+	iobatch_num(ctx, cols, IOB_A3, i, av[2]);
+	iobatch_num(ctx, cols, IOB_A4, i, av[3]);
+
+	if (ev->kind == EVENT_IO_BUTTON && ev->devkind == EVENT_IDEVKIND_KEYBOARD)
+		iobatch_str(ctx, cols, IOB_UTF8, i, (char*)ev->input.translated.utf8);
+	else
+		iobatch_bool(ctx, cols, IOB_UTF8, i, false);
+
+	if (ev->flags & ARCAN_IOFL_COALESCED)
+		iobatch_num(ctx, cols, IOB_COALESCED, i,
+			ev->kind == EVENT_IO_AXIS_MOVE ?
+				ev->input.analog.axisval[2] : ev->input.touch.coalesced);
+	else
+		iobatch_bool(ctx, cols, IOB_COALESCED, i, false);
+
+	if (ev->kind == EVENT_IO_STATUS || ev->kind == EVENT_IO_EYES){
+		append_iotable(ctx, ev);
+		lua_rawseti(ctx, cols[IOB_TABLE], i);
+	}
+	else
+		iobatch_bool(ctx, cols, IOB_TABLE, i, false);
+}
+
+static void flush_iobatch(lua_State* ctx)
+{
+	size_t count = luactx.iobatch_used;
+	if (!count)
+		return;
+
+	luactx.iobatch_used = 0;
+	lua_rawgeti(ctx, LUA_REGISTRYINDEX, luactx.iobatch_fn);
+	luaL_unref(ctx, LUA_REGISTRYINDEX, luactx.iobatch_fn);
+	luactx.iobatch_fn = LUA_NOREF;
+
+/* handler, table, one slot per column and a few for the nested tables */
+	if (!lua_checkstack(ctx, IOB_LIMIT + 8)){
+		arcan_warning("input_batch: out of stack, dropped %zu events\n", count);
+		lua_pop(ctx, 1);
+		return;
+	}
+
+	bool bench = arcan_bench_data()->bench_enabled;
+	unsigned long long start = bench ? arcan_timemicros() : 0;
+
+/* the reference is tied to the VM, so rebuild after a collapse */
+	if (luactx.iobatch_ctx != ctx){
+		lua_newtable(ctx);
+		luactx.iobatch_ref = luaL_ref(ctx, LUA_REGISTRYINDEX);
+		luactx.iobatch_ctx = ctx;
+	}
+
+	lua_rawgeti(ctx, LUA_REGISTRYINDEX, luactx.iobatch_ref);
+	int tbl = lua_gettop(ctx);
+
+/* the appl is free to modify the table, so recreate any missing column */
+	int cols[IOB_LIMIT];
+	for (size_t i = 0; i < IOB_LIMIT; i++){
+		lua_getfield(ctx, tbl, iobatch_columns[i]);
+		if (!lua_istable(ctx, -1)){
+			lua_pop(ctx, 1);
+			lua_createtable(ctx, count, 0);
+			lua_pushvalue(ctx, -1);
+			lua_setfield(ctx, tbl, iobatch_columns[i]);
+		}
+		cols[i] = lua_gettop(ctx);
+	}
+
+	TRACE_MARK_ENTER("scripting", "input-batch", TRACE_SYS_DEFAULT, 0, count, "");
+	for (size_t i = 0; i < count; i++)
+		iobatch_unpack(ctx, cols, i + 1, &luactx.iobatch[i]);
+
+	lua_settop(ctx, tbl);
+	lua_pushnumber(ctx, count);
+	alua_call(ctx, 2, 0, LINE_TAG":event:input_batch");
+	TRACE_MARK_EXIT("scripting", "input-batch", TRACE_SYS_DEFAULT, 0, count, "");
+
+	if (bench)
+		arcan_bench_register_io(0, arcan_timemicros() - start);
+}
+
+/* the handler is looked up on the first event of a batch and expected on the
+ * top of the stack, no script code runs until the batch is flushed */
+static void queue_iobatch(lua_State* ctx, arcan_ioevent* ev)
+{
+	if (!luactx.iobatch_used)
+		luactx.iobatch_fn = luaL_ref(ctx, LUA_REGISTRYINDEX);
+
+	if (!luactx.iobatch){
+		luactx.iobatch = arcan_alloc_mem(sizeof(arcan_ioevent) * IOBATCH_LIMIT,
+			ARCAN_MEM_BINDING, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+	}
+
+	luactx.iobatch[luactx.iobatch_used++] = *ev;
+	if (luactx.iobatch_used == IOBATCH_LIMIT)
+		flush_iobatch(ctx);
+}
+
 #ifdef ARCAN_LWA
 void arcan_lwa_subseg_ev(
 	arcan_luactx* ctx, arcan_vobj_id source, uintptr_t cb_tag, arcan_event* ev)
@@ -5117,6 +5372,8 @@ void arcan_lua_pushevent(lua_State* ctx, arcan_event* ev)
 	bool adopt_check = false;
 	char msgbuf[sizeof(arcan_event)+1];
 	if (!ev){
+		flush_iobatch(ctx);
+
 		if (grabapplfunction(ctx, "input_end", 9)){
 			alua_call(ctx, 0, 0, LINE_TAG":event:input_eob");
 		}
@@ -5124,13 +5381,26 @@ void arcan_lua_pushevent(lua_State* ctx, arcan_event* ev)
 	}
 
 	if (ev->category == EVENT_IO){
-		if (grabapplfunction(ctx, "input", 5)){
+		bool bench = arcan_bench_data()->bench_enabled;
+		unsigned long long start = bench ? arcan_timemicros() : 0;
+
+		if (luactx.iobatch_used || grabapplfunction(ctx, "input_batch", 11)){
+			queue_iobatch(ctx, &ev->io);
+		}
+		else if (grabapplfunction(ctx, "input", 5)){
 			append_iotable(ctx, &ev->io);
 			alua_call(ctx, 1, 0, LINE_TAG":event:input");
 		}
+
+		if (bench)
+			arcan_bench_register_io(1, arcan_timemicros() - start);
 		return;
 	}
-	else if (ev->category == EVENT_EXTERNAL){
+
+/* keep the ordering between batched input and other events */
+	flush_iobatch(ctx);
+
+	if (ev->category == EVENT_EXTERNAL){
 		bool preroll = false;
 /* need to jump through a few hoops to get hold of the possible callback */
 		arcan_vobject* vobj = arcan_video_getobject(ev->ext.source);
@@ -6239,6 +6509,21 @@ static int buildbox(lua_State* ctx)
 	LUA_ETRACE("build_3dbox", NULL, 1);
 }
 
+static int instancemodel(lua_State* ctx)
+{
+	LUA_TRACE("instance_3dmodel");
+	arcan_vobj_id src = luaL_checkvid(ctx, 1, NULL);
+
+	arcan_vobj_id id = arcan_3d_instance(src);
+	if (id == ARCAN_EID)
+		arcan_fatal("instance_3dmodel(), specified vid"
+			" is not connected to a 3d model.\n");
+
+	lua_pushvid(ctx, id);
+	trace_allocation(ctx, "instance_3dmodel", id);
+	LUA_ETRACE("instance_3dmodel", NULL, 1);
+}
+
 static int pointcloud(lua_State* ctx)
 {
 	LUA_TRACE("build_pointcloud");
@@ -7664,6 +7949,13 @@ static int luaB_loadstring (lua_State* ctx) {
 
 void arcan_lua_mapfunctions(lua_State* ctx, int debuglevel)
 {
+/* a collapsed VM takes its heap with it */
+	luactx.gc_mark = 0;
+	luactx.gc_hold = 0;
+	luactx.iobatch_used = 0;
+	luactx.iobatch_ctx = NULL;
+	luactx.iobatch_fn = LUA_NOREF;
+
 	luaL_nil_banned(ctx);
 	alua_exposefuncs(ctx, debuglevel);
 /* update with debuglevel etc. */
@@ -7974,6 +8266,43 @@ static int screencoord(lua_State* ctx)
 	LUA_ETRACE("image_screen_coordinates", "couldn't resolve", 0);
 }
 
+size_t arcan_lua_gcstep(lua_State* ctx, size_t budget)
+{
+	if (!ctx || !budget)
+		return 0;
+
+/* don't start a new cycle for just a few allocations */
+	int count = lua_gc(ctx, LUA_GCCOUNT, 0);
+	int thresh = luactx.gc_mark >> 4;
+	if (!luactx.gc_hold && count < luactx.gc_mark + (thresh > 64 ? thresh : 64))
+		return 0;
+
+	unsigned long long start = arcan_timemicros();
+	unsigned long long now = start;
+	bool done = false;
+
+	while (now - start < budget){
+		if (lua_gc(ctx, LUA_GCSTEP, 0)){
+			luactx.gc_mark = lua_gc(ctx, LUA_GCCOUNT, 0);
+			done = true;
+			break;
+		}
+		now = arcan_timemicros();
+	}
+
+/* each step re-arms the automatic collector, which would then also step on
+ * allocations between slices. Keep it stopped until the cycle is finished,
+ * the step that finishes it sets the normal pause-based threshold again */
+	if (done)
+		luactx.gc_hold = 0;
+	else {
+		lua_gc(ctx, LUA_GCSTOP, 0);
+		luactx.gc_hold = GC_HOLD_TICKS;
+	}
+
+	return arcan_timemicros() - start;
+}
+
 bool arcan_lua_callvoidfun(lua_State* ctx,
 	const char* fun, bool warn, const char** argv)
 {
@@ -10389,17 +10718,18 @@ static int spawn_recsubseg(lua_State* ctx,
 	arcan_video_alterfeed(did, FFUNC_AVFEED, fftag);
 
 /* similar restrictions and problems as in spawn_recfsrv with the
- * hooking chicken-and-egg problem */
+ * hooking chicken-and-egg problem, the mixer goes first as the hooks can
+ * fire on the audio thread as soon as they are installed */
 	rv->alocks = aidlocks;
+	if (naids > 1)
+		arcan_frameserver_avfeed_mixer(rv, naids, aidlocks);
+
 	arcan_aobj_id* base = aidlocks;
 		while(base && *base){
 		void* hookfun;
 		arcan_audio_hookfeed(*base++, rv, arcan_frameserver_avfeedmon, &hookfun);
 	}
 
-	if (naids > 1)
-		arcan_frameserver_avfeed_mixer(rv, naids, aidlocks);
-
 	lua_pushvid(ctx, rv->vid);
 	trace_allocation(ctx, "encode", rv->vid);
 	return 1;
@@ -10479,6 +10809,16 @@ static int spawn_recfsrv(lua_State* ctx,
 
 	mvctx->alocks = aidlocks;
 
+/*
+ * if we have several input audio sources, we need to set up an intermediate
+ * mixing system, that accumulates samples from each audio source monitor,
+ * and emitts a mixed buffer. This requires that the audio sources operate at
+ * the same rate and buffering will converge on the biggest- buffer audio source.
+ * It has to be in place before the hooks as those can fire on the audio thread.
+ */
+	if (naids > 1)
+		arcan_frameserver_avfeed_mixer(mvctx, naids, aidlocks);
+
 /*
  * lastly, lock each audio object and forcibly attach the frameserver as a
  * monitor. NOTE that this currently doesn't handle the case where we we set up
@@ -10491,15 +10831,6 @@ static int spawn_recfsrv(lua_State* ctx,
 			arcan_frameserver_avfeedmon, &hookfun);
 	}
 
-/*
- * if we have several input audio sources, we need to set up an intermediate
- * mixing system, that accumulates samples from each audio source monitor,
- * and emitts a mixed buffer. This requires that the audio sources operate at
- * the same rate and buffering will converge on the biggest- buffer audio source
- */
-	if (naids > 1)
-		arcan_frameserver_avfeed_mixer(mvctx, naids, aidlocks);
-
 	tgtevent(did, (arcan_event){
 		.category = EVENT_TARGET,
 		.tgt.kind = TARGET_COMMAND_ACTIVATE
@@ -11044,6 +11375,12 @@ static int togglebench(lua_State* ctx)
 	memset(benchdata.framecost, '\0', sizeof(benchdata.framecost));
 	benchdata.tickofs = benchdata.frameofs = benchdata.costofs = 0;
 	benchdata.framecount = benchdata.tickcount = benchdata.costcount = 0;
+	benchdata.iocount = benchdata.iotime = 0;
+	benchdata.culled = 0;
+	benchdata.texthit = benchdata.textmiss = 0;
+	benchdata.glyphhit = benchdata.glyphmiss = 0;
+	benchdata.unifset = benchdata.unifskip = 0;
+	benchdata.drawn3d = benchdata.culled3d = benchdata.draws3d = 0;
 
 	LUA_ETRACE("benchmark_enable", NULL, 0);
 }
@@ -11110,7 +11447,23 @@ static int getbenchvals(lua_State* ctx)
 		i = (i + 1) % bench_sz;
 	}
 
-	LUA_ETRACE("benchmark_data", NULL, 6);
+/* named so that new counters don't shift the return values */
+	lua_createtable(ctx, 0, 12);
+	top = lua_gettop(ctx);
+	tblnum(ctx, "iocount", benchdata.iocount, top);
+	tblnum(ctx, "iotime", benchdata.iotime, top);
+	tblnum(ctx, "culled", benchdata.culled, top);
+	tblnum(ctx, "texthit", benchdata.texthit, top);
+	tblnum(ctx, "textmiss", benchdata.textmiss, top);
+	tblnum(ctx, "unifset", benchdata.unifset, top);
+	tblnum(ctx, "unifskip", benchdata.unifskip, top);
+	tblnum(ctx, "drawn3d", benchdata.drawn3d, top);
+	tblnum(ctx, "culled3d", benchdata.culled3d, top);
+	tblnum(ctx, "draws3d", benchdata.draws3d, top);
+	tblnum(ctx, "glyphhit", benchdata.glyphhit, top);
+	tblnum(ctx, "glyphmiss", benchdata.glyphmiss, top);
+
+	LUA_ETRACE("benchmark_data", NULL, 7);
 }
 
 static int timestamp(lua_State* ctx)
@@ -11664,6 +12017,8 @@ static int inputfilteranalog(lua_State* ctx)
 		mode = ARCAN_ANALOGFILTER_AVG;
 	else if (strcmp(smode, "latest") == 0)
 		mode = ARCAN_ANALOGFILTER_ALAST;
+	else if (strcmp(smode, "coalesce") == 0)
+		mode = ARCAN_ANALOGFILTER_COALESCE;
 	else
 		arcan_warning("inputfilteranalog(), unsupported mode (%s)\n", smode);
 
@@ -11689,6 +12044,9 @@ static void tblanalogenum(lua_State* ctx, int ttop,
 	case ARCAN_ANALOGFILTER_ALAST:
 		tblstr(ctx, "mode", "latest", ttop);
 	break;
+	case ARCAN_ANALOGFILTER_COALESCE:
+		tblstr(ctx, "mode", "coalesce", ttop);
+	break;
 	}
 }
 
@@ -12546,6 +12904,7 @@ static const luaL_Reg threedfuns[] = {
 {"build_sphere",     buildsphere  },
 {"build_cylinder",   buildcylinder},
 {"build_pointcloud", pointcloud   },
+{"instance_3dmodel", instancemodel},
 {"scale_3dvertices", scale3dverts },
 {"swizzle_model",    swizzlemodel },
 {"mesh_shader",      setmeshshader},
@@ -13036,8 +13395,6 @@ static char* lut_kind(arcan_vobject* src)
 		return "frameserver";
 	else if (src->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
 		return "textured_loading";
-	else if (src->feed.state.tag == ARCAN_TAG_ASYNCIMGRD)
-		return "texture_ready";
 	else if (src->feed.state.tag == ARCAN_TAG_3DOBJ)
 		return "3dobject";
 	else
@@ -13162,7 +13519,7 @@ fprintf(dst,
 \toutevq_used = %d,",
 	(long long) fsrv->lastpts,
 	(int) fsrv->sz_audb,
-	(int) fsrv->ofs_audb,
+	(int) (fsrv->ofs_audb - fsrv->ofs_audp),
 	(int) fsrv->flags.alive,
 	(int) fsrv->inqueue.eventbuf_sz,
 	qused(&fsrv->inqueue),
@@ -13182,8 +13539,7 @@ static void dump_vobject(FILE* dst, arcan_vobject* src)
 
 /*
  * note that most strings á glstore_*, scale* etc. are safe in the sense that
- * they are not user-supplied in any way. We ignore last_updated as parameter
- * to remove "useless" values in diffs. Add if needed for debugging cache.
+ * they are not user-supplied in any way.
  */
 	fprintf(dst,
 "vobj = {\n\
@@ -55,6 +55,12 @@ void arcan_lua_pushevent(struct arcan_luactx* ctx, arcan_event* ev);
 bool arcan_lua_callvoidfun(struct arcan_luactx* ctx,
 	const char* fun, bool warn, const char** argv);
 
+/* step the incremental garbage collector for up to [budget] microseconds,
+ * used by the conductor to move collection work into periods where it would
+ * otherwise be waiting. Stops early if there is not enough garbage to make
+ * it worthwhile or a cycle completes. Returns the time spent (microseconds) */
+size_t arcan_lua_gcstep(struct arcan_luactx* ctx, size_t budget);
+
 /* serialize a Lua- parseable snapshot of the various mapped subsystems and
  * resources into the (dst) filestream. If delim is set, we're in streaming
  * mode so a delimiter will be added to account for more snapshots over the
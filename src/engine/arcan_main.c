@@ -240,6 +240,7 @@ void appl_user_warning(const char* name, const char* err_msg)
 
 static void fatal_shutdown()
 {
+	arcan_db_sync(arcan_db_get_shared(NULL));
 	arcan_audio_shutdown();
 	arcan_video_shutdown(false);
 }
@@ -252,6 +253,39 @@ static struct {
 	FILE* mon_outf;
 } settings = {0};
 
+/* default ms the database worker waits to coalesce writes */
+#define DB_WB_PERIOD 250
+
+/*
+ * the appl key-value mirror would hide changes made by an external tool
+ * while running, so it is opt-in. Writes go through a worker thread
+ * unless db_writebehind is set to 0 (ms to coalesce writes otherwise).
+ */
+static void setup_db(struct arcan_dbh* dbh)
+{
+	uintptr_t tag;
+	cfg_lookup_fun get_config = platform_config_lookup(&tag);
+	arcan_db_kvmirror(dbh, get_config("db_kvmirror", 0, NULL, tag));
+
+	char* val;
+	unsigned period = DB_WB_PERIOD;
+	if (get_config("db_writebehind", 0, &val, tag)){
+		period = strtoul(val, NULL, 10);
+		free(val);
+	}
+
+	enum DB_SYNCH synch = DB_SYNCH_NORMAL;
+	if (get_config("db_synchronous", 0, &val, tag)){
+		if (strcmp(val, "off") == 0)
+			synch = DB_SYNCH_OFF;
+		else if (strcmp(val, "full") == 0)
+			synch = DB_SYNCH_FULL;
+		free(val);
+	}
+
+	arcan_db_writebehind(dbh, period, synch);
+}
+
 static void main_cycle()
 {
 	if (settings.monitor && !settings.in_monitor){
@@ -614,6 +648,7 @@ int MAIN_REDIR(int argc, char* argv[])
 		goto error;
 	}
 	arcan_db_set_shared(dbhandle);
+	setup_db(dbhandle);
 	const char* target_appl = NULL;
 	dbhandle = arcan_db_get_shared(&target_appl);
 
@@ -706,6 +741,7 @@ int MAIN_REDIR(int argc, char* argv[])
 			goto error;
 
 		arcan_db_set_shared(dbhandle);
+		setup_db(dbhandle);
 		arcan_lua_cbdrop();
 		arcan_lua_shutdown(main_lua_context);
 
@@ -766,6 +802,8 @@ int MAIN_REDIR(int argc, char* argv[])
 			goto error;
 		}
 
+/* make sure everything the failed appl stored is committed before handover */
+		arcan_db_sync(dbhandle);
 		arcan_event_maskall(evctx);
 		arcan_video_recoverexternal(true, &saved, &truncated, NULL, NULL);
 		arcan_event_clearmask(evctx);
@@ -899,6 +937,13 @@ error:
 	arcan_audio_shutdown();
 	arcan_video_shutdown(false);
 
+/* dbhandle might not be set here, the shared one always is */
+	struct arcan_dbh* dbh = arcan_db_get_shared(NULL);
+	if (dbh){
+		arcan_db_close(&dbh);
+		arcan_db_set_shared(NULL);
+	}
+
 /* now that video has been shut down, it should be safe to write the
  * last known Lua VM crash state information to stdout without risking
  * it being dropped due to TTY in GRAPHICS mode */
@@ -917,6 +917,8 @@ enum cstate frustum_aabb(const float frustum[6][4],
 enum cstate frustum_sphere(const float frustum[6][4],
 	const float x, const float y, const float z, const float radius)
 {
+	enum cstate res = inside;
+
 	for (int i = 0; i < 6; i++){
 		float dist =
 			frustum[i][0] * x +
@@ -927,18 +929,19 @@ enum cstate frustum_sphere(const float frustum[6][4],
 		if (dist < -radius)
 			return outside;
 
+/* keep going, a later plane can still reject the sphere */
 		else if (fabs(dist) < radius)
-			return intersect;
+			res = intersect;
 	}
 
-	return inside;
+	return res;
 }
 
 void update_frustum(float* prjm, float* mvm, float frustum[6][4])
 {
 	float mmr[16];
-/* multiply modelview with projection */
-	multiply_matrix(mmr, mvm, prjm);
+/* clip = projection * modelview, the planes end up in modelview space */
+	multiply_matrix(mmr, prjm, mvm);
 
 /* extract and normalize planes */
 	frustum[0][0] = mmr[3]  + mmr[0]; // left
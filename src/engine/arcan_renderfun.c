@@ -112,11 +112,63 @@ static struct text_format last_style = {
 	.col = {0xff, 0xff, 0xff, 0xff},
 };
 
+static void textcache_flush();
+static bool textcache_skip;
+
 static unsigned int font_cache_size = ARCAN_FONT_CACHE_LIMIT;
 static struct tui_font builtin_bitmap;
 static struct font_entry font_cache[ARCAN_FONT_CACHE_LIMIT] = {
 };
 
+/* glyph cache lookups across the font cache that have been accounted for,
+ * only tracked while benchmarking is enabled */
+static struct ttf_cache_stats glyphs_seen;
+static bool glyphs_synched;
+
+/*
+ * forward glyph cache hits / misses since the last call to the benchmark
+ * counters, fonts that are about to be closed are removed with glyphs_forget
+ */
+static void glyphs_register()
+{
+	if (!arcan_bench_data()->bench_enabled){
+		glyphs_synched = false;
+		return;
+	}
+
+	struct ttf_cache_stats sum = {0};
+
+	for (size_t i = 0; i < ARCAN_FONT_CACHE_LIMIT; i++)
+		for (size_t j = 0; j < font_cache[i].chain.count; j++){
+			struct ttf_cache_stats st;
+			if (!font_cache[i].chain.data[j])
+				continue;
+
+			TTF_CacheStats(font_cache[i].chain.data[j], &st);
+			sum.hits += st.hits;
+			sum.misses += st.misses;
+		}
+
+/* the first pass after enabling only takes the baseline */
+	if (glyphs_synched)
+		arcan_bench_register_glyphs(
+			sum.hits - glyphs_seen.hits, sum.misses - glyphs_seen.misses);
+
+	glyphs_seen = sum;
+	glyphs_synched = true;
+}
+
+static void glyphs_forget(TTF_Font* font)
+{
+	if (!glyphs_synched)
+		return;
+
+	struct ttf_cache_stats st;
+	TTF_CacheStats(font, &st);
+	glyphs_seen.hits -= st.hits;
+	glyphs_seen.misses -= st.misses;
+}
+
 static uint16_t nexthigher(uint16_t k)
 {
 	k--;
@@ -227,17 +279,24 @@ static void update_style(struct text_format* dst, struct font_entry* font)
 
 static void zap_slot(int i)
 {
+	glyphs_register();
+
 	for (size_t j = 0; j < font_cache[i].chain.count; j++){
 		if (font_cache[i].chain.fd[j] != BADFD){
 			close(font_cache[i].chain.fd[j]);
 			font_cache[i].chain.fd[j] = BADFD;
 		}
 
-		if (font_cache[i].chain.data[j])
+		if (font_cache[i].chain.data[j]){
+			glyphs_forget(font_cache[i].chain.data[j]);
 			TTF_CloseFont(font_cache[i].chain.data[j]);
+		}
 	}
 	free(font_cache[i].identifier);
 	memset(&font_cache[i], '\0', sizeof(font_cache[0]));
+
+/* rendered strings may reference the slot through their carried style */
+	textcache_flush();
 }
 
 static void set_style(struct text_format* dst, struct font_entry* font)
@@ -338,6 +397,7 @@ static struct font_entry* grab_font(const char* fname, size_t size)
 	}
 
 /* update counters */
+	textcache_flush();
 	font_cache[i].identifier = strdup(fname);
 	font_cache[i].usecount++;
 	font_cache[i].size = size;
@@ -367,6 +427,8 @@ bool arcan_video_defaultfont(const char* ident,
 		default_hint = hint;
 	}
 
+	textcache_flush();
+
 	if (!append){
 		zap_slot(0);
 		font_cache[0].identifier = strdup(ident);
@@ -380,6 +442,8 @@ bool arcan_video_defaultfont(const char* ident,
 		int dst_i = font_cache[0].chain.count;
 		size_t lim = COUNT_OF(font_cache[0].chain.data);
 		if (dst_i == lim){
+			glyphs_register();
+			glyphs_forget(font_cache[0].chain.data[dst_i-1]);
 			close(font_cache[0].chain.fd[dst_i-1]);
 			TTF_CloseFont(font_cache[0].chain.data[dst_i-1]);
 		}
@@ -867,9 +931,11 @@ retry:
 			prev.style & !TTF_STYLE_ITALIC : prev.style | TTF_STYLE_ITALIC);
 		break;
 		case 'e':
+			textcache_skip = true;
 			base = extract_vidref(&prev, base, false);
 		break;
 		case 'E':
+			textcache_skip = true;
 			base = extract_vidref(&prev, base, true);
 		break;
 		case 'v':
@@ -881,9 +947,11 @@ retry:
 		case 'V':
 		break;
 		case 'p':
+			textcache_skip = true;
 			base = extract_image_simple(&prev, base);
 		break;
 		case 'P':
+			textcache_skip = true;
 			base = extract_image(&prev, base);
 		break;
 		case '#':
@@ -1190,6 +1258,41 @@ static void cleanup_chain(struct rcell* root)
 	}
 }
 
+/* if we have a vobj set, re-use that backing store, and treat
+ * it as a source-stream resize (so scaling factors etc. get reapplied) */
+static av_pixel* alloc_output(
+	arcan_vobject* dst, size_t dw, size_t dh, uint32_t d_sz)
+{
+	if (!dst)
+		return arcan_alloc_mem(d_sz, ARCAN_MEM_VBUFFER,
+			ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_PAGE);
+
+/* manually resize the local buffer so the video_resizefeed call won't
+ * do dual agp_update_vstore synchs */
+	struct agp_vstore* s = dst->vstore;
+
+	if (s->vinf.text.raw)
+		arcan_mem_free(s->vinf.text.raw);
+
+	s->vinf.text.raw = arcan_alloc_mem(d_sz,
+		ARCAN_MEM_VBUFFER, 0, ARCAN_MEMALIGN_PAGE);
+	s->vinf.text.s_raw = d_sz;
+	s->w = dw;
+	s->h = dh;
+
+	return s->vinf.text.raw;
+}
+
+static void finish_output(arcan_vobject* dst, size_t dw, size_t dh)
+{
+	if (!dst)
+		return;
+
+	agp_resize_vstore(dst->vstore, dw, dh);
+	dst->vstore->vinf.text.hppcm = default_hdpi / 2.54;
+	dst->vstore->vinf.text.vppcm = default_vdpi / 2.54;
+}
+
 static av_pixel* process_chain(struct rcell* root, arcan_vobject* dst,
 	size_t chainlines, bool norender, bool pot,
 	unsigned int* n_lines, struct renderline_meta** lineheights, size_t* dw,
@@ -1276,29 +1379,7 @@ static av_pixel* process_chain(struct rcell* root, arcan_vobject* dst,
 	if (norender)
 		return (cleanup_chain(root), NULL);
 
-/* if we have a vobj set, re-use that backing store, and treat
- * it as a source-stream resize (so scaling factors etc. get reapplied) */
-
-	av_pixel* raw = NULL;
-
-	if (dst){
-/* manually resize the local buffer so the video_resizefeed call won't
- * do dual agp_update_vstore synchs */
-		struct agp_vstore* s = dst->vstore;
-
-		if (s->vinf.text.raw)
-			arcan_mem_free(s->vinf.text.raw);
-
-	 	raw = s->vinf.text.raw = arcan_alloc_mem(*d_sz,
-			ARCAN_MEM_VBUFFER, 0, ARCAN_MEMALIGN_PAGE);
-		s->vinf.text.s_raw = *d_sz;
-		s->w = *dw;
-		s->h = *dh;
-	}
-	else{
-		raw = arcan_alloc_mem(*d_sz, ARCAN_MEM_VBUFFER,
-			ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_PAGE);
-	}
+	av_pixel* raw = alloc_output(dst, *dw, *dh, *d_sz);
 
 	if (!raw || !*d_sz)
 		return (cleanup_chain(root), raw);
@@ -1334,26 +1415,371 @@ static av_pixel* process_chain(struct rcell* root, arcan_vobject* dst,
 	else
 		arcan_mem_free(lines);
 
-	if (dst){
-		agp_resize_vstore(dst->vstore, *dw, *dh);
-		dst->vstore->vinf.text.hppcm = default_hdpi / 2.54;
-		dst->vstore->vinf.text.vppcm = default_vdpi / 2.54;
-	}
+	finish_output(dst, *dw, *dh);
 
 	return (cleanup_chain(root), raw);
 }
 
+/*
+ * Rendered string cache. UIs tend to re-render the same labels over and over
+ * (menus, titlebars, clocks where only some parts change) so the finished
+ * composite for a format string is kept, keyed on the string(s), the style
+ * state carried in from the previous call, output density and padding. A hit
+ * skips parsing and rasterization and just copies the composite out and
+ * restores the style state the string left behind.
+ *
+ * Strings that embed images or vids are never stored as the sources can
+ * change underneath, and the whole cache is dropped whenever a font slot
+ * changes as the carried style may reference it.
+ */
+#ifndef ARCAN_TEXTCACHE_BUDGET
+#define ARCAN_TEXTCACHE_BUDGET (8 * 1024 * 1024)
+#endif
+
+#define TEXTCACHE_BUCKETS 256
+
+struct textcache_key {
+	bool extended;
+	bool pot;
+	int style;
+	uint8_t col[4];
+	uint8_t alpha;
+	size_t pt_size;
+	struct font_entry* font;
+	float hdpi, vdpi;
+};
+
+struct textcache_entry {
+	uint64_t hash;
+	uint8_t* key;
+	size_t key_sz;
+
+	av_pixel* raw;
+	uint32_t d_sz;
+	size_t dw, dh, maxw, maxh;
+	struct renderline_meta* lines;
+	unsigned int n_lines;
+	struct text_format out_style;
+	size_t bytes;
+
+	struct textcache_entry* next;
+	struct textcache_entry* lru_prev;
+	struct textcache_entry* lru_next;
+};
+
+static struct {
+	struct textcache_entry* buckets[TEXTCACHE_BUCKETS];
+	struct textcache_entry* lru_head;
+	struct textcache_entry* lru_tail;
+	size_t bytes;
+	size_t budget;
+	bool disabled;
+} textcache = {
+	.budget = ARCAN_TEXTCACHE_BUDGET
+};
+
+static void textcache_unlink(struct textcache_entry* ent)
+{
+	struct textcache_entry** cur = &textcache.buckets[ent->hash % TEXTCACHE_BUCKETS];
+	while (*cur != ent)
+		cur = &(*cur)->next;
+	*cur = ent->next;
+
+	if (ent->lru_prev)
+		ent->lru_prev->lru_next = ent->lru_next;
+	else
+		textcache.lru_head = ent->lru_next;
+
+	if (ent->lru_next)
+		ent->lru_next->lru_prev = ent->lru_prev;
+	else
+		textcache.lru_tail = ent->lru_prev;
+
+	textcache.bytes -= ent->bytes;
+	arcan_mem_free(ent->raw);
+	arcan_mem_free(ent->lines);
+	arcan_mem_free(ent->key);
+	arcan_mem_free(ent);
+}
+
+static void textcache_flush()
+{
+	while (textcache.lru_head)
+		textcache_unlink(textcache.lru_head);
+}
+
+void arcan_renderfun_textcache(size_t budget)
+{
+	textcache.disabled = budget == 0;
+	textcache.budget = budget;
+	textcache_flush();
+}
+
+/*
+ * serialize the incoming state and the message(s) into [out] (or just count
+ * the bytes if NULL), strings are stored with their terminator so that
+ * empty entries in an extended array still shift the pattern
+ */
+static size_t textcache_buildkey(uint8_t* out,
+	const char* message, const char** msgarray, bool pot)
+{
+	struct textcache_key key;
+	memset(&key, '\0', sizeof(key));
+	key.extended = msgarray != NULL;
+	key.pot = pot;
+	key.style = last_style.style;
+	memcpy(key.col, last_style.col, sizeof(key.col));
+	key.alpha = last_style.alpha;
+	key.pt_size = last_style.pt_size;
+	key.font = last_style.font;
+	key.hdpi = default_hdpi;
+	key.vdpi = default_vdpi;
+
+	size_t pos = sizeof(key);
+	if (out)
+		memcpy(out, &key, sizeof(key));
+
+	for (size_t i = 0; msgarray ? msgarray[i] != NULL : i == 0; i++){
+		const char* str = msgarray ? msgarray[i] : message;
+		size_t len = strlen(str) + 1;
+		if (out)
+			memcpy(&out[pos], str, len);
+		pos += len;
+	}
+
+	return pos;
+}
+
+static uint64_t textcache_hash(const uint8_t* buf, size_t sz)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < sz; i++){
+		hash ^= buf[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/*
+ * look up the current message and state, returns NULL on miss or the entry
+ * (moved to the front), [keyout, keysz, hash] are set for a later insert
+ */
+static struct textcache_entry* textcache_lookup(const char* message,
+	const char** msgarray, bool pot, uint8_t** keyout, size_t* keysz, uint64_t* hash)
+{
+	*keyout = NULL;
+	if (textcache.disabled)
+		return NULL;
+
+	*keysz = textcache_buildkey(NULL, message, msgarray, pot);
+	*keyout = arcan_alloc_mem(*keysz,
+		ARCAN_MEM_STRINGBUF, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_NATURAL);
+	if (!*keyout)
+		return NULL;
+
+	textcache_buildkey(*keyout, message, msgarray, pot);
+	*hash = textcache_hash(*keyout, *keysz);
+
+	struct textcache_entry* ent = textcache.buckets[*hash % TEXTCACHE_BUCKETS];
+	for (; ent; ent = ent->next){
+		if (ent->hash == *hash && ent->key_sz == *keysz &&
+			memcmp(ent->key, *keyout, *keysz) == 0)
+			break;
+	}
+
+	arcan_bench_register_textcache(ent != NULL);
+	if (!ent || ent == textcache.lru_head)
+		return ent;
+
+/* move to front */
+	ent->lru_prev->lru_next = ent->lru_next;
+	if (ent->lru_next)
+		ent->lru_next->lru_prev = ent->lru_prev;
+	else
+		textcache.lru_tail = ent->lru_prev;
+
+	ent->lru_prev = NULL;
+	ent->lru_next = textcache.lru_head;
+	textcache.lru_head->lru_prev = ent;
+	textcache.lru_head = ent;
+
+	return ent;
+}
+
+/* takes ownership of [key], copies [raw] and [lines] */
+static void textcache_insert(uint8_t* key, size_t key_sz, uint64_t hash,
+	const av_pixel* raw, uint32_t d_sz, size_t dw, size_t dh,
+	size_t maxw, size_t maxh, unsigned int n_lines,
+	const struct renderline_meta* lines)
+{
+	size_t lines_sz = sizeof(struct renderline_meta) * (n_lines + 1);
+	size_t bytes = sizeof(struct textcache_entry) + key_sz + d_sz + lines_sz;
+
+/* don't let a single huge string push out everything else */
+	if (!key || textcache_skip || !raw || !d_sz || bytes > textcache.budget / 8){
+		arcan_mem_free(key);
+		return;
+	}
+
+	struct textcache_entry* ent = arcan_alloc_mem(sizeof(struct textcache_entry),
+		ARCAN_MEM_VSTRUCT, ARCAN_MEM_NONFATAL | ARCAN_MEM_BZERO,
+		ARCAN_MEMALIGN_NATURAL
+	);
+	av_pixel* copy = arcan_alloc_mem(d_sz,
+		ARCAN_MEM_VBUFFER, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_PAGE);
+	struct renderline_meta* lcopy = arcan_alloc_mem(lines_sz,
+		ARCAN_MEM_VSTRUCT, ARCAN_MEM_NONFATAL | ARCAN_MEM_BZERO,
+		ARCAN_MEMALIGN_NATURAL
+	);
+
+	if (!ent || !copy || !lcopy){
+		arcan_mem_free(ent);
+		arcan_mem_free(copy);
+		arcan_mem_free(lcopy);
+		arcan_mem_free(key);
+		return;
+	}
+
+	memcpy(copy, raw, d_sz);
+	if (lines)
+		memcpy(lcopy, lines, sizeof(struct renderline_meta) * n_lines);
+
+	*ent = (struct textcache_entry){
+		.hash = hash,
+		.key = key,
+		.key_sz = key_sz,
+		.raw = copy,
+		.d_sz = d_sz,
+		.dw = dw, .dh = dh,
+		.maxw = maxw, .maxh = maxh,
+		.lines = lcopy,
+		.n_lines = n_lines,
+		.out_style = last_style,
+		.bytes = bytes
+	};
+
+/* the style carries pointers into the work buffer and a consumed surface */
+	ent->out_style.endofs = NULL;
+	ent->out_style.surf.buf = NULL;
+
+	while (textcache.lru_tail && textcache.bytes + bytes > textcache.budget)
+		textcache_unlink(textcache.lru_tail);
+
+	size_t bucket = hash % TEXTCACHE_BUCKETS;
+	ent->next = textcache.buckets[bucket];
+	textcache.buckets[bucket] = ent;
+
+	ent->lru_next = textcache.lru_head;
+	if (textcache.lru_head)
+		textcache.lru_head->lru_prev = ent;
+	else
+		textcache.lru_tail = ent;
+	textcache.lru_head = ent;
+
+	textcache.bytes += bytes;
+}
+
+/* same contract as process_chain, but sourced from a cache entry */
+static av_pixel* textcache_output(struct textcache_entry* ent,
+	arcan_vobject* dst, bool norender,
+	unsigned int* n_lines, struct renderline_meta** lineheights, size_t* dw,
+	size_t* dh, uint32_t* d_sz, size_t* maxw, size_t* maxh)
+{
+	last_style = ent->out_style;
+	*dw = ent->dw;
+	*dh = ent->dh;
+	*d_sz = ent->d_sz;
+	*maxw = ent->maxw;
+	*maxh = ent->maxh;
+
+	if (norender)
+		return NULL;
+
+	av_pixel* raw = alloc_output(dst, ent->dw, ent->dh, ent->d_sz);
+	if (!raw)
+		return NULL;
+
+	memcpy(raw, ent->raw, ent->d_sz);
+
+	if (n_lines)
+		*n_lines = ent->n_lines;
+
+	if (lineheights){
+		size_t lines_sz = sizeof(struct renderline_meta) * (ent->n_lines + 1);
+		*lineheights = arcan_alloc_mem(lines_sz, ARCAN_MEM_VSTRUCT,
+			ARCAN_MEM_BZERO | ARCAN_MEM_TEMPORARY, ARCAN_MEMALIGN_NATURAL);
+		memcpy(*lineheights, ent->lines, lines_sz);
+	}
+
+	finish_output(dst, ent->dw, ent->dh);
+	return raw;
+}
+
+/* process_chain, but keep the result in the cache under [key] if possible */
+static av_pixel* process_cached(struct rcell* root, arcan_vobject* dst,
+	size_t chainlines, bool norender, bool pot,
+	uint8_t* key, size_t key_sz, uint64_t hash,
+	unsigned int* n_lines, struct renderline_meta** lineheights, size_t* dw,
+	size_t* dh, uint32_t* d_sz, size_t* maxw, size_t* maxh)
+{
+	if (!key || norender){
+		arcan_mem_free(key);
+		av_pixel* raw = process_chain(root, dst, chainlines, norender, pot,
+			n_lines, lineheights, dw, dh, d_sz, maxw, maxh);
+		glyphs_register();
+		return raw;
+	}
+
+	unsigned int lc = 0;
+	struct renderline_meta* lines = NULL;
+	av_pixel* raw = process_chain(root, dst, chainlines, false, pot,
+		&lc, &lines, dw, dh, d_sz, maxw, maxh);
+	glyphs_register();
+
+	textcache_insert(key, key_sz, hash,
+		raw, *d_sz, *dw, *dh, *maxw, *maxh, lc, lines);
+
+	if (n_lines)
+		*n_lines = lc;
+
+	if (lineheights)
+		*lineheights = lines;
+	else
+		arcan_mem_free(lines);
+
+	return raw;
+}
+
 av_pixel* arcan_renderfun_renderfmtstr_extended(const char** msgarray,
 	arcan_vobj_id dstore, bool pot,
 	unsigned int* n_lines, struct renderline_meta** lineheights, size_t* dw,
 	size_t* dh, uint32_t* d_sz, size_t* maxw, size_t* maxh, bool norender)
 {
+	if (!msgarray || !msgarray[0])
+		return NULL;
+
+	uint8_t* key;
+	size_t key_sz;
+	uint64_t hash;
+	struct textcache_entry* ent =
+		textcache_lookup(NULL, msgarray, pot, &key, &key_sz, &hash);
+
+	if (ent){
+		arcan_mem_free(key);
+		return textcache_output(ent, arcan_video_getobject(dstore), norender,
+			n_lines, lineheights, dw, dh, d_sz, maxw, maxh);
+	}
+
 	struct rcell* root = arcan_alloc_mem(sizeof(struct rcell),
 		ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO | ARCAN_MEM_TEMPORARY,
 		ARCAN_MEMALIGN_NATURAL
 	);
-	if (!root || !msgarray || !msgarray[0])
+	if (!root){
+		arcan_mem_free(key);
 		return NULL;
+	}
+
+	textcache_skip = false;
 
 	last_style.newline = 0;
 	last_style.tab = 0;
@@ -1398,8 +1824,8 @@ av_pixel* arcan_renderfun_renderfmtstr_extended(const char** msgarray,
 	);
 	cur->data.format.newline = 1;
 
-	return process_chain(root, arcan_video_getobject(dstore),
-		acc+1, norender, pot, n_lines,
+	return process_cached(root, arcan_video_getobject(dstore),
+		acc+1, norender, pot, key, key_sz, hash, n_lines,
 		lineheights, dw, dh, d_sz, maxw, maxh
 	);
 }
@@ -1415,11 +1841,24 @@ av_pixel* arcan_renderfun_renderfmtstr(const char* message,
 
 	av_pixel* raw = NULL;
 
+	uint8_t* key;
+	size_t key_sz;
+	uint64_t hash;
+	struct textcache_entry* ent =
+		textcache_lookup(message, NULL, pot, &key, &key_sz, &hash);
+
+	if (ent){
+		arcan_mem_free(key);
+		return textcache_output(ent, arcan_video_getobject(dstore), norender,
+			n_lines, lineheights, dw, dh, d_sz, maxw, maxh);
+	}
+
 /* (A) parse format string and build chains of renderblocks */
 	struct rcell* root = arcan_alloc_mem(sizeof(struct rcell),
 		ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO | ARCAN_MEM_TEMPORARY,
 		ARCAN_MEMALIGN_NATURAL
 	);
+	textcache_skip = false;
 
 	char* work = strdup(message);
 	last_style.newline = 0;
@@ -1430,11 +1869,13 @@ av_pixel* arcan_renderfun_renderfmtstr(const char* message,
 	arcan_mem_free(work);
 
 	if (chainlines > 0){
-		raw = process_chain(root, arcan_video_getobject(dstore),
-			chainlines, norender, pot, n_lines, lineheights,
+		raw = process_cached(root, arcan_video_getobject(dstore),
+			chainlines, norender, pot, key, key_sz, hash, n_lines, lineheights,
 			dw, dh, d_sz, maxw, maxh
 		);
 	}
+	else
+		arcan_mem_free(key);
 
 	return raw;
 }
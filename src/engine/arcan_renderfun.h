@@ -122,6 +122,13 @@ void arcan_video_fontdefaults(file_handle* fd, int* pt_sz, int* hint);
  */
 void arcan_renderfun_reset_fontcache();
 
+/*
+ * Set the byte budget for the cache of rendered format strings, identical
+ * strings rendered with the same carried state and density are served from
+ * the cache without parsing or rasterization. 0 disables the cache.
+ */
+void arcan_renderfun_textcache(size_t budget);
+
 /*
  * RGBA32 only for now, rather unoptimized
  * returns -1 or failure, 0 on success
@@ -57,6 +57,18 @@
 #define CACHED_METRICS	0x10
 #define CACHED_BITMAP	0x01
 #define CACHED_PIXMAP	0x02
+#define CACHED_MISSING	0x20
+
+/* default byte budget per font for the glyph cache, see Find_Glyph */
+#ifndef TTF_GLYPH_BUDGET
+#define TTF_GLYPH_BUDGET (2 * 1024 * 1024)
+#endif
+
+/* bitmap slab size classes, SLAB_MIN << (0..SLAB_CLASSES-1) bytes, larger
+ * bitmaps (big emoji and so on) go through malloc */
+#define SLAB_MIN 32
+#define SLAB_CLASSES 10
+#define SLAB_PAGE (64 * 1024)
 
 /* Cached glyph information */
 typedef struct cached_glyph {
@@ -70,7 +82,14 @@ typedef struct cached_glyph {
 	int maxy;
 	int yoffset;
 	int advance;
-	uint32_t cached;
+
+/* (codepoint or index, style, size), see glyph_key */
+	uint64_t key;
+
+/* 1-based slot indices, 0 terminates, next doubles as free-list link */
+	uint32_t lru_prev;
+	uint32_t lru_next;
+	size_t bytes;
 
 /* special case, set this to true when we deal with non- scalable fonts with
  * embedded bitmaps where we scale to fit the set pt- size (or, with a
@@ -79,6 +98,36 @@ typedef struct cached_glyph {
 
 } c_glyph;
 
+/*
+ * Per-font glyph cache. Glyphs live in a slot array with stable indices so
+ * that the LRU links survive growth, and an open-addressed (linear probing)
+ * table of 1-based slot indices maps keys to slots. Rendered bitmaps are
+ * carved out of size-class pages rather than allocated one by one.
+ */
+struct glyph_cache {
+	c_glyph* slots;
+	uint32_t n_slots;
+	uint32_t used_slots;
+	uint32_t free_slot;
+
+	uint32_t* table;
+	size_t table_sz;
+	size_t table_used;
+
+	uint32_t lru_head;
+	uint32_t lru_tail;
+
+	size_t bytes;
+	size_t budget;
+
+	void* slab_free[SLAB_CLASSES];
+	void** pages;
+	size_t n_pages;
+	size_t pages_sz;
+
+	struct ttf_cache_stats stats;
+};
+
 /* The structure used to hold internal font information */
 struct _TTF_Font {
 	/* Freetype2 maintains all sorts of useful info itself */
@@ -108,7 +157,7 @@ struct _TTF_Font {
 
 	/* Cache for style-transformed glyphs */
 	c_glyph *current;
-	c_glyph cache[257]; /* 257 is a prime */
+	struct glyph_cache cache;
 
 	/* We are responsible for closing the font stream */
 	FILE* src;
@@ -118,6 +167,7 @@ struct _TTF_Font {
 	/* For non-scalable formats, we must remember which font index size */
 	int font_size_family;
 	int ptsize;
+	uint16_t hdpi, vdpi;
 
 	/* really just flags passed into FT_Load_Glyph */
 	int hinting;
@@ -282,6 +332,15 @@ void TTF_Resize(TTF_Font* font, int ptsize, uint16_t hdpi, uint16_t vdpi)
 {
 	float emsize = ptsize * 64.0;
 	FT_Set_Char_Size(font->face, 0, emsize, hdpi, vdpi);
+
+/* size is part of the glyph key, old entries will age out - density is not
+ * so a change there has to drop what is cached */
+	if (hdpi != font->hdpi || vdpi != font->vdpi)
+		TTF_Flush_Cache(font);
+
+	font->ptsize = ptsize;
+	font->hdpi = hdpi;
+	font->vdpi = vdpi;
 }
 
 TTF_Font* TTF_OpenFontIndexRW( FILE* src, int freesrc, int ptsize,
@@ -339,6 +398,8 @@ TTF_Font* TTF_OpenFontIndexRW( FILE* src, int freesrc, int ptsize,
 	font->args.flags = FT_OPEN_STREAM;
 	font->args.stream = stream;
 	font->ptsize = ptsize;
+	font->hdpi = hdpi;
+	font->vdpi = vdpi;
 
 	error = FT_Open_Face( library, &font->args, index, &font->face );
 	if( error ) {
@@ -497,32 +558,123 @@ TTF_Font* TTF_OpenFontFD(int fd,
 	return res;
 }
 
-static void Flush_Glyph( c_glyph* glyph )
+static int slab_class(size_t sz)
+{
+	int cl = 0;
+	while (cl < SLAB_CLASSES && (SLAB_MIN << cl) < sz)
+		cl++;
+	return cl;
+}
+
+static void* slab_alloc(struct glyph_cache* cache, size_t sz)
+{
+	int cl = slab_class(sz);
+	if (cl == SLAB_CLASSES)
+		return malloc(sz);
+
+/* carve a new page into chunks of this class */
+	if (!cache->slab_free[cl]){
+		if (cache->n_pages == cache->pages_sz){
+			size_t new_sz = cache->pages_sz ? cache->pages_sz * 2 : 8;
+			void** pages = realloc(cache->pages, new_sz * sizeof(void*));
+			if (!pages)
+				return NULL;
+			cache->pages = pages;
+			cache->pages_sz = new_sz;
+		}
+
+		uint8_t* page = malloc(SLAB_PAGE);
+		if (!page)
+			return NULL;
+		cache->pages[cache->n_pages++] = page;
+
+		size_t step = SLAB_MIN << cl;
+		for (size_t ofs = 0; ofs + step <= SLAB_PAGE; ofs += step){
+			*(void**)&page[ofs] = cache->slab_free[cl];
+			cache->slab_free[cl] = &page[ofs];
+		}
+	}
+
+	void* res = cache->slab_free[cl];
+	cache->slab_free[cl] = *(void**)res;
+	return res;
+}
+
+static void slab_release(struct glyph_cache* cache, void* buf, size_t sz)
+{
+	int cl = slab_class(sz);
+	if (cl == SLAB_CLASSES){
+		free(buf);
+		return;
+	}
+
+	*(void**)buf = cache->slab_free[cl];
+	cache->slab_free[cl] = buf;
+}
+
+static size_t bitmap_size(FT_Bitmap* bm)
+{
+	return (size_t) bm->pitch * bm->rows;
+}
+
+static void Flush_Glyph( struct glyph_cache* cache, c_glyph* glyph )
 {
 	glyph->stored = 0;
 	glyph->index = 0;
 	if( glyph->bitmap.buffer ) {
-		free( glyph->bitmap.buffer );
+		slab_release(cache, glyph->bitmap.buffer, bitmap_size(&glyph->bitmap));
 		glyph->bitmap.buffer = 0;
 	}
 	if( glyph->pixmap.buffer ) {
-		free( glyph->pixmap.buffer );
+		slab_release(cache, glyph->pixmap.buffer, bitmap_size(&glyph->pixmap));
 		glyph->pixmap.buffer = 0;
 	}
-	glyph->cached = 0;
+	glyph->key = 0;
 }
 
 void TTF_Flush_Cache( TTF_Font* font )
 {
-	int i;
-	int size = sizeof( font->cache ) / sizeof( font->cache[0] );
+	struct glyph_cache* cache = &font->cache;
+
+/* only the large bitmaps need to be released one by one, the rest goes with
+ * the pages */
+	for (size_t i = 0; i < cache->used_slots; i++){
+		c_glyph* glyph = &cache->slots[i];
+		if (glyph->bitmap.buffer &&
+			slab_class(bitmap_size(&glyph->bitmap)) == SLAB_CLASSES)
+			free(glyph->bitmap.buffer);
+		if (glyph->pixmap.buffer &&
+			slab_class(bitmap_size(&glyph->pixmap)) == SLAB_CLASSES)
+			free(glyph->pixmap.buffer);
+	}
 
-	for( i = 0; i < size; ++i ) {
-		if( font->cache[i].cached ) {
-			Flush_Glyph( &font->cache[i] );
-		}
+	for (size_t i = 0; i < cache->n_pages; i++)
+		free(cache->pages[i]);
 
-	}
+	cache->n_pages = 0;
+	memset(cache->slab_free, '\0', sizeof(cache->slab_free));
+
+	if (cache->table)
+		memset(cache->table, '\0', cache->table_sz * sizeof(uint32_t));
+
+	cache->table_used = 0;
+	cache->used_slots = 0;
+	cache->free_slot = 0;
+	cache->lru_head = cache->lru_tail = 0;
+	cache->bytes = 0;
+	font->current = NULL;
+}
+
+void TTF_SetCacheBudget(TTF_Font* font, size_t bytes)
+{
+	font->cache.budget = bytes;
+}
+
+void TTF_CacheStats(TTF_Font* font, struct ttf_cache_stats* out)
+{
+	*out = font->cache.stats;
+	out->glyphs = font->cache.table_used;
+	out->bytes = font->cache.bytes;
 }
 
 static FT_Error Load_Glyph(
@@ -546,8 +698,10 @@ static FT_Error Load_Glyph(
 			cached->index = ch;
 		else
 			cached->index = FT_Get_Char_Index( face, ch );
-		if (0 == cached->index)
+		if (0 == cached->index){
+			cached->stored |= CACHED_MISSING;
 			return -1;
+		}
 	}
 	error = FT_Load_Glyph( face, cached->index,
 		(FT_LOAD_DEFAULT | FT_LOAD_COLOR | FT_LOAD_TARGET_(font->hinting))
@@ -655,6 +809,7 @@ static FT_Error Load_Glyph(
 			dst = &cached->pixmap;
 		}
 		memcpy( dst, src, sizeof( *dst ) );
+		dst->buffer = NULL;
 
 /* FT_Render_Glyph() and .fon fonts always generate a two-color (black and
  * white) glyphslot surface, even when rendered in ft_render_mode_normal. */
@@ -692,10 +847,12 @@ static FT_Error Load_Glyph(
 		}
 
 		if (dst->rows != 0) {
-			dst->buffer = (unsigned char *)malloc( dst->pitch * dst->rows );
+			dst->buffer = slab_alloc(&font->cache, bitmap_size(dst));
 			if( !dst->buffer ) {
 				return FT_Err_Out_Of_Memory;
 			}
+			cached->bytes += bitmap_size(dst);
+			font->cache.bytes += bitmap_size(dst);
 			memset( dst->buffer, 0, dst->pitch * dst->rows );
 
 			for( i = 0; i < src->rows; i++ ) {
@@ -847,27 +1004,212 @@ static FT_Error Load_Glyph(
 		}
 	}
 
-	/* We're done, mark this glyph cached */
-	cached->cached = ch;
-
 	return 0;
 }
 
+#define GLYPH_SLOT(C, I) (&(C)->slots[(I) - 1])
+
+static uint64_t glyph_key(TTF_Font* font, uint32_t ch, bool by_ind)
+{
+	int style = font->style & ~TTF_STYLE_NO_GLYPH_CHANGE;
+	return (uint64_t) ch |
+		((uint64_t)(style & 0x7f) << 32) |
+		((uint64_t) by_ind << 39) |
+		((uint64_t)(font->ptsize & 0xffff) << 40) |
+		((uint64_t) 1 << 63);
+}
+
+static size_t glyph_hash(uint64_t key, size_t mask)
+{
+	key ^= key >> 29;
+	key *= 0xbf58476d1ce4e5b9ull;
+	key ^= key >> 32;
+	return key & mask;
+}
+
+static void lru_unlink(struct glyph_cache* cache, uint32_t ind)
+{
+	c_glyph* glyph = GLYPH_SLOT(cache, ind);
+
+	if (glyph->lru_prev)
+		GLYPH_SLOT(cache, glyph->lru_prev)->lru_next = glyph->lru_next;
+	else
+		cache->lru_head = glyph->lru_next;
+
+	if (glyph->lru_next)
+		GLYPH_SLOT(cache, glyph->lru_next)->lru_prev = glyph->lru_prev;
+	else
+		cache->lru_tail = glyph->lru_prev;
+
+	glyph->lru_prev = glyph->lru_next = 0;
+}
+
+static void lru_front(struct glyph_cache* cache, uint32_t ind)
+{
+	c_glyph* glyph = GLYPH_SLOT(cache, ind);
+	glyph->lru_prev = 0;
+	glyph->lru_next = cache->lru_head;
+
+	if (cache->lru_head)
+		GLYPH_SLOT(cache, cache->lru_head)->lru_prev = ind;
+	else
+		cache->lru_tail = ind;
+
+	cache->lru_head = ind;
+}
+
+/* returns the table position for [key], either holding it or empty */
+static size_t table_probe(struct glyph_cache* cache, uint64_t key)
+{
+	size_t mask = cache->table_sz - 1;
+	size_t pos = glyph_hash(key, mask);
+
+	while (cache->table[pos] &&
+		GLYPH_SLOT(cache, cache->table[pos])->key != key)
+		pos = (pos + 1) & mask;
+
+	return pos;
+}
+
+static bool table_grow(struct glyph_cache* cache)
+{
+	size_t new_sz = cache->table_sz ? cache->table_sz * 2 : 256;
+	uint32_t* new_table = calloc(new_sz, sizeof(uint32_t));
+	if (!new_table)
+		return false;
+
+	uint32_t* old = cache->table;
+	size_t old_sz = cache->table_sz;
+	cache->table = new_table;
+	cache->table_sz = new_sz;
+
+	for (size_t i = 0; i < old_sz; i++)
+		if (old[i])
+			cache->table[table_probe(cache, GLYPH_SLOT(cache, old[i])->key)] = old[i];
+
+	free(old);
+	return true;
+}
+
+/* backward-shift deletion so that probe chains stay intact without tombstones */
+static void table_remove(struct glyph_cache* cache, uint64_t key)
+{
+	size_t mask = cache->table_sz - 1;
+	size_t pos = table_probe(cache, key);
+	if (!cache->table[pos])
+		return;
+
+	size_t next = (pos + 1) & mask;
+	while (cache->table[next]){
+		size_t home = glyph_hash(GLYPH_SLOT(cache, cache->table[next])->key, mask);
+
+/* can the entry at next move back to pos without passing its home slot */
+		if (((next - home) & mask) >= ((next - pos) & mask)){
+			cache->table[pos] = cache->table[next];
+			pos = next;
+		}
+		next = (next + 1) & mask;
+	}
+
+	cache->table[pos] = 0;
+	cache->table_used--;
+}
+
+static void cache_evict(struct glyph_cache* cache, uint32_t ind)
+{
+	c_glyph* glyph = GLYPH_SLOT(cache, ind);
+
+	table_remove(cache, glyph->key);
+	lru_unlink(cache, ind);
+
+	cache->bytes -= glyph->bytes;
+	Flush_Glyph(cache, glyph);
+
+	glyph->lru_next = cache->free_slot;
+	cache->free_slot = ind;
+	cache->stats.evictions++;
+}
+
+/* new, empty, most recently used entry for [key] or 0 if out of memory */
+static uint32_t cache_insert(struct glyph_cache* cache, uint64_t key)
+{
+	if ((cache->table_used + 1) * 2 > cache->table_sz && !table_grow(cache))
+		return 0;
+
+	uint32_t ind = cache->free_slot;
+	if (ind){
+		cache->free_slot = GLYPH_SLOT(cache, ind)->lru_next;
+	}
+	else {
+		if (cache->used_slots == cache->n_slots){
+			uint32_t new_sz = cache->n_slots ? cache->n_slots * 2 : 128;
+			c_glyph* slots = realloc(cache->slots, new_sz * sizeof(c_glyph));
+			if (!slots)
+				return 0;
+			cache->slots = slots;
+			cache->n_slots = new_sz;
+		}
+		ind = ++cache->used_slots;
+	}
+
+	c_glyph* glyph = GLYPH_SLOT(cache, ind);
+	memset(glyph, '\0', sizeof(c_glyph));
+	glyph->key = key;
+	glyph->bytes = sizeof(c_glyph);
+	cache->bytes += glyph->bytes;
+
+	cache->table[table_probe(cache, key)] = ind;
+	cache->table_used++;
+	lru_front(cache, ind);
+
+	return ind;
+}
+
+/*
+ * Glyphs are cached per font on (codepoint or index, style, size) so that
+ * style switches and fallback chains don't thrash. When the cache grows past
+ * its byte budget the least recently used glyphs are dropped, except for the
+ * one just looked up as callers keep using font->current.
+ */
 static FT_Error Find_Glyph(
 	TTF_Font* font, uint32_t ch, int want, bool by_ind)
 {
-	int retval = 0;
-	int hsize = sizeof( font->cache ) / sizeof( font->cache[0] );
+	struct glyph_cache* cache = &font->cache;
+	uint64_t key = glyph_key(font, ch, by_ind);
+	uint32_t ind = 0;
+
+	if (cache->table_sz)
+		ind = cache->table[table_probe(cache, key)];
 
-	int h = ch % hsize;
-	font->current = &font->cache[h];
+	if (ind){
+		if (ind != cache->lru_head){
+			lru_unlink(cache, ind);
+			lru_front(cache, ind);
+		}
+	}
+	else if (!(ind = cache_insert(cache, key)))
+		return FT_Err_Out_Of_Memory;
 
-	if (font->current->cached != ch)
-		Flush_Glyph( font->current );
+	font->current = GLYPH_SLOT(cache, ind);
+
+/* known to not be in this font, the chain will move on to the next */
+	if (font->current->stored & CACHED_MISSING){
+		cache->stats.hits++;
+		return -1;
+	}
 
-	if ( (font->current->stored & want) != want ) {
-		retval = Load_Glyph( font, ch, font->current, want, by_ind );
+	if ( (font->current->stored & want) == want ){
+		cache->stats.hits++;
+		return 0;
 	}
+
+	cache->stats.misses++;
+	int retval = Load_Glyph( font, ch, font->current, want, by_ind );
+
+	size_t budget = cache->budget ? cache->budget : TTF_GLYPH_BUDGET;
+	while (cache->bytes > budget && cache->lru_tail && cache->lru_tail != ind)
+		cache_evict(cache, cache->lru_tail);
+
 	return retval;
 }
 
@@ -888,6 +1230,9 @@ void TTF_CloseFont( TTF_Font* font )
 {
 	if ( font ) {
 		TTF_Flush_Cache( font );
+		free( font->cache.slots );
+		free( font->cache.table );
+		free( font->cache.pages );
 		if ( font->face ) {
 			FT_Done_Face( font->face );
 		}
@@ -1066,15 +1411,9 @@ int TTF_GlyphMetrics(TTF_Font *font, uint32_t ch,
 
 void TTF_SetFontStyle( TTF_Font* font, int style )
 {
-	int prev_style = font->style;
+	/* No flush needed, the glyph-affecting style bits are part of the cache
+	 * key and glyphs for the previous style simply age out. */
 	font->style = style | font->face_style;
-
-	/* Flush the cache if the style has changed.
-	* Ignore UNDERLINE which does not impact glyph drawning.
-	* */
-	if ( (font->style | TTF_STYLE_NO_GLYPH_CHANGE ) != ( prev_style | TTF_STYLE_NO_GLYPH_CHANGE )) {
-		TTF_Flush_Cache( font );
-	}
 }
 
 _Thread_local static size_t pool_cnt;
@@ -196,6 +196,25 @@ bool TTF_RenderUNICODEglyph(PIXEL* dst,
 
 void TTF_Flush_Cache( TTF_Font* font );
 
+/*
+ * Glyph cache counters for a font, hits and misses are per glyph lookup,
+ * [bytes] covers cached bitmaps and per-glyph bookkeeping.
+ */
+struct ttf_cache_stats {
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+	size_t glyphs;
+	size_t bytes;
+};
+void TTF_CacheStats(TTF_Font* font, struct ttf_cache_stats* out);
+
+/*
+ * Set the byte budget for the glyph cache of [font], least recently used
+ * glyphs are dropped beyond this point. 0 restores the default.
+ */
+void TTF_SetCacheBudget(TTF_Font* font, size_t bytes);
+
 /*
  * Same as TTF_RenderUNICODEglyph above, but 'ch' references the glyph index in
  * the font-chain, not the unicode codepoint.  This is only for special/trusted
@@ -119,6 +119,14 @@ unsigned vcontext_ind = 0;
  */
 static bool detach_fromtarget(struct rendertarget* dst, arcan_vobject* src);
 static void attach_object(struct rendertarget* dst, arcan_vobject* src);
+static void pick_queue(arcan_vobject_litem* item);
+static void pick_attach(struct rendertarget* dst, arcan_vobject_litem* item);
+static void pick_forget(arcan_vobject_litem* item);
+static void pick_free(struct pick_index* ind);
+static void anim_sync(arcan_vobject* vobj);
+static void anim_relocate(arcan_vobject* vobj);
+static void anim_forget(arcan_vobject* vobj);
+static void resolve_threads(size_t n);
 static arcan_errc update_zv(arcan_vobject* vobj, int newzv);
 static void rebase_transform(struct surface_transform*, int64_t);
 static size_t process_rendertarget(struct rendertarget*, float);
@@ -127,6 +135,7 @@ struct arcan_video_context* dctx);
 static inline void build_modelview(float* dmatr,
 	float* imatr, surface_properties* prop, arcan_vobject* src);
 static inline void process_readback(struct rendertarget* tgt, float fract);
+static void imgcache_forget(struct agp_vstore* store);
 
 static inline void trace(const char* msg, ...)
 {
@@ -152,6 +161,8 @@ void arcan_vint_drop_vstore(struct agp_vstore* s)
 	s->refcount--;
 
 	if (s->refcount == 0){
+		imgcache_forget(s);
+
 		if (s->txmapped != TXSTATE_OFF && s->vinf.text.glid){
 			if (s->vinf.text.raw){
 				arcan_mem_free(s->vinf.text.raw);
@@ -245,14 +256,17 @@ static void addchild(arcan_vobject* parent, arcan_vobject* child)
 
 /*
  * recursively sweep children and
- * flag their caches for updates as well
+ * flag their caches for updates as well. An already invalid cache doesn't
+ * mean that the children have been queued for a new pick cell (the cache is
+ * revalidated at draw time, and shallow clipping clears it every frame) so
+ * the whole subtree is always walked.
  */
 static void invalidate_cache(arcan_vobject* vobj)
 {
 	FLAG_DIRTY(vobj);
 
-	if (!vobj->valid_cache)
-		return;
+	if (vobj->owner_litem)
+		pick_queue(vobj->owner_litem);
 
 	vobj->valid_cache = false;
 
@@ -261,6 +275,11 @@ static void invalidate_cache(arcan_vobject* vobj)
 			invalidate_cache(vobj->children[i]);
 }
 
+void arcan_vint_invalidate(arcan_vobject* vobj)
+{
+	invalidate_cache(vobj);
+}
+
 static void dropchild(arcan_vobject* parent, arcan_vobject* child)
 {
 	for (size_t i = 0; i < parent->childslots; i++){
@@ -286,8 +305,7 @@ static void deallocate_gl_context(
 
 /* before doing any modification, wait for any async load calls to finish(!),
  * question is IF this should invalidate or not */
-			if (current->feed.state.tag == ARCAN_TAG_ASYNCIMGLD ||
-				current->feed.state.tag == ARCAN_TAG_ASYNCIMGRD)
+			if (current->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
 				arcan_video_pushasynch(i);
 
 /* for persistant objects, deleteobject will only be "effective" if we're at
@@ -356,6 +374,7 @@ static void reallocate_gl_context(struct arcan_video_context* context)
  * has already occurred */
 			if (ctrans && cticks > context->last_tickstamp){
 				rebase_transform(ctrans, cticks - context->last_tickstamp);
+				anim_sync(current);
 			}
 
 /* for conservative memory management mode we need to reallocate
@@ -363,8 +382,12 @@ static void reallocate_gl_context(struct arcan_video_context* context)
  * copy and free */
 			if (arcan_video_display.conservative &&
 				(char)current->feed.state.tag == ARCAN_TAG_IMAGE){
-					char* fname = strdup( current->vstore->vinf.text.source );
-					arcan_mem_free(current->vstore->vinf.text.source);
+/* store can be shared through the image cache, only rebuild it once */
+				if (current->vstore->vinf.text.glid)
+					continue;
+
+				char* fname = strdup( current->vstore->vinf.text.source );
+				arcan_mem_free(current->vstore->vinf.text.source);
 				arcan_vint_getimage(fname,
 					current, (img_cons){.w = current->origw, .h = current->origh}, false);
 				arcan_mem_free(fname);
@@ -421,6 +444,7 @@ static void push_transfer_persists(
 
 		detach_fromtarget(srcobj->owner, srcobj);
 		memcpy(dstobj, srcobj, sizeof(arcan_vobject));
+		anim_relocate(dstobj);
 		dst->nalive++; /* fake allocate */
 		dstobj->parent = &dst->world; /* don't cross- reference worlds */
 		attach_object(&dst->stdoutp, dstobj);
@@ -450,6 +474,7 @@ static void pop_transfer_persists(
 		src->nalive--;
 
 		memcpy(dstobj, srcobj, sizeof(arcan_vobject));
+		anim_relocate(dstobj);
 		attach_object(&dst->stdoutp, dstobj);
 		dstobj->parent = parent;
 		memset(srcobj, '\0', sizeof(arcan_vobject));
@@ -628,6 +653,12 @@ signed arcan_video_pushcontext()
 
 	current_context = &vcontext_stack[ vcontext_ind ];
 	current_context->stdoutp.first = NULL;
+	memset(current_context->stdoutp.skip, '\0', sizeof(current_context->stdoutp.skip));
+
+/* the spatial indices belong to the previous layer */
+	current_context->stdoutp.pick = NULL;
+	for (size_t i = 0; i < RENDERTARGET_LIMIT; i++)
+		current_context->rtargets[i].pick = NULL;
 	current_context->vitem_ofs = 1;
 	current_context->nalive = 0;
 
@@ -644,6 +675,7 @@ signed arcan_video_pushcontext()
 	);
 
 	current_context->rtargets[0].first = NULL;
+	memset(current_context->rtargets[0].skip, '\0', sizeof(current_context->rtargets[0].skip));
 
 /* propagate persistent flagged objects upwards */
 	push_transfer_persists(
@@ -893,6 +925,9 @@ unsigned arcan_video_popcontext()
 			current_context, &vcontext_stack[vcontext_ind-1]);
 
 	deallocate_gl_context(current_context, true, current_context->world.vstore);
+	anim_forget(&current_context->world);
+	pick_free(current_context->stdoutp.pick);
+	current_context->stdoutp.pick = NULL;
 
 	if (vcontext_ind > 0){
 		vcontext_ind--;
@@ -991,7 +1026,9 @@ arcan_errc arcan_video_resampleobject(arcan_vobj_id vid,
 			return ARCAN_ERRC_OUT_OF_SPACE;
 		}
 
-/* and now swap and the rest of the function should behave as normal */
+/* the contents of did will be replaced, so it can no longer be handed out
+ * by the image cache, and now swap and the rest should behave as normal */
+		imgcache_forget(dvobj->vstore);
 		if (dvobj->vstore->w != neww || dvobj->vstore->h != newh){
 			agp_resize_vstore(dvobj->vstore, neww, newh);
 		}
@@ -1078,6 +1115,7 @@ arcan_errc arcan_video_mipmapset(arcan_vobj_id vid, bool enable)
 	if (!newbuf)
 		return ARCAN_ERRC_OUT_OF_SPACE;
 
+	imgcache_forget(vobj->vstore);
 	arcan_vint_drop_vstore(vobj->vstore);
 	if (enable)
 		vobj->vstore->filtermode |= ARCAN_VFILTER_MIPMAP;
@@ -1219,6 +1257,149 @@ arcan_vobject* arcan_video_getobject(arcan_vobj_id id)
 	return rc;
 }
 
+/*
+ * Pipeline entries are carved out of larger blocks and recycled through a
+ * free-list rather than allocated one by one, this keeps the entries of a
+ * rendertarget close together in memory as the list is walked several times
+ * per frame (tick, occlusion, draw, picking).
+ */
+#ifndef LITEM_BLOCK
+#define LITEM_BLOCK 1024
+#endif
+
+static arcan_vobject_litem* litem_pool;
+
+static arcan_vobject_litem* litem_alloc()
+{
+	if (!litem_pool){
+		arcan_vobject_litem* block = arcan_alloc_mem(
+			sizeof(arcan_vobject_litem) * LITEM_BLOCK,
+			ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL
+		);
+
+/* chain in reverse so that consecutive allocations are adjacent */
+		for (size_t i = LITEM_BLOCK; i > 0; i--){
+			block[i-1].next = litem_pool;
+			litem_pool = &block[i-1];
+		}
+	}
+
+	arcan_vobject_litem* res = litem_pool;
+	litem_pool = res->next;
+	memset(res, '\0', sizeof(arcan_vobject_litem));
+
+	return res;
+}
+
+static void litem_free(arcan_vobject_litem* litem)
+{
+	litem->next = litem_pool;
+	litem_pool = litem;
+}
+
+/*
+ * The pipeline is a doubly linked list sorted on (order, seq) so that it can
+ * be walked front to back, with a skip list layered on top. Each entry gets
+ * a random height and entry->skip[i] links to the next entry at level i+1,
+ * with the heads in dst->skip. Insert and unlink are O(log n) instead of a
+ * scan from the start of the list.
+ */
+static inline bool litem_before(
+	arcan_vobject_litem* a, arcan_vobject_litem* b)
+{
+	return a->order < b->order || (a->order == b->order && a->seq < b->seq);
+}
+
+static size_t litem_height()
+{
+	static uint32_t state = 0x9e3779b9;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+/* p = 1/4 per level */
+	size_t h = 1;
+	uint32_t v = state;
+	while (h <= LITEM_SKIP && (v & 3) == 0){
+		h++;
+		v >>= 2;
+	}
+
+	return h;
+}
+
+/* fill [pred] with the last entry before [item] on each level, NULL = head */
+static arcan_vobject_litem* litem_search(struct rendertarget* dst,
+	arcan_vobject_litem* item, arcan_vobject_litem** pred)
+{
+	arcan_vobject_litem* cur = NULL;
+
+	for (size_t i = LITEM_SKIP; i > 0; i--){
+		arcan_vobject_litem* next = cur ? cur->skip[i-1] : dst->skip[i-1];
+		while (next && litem_before(next, item)){
+			cur = next;
+			next = cur->skip[i-1];
+		}
+		pred[i-1] = cur;
+	}
+
+	arcan_vobject_litem* next = cur ? cur->next : dst->first;
+	while (next && litem_before(next, item)){
+		cur = next;
+		next = cur->next;
+	}
+
+	return cur;
+}
+
+static void litem_link(struct rendertarget* dst, arcan_vobject_litem* item)
+{
+	arcan_vobject_litem* pred[LITEM_SKIP];
+	arcan_vobject_litem* prev = litem_search(dst, item, pred);
+
+	item->previous = prev;
+	if (prev){
+		item->next = prev->next;
+		prev->next = item;
+	}
+	else {
+		item->next = dst->first;
+		dst->first = item;
+	}
+
+	if (item->next)
+		item->next->previous = item;
+
+	item->height = litem_height();
+	for (size_t i = 0; i + 1 < item->height; i++){
+		arcan_vobject_litem** link = pred[i] ? &pred[i]->skip[i] : &dst->skip[i];
+		item->skip[i] = *link;
+		*link = item;
+	}
+}
+
+static void litem_unlink(struct rendertarget* dst, arcan_vobject_litem* item)
+{
+	if (item->height > 1){
+		arcan_vobject_litem* pred[LITEM_SKIP];
+		litem_search(dst, item, pred);
+
+		for (size_t i = 0; i + 1 < item->height; i++){
+			arcan_vobject_litem** link = pred[i] ? &pred[i]->skip[i] : &dst->skip[i];
+			if (*link == item)
+				*link = item->skip[i];
+		}
+	}
+
+	if (item->previous)
+		item->previous->next = item->next;
+	else
+		dst->first = item->next;
+
+	if (item->next)
+		item->next->previous = item->previous;
+}
+
 static bool detach_fromtarget(struct rendertarget* dst, arcan_vobject* src)
 {
 	arcan_vobject_litem* torem;
@@ -1244,42 +1425,31 @@ static bool detach_fromtarget(struct rendertarget* dst, arcan_vobject* src)
 	if (dst->camtag == src->cellid)
 		dst->camtag = ARCAN_EID;
 
-/* find it */
-	torem = dst->first;
-	while(torem){
-		if (torem->elem == src)
-			break;
+/* find it, the primary attachment is known, others need a scan */
+	if (src->owner == dst && src->owner_litem)
+		torem = src->owner_litem;
+	else {
+		torem = dst->first;
+		while(torem){
+			if (torem->elem == src)
+				break;
 
-		torem = torem->next;
+			torem = torem->next;
+		}
 	}
 	if (!torem)
 		return false;
 
-/* (1.) remove first */
-	if (dst->first == torem){
-		dst->first = torem->next;
-
-/* only one element? */
-		if (dst->first){
-			dst->first->previous = NULL;
-		}
-	}
-/* (2.) remove last */
-	else if (torem->next == NULL){
-		assert(torem->previous);
-		torem->previous->next = NULL;
-	}
-/* (3.) remove arbitrary */
-	else {
-		torem->next->previous = torem->previous;
-		torem->previous->next = torem->next;
-	}
+	litem_unlink(dst, torem);
 
 /* (4.) mark as something easy to find in dumps */
+	pick_forget(torem);
+	if (src->owner_litem == torem)
+		src->owner_litem = NULL;
 	torem->elem = (arcan_vobject*) 0xfeedface;
 
 /* cleanup torem */
-	arcan_mem_free(torem);
+	litem_free(torem);
 
 	if (src->owner == dst)
 		src->owner = NULL;
@@ -1343,52 +1513,24 @@ static void attach_object(struct rendertarget* dst, arcan_vobject* src)
 	if (dst->link)
 		return attach_object(dst->link, src);
 
-	arcan_vobject_litem* new_litem =
-		arcan_alloc_mem(sizeof *new_litem,
-			ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL);
-
-	new_litem->next = new_litem->previous = NULL;
+	static uint64_t litem_seq;
+	arcan_vobject_litem* new_litem = litem_alloc();
 	new_litem->elem = src;
+	new_litem->seq = ++litem_seq;
+	new_litem->order = src->order;
 
 /* (pre) if orphaned, assign */
 	if (src->owner == NULL){
 		src->owner = dst;
 	}
 
-/* 2. insert first into empty? */
-	if (!dst->first)
-		dst->first = new_litem;
-	else
-/* 3. insert first with n >= 1 */
-	if (dst->first->elem->order > src->order){
-		new_litem->next = dst->first;
-		dst->first = new_litem;
-		new_litem->next->previous = new_litem;
-	}
-/* 4. insert last or arbitrary */
-	else {
-		bool last;
-		arcan_vobject_litem* ipoint = dst->first;
-
-/* 5. scan for insertion point */
-		do
-			last = (ipoint->elem->order <= src->order);
-		while (last && ipoint->next && (ipoint = ipoint->next));
-
-/* 6. insert last? */
-		if (last){
-			new_litem->previous = ipoint;
-			ipoint->next = new_litem;
-		}
+	if (src->owner == dst)
+		src->owner_litem = new_litem;
 
-		else {
-/* 7. insert arbitrary */
-			ipoint->previous->next = new_litem;
-			new_litem->previous = ipoint->previous;
-			ipoint->previous = new_litem;
-			new_litem->next = ipoint;
-		}
-	}
+/* sorted on order, and after any existing items with the same order */
+	litem_link(dst, new_litem);
+
+	pick_attach(dst, new_litem);
 
 	FLAG_DIRTY(src);
 	if (dst->color){
@@ -1459,6 +1601,201 @@ static void swipe_chain(surface_transform* base, unsigned ofs, unsigned size)
 	}
 }
 
+/*
+ * Animation tracks: the chain in vobj->transform is the queue of pending
+ * transformations, the head of each property is mirrored into one track per
+ * property stored as a structure of arrays. A tick steps every animated
+ * object in one pass per track rather than walking each object, its parents
+ * and its chain, and completions are collected and handled after the pass
+ * (tags, cycling and compacting work as before).
+ *
+ * Anything that changes the head of a chain needs to call anim_sync.
+ */
+enum anim_prop {
+	ANIM_BLEND = 0,
+	ANIM_MOVE,
+	ANIM_SCALE,
+	ANIM_ROTATE,
+	ANIM_PROPS
+};
+
+struct anim_track {
+	size_t count, limit;
+	arcan_vobject** obj;
+	float* startt;
+	float* endt;
+	float* fract;
+	uint8_t* interp;
+	float* sv[3];
+	float* ev[3];
+	float* val[3];
+};
+
+static struct {
+	struct anim_track tracks[ANIM_PROPS];
+
+	struct anim_done {
+		arcan_vobject* obj;
+		enum anim_prop prop;
+	}* done;
+	size_t n_done, done_limit;
+} anim;
+
+/* number of value components stepped in the track for each property,
+ * rotation is left to the quaternion interpolation of the chain head */
+static const size_t anim_components[ANIM_PROPS] = {1, 3, 3, 0};
+
+#ifndef TRANSFORM_BLOCK
+#define TRANSFORM_BLOCK 256
+#endif
+
+static surface_transform* transform_pool;
+
+static surface_transform* transform_alloc()
+{
+	if (!transform_pool){
+		surface_transform* block = arcan_alloc_mem(
+			sizeof(surface_transform) * TRANSFORM_BLOCK,
+			ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL
+		);
+
+		for (size_t i = 0; i < TRANSFORM_BLOCK; i++){
+			block[i].next = transform_pool;
+			transform_pool = &block[i];
+		}
+	}
+
+	surface_transform* res = transform_pool;
+	transform_pool = res->next;
+	memset(res, '\0', sizeof(surface_transform));
+
+	return res;
+}
+
+static void transform_free(surface_transform* tf)
+{
+	tf->next = transform_pool;
+	transform_pool = tf;
+}
+
+static void* anim_resize(void* arr, size_t sz, size_t count, size_t limit)
+{
+	void* res = arcan_alloc_mem(
+		sz * limit, ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_SIMD);
+
+	if (arr){
+		memcpy(res, arr, sz * count);
+		arcan_mem_free(arr);
+	}
+
+	return res;
+}
+
+static size_t anim_slot(enum anim_prop prop, arcan_vobject* vobj)
+{
+	struct anim_track* t = &anim.tracks[prop];
+	if (vobj->anim[prop])
+		return vobj->anim[prop] - 1;
+
+	if (t->count == t->limit){
+		size_t limit = t->limit ? t->limit * 2 : 64;
+		t->obj = anim_resize(t->obj, sizeof(arcan_vobject*), t->count, limit);
+		t->startt = anim_resize(t->startt, sizeof(float), t->count, limit);
+		t->endt = anim_resize(t->endt, sizeof(float), t->count, limit);
+		t->fract = anim_resize(t->fract, sizeof(float), t->count, limit);
+		t->interp = anim_resize(t->interp, sizeof(uint8_t), t->count, limit);
+
+		for (size_t i = 0; i < anim_components[prop]; i++){
+			t->sv[i] = anim_resize(t->sv[i], sizeof(float), t->count, limit);
+			t->ev[i] = anim_resize(t->ev[i], sizeof(float), t->count, limit);
+			t->val[i] = anim_resize(t->val[i], sizeof(float), t->count, limit);
+		}
+
+		t->limit = limit;
+	}
+
+	t->obj[t->count] = vobj;
+	vobj->anim[prop] = ++t->count;
+
+	return t->count - 1;
+}
+
+static void anim_drop(enum anim_prop prop, arcan_vobject* vobj)
+{
+	struct anim_track* t = &anim.tracks[prop];
+	if (!vobj->anim[prop])
+		return;
+
+	size_t i = vobj->anim[prop] - 1;
+	size_t last = --t->count;
+	vobj->anim[prop] = 0;
+
+	if (i == last)
+		return;
+
+	t->obj[i] = t->obj[last];
+	t->startt[i] = t->startt[last];
+	t->endt[i] = t->endt[last];
+	t->interp[i] = t->interp[last];
+	for (size_t j = 0; j < anim_components[prop]; j++){
+		t->sv[j][i] = t->sv[j][last];
+		t->ev[j][i] = t->ev[j][last];
+	}
+
+	t->obj[i]->anim[prop] = i + 1;
+}
+
+static void anim_set(enum anim_prop prop, arcan_vobject* vobj,
+	arcan_tickv startt, arcan_tickv endt, uint8_t interp,
+	const float* sv, const float* ev)
+{
+	if (!startt)
+		return anim_drop(prop, vobj);
+
+	struct anim_track* t = &anim.tracks[prop];
+	size_t i = anim_slot(prop, vobj);
+
+	t->startt[i] = startt;
+	t->endt[i] = endt;
+	t->interp[i] = interp;
+	for (size_t j = 0; j < anim_components[prop]; j++){
+		t->sv[j][i] = sv[j];
+		t->ev[j][i] = ev[j];
+	}
+}
+
+static void anim_sync(arcan_vobject* vobj)
+{
+	static const surface_transform empty;
+	const surface_transform* tf = vobj->transform ? vobj->transform : &empty;
+
+	anim_set(ANIM_BLEND, vobj, tf->blend.startt, tf->blend.endt,
+		tf->blend.interp, &tf->blend.startopa, &tf->blend.endopa);
+
+	anim_set(ANIM_MOVE, vobj, tf->move.startt, tf->move.endt,
+		tf->move.interp, tf->move.startp.xyz, tf->move.endp.xyz);
+
+	anim_set(ANIM_SCALE, vobj, tf->scale.startt, tf->scale.endt,
+		tf->scale.interp, tf->scale.startd.xyz, tf->scale.endd.xyz);
+
+	anim_set(ANIM_ROTATE, vobj,
+		tf->rotate.startt, tf->rotate.endt, 0, NULL, NULL);
+}
+
+static void anim_forget(arcan_vobject* vobj)
+{
+	for (size_t i = 0; i < ANIM_PROPS; i++)
+		anim_drop(i, vobj);
+}
+
+/* the object has been copied to a new slot (context persistence) */
+static void anim_relocate(arcan_vobject* vobj)
+{
+	for (size_t i = 0; i < ANIM_PROPS; i++)
+		if (vobj->anim[i])
+			anim.tracks[i].obj[vobj->anim[i] - 1] = vobj;
+}
+
 /* copy a transform and at the same time, compact it into
  * a better sized buffer */
 static surface_transform* dup_chain(surface_transform* base)
@@ -1466,9 +1803,7 @@ static surface_transform* dup_chain(surface_transform* base)
 	if (!base)
 		return NULL;
 
-	surface_transform* res = arcan_alloc_mem( sizeof(surface_transform),
-		ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL);
-
+	surface_transform* res = transform_alloc();
 	surface_transform* current = res;
 
 	while (base)
@@ -1476,8 +1811,7 @@ static surface_transform* dup_chain(surface_transform* base)
 		memcpy(current, base, sizeof(surface_transform));
 
 		if (base->next)
-			current->next = arcan_alloc_mem( sizeof(surface_transform),
-			ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL);
+			current->next = transform_alloc();
 		else
 			current->next = NULL;
 
@@ -1531,6 +1865,7 @@ arcan_errc arcan_video_transformmask(arcan_vobj_id id,
 
 	if (vobj && id > FL_INUSE){
 		vobj->mask = mask;
+		invalidate_cache(vobj);
 		rv = ARCAN_OK;
 	}
 
@@ -1566,9 +1901,11 @@ arcan_errc arcan_video_linkobjs(arcan_vobj_id srcid,
 	src->mask = mask;
 	src->p_scale = scalem;
 
-/* already linked to dst? do nothing */
-		if (src->parent == dst)
+/* already linked to dst? only the mask and anchoring changed */
+		if (src->parent == dst){
+			invalidate_cache(src);
 			return ARCAN_OK;
+		}
 
 /* otherwise, first decrement parent counter */
 		else if (src->parent != &current_context->world)
@@ -1595,8 +1932,10 @@ arcan_errc arcan_video_linkobjs(arcan_vobj_id srcid,
 		sizeof(struct transf_scale ));
 	swipe_chain(src->transform, offsetof(surface_transform, rotate),
 		sizeof(struct transf_rotate));
+	anim_sync(src);
 
-	FLAG_DIRTY(NULL);
+/* resolved properties now come from a different chain */
+	invalidate_cache(src);
 
 	return ARCAN_OK;
 }
@@ -1626,6 +1965,39 @@ arcan_errc arcan_video_init(uint16_t width, uint16_t height, uint8_t bpp,
 		if (get_config("video_ignore_dirty", 0, NULL, tag)){
 			arcan_video_display.ignore_dirty = SIZE_MAX >> 1;
 		}
+
+/* same goes for merging similar draw calls into batches */
+		if (get_config("video_nobatch", 0, NULL, tag)){
+			arcan_video_display.no_batch = true;
+		}
+
+/* using the spatial index for picking rather than testing every object */
+		if (get_config("video_nopickindex", 0, NULL, tag)){
+			arcan_video_display.no_pickindex = true;
+		}
+
+/* and skipping objects that are fully covered by opaque ones */
+		if (get_config("video_noocclusion", 0, NULL, tag)){
+			arcan_video_display.no_occlusion = true;
+		}
+
+/* and 3D models that fall outside of the camera view frustum */
+		if (get_config("video_no3dcull", 0, NULL, tag)){
+			arcan_video_display.no_3dcull = true;
+		}
+
+/* number of extra threads for resolving large pipelines, 0 disables */
+		char* val;
+		if (get_config("video_resolve_threads", 0, &val, tag)){
+			resolve_threads(strtoul(val, NULL, 10));
+			free(val);
+		}
+
+/* budget (KiB) for rendered format strings, 0 disables */
+		if (get_config("video_textcache", 0, &val, tag)){
+			arcan_renderfun_textcache(strtoul(val, NULL, 10) * 1024);
+			free(val);
+		}
 	}
 
 	if (!platform_video_init(width, height, bpp, fs, frames, caption)){
@@ -1715,80 +2087,373 @@ static uint16_t nexthigher(uint16_t k)
 	return k+1;
 }
 
-arcan_errc arcan_vint_getimage(const char* fname, arcan_vobject* dst,
-	img_cons forced, bool asynchsrc)
-{
 /*
- * with asynchsynch, it's likely that we get a storm of requests and we'd
- * likely suffer thrashing, so limit this.  also, look into using
- * pthread_setschedparam and switch to pthreads exclusively
+ * Decoded image cache, two parts:
+ *
+ * 1. Loaded stores are tracked (weak, not referenced) by their source path,
+ *    modification time, size and the decode parameters, so that loading the
+ *    same asset into another vobject just shares the store as with
+ *    shareglstore. Entries are dropped when the store dies, or when it gets
+ *    modified in a way that makes it unfit for new sharers (rendertarget,
+ *    filter changes).
+ *
+ * 2. In conservative mode the CPU copy is released after upload, and a
+ *    context pop would need to go back to disk and decode everything again.
+ *    A byte-budgeted LRU of decoded pixels is kept so that getimage can
+ *    rebuild from memory instead. As getimage can run in the asynch decode
+ *    workers, this part is protected by a mutex.
  */
-	arcan_sem_wait(asynchsynch);
+#ifndef IMGCACHE_BUCKETS
+#define IMGCACHE_BUCKETS 64
+#endif
 
-	size_t inw, inh;
+#ifndef IMGCACHE_PIXEL_BUDGET
+#define IMGCACHE_PIXEL_BUDGET (64 * 1024 * 1024)
+#endif
 
-/* try- open */
-	data_source inres = arcan_open_resource(fname);
-	if (inres.fd == BADFD){
-		arcan_sem_post(asynchsynch);
-		return ARCAN_ERRC_BAD_RESOURCE;
-	}
+struct imgcache_key {
+	uint32_t hash;
+	const char* path;
+	time_t mtime;
+	off_t size;
+	size_t cw, ch;
+	uint8_t imageproc, scale, filtermode;
+};
 
-/* mmap (preferred) or buffer (mmap not working / useful due to alignment) */
-	map_region inmem = arcan_map_resource(&inres, false);
-	if (inmem.ptr == NULL){
-		arcan_sem_post(asynchsynch);
-		arcan_release_resource(&inres);
-		return ARCAN_ERRC_BAD_RESOURCE;
-	}
+struct imgcache_ent {
+	struct imgcache_key key;
+	struct agp_vstore* store;
+	size_t origw, origh;
+	struct imgcache_ent* next;
+};
 
-	struct arcan_img_meta meta = {0};
-	uint32_t* ch_imgbuf = NULL;
+struct imgcache_pixels {
+	struct imgcache_key key;
+	av_pixel* buf;
+	size_t buf_sz;
+	size_t w, h, origw, origh;
+	struct imgcache_pixels* prev;
+	struct imgcache_pixels* next;
+};
 
-	arcan_errc rv = arcan_img_decode(fname, inmem.ptr, inmem.sz,
-		&ch_imgbuf, &inw, &inh, &meta, dst->vstore->imageproc == IMAGEPROC_FLIPH);
+static struct {
+	struct imgcache_ent* buckets[IMGCACHE_BUCKETS];
 
-	arcan_release_map(inmem);
-	arcan_release_resource(&inres);
+	pthread_mutex_t lock;
+	struct imgcache_pixels* mru;
+	struct imgcache_pixels* lru;
+	size_t pixel_bytes;
+} imgcache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER
+};
 
-	if (ARCAN_OK != rv)
-		goto done;
+static uint32_t imgcache_hash(const char* path)
+{
+	uint32_t hash = 5381;
+	for (; *path; path++)
+		hash = ((hash << 5) + hash) + (uint8_t)*path;
+	return hash;
+}
 
-	av_pixel* imgbuf = arcan_img_repack(ch_imgbuf, inw, inh);
-	if (!imgbuf){
-		rv = ARCAN_ERRC_OUT_OF_SPACE;
-		goto done;
-	}
+static bool imgcache_mkkey(const char* path,
+	struct agp_vstore* vs, img_cons cons, struct imgcache_key* key)
+{
+	struct stat fs;
+	if (!path || -1 == stat(path, &fs) || !S_ISREG(fs.st_mode))
+		return false;
 
-	uint16_t neww, newh;
+	*key = (struct imgcache_key){
+		.hash = imgcache_hash(path),
+		.path = path,
+		.mtime = fs.st_mtime,
+		.size = fs.st_size,
+		.cw = cons.w,
+		.ch = cons.h,
+		.imageproc = vs->imageproc,
+		.scale = vs->scale,
+		.filtermode = vs->filtermode
+	};
 
-/* store this so we can maintain aspect ratios etc. while still
- * possibly aligning to next power of two */
-	dst->origw = inw;
-	dst->origh = inh;
+	return true;
+}
 
-	neww = inw;
-	newh = inh;
+static bool imgcache_match(struct imgcache_key* a, struct imgcache_key* b)
+{
+	return a->hash == b->hash && a->mtime == b->mtime && a->size == b->size &&
+		a->cw == b->cw && a->ch == b->ch && a->imageproc == b->imageproc &&
+		a->scale == b->scale && a->filtermode == b->filtermode &&
+		strcmp(a->path, b->path) == 0;
+}
 
-/* the thread_loader will take care of converting the asynchsrc
- * to an image once its completely done */
-	if (!asynchsrc)
-		dst->feed.state.tag = ARCAN_TAG_IMAGE;
+/*
+ * Try to substitute the store of [dst] with one already loaded from the same
+ * source, returns true if that was possible.
+ */
+static bool imgcache_share(const char* path, arcan_vobject* dst, img_cons cons)
+{
+	struct imgcache_key key;
+	if (!imgcache_mkkey(path, dst->vstore, cons, &key))
+		return false;
 
-/* need to keep the identification string in order to rebuild
- * on a forced push/pop */
-	struct agp_vstore* dstframe = dst->vstore;
-	dstframe->vinf.text.source = strdup(fname);
+	struct imgcache_ent* ent = imgcache.buckets[key.hash % IMGCACHE_BUCKETS];
+	for (; ent; ent = ent->next)
+		if (imgcache_match(&ent->key, &key))
+			break;
 
-	enum arcan_vimage_mode desm = dst->vstore->scale;
+	if (!ent)
+		return false;
 
-	if (meta.compressed)
-		goto push_comp;
+	arcan_vint_drop_vstore(dst->vstore);
+	dst->vstore = ent->store;
+	dst->vstore->refcount++;
+	dst->origw = ent->origw;
+	dst->origh = ent->origh;
+	dst->feed.state.tag = ARCAN_TAG_IMAGE;
 
-/* the user requested specific dimensions, or we are in a mode where
- * we should manually enfore a stretch to the nearest power of two */
-	if (desm == ARCAN_VIMAGE_SCALEPOW2){
-		forced.w = nexthigher(neww) == neww ? 0 : nexthigher(neww);
+	return true;
+}
+
+static void imgcache_track(const char* path, arcan_vobject* src, img_cons cons)
+{
+	struct imgcache_key key;
+	if (src->vstore->txmapped != TXSTATE_TEX2D ||
+		!imgcache_mkkey(path, src->vstore, cons, &key))
+		return;
+
+	struct imgcache_ent* ent = arcan_alloc_mem(sizeof(struct imgcache_ent),
+		ARCAN_MEM_VSTRUCT, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_NATURAL);
+	if (!ent)
+		return;
+
+	key.path = strdup(path);
+	*ent = (struct imgcache_ent){
+		.key = key,
+		.store = src->vstore,
+		.origw = src->origw,
+		.origh = src->origh,
+		.next = imgcache.buckets[key.hash % IMGCACHE_BUCKETS]
+	};
+	imgcache.buckets[key.hash % IMGCACHE_BUCKETS] = ent;
+}
+
+static void imgcache_forget(struct agp_vstore* store)
+{
+	if (store->txmapped == TXSTATE_OFF ||
+		store->vinf.text.kind != STORAGE_IMAGE_URI || !store->vinf.text.source)
+		return;
+
+	struct imgcache_ent** cur = &imgcache.buckets[
+		imgcache_hash(store->vinf.text.source) % IMGCACHE_BUCKETS];
+
+	while (*cur){
+		if ((*cur)->store == store){
+			struct imgcache_ent* ent = *cur;
+			*cur = ent->next;
+			arcan_mem_free((char*) ent->key.path);
+			arcan_mem_free(ent);
+			return;
+		}
+		cur = &(*cur)->next;
+	}
+}
+
+static void pixels_unlink(struct imgcache_pixels* ent)
+{
+	if (ent->prev)
+		ent->prev->next = ent->next;
+	else
+		imgcache.mru = ent->next;
+
+	if (ent->next)
+		ent->next->prev = ent->prev;
+	else
+		imgcache.lru = ent->prev;
+
+	ent->prev = ent->next = NULL;
+}
+
+static void pixels_front(struct imgcache_pixels* ent)
+{
+	ent->next = imgcache.mru;
+	if (imgcache.mru)
+		imgcache.mru->prev = ent;
+	else
+		imgcache.lru = ent;
+	imgcache.mru = ent;
+}
+
+/* returns a copy of the pixels matching [key] in [dst], or false */
+static bool imgcache_getpixels(struct imgcache_key* key, arcan_vobject* dst)
+{
+	bool rv = false;
+	pthread_mutex_lock(&imgcache.lock);
+
+	struct imgcache_pixels* ent = imgcache.mru;
+	for (; ent; ent = ent->next)
+		if (imgcache_match(&ent->key, key))
+			break;
+
+	if (!ent)
+		goto out;
+
+	av_pixel* buf = arcan_alloc_fillmem(ent->buf, ent->buf_sz,
+		ARCAN_MEM_VBUFFER, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_PAGE);
+	if (!buf)
+		goto out;
+
+	pixels_unlink(ent);
+	pixels_front(ent);
+
+	dst->origw = ent->origw;
+	dst->origh = ent->origh;
+	dst->vstore->w = ent->w;
+	dst->vstore->h = ent->h;
+	dst->vstore->vinf.text.raw = buf;
+	dst->vstore->vinf.text.s_raw = ent->buf_sz;
+	rv = true;
+
+out:
+	pthread_mutex_unlock(&imgcache.lock);
+	return rv;
+}
+
+static void imgcache_putpixels(struct imgcache_key* key, arcan_vobject* src)
+{
+	struct agp_vstore* vs = src->vstore;
+	if (!vs->vinf.text.raw || vs->vinf.text.s_raw > IMGCACHE_PIXEL_BUDGET / 4)
+		return;
+
+	struct imgcache_pixels* ent = arcan_alloc_mem(
+		sizeof(struct imgcache_pixels),
+		ARCAN_MEM_VSTRUCT, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_NATURAL);
+	if (!ent)
+		return;
+
+/* keyed on the final dimensions as that is what a rebuild will ask for */
+	*ent = (struct imgcache_pixels){
+		.key = *key,
+		.buf_sz = vs->vinf.text.s_raw,
+		.w = vs->w,
+		.h = vs->h,
+		.origw = src->origw,
+		.origh = src->origh
+	};
+	ent->key.cw = src->origw;
+	ent->key.ch = src->origh;
+
+	ent->buf = arcan_alloc_fillmem(vs->vinf.text.raw, ent->buf_sz,
+		ARCAN_MEM_VBUFFER, ARCAN_MEM_NONFATAL, ARCAN_MEMALIGN_PAGE);
+	if (!ent->buf){
+		arcan_mem_free(ent);
+		return;
+	}
+	ent->key.path = strdup(key->path);
+
+	pthread_mutex_lock(&imgcache.lock);
+	while (imgcache.lru &&
+		imgcache.pixel_bytes + ent->buf_sz > IMGCACHE_PIXEL_BUDGET){
+		struct imgcache_pixels* old = imgcache.lru;
+		pixels_unlink(old);
+		imgcache.pixel_bytes -= old->buf_sz;
+		arcan_mem_free(old->buf);
+		arcan_mem_free((char*) old->key.path);
+		arcan_mem_free(old);
+	}
+
+	pixels_front(ent);
+	imgcache.pixel_bytes += ent->buf_sz;
+	pthread_mutex_unlock(&imgcache.lock);
+}
+
+arcan_errc arcan_vint_getimage(const char* fname, arcan_vobject* dst,
+	img_cons forced, bool asynchsrc)
+{
+/* conservative mode, the pixels may still be around from a previous load */
+	struct imgcache_key key;
+	bool cached = arcan_video_display.conservative &&
+		imgcache_mkkey(fname, dst->vstore, forced, &key);
+
+	if (cached && imgcache_getpixels(&key, dst)){
+		dst->vstore->vinf.text.source = strdup(fname);
+		if (!asynchsrc){
+			dst->feed.state.tag = ARCAN_TAG_IMAGE;
+			if (dst->vstore->txmapped != TXSTATE_OFF)
+				agp_update_vstore(dst->vstore, true);
+		}
+		return ARCAN_OK;
+	}
+
+/*
+ * with asynchsynch, it's likely that we get a storm of requests and we'd
+ * likely suffer thrashing, so limit this.  also, look into using
+ * pthread_setschedparam and switch to pthreads exclusively
+ */
+	arcan_sem_wait(asynchsynch);
+
+	size_t inw, inh;
+
+/* try- open */
+	data_source inres = arcan_open_resource(fname);
+	if (inres.fd == BADFD){
+		arcan_sem_post(asynchsynch);
+		return ARCAN_ERRC_BAD_RESOURCE;
+	}
+
+/* mmap (preferred) or buffer (mmap not working / useful due to alignment) */
+	map_region inmem = arcan_map_resource(&inres, false);
+	if (inmem.ptr == NULL){
+		arcan_sem_post(asynchsynch);
+		arcan_release_resource(&inres);
+		return ARCAN_ERRC_BAD_RESOURCE;
+	}
+
+	struct arcan_img_meta meta = {0};
+	uint32_t* ch_imgbuf = NULL;
+
+	arcan_errc rv = arcan_img_decode(fname, inmem.ptr, inmem.sz,
+		&ch_imgbuf, &inw, &inh, &meta, dst->vstore->imageproc == IMAGEPROC_FLIPH);
+
+	arcan_release_map(inmem);
+	arcan_release_resource(&inres);
+
+	if (ARCAN_OK != rv)
+		goto done;
+
+	av_pixel* imgbuf = arcan_img_repack(ch_imgbuf, inw, inh);
+	if (!imgbuf){
+		rv = ARCAN_ERRC_OUT_OF_SPACE;
+		goto done;
+	}
+
+	uint16_t neww, newh;
+
+/* store this so we can maintain aspect ratios etc. while still
+ * possibly aligning to next power of two */
+	dst->origw = inw;
+	dst->origh = inh;
+
+	neww = inw;
+	newh = inh;
+
+/* the thread_loader will take care of converting the asynchsrc
+ * to an image once its completely done */
+	if (!asynchsrc)
+		dst->feed.state.tag = ARCAN_TAG_IMAGE;
+
+/* need to keep the identification string in order to rebuild
+ * on a forced push/pop */
+	struct agp_vstore* dstframe = dst->vstore;
+	dstframe->vinf.text.source = strdup(fname);
+
+	enum arcan_vimage_mode desm = dst->vstore->scale;
+
+	if (meta.compressed)
+		goto push_comp;
+
+/* the user requested specific dimensions, or we are in a mode where
+ * we should manually enfore a stretch to the nearest power of two */
+	if (desm == ARCAN_VIMAGE_SCALEPOW2){
+		forced.w = nexthigher(neww) == neww ? 0 : nexthigher(neww);
 		forced.h = nexthigher(newh) == newh ? 0 : nexthigher(newh);
 	}
 
@@ -1817,6 +2482,9 @@ arcan_errc arcan_vint_getimage(const char* fname, arcan_vobject* dst,
 	dst->vstore->w = neww;
 	dst->vstore->h = newh;
 
+	if (cached)
+		imgcache_putpixels(&key, dst);
+
 /*
  * for the asynch case, we need to do this separately as we're in a different
  * thread and forcibly assigning the glcontext to another thread is expensive */
@@ -1858,6 +2526,8 @@ static void rescale_origwh(arcan_vobject* dst, float fx, float fy)
 		current->scale.endd   = mul_vector(current->scale.endd, svect);
 		current = current->next;
 	}
+
+	anim_sync(dst);
 }
 
 arcan_errc arcan_video_framecyclemode(arcan_vobj_id id, int mode)
@@ -2295,6 +2965,9 @@ arcan_errc arcan_video_setuprendertarget(arcan_vobj_id did,
 	if (current_context->n_rtargets >= RENDERTARGET_LIMIT)
 		return ARCAN_ERRC_OUT_OF_SPACE;
 
+/* contents will diverge from the source, stop handing it out */
+	imgcache_forget(vobj->vstore);
+
 	int ind = current_context->n_rtargets++;
 	struct rendertarget* dst = &current_context->rtargets[ ind ];
 	*dst = (struct rendertarget){};
@@ -2391,76 +3064,358 @@ arcan_errc arcan_video_setasframe(arcan_vobj_id dst,
 	return ARCAN_OK;
 }
 
-struct thread_loader_args {
+/*
+ * Asynchronous image loading is serviced by a small pool of decode threads
+ * that are spawned on demand. Pending jobs sit in two FIFO queues, one for
+ * objects that have become visible or were explicitly requested and one for
+ * the rest. Workers decode into a job-local staging store so the vobject is
+ * only ever touched from the main thread. This means that a job can be
+ * cancelled at any stage by unlinking or marking it, and that finished jobs
+ * can be collected and uploaded in one go at the frame boundary.
+ */
+#ifndef ASYNCH_DECODE_THREADS
+#define ASYNCH_DECODE_THREADS 4
+#endif
+
+/* upper bound on the number of finished jobs to upload per frame */
+#ifndef ASYNCH_UPLOAD_LIMIT
+#define ASYNCH_UPLOAD_LIMIT 32
+#endif
+
+enum asynch_state {
+	ASYNCH_QUEUED = 0,
+	ASYNCH_DECODING,
+	ASYNCH_DONE
+};
+
+struct asynch_job {
 	arcan_vobject* dst;
-	pthread_t self;
 	arcan_vobj_id dstid;
 	char* fname;
 	intptr_t tag;
 	img_cons constraints;
 	arcan_errc rc;
+
+	enum asynch_state state;
+	bool cancelled;
+	bool prio;
+
+/* staging area the worker decodes into */
+	arcan_vobject stage;
+	struct agp_vstore store;
+
+	struct asynch_job* prev;
+	struct asynch_job* next;
+};
+
+struct asynch_queue {
+	struct asynch_job* first;
+	struct asynch_job* last;
 };
 
-static void* thread_loader(void* in)
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+
+/* [0] is the priority queue, [1] the normal one */
+	struct asynch_queue pending[2];
+	struct asynch_queue ready;
+
+	pthread_t threads[ASYNCH_DECODE_THREADS];
+	size_t workers;
+	size_t idle;
+	bool shutdown;
+} asynch = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.work = PTHREAD_COND_INITIALIZER,
+	.done = PTHREAD_COND_INITIALIZER
+};
+
+static void asynch_append(struct asynch_queue* queue, struct asynch_job* job)
 {
-	struct thread_loader_args* largs = (struct thread_loader_args*) in;
-	arcan_vobject* dst = largs->dst;
-	largs->rc = arcan_vint_getimage(largs->fname, dst, largs->constraints, true);
-	dst->feed.state.tag = ARCAN_TAG_ASYNCIMGRD;
-	return 0;
+	job->next = NULL;
+	job->prev = queue->last;
+
+	if (queue->last)
+		queue->last->next = job;
+	else
+		queue->first = job;
+
+	queue->last = job;
 }
 
-void arcan_vint_joinasynch(arcan_vobject* img, bool emit, bool force)
+static void asynch_unlink(struct asynch_queue* queue, struct asynch_job* job)
+{
+	if (job->prev)
+		job->prev->next = job->next;
+	else
+		queue->first = job->next;
+
+	if (job->next)
+		job->next->prev = job->prev;
+	else
+		queue->last = job->prev;
+
+	job->prev = job->next = NULL;
+}
+
+static void asynch_free(struct asynch_job* job)
+{
+	arcan_mem_free(job->store.vinf.text.raw);
+	free(job->store.vinf.text.source);
+	arcan_mem_free(job->fname);
+	arcan_mem_free(job);
+}
+
+static void* asynch_worker(void* in)
+{
+	pthread_mutex_lock(&asynch.lock);
+
+	for(;;){
+		struct asynch_job* job = asynch.pending[0].first ?
+			asynch.pending[0].first : asynch.pending[1].first;
+
+		if (!job){
+			if (asynch.shutdown)
+				break;
+
+			asynch.idle++;
+			pthread_cond_wait(&asynch.work, &asynch.lock);
+			asynch.idle--;
+			continue;
+		}
+
+		asynch_unlink(&asynch.pending[job->prio ? 0 : 1], job);
+		job->state = ASYNCH_DECODING;
+		pthread_mutex_unlock(&asynch.lock);
+
+		job->rc = arcan_vint_getimage(
+			job->fname, &job->stage, job->constraints, true);
+
+		pthread_mutex_lock(&asynch.lock);
+		job->state = ASYNCH_DONE;
+
+		if (job->cancelled)
+			asynch_free(job);
+		else
+			asynch_append(&asynch.ready, job);
+
+		pthread_cond_broadcast(&asynch.done);
+	}
+
+	pthread_mutex_unlock(&asynch.lock);
+	return NULL;
+}
+
+static void asynch_enqueue(struct asynch_job* job)
+{
+	pthread_mutex_lock(&asynch.lock);
+	asynch_append(&asynch.pending[1], job);
+
+	if (!asynch.idle && asynch.workers < ASYNCH_DECODE_THREADS){
+		if (0 == pthread_create(
+			&asynch.threads[asynch.workers], NULL, asynch_worker, NULL))
+			asynch.workers++;
+		else
+			arcan_warning("loadimage_asynch(), couldn't spawn decode thread\n");
+	}
+
+	pthread_cond_signal(&asynch.work);
+	pthread_mutex_unlock(&asynch.lock);
+}
+
+/*
+ * let the workers finish what they are decoding and join them, by now every
+ * context has been popped so any job left is either cancelled or orphaned
+ */
+static void asynch_shutdown()
+{
+	pthread_mutex_lock(&asynch.lock);
+	for (size_t i = 0; i < 2; i++)
+		while (asynch.pending[i].first){
+			struct asynch_job* job = asynch.pending[i].first;
+			asynch_unlink(&asynch.pending[i], job);
+			asynch_free(job);
+		}
+
+	asynch.shutdown = true;
+	pthread_cond_broadcast(&asynch.work);
+	pthread_mutex_unlock(&asynch.lock);
+
+	for (size_t i = 0; i < asynch.workers; i++)
+		pthread_join(asynch.threads[i], NULL);
+
+	while (asynch.ready.first){
+		struct asynch_job* job = asynch.ready.first;
+		asynch_unlink(&asynch.ready, job);
+		asynch_free(job);
+	}
+
+	asynch.workers = 0;
+	asynch.idle = 0;
+	asynch.shutdown = false;
+}
+
+/* move a still queued job for an object that became visible up front */
+static void asynch_prioritize(arcan_vobject* img)
 {
-	if (!force && img->feed.state.tag != ARCAN_TAG_ASYNCIMGRD){
+	struct asynch_job* job = img->feed.state.ptr;
+	if (job->prio)
 		return;
+
+	pthread_mutex_lock(&asynch.lock);
+	if (job->state == ASYNCH_QUEUED){
+		asynch_unlink(&asynch.pending[1], job);
+		asynch_append(&asynch.pending[0], job);
+	}
+	job->prio = true;
+	pthread_mutex_unlock(&asynch.lock);
+}
+
+/* vobject is being deleted, release the job or leave it to the worker */
+static void asynch_cancel(arcan_vobject* img)
+{
+	struct asynch_job* job = img->feed.state.ptr;
+
+	pthread_mutex_lock(&asynch.lock);
+	switch (job->state){
+	case ASYNCH_QUEUED:
+		asynch_unlink(&asynch.pending[job->prio ? 0 : 1], job);
+	break;
+	case ASYNCH_DECODING:
+		job->cancelled = true;
+		job = NULL;
+	break;
+	case ASYNCH_DONE:
+		asynch_unlink(&asynch.ready, job);
+	break;
 	}
+	pthread_mutex_unlock(&asynch.lock);
 
-	struct thread_loader_args* args =
-		(struct thread_loader_args*) img->feed.state.ptr;
+	if (job)
+		asynch_free(job);
+
+	img->feed.state.ptr = NULL;
+	img->feed.state.tag = ARCAN_TAG_NONE;
+}
 
-	pthread_join(args->self, NULL);
+/* main thread only, move the staged data into the vobject and upload */
+static void asynch_finish(struct asynch_job* job, arcan_vobject* img, bool emit)
+{
+	struct agp_vstore* store = img->vstore;
 
 	arcan_event loadev = {
 		.category = EVENT_VIDEO,
-		.vid.data = args->tag,
-		.vid.source = args->dstid
+		.vid.data = job->tag,
+		.vid.source = job->dstid
 	};
 
-	if (args->rc == ARCAN_OK){
+/* dimensions change, anything derived from the old ones is stale */
+	invalidate_cache(img);
+
+	if (job->rc == ARCAN_OK){
+		img->origw = job->stage.origw;
+		img->origh = job->stage.origh;
+/* compressed sources don't set dimensions at the decode stage */
+		if (job->store.w && job->store.h){
+			store->w = job->store.w;
+			store->h = job->store.h;
+		}
+		store->vinf.text.raw = job->store.vinf.text.raw;
+		store->vinf.text.s_raw = job->store.vinf.text.s_raw;
+		store->vinf.text.source = job->store.vinf.text.source;
+		job->store.vinf.text.raw = NULL;
+		job->store.vinf.text.source = NULL;
+
 		loadev.vid.kind = EVENT_VIDEO_ASYNCHIMAGE_LOADED;
 		loadev.vid.width = img->origw;
 		loadev.vid.height = img->origh;
+		imgcache_track(job->fname, img, job->constraints);
 	}
 /* copy broken placeholder instead */
 	else {
 		img->origw = 32;
 		img->origh = 32;
-		img->vstore->vinf.text.s_raw = 32 * 32 * sizeof(av_pixel);
-		img->vstore->vinf.text.raw = arcan_alloc_mem(img->vstore->vinf.text.s_raw,
+		store->vinf.text.s_raw = 32 * 32 * sizeof(av_pixel);
+		store->vinf.text.raw = arcan_alloc_mem(store->vinf.text.s_raw,
 			ARCAN_MEM_VBUFFER, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_PAGE);
 
-		img->vstore->w = 32;
-		img->vstore->h = 32;
-		img->vstore->vinf.text.source = strdup(args->fname);
-		img->vstore->filtermode = ARCAN_VFILTER_NONE;
+		store->w = 32;
+		store->h = 32;
+		store->vinf.text.source = strdup(job->fname);
+		store->filtermode = ARCAN_VFILTER_NONE;
 
 		loadev.vid.width = 32;
 		loadev.vid.height = 32;
 		loadev.vid.kind = EVENT_VIDEO_ASYNCHIMAGE_FAILED;
 	}
 
-	agp_update_vstore(img->vstore, true);
+	agp_update_vstore(store, true);
 
 	if (emit)
 		arcan_event_enqueue(arcan_event_defaultctx(), &loadev);
 
-	arcan_mem_free(args->fname);
-	arcan_mem_free(args);
+	asynch_free(job);
 	img->feed.state.ptr = NULL;
 	img->feed.state.tag = ARCAN_TAG_IMAGE;
 }
 
+void arcan_vint_joinasynch(arcan_vobject* img, bool emit, bool force)
+{
+	if (img->feed.state.tag != ARCAN_TAG_ASYNCIMGLD)
+		return;
+
+	struct asynch_job* job = img->feed.state.ptr;
+	pthread_mutex_lock(&asynch.lock);
+
+	if (job->state != ASYNCH_DONE && !force){
+		pthread_mutex_unlock(&asynch.lock);
+		return;
+	}
+
+/* not picked up by a worker yet, cheaper to just do it here than to wait */
+	if (job->state == ASYNCH_QUEUED){
+		asynch_unlink(&asynch.pending[job->prio ? 0 : 1], job);
+		job->state = ASYNCH_DECODING;
+		pthread_mutex_unlock(&asynch.lock);
+
+		job->rc = arcan_vint_getimage(
+			job->fname, &job->stage, job->constraints, true);
+		job->state = ASYNCH_DONE;
+	}
+	else {
+		while (job->state != ASYNCH_DONE)
+			pthread_cond_wait(&asynch.done, &asynch.lock);
+
+		asynch_unlink(&asynch.ready, job);
+		pthread_mutex_unlock(&asynch.lock);
+	}
+
+	asynch_finish(job, img, emit);
+}
+
+void arcan_vint_flushasynch()
+{
+	struct asynch_job* jobs[ASYNCH_UPLOAD_LIMIT];
+	size_t count = 0;
+
+	pthread_mutex_lock(&asynch.lock);
+	while (asynch.ready.first && count < ASYNCH_UPLOAD_LIMIT){
+		jobs[count] = asynch.ready.first;
+		asynch_unlink(&asynch.ready, jobs[count++]);
+	}
+	pthread_mutex_unlock(&asynch.lock);
+
+	if (!count)
+		return;
+
+	TRACE_MARK_ENTER("video", "asynch-upload", TRACE_SYS_DEFAULT, 0, count, "");
+	for (size_t i = 0; i < count; i++)
+		asynch_finish(jobs[i], jobs[i]->dst, true);
+	TRACE_MARK_EXIT("video", "asynch-upload", TRACE_SYS_DEFAULT, 0, count, "");
+}
+
 static arcan_vobj_id loadimage_asynch(const char* fname,
 	img_cons constraints, intptr_t tag)
 {
@@ -2469,20 +3424,36 @@ static arcan_vobj_id loadimage_asynch(const char* fname,
 	if (!dstobj)
 		return rv;
 
-	struct thread_loader_args* args = arcan_alloc_mem(
-		sizeof(struct thread_loader_args),
-		ARCAN_MEM_THREADCTX, 0, ARCAN_MEMALIGN_NATURAL);
+/* already loaded, no need to go through the pool, just emit the event */
+	if (imgcache_share(fname, dstobj, constraints)){
+		arcan_event_enqueue(arcan_event_defaultctx(), &(arcan_event){
+			.category = EVENT_VIDEO,
+			.vid.kind = EVENT_VIDEO_ASYNCHIMAGE_LOADED,
+			.vid.data = tag,
+			.vid.source = rv,
+			.vid.width = dstobj->origw,
+			.vid.height = dstobj->origh
+		});
+		return rv;
+	}
+
+	struct asynch_job* job = arcan_alloc_mem(
+		sizeof(struct asynch_job),
+		ARCAN_MEM_THREADCTX, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
 
-	args->dstid = rv;
-	args->dst = dstobj;
-	args->fname = strdup(fname);
-	args->tag = tag;
-	args->constraints = constraints;
+	job->dstid = rv;
+	job->dst = dstobj;
+	job->fname = strdup(fname);
+	job->tag = tag;
+	job->constraints = constraints;
+	job->stage.vstore = &job->store;
+	job->store.imageproc = dstobj->vstore->imageproc;
+	job->store.scale = dstobj->vstore->scale;
 
 	dstobj->feed.state.tag = ARCAN_TAG_ASYNCIMGLD;
-	dstobj->feed.state.ptr = args;
+	dstobj->feed.state.ptr = job;
 
-	pthread_create(&args->self, NULL, thread_loader, (void*) args);
+	asynch_enqueue(job);
 
 	return rv;
 }
@@ -2494,8 +3465,7 @@ arcan_errc arcan_video_pushasynch(arcan_vobj_id source)
 	if (!vobj)
 		return ARCAN_ERRC_NO_SUCH_OBJECT;
 
-	if (vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGLD ||
-		vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGRD){
+	if (vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGLD){
 		/* protect us against premature invocation */
 		arcan_vint_joinasynch(vobj, false, true);
 	}
@@ -2514,10 +3484,18 @@ static arcan_vobj_id loadimage(const char* fname, img_cons constraints,
 	if (newvobj == NULL)
 		return ARCAN_EID;
 
+	if (imgcache_share(fname, newvobj, constraints)){
+		if (errcode != NULL)
+			*errcode = ARCAN_OK;
+		return rv;
+	}
+
 	arcan_errc rc = arcan_vint_getimage(fname, newvobj, constraints, false);
 
 	if (rc != ARCAN_OK)
 		arcan_video_deleteobject(rv);
+	else
+		imgcache_track(fname, newvobj, constraints);
 
 	if (errcode != NULL)
 		*errcode = rc;
@@ -2606,8 +3584,7 @@ arcan_errc arcan_video_resizefeed(arcan_vobj_id id, size_t w, size_t h)
 	if (!vobj)
 		return ARCAN_ERRC_NO_SUCH_OBJECT;
 
-	if (vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGLD ||
-		vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGRD)
+	if (vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
 		arcan_video_pushasynch(id);
 
 /* rescale transformation chain */
@@ -2628,6 +3605,7 @@ arcan_errc arcan_video_resizefeed(arcan_vobj_id id, size_t w, size_t h)
 	vobj->current.scale.x = sfx;
 	vobj->current.scale.y = sfy;
 	invalidate_cache(vobj);
+	imgcache_forget(vobj->vstore);
 	agp_resize_vstore(vobj->vstore, w, h);
 
 	FLAG_DIRTY();
@@ -2889,7 +3867,7 @@ arcan_errc arcan_video_zaptransform(
 				*last = current->next;
 
 			surface_transform* next = current->next;
-			arcan_mem_free(current);
+			transform_free(current);
 			current = next;
 		}
 		else {
@@ -2898,6 +3876,7 @@ arcan_errc arcan_video_zaptransform(
 		}
 	}
 
+	anim_sync(vobj);
 	invalidate_cache(vobj);
 	return ARCAN_OK;
 }
@@ -3055,7 +4034,7 @@ arcan_errc arcan_video_instanttransform(
 
 			surface_transform* tokill = current;
 			current = current->next;
-			arcan_mem_free(tokill);
+			transform_free(tokill);
 		}
 		else {
 			last = &current->next;
@@ -3063,6 +4042,7 @@ arcan_errc arcan_video_instanttransform(
 		}
 	}
 
+	anim_sync(vobj);
 	invalidate_cache(vobj);
 	return ARCAN_OK;
 }
@@ -3074,6 +4054,7 @@ arcan_errc arcan_video_objecttexmode(arcan_vobj_id id,
 	arcan_errc rv = ARCAN_ERRC_NO_SUCH_OBJECT;
 
 	if (src){
+		imgcache_forget(src->vstore);
 		src->vstore->txu = modes;
 		src->vstore->txv = modet;
 		agp_update_vstore(src->vstore, false);
@@ -3091,6 +4072,7 @@ arcan_errc arcan_video_objectfilter(arcan_vobj_id id,
 
 /* fake an upload with disabled filteroptions */
 	if (src){
+		imgcache_forget(src->vstore);
 		src->vstore->filtermode = mode;
 		agp_update_vstore(src->vstore, false);
 	}
@@ -3158,6 +4140,7 @@ arcan_errc arcan_video_copytransform(arcan_vobj_id sid, arcan_vobj_id did)
 
 	arcan_video_zaptransform(did, 0, NULL);
 	dst->transform = dup_chain(src->transform);
+	anim_sync(dst);
 	update_zv(dst, src->order);
 
 	invalidate_cache(dst);
@@ -3258,6 +4241,9 @@ static void drop_rtarget(arcan_vobject* vobj)
 		agp_drop_rendertarget(dst->art);
 	dst->art = NULL;
 
+	pick_free(dst->pick);
+	dst->pick = NULL;
+
 /* create a temporary copy of all the elements in the rendertarget,
  * this will be a noop for a linked rendertarget */
 	arcan_vobject_litem* current = dst->first;
@@ -3269,6 +4255,8 @@ static void drop_rtarget(arcan_vobject* vobj)
 	while (current){
 		arcan_vobject* base = current->elem;
 		pool[cascade_c++] = base;
+		if (base->owner_litem == current)
+			base->owner_litem = NULL;
 
 /* rtarget has one less attachment, and base is attached to one less */
 		vobj->extrefc.attachments--;
@@ -3293,8 +4281,7 @@ static void drop_rtarget(arcan_vobject* vobj)
 		arcan_vobject_litem* last = current;
 		current->elem = (arcan_vobject*) 0xfacefeed;
 		current = current->next;
-		last->next = (struct arcan_vobject_litem*) 0xdeadbeef;
-		arcan_mem_free(last);
+		litem_free(last);
 	}
 
 /* compact the context array of rendertargets */
@@ -3443,7 +4430,7 @@ arcan_errc arcan_video_deleteobject(arcan_vobj_id id)
 	}
 
 	if (vobj->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
-		arcan_video_pushasynch(id);
+		asynch_cancel(vobj);
 
 /* video storage, will take care of refcounting in case of shared storage */
 	arcan_vint_drop_vstore(vobj->vstore);
@@ -3592,6 +4579,7 @@ arcan_errc arcan_video_objectrotate3d(arcan_vobj_id id,
 		vobj->current.rotation.pitch = pitch;
 		vobj->current.rotation.yaw   = yaw;
 		vobj->current.rotation.quaternion = build_quat_taitbryan(roll,pitch,yaw);
+		anim_sync(vobj);
 
 		return ARCAN_OK;
 	}
@@ -3610,11 +4598,9 @@ arcan_errc arcan_video_objectrotate3d(arcan_vobj_id id,
 
 	if (!base){
 		if (last)
-			base = last->next = arcan_alloc_mem(sizeof(surface_transform),
-							ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+			base = last->next = transform_alloc();
 		else
-			base = last = arcan_alloc_mem(sizeof(surface_transform),
-				ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+			base = last = transform_alloc();
 	}
 
 	if (!vobj->transform)
@@ -3635,6 +4621,7 @@ arcan_errc arcan_video_objectrotate3d(arcan_vobj_id id,
 	base->rotate.interp = (fabsf(bv.roll - roll) > 180.0 ||
 		fabsf(bv.pitch - pitch) > 180.0 || fabsf(bv.yaw - yaw) > 180.0) ?
 		nlerp_quat180 : nlerp_quat360;
+	anim_sync(vobj);
 
 	return ARCAN_OK;
 }
@@ -3738,13 +4725,9 @@ arcan_errc arcan_video_objectopacity(arcan_vobj_id id,
 
 			if (!base){
 				if (last)
-					base = last->next =
-						arcan_alloc_mem(sizeof(surface_transform), ARCAN_MEM_VSTRUCT,
-							ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+					base = last->next = transform_alloc();
 				else
-					base = last =
-						arcan_alloc_mem(sizeof(surface_transform), ARCAN_MEM_VSTRUCT,
-							ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+					base = last = transform_alloc();
 			}
 
 			if (!vobj->transform)
@@ -3760,6 +4743,8 @@ arcan_errc arcan_video_objectopacity(arcan_vobj_id id,
 			base->blend.endopa = opa + EPSILON;
 			base->blend.interp = ARCAN_VINTER_LINEAR;
 		}
+
+		anim_sync(vobj);
 	}
 
 	return rv;
@@ -3782,6 +4767,7 @@ arcan_errc arcan_video_blendinterp(arcan_vobj_id id, enum arcan_vinterp inter)
 
 	assert(base);
 	base->blend.interp = inter;
+	anim_sync(vobj);
 
 	return ARCAN_OK;
 }
@@ -3803,6 +4789,7 @@ arcan_errc arcan_video_scaleinterp(arcan_vobj_id id, enum arcan_vinterp inter)
 
 	assert(base);
 	base->scale.interp = inter;
+	anim_sync(vobj);
 
 	return ARCAN_OK;
 }
@@ -3824,6 +4811,7 @@ arcan_errc arcan_video_moveinterp(arcan_vobj_id id, enum arcan_vinterp inter)
 
 	assert(base);
 	base->move.interp = inter;
+	anim_sync(vobj);
 
 	return ARCAN_OK;
 }
@@ -3851,6 +4839,7 @@ arcan_errc arcan_video_objectmove(arcan_vobj_id id, float newx,
 		vobj->current.position.x = newx;
 		vobj->current.position.y = newy;
 		vobj->current.position.z = newz;
+		anim_sync(vobj);
 		return ARCAN_OK;
 	}
 
@@ -3870,13 +4859,9 @@ arcan_errc arcan_video_objectmove(arcan_vobj_id id, float newx,
 
 	if (!base){
 		if (last)
-			base = last->next =
-				arcan_alloc_mem(sizeof(surface_transform), ARCAN_MEM_VSTRUCT,
-					ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+			base = last->next = transform_alloc();
 		else
-			base = last =
-				arcan_alloc_mem(sizeof(surface_transform), ARCAN_MEM_VSTRUCT,
-					ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+			base = last = transform_alloc();
 	}
 
 	point newp = {newx, newy, newz};
@@ -3892,6 +4877,7 @@ arcan_errc arcan_video_objectmove(arcan_vobj_id id, float newx,
 	base->move.endp   = newp;
 	if (vobj->owner)
 		vobj->owner->transfc++;
+	anim_sync(vobj);
 
 	return ARCAN_OK;
 }
@@ -3935,11 +4921,9 @@ arcan_errc arcan_video_objectscale(arcan_vobj_id id, float wf,
 
 			if (!base){
 				if (last)
-					base = last->next = arcan_alloc_mem(sizeof(surface_transform),
-						ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+					base = last->next = transform_alloc();
 				else
-					base = last = arcan_alloc_mem(sizeof(surface_transform),
-						ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+					base = last = transform_alloc();
 			}
 
 			if (!vobj->transform)
@@ -3957,6 +4941,8 @@ arcan_errc arcan_video_objectscale(arcan_vobj_id id, float wf,
 			if (vobj->owner)
 				vobj->owner->transfc++;
 		}
+
+		anim_sync(vobj);
 	}
 
 	return rv;
@@ -4112,7 +5098,7 @@ static void compact_transformation(arcan_vobject* base,
 	if (!(work->blend.startt | work->scale.startt |
 		work->move.startt | work->rotate.startt )){
 
-		arcan_mem_free(work);
+		transform_free(work);
 		if (last)
 			last->next = NULL;
 		else
@@ -4141,149 +5127,204 @@ static inline float lerp_fract(float startt, float endt, float ts)
 	return rv;
 }
 
-static int update_object(arcan_vobject* ci, unsigned long long stamp)
+static inline bool anim_local(arcan_vobject* obj)
 {
-	int upd = 0;
-
-/* update parent if this has not already been updated this cycle */
-	if (ci->last_updated < stamp &&
-		ci->parent && ci->parent != &current_context->world &&
-		ci->parent->last_updated != stamp){
-		upd += update_object(ci->parent, stamp);
-	}
-
-	ci->last_updated = stamp;
+	return obj == &current_context->world || (
+		obj >= current_context->vitems_pool &&
+		obj < &current_context->vitems_pool[current_context->vitem_limit]);
+}
 
+static void anim_complete(arcan_vobject* ci, enum anim_prop prop)
+{
 	if (!ci->transform)
-		return upd;
+		return;
 
-	if (ci->transform->blend.startt){
-		upd++;
-		float fract = lerp_fract(ci->transform->blend.startt,
-			ci->transform->blend.endt, stamp);
+	switch (prop){
+	case ANIM_BLEND:
+		ci->current.opa = ci->transform->blend.endopa;
 
-		ci->current.opa = lut_interp_1d[ci->transform->blend.interp](
-			ci->transform->blend.startopa,
-			ci->transform->blend.endopa, fract
-		);
+		if (FL_TEST(ci, FL_TCYCLE)){
+			arcan_video_objectopacity(ci->cellid, ci->transform->blend.endopa,
+				ci->transform->blend.endt - ci->transform->blend.startt);
+			if (ci->transform->blend.interp > 0)
+				arcan_video_blendinterp(ci->cellid, ci->transform->blend.interp);
+		}
 
-		if (fract > 1.0-EPSILON){
-			ci->current.opa = ci->transform->blend.endopa;
+		if (ci->transform->blend.tag)
+			emit_transform_event(ci->cellid,
+				MASK_OPACITY, ci->transform->blend.tag);
 
-			if (FL_TEST(ci, FL_TCYCLE)){
-				arcan_video_objectopacity(ci->cellid, ci->transform->blend.endopa,
-					ci->transform->blend.endt - ci->transform->blend.startt);
-				if (ci->transform->blend.interp > 0)
-					arcan_video_blendinterp(ci->cellid, ci->transform->blend.interp);
-			}
+		compact_transformation(ci,
+			offsetof(surface_transform, blend),
+			sizeof(struct transf_blend));
+	break;
 
-			if (ci->transform->blend.tag)
-				emit_transform_event(ci->cellid,
-					MASK_OPACITY, ci->transform->blend.tag);
+	case ANIM_MOVE:
+		ci->current.position = ci->transform->move.endp;
 
-			compact_transformation(ci,
-				offsetof(surface_transform, blend),
-				sizeof(struct transf_blend));
+		if (FL_TEST(ci, FL_TCYCLE)){
+			arcan_video_objectmove(ci->cellid,
+				ci->transform->move.endp.x,
+				ci->transform->move.endp.y,
+				ci->transform->move.endp.z,
+				ci->transform->move.endt - ci->transform->move.startt
+			);
+
+			if (ci->transform->move.interp > 0)
+				arcan_video_moveinterp(ci->cellid, ci->transform->move.interp);
 		}
-	}
 
-	if (ci->transform && ci->transform->move.startt){
-		upd++;
-		float fract = lerp_fract(ci->transform->move.startt,
-			ci->transform->move.endt, stamp);
+		if (ci->transform->move.tag)
+			emit_transform_event(ci->cellid,
+				MASK_POSITION, ci->transform->move.tag);
+
+		compact_transformation(ci,
+			offsetof(surface_transform, move),
+			sizeof(struct transf_move));
+	break;
+
+	case ANIM_SCALE:
+		ci->current.scale = ci->transform->scale.endd;
+
+		if (FL_TEST(ci, FL_TCYCLE)){
+			arcan_video_objectscale(ci->cellid, ci->transform->scale.endd.x,
+				ci->transform->scale.endd.y,
+				ci->transform->scale.endd.z,
+				ci->transform->scale.endt - ci->transform->scale.startt);
 
-		ci->current.position = lut_interp_3d[ci->transform->move.interp](
-				ci->transform->move.startp,
-				ci->transform->move.endp, fract
+			if (ci->transform->scale.interp > 0)
+				arcan_video_scaleinterp(ci->cellid, ci->transform->scale.interp);
+		}
+
+		if (ci->transform->scale.tag)
+			emit_transform_event(ci->cellid, MASK_SCALE, ci->transform->scale.tag);
+
+		compact_transformation(ci,
+			offsetof(surface_transform, scale),
+			sizeof(struct transf_scale));
+	break;
+
+	case ANIM_ROTATE:
+		ci->current.rotation = ci->transform->rotate.endo;
+		if (FL_TEST(ci, FL_TCYCLE))
+			arcan_video_objectrotate3d(ci->cellid,
+				ci->transform->rotate.endo.roll,
+				ci->transform->rotate.endo.pitch,
+				ci->transform->rotate.endo.yaw,
+				ci->transform->rotate.endt - ci->transform->rotate.startt
 			);
 
-		if (fract > 1.0-EPSILON){
-			ci->current.position = ci->transform->move.endp;
+		if (ci->transform->rotate.tag)
+			emit_transform_event(ci->cellid,
+				MASK_ORIENTATION, ci->transform->rotate.tag);
 
-			if (FL_TEST(ci, FL_TCYCLE)){
-				arcan_video_objectmove(ci->cellid,
-					ci->transform->move.endp.x,
-					ci->transform->move.endp.y,
-					ci->transform->move.endp.z,
-					ci->transform->move.endt - ci->transform->move.startt
-				);
+		compact_transformation(ci,
+			offsetof(surface_transform, rotate),
+			sizeof(struct transf_rotate));
+	break;
 
-				if (ci->transform->move.interp > 0)
-					arcan_video_moveinterp(ci->cellid, ci->transform->move.interp);
-			}
+	default:
+	break;
+	}
+}
 
-			if (ci->transform->move.tag)
-				emit_transform_event(ci->cellid,
-					MASK_POSITION, ci->transform->move.tag);
+/*
+ * Step all the animation tracks to [stamp]. The fractions and the linear
+ * values are computed in flat loops over the track arrays, then scattered
+ * back into the objects. Transformations that reach their end are queued
+ * and completed afterwards as that can modify the tracks. Returns the number
+ * of updates for objects that are not attached to a rendertarget, the rest
+ * is accounted for in the transfc of the owner.
+ */
+static int anim_step(unsigned long long stamp)
+{
+	int upd = 0;
+	float ts = stamp;
+	anim.n_done = 0;
 
-			compact_transformation(ci,
-				offsetof(surface_transform, move),
-				sizeof(struct transf_move));
+	for (size_t prop = 0; prop < ANIM_PROPS; prop++){
+		struct anim_track* t = &anim.tracks[prop];
+		size_t nc = anim_components[prop];
+		size_t n = t->count;
+
+		for (size_t i = 0; i < n; i++){
+			float fract = (EPSILON + (ts - t->startt[i])) / (t->endt[i] - t->startt[i]);
+			t->fract[i] = fract > 1.0 ? 1.0 : fract;
 		}
-	}
 
-	if (ci->transform && ci->transform->scale.startt){
-		upd++;
-		float fract = lerp_fract(ci->transform->scale.startt,
-			ci->transform->scale.endt, stamp);
-		ci->current.scale = lut_interp_3d[ci->transform->scale.interp](
-			ci->transform->scale.startd,
-			ci->transform->scale.endd, fract
-		);
+		for (size_t c = 0; c < nc; c++){
+			float* restrict sv = t->sv[c];
+			float* restrict ev = t->ev[c];
+			float* restrict val = t->val[c];
+			float* restrict fract = t->fract;
 
-		if (fract > 1.0-EPSILON){
-			ci->current.scale = ci->transform->scale.endd;
+			for (size_t i = 0; i < n; i++)
+				val[i] = sv[i] + (ev[i] - sv[i]) * fract[i];
+		}
 
-			if (FL_TEST(ci, FL_TCYCLE)){
-				arcan_video_objectscale(ci->cellid, ci->transform->scale.endd.x,
-					ci->transform->scale.endd.y,
-					ci->transform->scale.endd.z,
-					ci->transform->scale.endt - ci->transform->scale.startt);
+		for (size_t i = 0; i < n; i++){
+			arcan_vobject* obj = t->obj[i];
+			if (!anim_local(obj))
+				continue;
 
-				if (ci->transform->scale.interp > 0)
-					arcan_video_scaleinterp(ci->cellid, ci->transform->scale.interp);
-			}
+			if (obj->owner)
+				obj->owner->transfc++;
+			else
+				upd++;
 
-			if (ci->transform->scale.tag)
-				emit_transform_event(ci->cellid, MASK_SCALE, ci->transform->scale.tag);
+			float fract = t->fract[i];
+			uint8_t interp = t->interp[i];
 
-			compact_transformation(ci,
-				offsetof(surface_transform, scale),
-				sizeof(struct transf_scale));
+			switch (prop){
+			case ANIM_BLEND:
+				obj->current.opa = interp == ARCAN_VINTER_LINEAR ? t->val[0][i] :
+					lut_interp_1d[interp](t->sv[0][i], t->ev[0][i], fract);
+			break;
+			case ANIM_MOVE:
+			case ANIM_SCALE:{
+				point* dst = prop == ANIM_MOVE ?
+					&obj->current.position : &obj->current.scale;
+
+				if (interp == ARCAN_VINTER_LINEAR){
+					dst->x = t->val[0][i];
+					dst->y = t->val[1][i];
+					dst->z = t->val[2][i];
+				}
+				else {
+					point a = {.x = t->sv[0][i], .y = t->sv[1][i], .z = t->sv[2][i]};
+					point b = {.x = t->ev[0][i], .y = t->ev[1][i], .z = t->ev[2][i]};
+					*dst = lut_interp_3d[interp](a, b, fract);
+				}
+			}
+			break;
+			case ANIM_ROTATE:
+				if (fract <= 1.0-EPSILON)
+					obj->current.rotation.quaternion = obj->transform->rotate.interp(
+						obj->transform->rotate.starto.quaternion,
+						obj->transform->rotate.endo.quaternion, fract
+					);
+			break;
+			}
+
+			if (fract > 1.0-EPSILON){
+				if (anim.n_done == anim.done_limit){
+					size_t limit = anim.done_limit ? anim.done_limit * 2 : 64;
+					anim.done = anim_resize(anim.done,
+						sizeof(struct anim_done), anim.n_done, limit);
+					anim.done_limit = limit;
+				}
+				anim.done[anim.n_done++] = (struct anim_done){
+					.obj = obj,
+					.prop = prop
+				};
+			}
 		}
 	}
 
-	if (ci->transform && ci->transform->rotate.startt){
-		upd++;
-		float fract = lerp_fract(ci->transform->rotate.startt,
-			ci->transform->rotate.endt, stamp);
-
-/* close enough */
-		if (fract > 1.0-EPSILON){
-			ci->current.rotation = ci->transform->rotate.endo;
-			if (FL_TEST(ci, FL_TCYCLE))
-				arcan_video_objectrotate3d(ci->cellid,
-					ci->transform->rotate.endo.roll,
-					ci->transform->rotate.endo.pitch,
-					ci->transform->rotate.endo.yaw,
-					ci->transform->rotate.endt - ci->transform->rotate.startt
-				);
-
-			if (ci->transform->rotate.tag)
-				emit_transform_event(ci->cellid,
-					MASK_ORIENTATION, ci->transform->rotate.tag);
-
-			compact_transformation(ci,
-				offsetof(surface_transform, rotate),
-				sizeof(struct transf_rotate));
-		}
-		else {
-			ci->current.rotation.quaternion =
-				ci->transform->rotate.interp(
-					ci->transform->rotate.starto.quaternion,
-					ci->transform->rotate.endo.quaternion, fract
-				);
-		}
+/* completing can cycle, compact and re-sync, which reorders the tracks */
+	for (size_t i = 0; i < anim.n_done; i++){
+		anim_complete(anim.done[i].obj, anim.done[i].prop);
+		anim_sync(anim.done[i].obj);
 	}
 
 	return upd;
@@ -4343,16 +5384,15 @@ static inline void process_readback(struct rendertarget* tgt, float fract)
  */
 static int tick_rendertarget(struct rendertarget* tgt)
 {
-	tgt->transfc = 0;
 	arcan_vobject_litem* current = tgt->first;
 
 	while (current){
 		arcan_vobject* elem = current->elem;
 
-		arcan_vint_joinasynch(elem, true, false);
-
-		if (elem->last_updated != arcan_video_display.c_ticks)
-			tgt->transfc += update_object(elem, arcan_video_display.c_ticks);
+/* visible objects still waiting for their image get to jump the queue */
+		if (elem->feed.state.tag == ARCAN_TAG_ASYNCIMGLD &&
+			elem->current.opa > EPSILON)
+			asynch_prioritize(elem);
 
 		if (elem->feed.ffunc)
 			arcan_ffunc_lookup(elem->feed.ffunc)
@@ -4399,8 +5439,11 @@ unsigned arcan_video_tick(unsigned steps, unsigned* njobs)
 #endif
 
 	do {
-		arcan_video_display.dirty +=
-			update_object(&current_context->world, arcan_video_display.c_ticks);
+		for (size_t i = 0; i < current_context->n_rtargets; i++)
+			current_context->rtargets[i].transfc = 0;
+		current_context->stdoutp.transfc = 0;
+
+		arcan_video_display.dirty += anim_step(arcan_video_display.c_ticks);
 
 		arcan_video_display.dirty +=
 			agp_shader_envv(TIMESTAMP_D, &tsd, sizeof(uint32_t));
@@ -4558,18 +5601,22 @@ static void apply(arcan_vobject* vobj, surface_properties* dprops,
  * which is then re-used every rendercall.
  * Queueing a transformation immediately invalidates the cache.
  */
-void arcan_resolve_vidprop(
-	arcan_vobject* vobj, float lerp, surface_properties* props)
+static void resolve_vidprop(arcan_vobject* vobj, float lerp,
+	surface_properties* props, const surface_properties* pprop)
 {
 	if (vobj->valid_cache)
 		*props = vobj->prop_cache;
 
 /* walk the chain up to the parent, resolve recursively - there might be an
  * early out detection here if all transforms are masked though the value of
- * that is questionable without more real-world data */
+ * that is questionable without more real-world data. If the caller already
+ * has the resolved parent, that is used instead. */
 	else if (vobj->parent && vobj->parent != &current_context->world){
 		surface_properties dprop = empty_surface();
-		arcan_resolve_vidprop(vobj->parent, lerp, &dprop);
+		if (pprop)
+			dprop = *pprop;
+		else
+			arcan_resolve_vidprop(vobj->parent, lerp, &dprop);
 
 /* now apply the parent chain to ourselves */
 		apply(vobj, props, &dprop, lerp, false);
@@ -4655,6 +5702,240 @@ void arcan_resolve_vidprop(
 		;
 }
 
+void arcan_resolve_vidprop(
+	arcan_vobject* vobj, float lerp, surface_properties* props)
+{
+	resolve_vidprop(vobj, lerp, props, NULL);
+}
+
+/*
+ * Per-frame resolve pass: before a rendertarget is drawn, the properties of
+ * every object in its pipeline are resolved once into an array indexed by
+ * the position in the vobject pool, with parents resolved through the same
+ * array so that each chain is only walked once per frame. The occlusion,
+ * clipping and drawing stages then only read from it (frame_vidprop).
+ *
+ * Large pipelines are split across a few worker threads. Objects are grouped
+ * on the root of their parent chain so that a subtree, which shares the
+ * cached state that resolving writes to, is always handled by one thread.
+ */
+#ifndef RESOLVE_THREADS
+#define RESOLVE_THREADS 3
+#endif
+
+#ifndef RESOLVE_PARALLEL_MIN
+#define RESOLVE_PARALLEL_MIN 2048
+#endif
+
+static struct {
+	uint64_t seq;
+	size_t limit;
+	uint64_t* stamp;
+	surface_properties* props;
+
+/* pipeline items sorted on group, group g is [ofs[g], ofs[g+1]) */
+	arcan_vobject** items;
+	arcan_vobject** sorted;
+	size_t* group;
+	size_t n_items, items_limit;
+	size_t ofs[RESOLVE_THREADS + 2];
+
+	float fract;
+	size_t threads, workers, pending;
+	uint64_t gen;
+	pthread_mutex_t lock;
+	pthread_cond_t work, done;
+} resolve = {
+	.threads = RESOLVE_THREADS,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.work = PTHREAD_COND_INITIALIZER,
+	.done = PTHREAD_COND_INITIALIZER
+};
+
+static void resolve_threads(size_t n)
+{
+	resolve.threads = n > RESOLVE_THREADS ? RESOLVE_THREADS : n;
+}
+
+static inline bool frame_slot(arcan_vobject* vobj, size_t* ind)
+{
+	if (vobj < current_context->vitems_pool ||
+		vobj >= &current_context->vitems_pool[current_context->vitem_limit])
+		return false;
+
+	*ind = vobj - current_context->vitems_pool;
+	return *ind < resolve.limit;
+}
+
+static const surface_properties* frame_resolve(arcan_vobject* vobj, float fract)
+{
+	size_t ind;
+	if (!frame_slot(vobj, &ind))
+		return NULL;
+
+	if (resolve.stamp[ind] == resolve.seq)
+		return &resolve.props[ind];
+
+	const surface_properties* pprop = NULL;
+	if (!vobj->valid_cache &&
+		vobj->parent && vobj->parent != &current_context->world)
+		pprop = frame_resolve(vobj->parent, fract);
+
+	surface_properties* res = &resolve.props[ind];
+	*res = empty_surface();
+	resolve_vidprop(vobj, fract, res, pprop);
+	resolve.stamp[ind] = resolve.seq;
+
+	return res;
+}
+
+/* resolved properties for the current frame, or resolve on the spot */
+static inline void frame_vidprop(
+	arcan_vobject* vobj, float fract, surface_properties* props)
+{
+	size_t ind;
+	if (frame_slot(vobj, &ind) && resolve.stamp[ind] == resolve.seq)
+		*props = resolve.props[ind];
+	else
+		arcan_resolve_vidprop(vobj, fract, props);
+}
+
+static void resolve_group(size_t group)
+{
+	for (size_t i = resolve.ofs[group]; i < resolve.ofs[group+1]; i++)
+		frame_resolve(resolve.sorted[i], resolve.fract);
+}
+
+static void* resolve_worker(void* arg)
+{
+	size_t group = (uintptr_t) arg;
+	uint64_t gen = 0;
+
+	pthread_mutex_lock(&resolve.lock);
+	while (true){
+		while (resolve.gen == gen)
+			pthread_cond_wait(&resolve.work, &resolve.lock);
+
+		gen = resolve.gen;
+		pthread_mutex_unlock(&resolve.lock);
+
+		resolve_group(group);
+
+		pthread_mutex_lock(&resolve.lock);
+		if (--resolve.pending == 0)
+			pthread_cond_signal(&resolve.done);
+	}
+
+	return NULL;
+}
+
+static void resolve_spawn()
+{
+	while (resolve.workers < resolve.threads){
+		pthread_t pth;
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+		if (0 != pthread_create(&pth, &attr,
+			resolve_worker, (void*)(uintptr_t)(resolve.workers + 1))){
+			arcan_warning("resolve_pass(), couldn't spawn worker, "
+				"continuing with %zu\n", resolve.workers);
+			resolve.threads = resolve.workers;
+		}
+		else
+			resolve.workers++;
+
+		pthread_attr_destroy(&attr);
+	}
+}
+
+static void resolve_pass(
+	struct rendertarget* tgt, arcan_vobject_litem* current, float fract)
+{
+	resolve.seq++;
+	resolve.fract = fract;
+
+	if (resolve.limit < current_context->vitem_limit){
+		arcan_mem_free(resolve.stamp);
+		arcan_mem_free(resolve.props);
+		resolve.limit = current_context->vitem_limit;
+		resolve.stamp = arcan_alloc_mem(sizeof(uint64_t) * resolve.limit,
+			ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+		resolve.props = arcan_alloc_mem(sizeof(surface_properties) *
+			resolve.limit, ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_SIMD);
+	}
+
+	size_t count = 0;
+	for (arcan_vobject_litem* cur = current;
+		cur && cur->elem->order <= (int) tgt->max_order; cur = cur->next)
+		count++;
+
+	if (count > resolve.items_limit){
+		arcan_mem_free(resolve.items);
+		arcan_mem_free(resolve.sorted);
+		arcan_mem_free(resolve.group);
+		resolve.items_limit = count * 2;
+		resolve.items = arcan_alloc_mem(sizeof(arcan_vobject*) *
+			resolve.items_limit, ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL);
+		resolve.sorted = arcan_alloc_mem(sizeof(arcan_vobject*) *
+			resolve.items_limit, ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL);
+		resolve.group = arcan_alloc_mem(sizeof(size_t) *
+			resolve.items_limit, ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL);
+	}
+
+	resolve.n_items = 0;
+	for (; current && current->elem->order <= (int) tgt->max_order;
+		current = current->next)
+		if (current->elem->order >= (int) tgt->min_order)
+			resolve.items[resolve.n_items++] = current->elem;
+
+/* small pipelines are not worth the synchronization */
+	if (!resolve.threads || resolve.n_items < RESOLVE_PARALLEL_MIN){
+		for (size_t i = 0; i < resolve.n_items; i++)
+			frame_resolve(resolve.items[i], fract);
+		return;
+	}
+
+	resolve_spawn();
+	size_t ngroups = resolve.workers + 1;
+	size_t groupc[RESOLVE_THREADS + 2] = {0};
+
+	for (size_t i = 0; i < resolve.n_items; i++){
+		arcan_vobject* root = resolve.items[i];
+		while (root->parent && root->parent != &current_context->world)
+			root = root->parent;
+
+		size_t group = ((uintptr_t) root / sizeof(arcan_vobject)) % ngroups;
+		resolve.group[i] = group;
+		groupc[group]++;
+	}
+
+	resolve.ofs[0] = 0;
+	for (size_t i = 0; i < ngroups; i++)
+		resolve.ofs[i+1] = resolve.ofs[i] + groupc[i];
+
+	for (size_t i = 0; i < ngroups; i++)
+		groupc[i] = resolve.ofs[i];
+
+	for (size_t i = 0; i < resolve.n_items; i++)
+		resolve.sorted[groupc[resolve.group[i]]++] = resolve.items[i];
+
+/* wake the workers, take group 0 here and wait for the rest */
+	pthread_mutex_lock(&resolve.lock);
+	resolve.pending = resolve.workers;
+	resolve.gen++;
+	pthread_cond_broadcast(&resolve.work);
+	pthread_mutex_unlock(&resolve.lock);
+
+	resolve_group(0);
+
+	pthread_mutex_lock(&resolve.lock);
+	while (resolve.pending)
+		pthread_cond_wait(&resolve.done, &resolve.lock);
+	pthread_mutex_unlock(&resolve.lock);
+}
+
 static void calc_cp_area(arcan_vobject* vobj, point* ul, point* lr)
 {
 	surface_properties cur;
@@ -4761,15 +6042,12 @@ static void update_shenv(arcan_vobject* src, surface_properties* prop)
 	}
 }
 
-static inline void setup_surf(struct rendertarget* dst,
+static inline void surf_matrix(struct rendertarget* dst,
 	surface_properties* prop, arcan_vobject* src, float** mv)
 {
 /* just temporary storage/scratch */
 	static float _Alignas(16) dmatr[16];
 
-	if (src->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
-		return;
-
 /* currently, we only cache the primary rendertarget, and the better option is
  * to actually remove secondary attachments etc. now that we have order-peeling
  * and sharestorage there should really just be 1:1 between src and dst */
@@ -4784,6 +6062,15 @@ static inline void setup_surf(struct rendertarget* dst,
 		build_modelview(dmatr, dst->base, prop, src);
 		*mv = dmatr;
 	}
+}
+
+static inline void setup_surf(struct rendertarget* dst,
+	surface_properties* prop, arcan_vobject* src, float** mv)
+{
+	if (src->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
+		return;
+
+	surf_matrix(dst, prop, src, mv);
 	update_shenv(src, prop);
 }
 
@@ -4989,7 +6276,7 @@ static inline void populate_stencil(
 		celem = get_clip_source(celem);
 		if (celem){
 			surface_properties pprops = empty_surface();
-			arcan_resolve_vidprop(celem, fract, &pprops);
+			frame_vidprop(celem, fract, &pprops);
 			draw_colorsurf(tgt, pprops, celem, 1.0, 1.0, 1.0, NULL);
 		}
 	}
@@ -4998,7 +6285,7 @@ static inline void populate_stencil(
  * terminate when a shallow clip- object is found */
 		while (celem->parent != &current_context->world){
 			surface_properties pprops = empty_surface();
-			arcan_resolve_vidprop(celem->parent, fract, &pprops);
+			frame_vidprop(celem->parent, fract, &pprops);
 
 			if (celem->parent->clip == ARCAN_CLIP_OFF)
 				draw_colorsurf(tgt, pprops, celem->parent, 1.0, 1.0, 1.0, NULL);
@@ -5074,6 +6361,320 @@ static int draw_vobj(struct rendertarget* tgt,
 	return 0;
 }
 
+/*
+ * Draw call batching: runs of z-order adjacent objects that use one of the
+ * default shaders with the same store (or color), blend mode and opacity are
+ * collected and submitted as a single draw with the vertices transformed on
+ * the CPU. Nothing else can be drawn in between so the order is unchanged.
+ * The first object of a run is kept as-is, a run of one is drawn exactly as
+ * it would be without batching.
+ */
+#ifndef BATCH_QUADS
+#define BATCH_QUADS 256
+#endif
+
+static struct {
+	size_t count;
+	agp_shader_id shid;
+	struct agp_vstore* store;
+	enum arcan_blendfunc blend;
+	float opa;
+	float col[3];
+	bool textured;
+
+/* the first object in the run */
+	float _Alignas(16) mv[16];
+	float x, y;
+	float txcos[8];
+
+	float verts[BATCH_QUADS * 12];
+	float vtxcos[BATCH_QUADS * 12];
+} batch;
+
+static bool batch_candidate(arcan_vobject* elem, agp_shader_id shid,
+	struct agp_vstore* store, surface_properties* dprops,
+	enum arcan_blendfunc* blend)
+{
+	if (arcan_video_display.no_batch ||
+		elem->shape || elem->feed.state.tag == ARCAN_TAG_ASYNCIMGLD ||
+		(elem->frameset && elem->frameset->mode == ARCAN_FRAMESET_MULTITEXTURE))
+		return false;
+
+/* only the default shaders are known to not use any other per-object state,
+ * and like draw_vobj the drawing type comes from the object's own store */
+	enum txstate txm = elem->vstore->txmapped;
+	if (!(
+		(shid == agp_default_shader(BASIC_2D) && txm == TXSTATE_TEX2D) ||
+		(shid == agp_default_shader(COLOR_2D) && txm == TXSTATE_OFF &&
+			elem->program != 0)))
+		return false;
+
+	if (elem->blendmode == BLEND_NORMAL && dprops->opa > 1.0 - EPSILON)
+		*blend = BLEND_NONE;
+	else
+		*blend = elem->blendmode;
+
+	return true;
+}
+
+static void batch_quad(size_t ind,
+	const float* mv, float x, float y, const float* txcos)
+{
+	static const uint8_t tri[6] = {0, 1, 2, 0, 2, 3};
+	float corners[8] = {-x, -y, x, -y, x, y, -x, y};
+	float* dv = &batch.verts[ind * 12];
+	float* dt = &batch.vtxcos[ind * 12];
+
+	for (size_t i = 0; i < 6; i++){
+		float cx = corners[tri[i] * 2 + 0];
+		float cy = corners[tri[i] * 2 + 1];
+		dv[i * 2 + 0] = mv[0] * cx + mv[4] * cy + mv[12];
+		dv[i * 2 + 1] = mv[1] * cx + mv[5] * cy + mv[13];
+		dt[i * 2 + 0] = txcos[tri[i] * 2 + 0];
+		dt[i * 2 + 1] = txcos[tri[i] * 2 + 1];
+	}
+}
+
+static void batch_flush()
+{
+	if (batch.count == 1)
+		agp_draw_vobj(-batch.x, -batch.y, batch.x, batch.y,
+			batch.textured ? batch.txcos : NULL, batch.mv);
+
+	else if (batch.count > 1){
+		agp_draw_vobj_batch(batch.verts,
+			batch.textured ? batch.vtxcos : NULL, batch.count);
+	}
+
+	batch.count = 0;
+}
+
+/*
+ * Start a new run with [elem], the shader and store are expected to be
+ * active. Returns false if the object has to be drawn the normal way.
+ */
+static bool batch_begin(struct rendertarget* tgt, arcan_vobject* elem,
+	agp_shader_id shid, struct agp_vstore* store,
+	surface_properties prop, float* txcos)
+{
+	enum arcan_blendfunc blend;
+	if (!txcos || !batch_candidate(elem, shid, store, &prop, &blend))
+		return false;
+
+	float opa = prop.opa;
+	float* mv;
+	agp_blendstate(blend);
+	setup_surf(tgt, &prop, elem, &mv);
+
+	batch.textured = elem->vstore->txmapped == TXSTATE_TEX2D;
+	if (!batch.textured){
+		batch.col[0] = elem->vstore->vinf.col.r;
+		batch.col[1] = elem->vstore->vinf.col.g;
+		batch.col[2] = elem->vstore->vinf.col.b;
+		agp_shader_forceunif("obj_col", shdrvec3, (void*) batch.col);
+	}
+
+	memcpy(batch.mv, mv, sizeof(float) * 16);
+	memcpy(batch.txcos, txcos, sizeof(float) * 8);
+	batch.x = prop.scale.x;
+	batch.y = prop.scale.y;
+	batch.shid = shid;
+	batch.store = store;
+	batch.blend = blend;
+	batch.opa = opa;
+	batch.count = 1;
+
+	return true;
+}
+
+/*
+ * Add [elem] to the current run if it would draw with the same state,
+ * nothing is activated or drawn here.
+ */
+static bool batch_append(struct rendertarget* tgt, arcan_vobject* elem,
+	agp_shader_id shid, struct agp_vstore* store,
+	surface_properties prop, float* txcos)
+{
+	enum arcan_blendfunc blend;
+	if (!batch.count || batch.count == BATCH_QUADS || shid != batch.shid ||
+		prop.opa != batch.opa || !txcos ||
+		!batch_candidate(elem, shid, store, &prop, &blend) ||
+		blend != batch.blend)
+		return false;
+
+	struct agp_vstore* own = elem->vstore;
+	if (batch.textured){
+		if (store != batch.store || own->txmapped != TXSTATE_TEX2D)
+			return false;
+	}
+	else if (own->txmapped != TXSTATE_OFF ||
+		own->vinf.col.r != batch.col[0] ||
+		own->vinf.col.g != batch.col[1] ||
+		own->vinf.col.b != batch.col[2])
+		return false;
+
+	if (batch.count == 1)
+		batch_quad(0, batch.mv, batch.x, batch.y, batch.txcos);
+
+	float* mv;
+	surf_matrix(tgt, &prop, elem, &mv);
+	batch_quad(batch.count++, mv, prop.scale.x, prop.scale.y, txcos);
+
+	return true;
+}
+
+/*
+ * Occlusion culling: the draw list is walked front to back ahead of the
+ * normal pass and any object whose bounds are fully inside those of an
+ * opaque, non-rotated object drawn on top of it is recorded so the normal
+ * pass can skip it. Only the default shaders are considered as they can not
+ * move vertices outside the object bounds or discard fragments.
+ */
+#ifndef OCCLUSION_LIMIT
+#define OCCLUSION_LIMIT 1024
+#endif
+
+#ifndef OCCLUSION_RECTS
+#define OCCLUSION_RECTS 8
+#endif
+
+static struct {
+	size_t count;
+	arcan_vobject_litem* skip[OCCLUSION_LIMIT];
+} occlusion;
+
+static bool occl_simple(struct rendertarget* tgt,
+	arcan_vobject* elem, surface_properties* dprops)
+{
+	agp_shader_id shid = tgt->shid;
+	if (!tgt->force_shid && elem->program)
+		shid = elem->program;
+
+	enum txstate txm = elem->vstore->txmapped;
+	if (!(
+		(shid == agp_default_shader(BASIC_2D) && txm == TXSTATE_TEX2D) ||
+		(shid == agp_default_shader(COLOR_2D) && txm == TXSTATE_OFF &&
+			elem->program != 0)))
+		return false;
+
+	if (elem->shape || elem->frameset ||
+		elem->feed.state.tag == ARCAN_TAG_ASYNCIMGLD)
+		return false;
+
+	return
+		fabsf(dprops->rotation.roll)  <= EPSILON &&
+		fabsf(dprops->rotation.pitch) <= EPSILON &&
+		fabsf(dprops->rotation.yaw)   <= EPSILON;
+}
+
+/* will the object replace every pixel it covers? */
+static bool occl_opaque(arcan_vobject* elem, float opa)
+{
+	struct agp_vstore* vs = elem->vstore;
+	bool noalpha = vs->txmapped == TXSTATE_OFF ||
+		vs->vinf.text.d_fmt == GL_NOALPHA_PIXEL_FORMAT;
+
+	if (elem->clip != ARCAN_CLIP_OFF)
+		return false;
+
+	switch (elem->blendmode){
+	case BLEND_NONE:
+		return true;
+	case BLEND_NORMAL:
+		return opa > 1.0 - EPSILON;
+	case BLEND_FORCE:
+	case BLEND_PREMUL:
+		return noalpha && opa > 1.0 - EPSILON;
+	default:
+		return false;
+	}
+}
+
+static void occlusion_pass(
+	struct rendertarget* tgt, arcan_vobject_litem* current, float fract)
+{
+	struct {
+		float x1, y1, x2, y2;
+	} rect[OCCLUSION_RECTS];
+	size_t n_rects = 0;
+
+	occlusion.count = 0;
+	if (arcan_video_display.no_occlusion)
+		return;
+
+	arcan_vobject_litem* last = NULL;
+	while (current && current->elem->order <= tgt->max_order){
+		last = current;
+		current = current->next;
+	}
+
+	for (current = last; current; current = current->previous){
+		arcan_vobject* elem = current->elem;
+		if (elem->order < 0 || elem->order < tgt->min_order)
+			break;
+
+		if (elem == tgt->color)
+			continue;
+
+		surface_properties dprops = empty_surface();
+		frame_vidprop(elem, fract, &dprops);
+		if (dprops.opa <= EPSILON || !occl_simple(tgt, elem, &dprops))
+			continue;
+
+		float x1 = dprops.position.x;
+		float y1 = dprops.position.y;
+		float x2 = x1 + dprops.scale.x * elem->origw;
+		float y2 = y1 + dprops.scale.y * elem->origh;
+		if (x1 > x2){
+			float t = x1; x1 = x2; x2 = t;
+		}
+		if (y1 > y2){
+			float t = y1; y1 = y2; y2 = t;
+		}
+
+		size_t i = 0;
+		for (; i < n_rects; i++)
+			if (x1 >= rect[i].x1 && y1 >= rect[i].y1 &&
+				x2 <= rect[i].x2 && y2 <= rect[i].y2)
+				break;
+
+		if (i < n_rects){
+			occlusion.skip[occlusion.count++] = current;
+			if (occlusion.count == OCCLUSION_LIMIT)
+				return;
+			continue;
+		}
+
+		if (!occl_opaque(elem, dprops.opa))
+			continue;
+
+/* keep the largest occluders if there are more than we track */
+		float area = (x2 - x1) * (y2 - y1);
+		size_t dst = n_rects;
+		if (n_rects == OCCLUSION_RECTS){
+			dst = 0;
+			float min = area;
+			for (i = 0; i < n_rects; i++){
+				float ra = (rect[i].x2 - rect[i].x1) * (rect[i].y2 - rect[i].y1);
+				if (ra < min){
+					min = ra;
+					dst = i + 1;
+				}
+			}
+			if (!dst)
+				continue;
+			dst--;
+		}
+		else
+			n_rects++;
+
+		rect[dst].x1 = x1;
+		rect[dst].y1 = y1;
+		rect[dst].x2 = x2;
+		rect[dst].y2 = y2;
+	}
+}
+
 /*
  * Apply clipping without using the stencil buffer, cheaper but with some
  * caveats of its own. Will work particularly bad for partial clipping with
@@ -5087,7 +6688,7 @@ static inline bool setup_shallow_texclip(
 	static float cliptxbuf[8];
 
 	surface_properties pprops = empty_surface();
-	arcan_resolve_vidprop(clip_src, fract, &pprops);
+	frame_vidprop(clip_src, fract, &pprops);
 
 	float p_x = pprops.position.x;
 	float p_y = pprops.position.y;
@@ -5218,6 +6819,10 @@ static size_t process_rendertarget(struct rendertarget* tgt, float fract)
 	agp_shader_activate(agp_default_shader(BASIC_2D));
 	agp_shader_envv(PROJECTION_MATR, tgt->projection, sizeof(float)*16);
 
+	resolve_pass(tgt, current, fract);
+	occlusion_pass(tgt, current, fract);
+	size_t culled = 0;
+
 	while (current && current->elem->order >= 0){
 		arcan_vobject* elem = current->elem;
 
@@ -5229,9 +6834,17 @@ static size_t process_rendertarget(struct rendertarget* tgt, float fract)
 		if (current->elem->order > tgt->max_order)
 			break;
 
-/* calculate coordinate system translations, world cannot be masked */
+/* recorded back to front so the next one to skip is always at the end */
+		if (occlusion.count && occlusion.skip[occlusion.count - 1] == current){
+			occlusion.count--;
+			culled++;
+			current = current->next;
+			continue;
+		}
+
+/* coordinate system translations from the resolve pass */
 		surface_properties dprops = empty_surface();
-		arcan_resolve_vidprop(elem, fract, &dprops);
+		frame_vidprop(elem, fract, &dprops);
 
 /* don't waste time on objects that aren't supposed to be visible */
 		if ( dprops.opa <= EPSILON || elem == tgt->color){
@@ -5265,49 +6878,64 @@ static size_t process_rendertarget(struct rendertarget* tgt, float fract)
 		agp_shader_id shid = tgt->shid;
 		if (!tgt->force_shid && elem->program)
 			shid = elem->program;
-		agp_shader_activate(shid);
 
-		if (elem->frameset){
-			if (elem->frameset->mode == ARCAN_FRAMESET_MULTITEXTURE){
-				arcan_vint_bindmulti(elem, elem->frameset->index);
-			}
-			else{
-				struct frameset_store* ds =
-					&elem->frameset->frames[elem->frameset->index];
-				txcos = ds->txcos;
-				agp_activate_vstore(ds->frame);
-			}
+		struct agp_vstore* store = elem->vstore;
+		if (elem->frameset &&
+			elem->frameset->mode != ARCAN_FRAMESET_MULTITEXTURE){
+			struct frameset_store* ds =
+				&elem->frameset->frames[elem->frameset->index];
+			txcos = ds->txcos;
+			store = ds->frame;
 		}
-		else
-			agp_activate_vstore(elem->vstore);
 
-/* fast-path out if no clipping */
+/* fast-path out if no clipping, shallow non-rotated clipping tweaks the
+ * output object size and texture coordinates, the rest needs the stencil */
 		arcan_vobject* clip_src;
+		bool stencil = false;
 		current = current->next;
 
-		if (elem->clip == ARCAN_CLIP_OFF || !(clip_src = get_clip_source(elem))){
-			pc += draw_vobj(tgt, elem, &dprops, *dstcos);
+		if (elem->clip != ARCAN_CLIP_OFF && (clip_src = get_clip_source(elem))){
+			if (elem->clip == ARCAN_CLIP_SHALLOW &&
+				!elem->rotate_state && !clip_src->rotate_state){
+				if (!setup_shallow_texclip(elem, clip_src, dstcos, &dprops, fract))
+					continue;
+			}
+			else
+				stencil = true;
+		}
+
+		if (!stencil &&
+			batch_append(tgt, elem, shid, store, dprops, *dstcos)){
+			pc++;
 			continue;
 		}
 
-/* fast-path, shallow non-rotated clipping */
-		if (elem->clip == ARCAN_CLIP_SHALLOW &&
-			!elem->rotate_state && !clip_src->rotate_state){
+		batch_flush();
+		agp_shader_activate(shid);
 
-/* this will tweak the output object size and texture coordinates */
-			if (!setup_shallow_texclip(elem, clip_src, dstcos, &dprops, fract)){
-				continue;
-			}
+		if (elem->frameset &&
+			elem->frameset->mode == ARCAN_FRAMESET_MULTITEXTURE)
+			arcan_vint_bindmulti(elem, elem->frameset->index);
+		else
+			agp_activate_vstore(store);
 
+		if (stencil){
+			populate_stencil(tgt, elem, fract);
 			pc += draw_vobj(tgt, elem, &dprops, *dstcos);
-			continue;
+			agp_disable_stencil();
 		}
-
-		populate_stencil(tgt, elem, fract);
-		pc += draw_vobj(tgt, elem, &dprops, *dstcos);
-		agp_disable_stencil();
+		else if (batch_begin(tgt, elem, shid, store, dprops, *dstcos))
+			pc++;
+		else
+			pc += draw_vobj(tgt, elem, &dprops, *dstcos);
 	}
 
+	batch_flush();
+	occlusion.count = 0;
+
+	if (culled)
+		arcan_bench_register_cull(culled);
+
 /* reset and try the 3d part again if requested */
 end3d:
 	current = tgt->first;
@@ -5516,6 +7144,9 @@ unsigned arcan_vint_refresh(float fract, size_t* ndirty)
 
 	size_t transfc = 0;
 
+/* finished asynchronous image loads are uploaded in a batch here */
+	arcan_vint_flushasynch();
+
 /* we track last interp. state in order to handle forcerefresh */
 	arcan_video_display.c_lerp = fract;
 	arcan_random((void*)&arcan_video_display.cookie, 8);
@@ -5569,6 +7200,14 @@ unsigned arcan_vint_refresh(float fract, size_t* ndirty)
 		arcan_video_display.ignore_dirty = platform_video_decay();
 	}
 
+	size_t unif_set, unif_skip;
+	agp_shader_stats(&unif_set, &unif_skip);
+	arcan_bench_register_uniforms(unif_set, unif_skip);
+
+	size_t models_drawn, models_culled, model_draws;
+	arcan_3d_stats(&models_drawn, &models_culled, &model_draws);
+	arcan_bench_register_models(models_drawn, models_culled, model_draws);
+
 	long long int post = arcan_timemillis();
 	TRACE_MARK_EXIT("video", "refresh", TRACE_SYS_DEFAULT, 0, 0, "");
 	return post - pre;
@@ -5736,6 +7375,268 @@ static inline bool obj_visible(arcan_vobject* vobj)
 	return visible;
 }
 
+/*
+ * Spatial index for picking: pipeline items are hashed into fixed size cells
+ * covering their (rotated) bounding box so that a pick only needs to test the
+ * items in one cell. Items that are too large, 3D or have transformations in
+ * progress are kept in a set that is always tested. Changes are queued from
+ * invalidate_cache and attach/detach and applied at the next pick, objects
+ * with finished transformations move back into the cells on the next pick.
+ *
+ * Only the primary attachment of an object is indexed, other rendertargets
+ * it might be attached to will always test it.
+ */
+#ifndef PICK_CELL
+#define PICK_CELL 64
+#endif
+
+#ifndef PICK_BUCKETS
+#define PICK_BUCKETS 1024
+#endif
+
+/* items covering more cells than this are always tested */
+#ifndef PICK_MAXCELLS
+#define PICK_MAXCELLS 64
+#endif
+
+enum pick_state {
+	PICK_NONE = 0,
+	PICK_GRID,
+	PICK_ALWAYS,
+	PICK_VOLATILE
+};
+
+struct pick_set {
+	arcan_vobject_litem** items;
+	size_t count, limit;
+};
+
+struct pick_index {
+	struct pick_set buckets[PICK_BUCKETS];
+	struct pick_set always;
+	struct pick_set queue;
+	struct pick_set cand;
+	uint32_t stamp;
+};
+
+static void pickset_add(struct pick_set* set, arcan_vobject_litem* item)
+{
+	if (set->count == set->limit){
+		size_t limit = set->limit ? set->limit * 2 : 8;
+		arcan_vobject_litem** items = arcan_alloc_mem(
+			limit * sizeof(arcan_vobject_litem*),
+			ARCAN_MEM_VSTRUCT, 0, ARCAN_MEMALIGN_NATURAL
+		);
+
+		if (set->items){
+			memcpy(items, set->items, set->count * sizeof(arcan_vobject_litem*));
+			arcan_mem_free(set->items);
+		}
+
+		set->items = items;
+		set->limit = limit;
+	}
+
+	set->items[set->count++] = item;
+}
+
+static void pickset_remove(struct pick_set* set, arcan_vobject_litem* item)
+{
+	for (size_t i = set->count; i > 0; i--)
+		if (set->items[i-1] == item){
+			set->items[i-1] = set->items[--set->count];
+			return;
+		}
+}
+
+static inline size_t pick_bucket(int cx, int cy)
+{
+	return ((unsigned) cx * 73856093u ^ (unsigned) cy * 19349663u) &
+		(PICK_BUCKETS - 1);
+}
+
+static void pick_unlink(arcan_vobject_litem* item)
+{
+	struct pick_index* ind = item->pick;
+
+	if (item->pick_state == PICK_GRID){
+		for (int cy = item->cy1; cy <= item->cy2; cy++)
+			for (int cx = item->cx1; cx <= item->cx2; cx++)
+				pickset_remove(&ind->buckets[pick_bucket(cx, cy)], item);
+	}
+	else if (item->pick_state != PICK_NONE)
+		pickset_remove(&ind->always, item);
+
+	item->pick_state = PICK_NONE;
+}
+
+static void pick_always(arcan_vobject_litem* item, enum pick_state state)
+{
+	item->pick_state = state;
+	pickset_add(&item->pick->always, item);
+}
+
+static void pick_queue(arcan_vobject_litem* item)
+{
+	if (!item->pick || item->pick_queued)
+		return;
+
+	item->pick_queued = true;
+	pickset_add(&item->pick->queue, item);
+}
+
+static void pick_attach(struct rendertarget* dst, arcan_vobject_litem* item)
+{
+	if (!dst->pick)
+		return;
+
+	item->pick = dst->pick;
+	if (item->elem->owner_litem == item)
+		pick_queue(item);
+	else
+		pick_always(item, PICK_ALWAYS);
+}
+
+static void pick_forget(arcan_vobject_litem* item)
+{
+	if (!item->pick)
+		return;
+
+	pick_unlink(item);
+	if (item->pick_queued)
+		pickset_remove(&item->pick->queue, item);
+
+	item->pick_queued = false;
+	item->pick = NULL;
+}
+
+static void pick_free(struct pick_index* ind)
+{
+	if (!ind)
+		return;
+
+	for (size_t i = 0; i < PICK_BUCKETS; i++)
+		arcan_mem_free(ind->buckets[i].items);
+
+	arcan_mem_free(ind->always.items);
+	arcan_mem_free(ind->queue.items);
+	arcan_mem_free(ind->cand.items);
+	arcan_mem_free(ind);
+}
+
+static bool pick_transforming(arcan_vobject* vobj)
+{
+	while (vobj){
+		if (vobj->transform)
+			return true;
+		vobj = vobj->parent;
+	}
+	return false;
+}
+
+static void pick_place(arcan_vobject_litem* item)
+{
+	arcan_vobject* elem = item->elem;
+	pick_unlink(item);
+
+	if (elem->feed.state.tag == ARCAN_TAG_3DOBJ || elem->order < 0)
+		return pick_always(item, PICK_ALWAYS);
+
+	if (pick_transforming(elem))
+		return pick_always(item, PICK_VOLATILE);
+
+	vector corners[4];
+	if (ARCAN_OK != arcan_video_screencoords(elem->cellid, corners))
+		return pick_always(item, PICK_ALWAYS);
+
+	float x1 = corners[0].x, x2 = x1;
+	float y1 = corners[0].y, y2 = y1;
+	for (size_t i = 1; i < 4; i++){
+		x1 = corners[i].x < x1 ? corners[i].x : x1;
+		x2 = corners[i].x > x2 ? corners[i].x : x2;
+		y1 = corners[i].y < y1 ? corners[i].y : y1;
+		y2 = corners[i].y > y2 ? corners[i].y : y2;
+	}
+
+	item->cx1 = floorf(x1 / PICK_CELL);
+	item->cy1 = floorf(y1 / PICK_CELL);
+	item->cx2 = floorf(x2 / PICK_CELL);
+	item->cy2 = floorf(y2 / PICK_CELL);
+
+	if ((size_t)(item->cx2 - item->cx1 + 1) *
+		(size_t)(item->cy2 - item->cy1 + 1) > PICK_MAXCELLS)
+		return pick_always(item, PICK_ALWAYS);
+
+	item->pick_state = PICK_GRID;
+	for (int cy = item->cy1; cy <= item->cy2; cy++)
+		for (int cx = item->cx1; cx <= item->cx2; cx++)
+			pickset_add(&item->pick->buckets[pick_bucket(cx, cy)], item);
+}
+
+static int pick_cmp(const void* a, const void* b)
+{
+	const arcan_vobject_litem* la = *(const arcan_vobject_litem**) a;
+	const arcan_vobject_litem* lb = *(const arcan_vobject_litem**) b;
+
+	if (la->elem->order != lb->elem->order)
+		return la->elem->order < lb->elem->order ? -1 : 1;
+
+	return la->seq < lb->seq ? -1 : (la->seq > lb->seq);
+}
+
+arcan_vobject_litem** arcan_vint_pickcandidates(
+	struct rendertarget* tgt, int x, int y, size_t* n)
+{
+	struct pick_index* ind = tgt->pick;
+
+	if (!ind){
+		ind = tgt->pick = arcan_alloc_mem(sizeof(struct pick_index),
+			ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
+
+		for (arcan_vobject_litem* cur = tgt->first; cur; cur = cur->next)
+			pick_attach(tgt, cur);
+	}
+
+/* anything that has stopped moving goes back into the cells */
+	for (size_t i = 0; i < ind->always.count; i++){
+		arcan_vobject_litem* item = ind->always.items[i];
+		if (item->pick_state == PICK_VOLATILE && !pick_transforming(item->elem))
+			pick_queue(item);
+	}
+
+	for (size_t i = 0; i < ind->queue.count; i++){
+		ind->queue.items[i]->pick_queued = false;
+		pick_place(ind->queue.items[i]);
+	}
+	ind->queue.count = 0;
+
+/* the same item can be in a bucket more than once through collisions */
+	int cx = floorf((float) x / PICK_CELL);
+	int cy = floorf((float) y / PICK_CELL);
+	struct pick_set* bucket = &ind->buckets[pick_bucket(cx, cy)];
+	ind->cand.count = 0;
+	ind->stamp++;
+
+	for (size_t i = 0; i < bucket->count; i++){
+		arcan_vobject_litem* item = bucket->items[i];
+		if (item->stamp == ind->stamp ||
+			cx < item->cx1 || cx > item->cx2 || cy < item->cy1 || cy > item->cy2)
+			continue;
+
+		item->stamp = ind->stamp;
+		pickset_add(&ind->cand, item);
+	}
+
+	for (size_t i = 0; i < ind->always.count; i++)
+		pickset_add(&ind->cand, ind->always.items[i]);
+
+	qsort(ind->cand.items,
+		ind->cand.count, sizeof(arcan_vobject_litem*), pick_cmp);
+
+	*n = ind->cand.count;
+	return ind->cand.items;
+}
+
 size_t arcan_video_rpick(arcan_vobj_id rt,
 	arcan_vobj_id* dst, size_t lim, int x, int y)
 {
@@ -5746,6 +7647,21 @@ size_t arcan_video_rpick(arcan_vobj_id rt,
 	if (lim == 0 || !tgt || !tgt->first)
 		return count;
 
+	if (!arcan_video_display.no_pickindex){
+		size_t n;
+		arcan_vobject_litem** cand = arcan_vint_pickcandidates(tgt, x, y, &n);
+
+		while (n-- && count < lim){
+			arcan_vobject* vobj = cand[n]->elem;
+
+			if ((vobj->mask & MASK_UNPICKABLE) == 0 && obj_visible(vobj) &&
+				arcan_video_hittest(vobj->cellid, x, y))
+					dst[count++] = vobj->cellid;
+		}
+
+		return count;
+	}
+
 	arcan_vobject_litem* current = tgt->first;
 
 /* skip to last, then start stepping backwards */
@@ -5774,6 +7690,21 @@ size_t arcan_video_pick(arcan_vobj_id rt,
 	if (lim == 0 || !tgt || !tgt->first)
 		return count;
 
+	if (!arcan_video_display.no_pickindex){
+		size_t n;
+		arcan_vobject_litem** cand = arcan_vint_pickcandidates(tgt, x, y, &n);
+
+		for (size_t i = 0; i < n && count < lim; i++){
+			arcan_vobject* vobj = cand[i]->elem;
+
+			if (vobj->cellid && !(vobj->mask & MASK_UNPICKABLE) &&
+				obj_visible(vobj) && arcan_video_hittest(vobj->cellid, x, y))
+					dst[count++] = vobj->cellid;
+		}
+
+		return count;
+	}
+
 	arcan_vobject_litem* current = tgt->first;
 
 	while (current && count < lim){
@@ -6120,6 +8051,7 @@ void arcan_video_shutdown(bool release_fsrv)
 
 	agp_shader_flush();
 	deallocate_gl_context(current_context, true, NULL);
+	asynch_shutdown();
 	arcan_video_reset_fontcache();
 	agp_rendertarget_clear();
 	TTF_Quit();
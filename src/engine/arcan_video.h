@@ -160,7 +160,8 @@ ARCAN_TAG_FRAMESERV = 3,/* got a connection to an external
 													 resource (frameserver)                             */
 ARCAN_TAG_ASYNCIMGLD= 4,/* intermediate state, means that getimage is still
 													 loading, don't touch objects in this state         */
-ARCAN_TAG_ASYNCIMGRD= 5,/* when asynch loader is finished, ready to collect   */
+ARCAN_TAG_ASYNCIMGRD= 5,/* unused, finished loads stay in ASYNCIMGLD until
+													 they are collected                                 */
 
 ARCAN_TAG_3DOBJ     = 6,/* got a corresponding entry in arcan_3dbase, ffunc is
 													 used to control the behavior of the 3d part        */
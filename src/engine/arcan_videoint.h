@@ -16,6 +16,12 @@
 #define RENDERTARGET_LIMIT 64
 #endif
 
+/* number of skip list levels above the pipeline list, with 1/4 promotion
+ * this covers a few times VITEM_CONTEXT_LIMIT entries */
+#ifndef LITEM_SKIP
+#define LITEM_SKIP 8
+#endif
+
 /*
  *  Indicate that the video pipeline is in such a state that
  *  it should be redrawn. X should be NULL or a vobj reference
@@ -33,6 +39,7 @@ static void _int_flag(){
 
 struct arcan_vobject_litem;
 struct arcan_vobject;
+struct pick_index;
 
 enum rtgt_flags {
 	TGTFL_READING = 1,
@@ -66,6 +73,11 @@ struct rendertarget {
  * first is the pipeline (subset of context vid pool) */
 	struct arcan_vobject* color;
 	struct arcan_vobject_litem* first;
+	struct arcan_vobject_litem* skip[LITEM_SKIP];
+
+/* spatial index over the pipeline, built on the first pick, see
+ * arcan_vint_pickcandidates */
+	struct pick_index* pick;
 
 /* it is possible for one rendertarget to share the pipeline with
  * another, if so, first is set to NULL and link points to the rtgt vid */
@@ -171,7 +183,9 @@ struct transf_rotate{
 /*
  * these are arranged in a linked list of slots,
  * where one slot may contain one of each transform categories
- * and will be packed "to the left" each time any one of them finishes
+ * and will be packed "to the left" each time any one of them finishes.
+ * Slots come from a pool in arcan_video.c and the head of the chain is
+ * mirrored into per-property animation tracks that are stepped every tick.
  */
 typedef struct surface_transform {
 
@@ -215,67 +229,74 @@ struct vobject_frameset {
  *
  *  - prefetch vobj->next and vobj
  *
- *  - use external re-order tool to cut down on padding
- *
  *  - null- terminate children
  */
 typedef struct arcan_vobject {
-	struct arcan_vobject* parent;
-	struct arcan_vobject** children;
+/*
+ * Hot members first, these are touched for every object on every tick or
+ * frame (animation, ordering, transform resolve and draw) and are kept
+ * together at the start so that a pass over the pool touches as few cache
+ * lines per object as possible. Note that the pool is indexed by cellid.
+ */
+	enum vobj_flags flags;
+	enum arcan_transform_mask mask;
+	signed int order;
+	enum arcan_blendfunc blendmode;
 
-	struct vobject_frameset* frameset;
+	struct rendertarget* owner;
+	struct arcan_vobject* parent;
 	struct agp_vstore* vstore;
+	surface_transform* transform;
 
-	enum vobj_flags flags;
-	uint16_t origw, origh;
+/* index + 1 into the animation track of each property (blend, move, scale,
+ * rotate) that mirrors the head of transform, 0 if the property is idle */
+	uint32_t anim[4];
 
 /* visual modifiers */
 	agp_shader_id program;
-	struct agp_mesh_store* shape;
-
-	struct {
-		enum arcan_ffunc ffunc;
-		vfunc_state state;
-		uint64_t pcookie;
-	} feed;
+	uint16_t origw, origh;
 
 /* if NULL, a default mapping will be used */
 	float* txcos;
-	enum arcan_blendfunc blendmode;
-
-/* position */
-	signed int order;
-	surface_properties current;
-	point origo_ofs;
-
-	surface_transform* transform;
-	enum arcan_transform_mask mask;
+	struct agp_mesh_store* shape;
+	struct vobject_frameset* frameset;
 
 /* clip (shallow=txco, deep=stencil, off=default) along with non-linked
  * parent reference object (needed for some edge cases) */
 	enum arcan_clipmode clip;
-	arcan_vobj_id clip_src;
 
 /* transform caching,
  * the invalidated flag will be active as long as there are running
  * transformations for the object in question, or if there's running
  * transformations somewhere in the parent chain */
 	bool valid_cache, rotate_state;
+
+/* position */
+	surface_properties current;
 	surface_properties prop_cache;
 	float _Alignas(16) prop_matr[16];
 
-/* life-cycle tracking */
-	unsigned long last_updated;
-	long lifetime;
-
-/* management mappings */
+/* warm, used when resolving against the parent or every tick */
+	point origo_ofs;
 	enum parent_anchor p_anchor;
 	enum parent_scale p_scale;
+	long lifetime;
 
-	unsigned childslots;
+	struct {
+		enum arcan_ffunc ffunc;
+		vfunc_state state;
+		uint64_t pcookie;
+	} feed;
 
-	struct rendertarget* owner;
+/* cold, management and debugging */
 	arcan_vobj_id cellid;
+	arcan_vobj_id clip_src;
+
+	struct arcan_vobject** children;
+	unsigned childslots;
+
+/* entry in the pipeline of owner, used to queue spatial index updates */
+	struct arcan_vobject_litem* owner_litem;
 
 #ifdef _DEBUG
 	bool frozen;
@@ -291,11 +312,27 @@ typedef struct arcan_vobject {
 	char* tracetag;
 } arcan_vobject;
 
-/* regular old- linked list, but also mapped to an array */
+/* regular old- linked list sorted on (order, seq), with skip list levels */
 struct arcan_vobject_litem {
 	arcan_vobject* elem;
 	struct arcan_vobject_litem* next;
 	struct arcan_vobject_litem* previous;
+
+/* attach sequence, breaks ties between items of the same order, and the
+ * order of elem at the time of attachment (the sort key) */
+	uint64_t seq;
+	int order;
+
+/* skip[i] is the next item on level i+1, valid for i < height - 1 */
+	uint8_t height;
+	struct arcan_vobject_litem* skip[LITEM_SKIP];
+
+/* spatial index state, covered cell range and which set it belongs to */
+	struct pick_index* pick;
+	int cx1, cy1, cx2, cy2;
+	uint32_t stamp;
+	uint8_t pick_state;
+	bool pick_queued;
 };
 typedef struct arcan_vobject_litem arcan_vobject_litem;
 
@@ -311,6 +348,10 @@ struct arcan_video_display {
 
 	int dirty;
 	size_t ignore_dirty;
+	bool no_batch;
+	bool no_occlusion;
+	bool no_pickindex;
+	bool no_3dcull;
 	enum arcan_order3d order3d;
 
 /*
@@ -398,6 +439,12 @@ unsigned arcan_vint_refresh(float fragment, size_t* ndirty);
 void arcan_resolve_vidprop(arcan_vobject* vobj,
 	float lerp, surface_properties* props);
 
+/*
+ * flag the transformation cache of vobj and its children as stale, for
+ * changes to properties (origw, origh, ...) made outside of arcan_video
+ */
+void arcan_vint_invalidate(arcan_vobject* vobj);
+
 arcan_vobject* arcan_video_getobject(arcan_vobj_id id);
 arcan_vobject* arcan_video_newvobject(arcan_vobj_id* id);
 
@@ -452,6 +499,12 @@ void arcan_vint_mirrormapping(float* dst, float st, float tt);
  */
 void arcan_vint_joinasynch(arcan_vobject* img, bool emit, bool force);
 
+/*
+ * collect finished asynchronous loads from the decode pool and upload them,
+ * called at the start of each refresh so the uploads are batched per frame
+ */
+void arcan_vint_flushasynch();
+
 void arcan_vint_reraster(arcan_vobject* img, struct rendertarget*);
 
 /*
@@ -469,6 +522,16 @@ arcan_vobj_id arcan_vint_nextfree();
 struct rendertarget* arcan_vint_findrt(arcan_vobject* vobj);
 struct rendertarget* arcan_vint_findrt_vstore(struct agp_vstore* st);
 
+/*
+ * Use the spatial index of [tgt] to find the pipeline items whose bounds
+ * might contain [x, y], sorted in drawing order (first drawn first). The
+ * returned array is owned by the index and valid until the next call, [n]
+ * is set to the number of items. Candidates still need to be checked with
+ * arcan_video_hittest and for visibility.
+ */
+arcan_vobject_litem** arcan_vint_pickcandidates(
+	struct rendertarget* tgt, int x, int y, size_t* n);
+
 /*
  * used by the video platform layer, assume that agp_vstore points
  * to the backing end of a rendertarget, and draw it to the bound output-rt
@@ -20,6 +20,7 @@
 #include <dlfcn.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <time.h>
 
 #ifdef FRAMESERVER_LIBRETRO_3D
 #ifdef ENABLE_RETEXTURE
@@ -40,6 +41,8 @@
 #include "ntsc/snes_ntsc.h"
 #include "sync_plot.h"
 #include "libretro.h"
+#include "pixconv.h"
+#include "rollback.h"
 
 #include "font_8x8.h"
 
@@ -121,6 +124,7 @@ static struct {
 
 /* colour conversion / filtering */
 	pixconv_fun converter;
+	const struct pixconv_kernels* pixconv;
 	uint16_t* ntsc_imb;
 	bool ntscconv;
 	snes_ntsc_t* ntscctx;
@@ -153,9 +157,17 @@ static struct {
  	bool dirty_input;
 	float aframesz;
 	int rollback_window;
-	unsigned rollback_front;
-	char* rollback_state;
+	bool rollback_delta;
+	struct rollback_ring* rollback;
 	size_t state_sz;
+
+/* for runahead = n, every frame is run, saved, then n frames are emulated
+ * with only the last one presented before the saved state is restored */
+	int runahead;
+	void* runahead_state;
+
+/* microseconds spent on serialize / encode and deserialize / decode */
+	unsigned long long savecost, pushcost, loadcost;
 	char* syspath;
 	bool res_empty;
 
@@ -299,6 +311,14 @@ static void resize_shmpage(int neww, int newh, bool first)
 	}
 }
 
+/* arcan_timemillis is too coarse for measuring state serialization */
+static unsigned long long state_micros()
+{
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return tp.tv_sec * 1000000ull + tp.tv_nsec / 1000;
+}
+
 /* overrv / overra are needed for handling rollbacks etc.
  * while still making sure the other frameskipping options are working */
 static void process_frames(int nframes, bool overrv, bool overra)
@@ -315,17 +335,50 @@ static void process_frames(int nframes, bool overrv, bool overra)
 	while(nframes--)
 		retro.run();
 
-	if (retro.skipmode <= TARGET_SKIP_ROLLBACK){
-		retro.serialize(retro.rollback_state +
-			(retro.rollback_front * retro.state_sz), retro.state_sz);
-		retro.rollback_front = (retro.rollback_front + 1)
-			% retro.rollback_window;
+	if (retro.skipmode <= TARGET_SKIP_ROLLBACK && retro.rollback){
+		unsigned long long start = state_micros();
+		retro.serialize(rollback_scratch(retro.rollback), retro.state_sz);
+
+		unsigned long long push = state_micros();
+		if (!rollback_push(retro.rollback)){
+			LOG("rollback: couldn't store state, disabling\n");
+			rollback_free(&retro.rollback);
+		}
+		retro.pushcost = state_micros() - push;
+		retro.savecost = state_micros() - start;
 	}
 
 	retro.skipframe_v = cv;
 	retro.skipframe_a = ca;
 }
 
+/*
+ * run one frame for real, keeping the audio but not the video, save, then
+ * emulate runahead frames ahead where only the last one gets presented and
+ * restore. The result is that the frame shown already reflects the input
+ * that came in runahead frames too early for the core to react to it.
+ */
+static void process_runahead()
+{
+	process_frames(1, true, false);
+
+	unsigned long long start = state_micros();
+	if (!retro.serialize(retro.runahead_state, retro.state_sz)){
+		LOG("runahead: couldn't serialize state, disabling\n");
+		retro.runahead = 0;
+		return;
+	}
+	retro.savecost = state_micros() - start;
+
+	if (retro.runahead > 1)
+		process_frames(retro.runahead - 1, true, true);
+	process_frames(1, false, true);
+
+	start = state_micros();
+	retro.deserialize(retro.runahead_state, retro.state_sz);
+	retro.loadcost = state_micros() - start;
+}
+
 #define RGB565(b, g, r) ((uint16_t)(((uint8_t)(r) >> 3) << 11) | \
 								(((uint8_t)(g) >> 2) << 5) | ((uint8_t)(b) >> 3))
 
@@ -361,84 +414,85 @@ static const uint8_t rgb565_lut6[] = {
 };
 
 static void libretro_rgb565_rgba(const uint16_t* data, shmif_pixel* outp,
-	unsigned width, unsigned height, size_t pitch)
+	unsigned width, unsigned height, size_t pitch, bool postfilter)
 {
-	uint16_t* interm = retro.ntsc_imb;
 	retro.colorspace = "RGB565->RGBA";
 
+	if (!postfilter){
+		pixconv_frame(retro.pixconv, PIXCONV_RGB565,
+			data, pitch, outp, retro.shmcont.pitch, width, height);
+		return;
+	}
+
 /* with NTSC on, the input format is already correct */
+	uint16_t* interm = retro.ntsc_imb;
 	for (int y = 0; y < height; y++){
 		for (int x = 0; x < width; x++){
 			uint16_t val = data[x];
 			uint8_t r = rgb565_lut5[ (val & 0xf800) >> 11 ];
 			uint8_t g = rgb565_lut6[ (val & 0x07e0) >> 5  ];
 			uint8_t b = rgb565_lut5[ (val & 0x001f)       ];
-
-			if (retro.ntscconv)
-				*interm++ = RGB565(r, g, b);
-			else
-				*outp++ = RGBA(r, g, b, 0xff);
+			*interm++ = RGB565(r, g, b);
 		}
 		data += pitch >> 1;
 	}
 
-	if (retro.ntscconv)
-		push_ntsc(width, height, retro.ntsc_imb, outp);
-
-	return;
+	push_ntsc(width, height, retro.ntsc_imb, outp);
 }
 
 static void libretro_xrgb888_rgba(const uint32_t* data, uint32_t* outp,
-	unsigned width, unsigned height, size_t pitch)
+	unsigned width, unsigned height, size_t pitch, bool postfilter)
 {
 	assert( (uintptr_t)data % 4 == 0 );
 	retro.colorspace = "XRGB888->RGBA";
 
-	uint16_t* interm = retro.ntsc_imb;
+	if (!postfilter){
+		pixconv_frame(retro.pixconv, PIXCONV_XRGB8888,
+			data, pitch, outp, retro.shmcont.pitch, width, height);
+		return;
+	}
 
+	uint16_t* interm = retro.ntsc_imb;
 	for (int y = 0; y < height; y++){
 		for (int x = 0; x < width; x++){
 			uint8_t* quad = (uint8_t*) (data + x);
-			if (retro.ntscconv)
-				*interm++ = RGB565(quad[2], quad[1], quad[0]);
-			else
-				*outp++ = RGBA(quad[2], quad[1], quad[0], 0xff);
+			*interm++ = RGB565(quad[2], quad[1], quad[0]);
 		}
 
 		data += pitch >> 2;
 	}
 
-	if (retro.ntscconv)
-		push_ntsc(width, height, retro.ntsc_imb, outp);
+	push_ntsc(width, height, retro.ntsc_imb, outp);
 }
 
 static void libretro_rgb1555_rgba(const uint16_t* data, uint32_t* outp,
 	unsigned width, unsigned height, size_t pitch, bool postfilter)
 {
-	uint16_t* interm = retro.ntsc_imb;
 	retro.colorspace = "RGB1555->RGBA";
 
 	unsigned dh = height >= ARCAN_SHMPAGE_MAXH ? ARCAN_SHMPAGE_MAXH : height;
 	unsigned dw =  width >= ARCAN_SHMPAGE_MAXW ? ARCAN_SHMPAGE_MAXW : width;
 
+	if (!postfilter){
+		pixconv_frame(retro.pixconv, PIXCONV_RGB1555,
+			data, pitch, outp, retro.shmcont.pitch, dw, dh);
+		return;
+	}
+
+	uint16_t* interm = retro.ntsc_imb;
 	for (int y = 0; y < dh; y++){
 		for (int x = 0; x < dw; x++){
 			uint16_t val = data[x];
 			uint8_t r = ((val & 0x7c00) >> 10) << 3;
 			uint8_t g = ((val & 0x03e0) >>  5) << 3;
 			uint8_t b = ( val & 0x001f) <<  3;
-
-			if (postfilter)
-				*interm++ = RGB565(r, g, b);
-			else
-				*outp++ = RGBA(r, g, b, 0xff);
+			*interm++ = RGB565(r, g, b);
 		}
 
 		data += pitch >> 1;
 	}
 
-	if (postfilter)
-		push_ntsc(width, height, retro.ntsc_imb, outp);
+	push_ntsc(width, height, retro.ntsc_imb, outp);
 }
 
 
@@ -563,14 +617,18 @@ static void reset_timing(bool newstate)
 		if (retro.rollback_window > 10)
 			retro.rollback_window = 10;
 
-		free(retro.rollback_state);
-		retro.rollback_state = malloc(retro.state_sz * retro.rollback_window);
-		retro.rollback_front = 0;
+		rollback_free(&retro.rollback);
+		retro.rollback = rollback_alloc(
+			retro.state_sz, retro.rollback_window, retro.rollback_delta);
+		if (!retro.rollback){
+			LOG("couldn't allocate input rollback (%d)\n", retro.rollback_window);
+			return;
+		}
 
-		retro.serialize(retro.rollback_state, retro.state_sz);
-		for (int i=1; i < retro.rollback_window - 1; i++)
-			memcpy(retro.rollback_state + (i*retro.state_sz),
-				retro.rollback_state, retro.state_sz);
+/* fill the ring with the current state, in delta mode the copies are free */
+		retro.serialize(rollback_scratch(retro.rollback), retro.state_sz);
+		for (int i=0; i < retro.rollback_window; i++)
+			rollback_push(retro.rollback);
 
 		LOG("setting input rollback (%d)\n", retro.rollback_window);
 	}
@@ -1684,6 +1742,7 @@ static void dump_help()
 		" vbufc   \t num       \t (1) 1..4 - number of video buffers\n"
 		" abufc   \t num       \t (8) 1..16 - number of audio buffers\n"
 		" abufsz  \t num       \t audio buffer size in bytes (default = probe)\n"
+		" runahead\t num       \t (0) 0..8 - frames to emulate ahead (needs savestates)\n"
     " noreset \t           \t (3D) disable context reset calls\n"
     "---------\t-----------\t-----------------\n"
 	);
@@ -1700,6 +1759,8 @@ int	afsrv_game(struct arcan_shmif_cont* cont, struct arg_arr* args)
 	}
 
 	retro.converter = (pixconv_fun) libretro_rgb1555_rgba;
+	retro.pixconv = pixconv_select();
+	LOG("pixel conversion: %s\n", retro.pixconv->name);
 	retro.inargs = args;
 	retro.shmcont = *cont;
 
@@ -1727,6 +1788,14 @@ int	afsrv_game(struct arcan_shmif_cont* cont, struct arg_arr* args)
 		retro.def_abuf_sz = strtoul(val, NULL, 10);
 	}
 
+	if (arg_lookup(args, "runahead", 0, &val)){
+		unsigned long frames = strtoul(val, NULL, 10);
+		retro.runahead = frames < 8 ? frames : 8;
+	}
+
+/* delta encode the rollback ring, less memory for more CPU per frame */
+	retro.rollback_delta = arg_lookup(args, "rollback_delta", 0, NULL);
+
 /* system directory doesn't really match any of arcan namespaces,
  * provide some kind of global-  user overridable way */
 	const char* spath = getenv("ARCAN_LIBRETRO_SYSPATH");
@@ -1829,8 +1898,13 @@ int	afsrv_game(struct arcan_shmif_cont* cont, struct arg_arr* args)
 /* some cores die on this kind of reset, retro.reset() e.g. NXengine
  * retro_reset() */
 
-	if (retro.state_sz > 0)
-		retro.rollback_state = malloc(retro.state_sz);
+	if (retro.runahead > 0 && retro.state_sz > 0)
+		retro.runahead_state = malloc(retro.state_sz);
+
+	if (retro.runahead > 0 && !retro.runahead_state){
+		LOG("runahead requires savestate support, disabling\n");
+		retro.runahead = 0;
+	}
 
 /* basetime is used as epoch for all other timing calculations, run
  * an initial frame because sometimes first run can introduce a large stall */
@@ -1862,10 +1936,12 @@ int	afsrv_game(struct arcan_shmif_cont* cont, struct arg_arr* args)
 				TARGET_SKIP_STEP + 1, false);
 
 		else if (retro.skipmode <= TARGET_SKIP_ROLLBACK &&
-			retro.dirty_input){
-/* last entry will always be the current front */
-			retro.deserialize(retro.rollback_state +
-				retro.state_sz * retro.rollback_front, retro.state_sz);
+			retro.rollback && retro.dirty_input){
+/* oldest entry in the window */
+			start = state_micros();
+			retro.deserialize(rollback_get(retro.rollback,
+				retro.rollback_window - 1), retro.state_sz);
+			retro.loadcost = state_micros() - start;
 
 /* rollback to desired "point", run frame (which will consume input)
  * then roll forward to next video frame */
@@ -1879,7 +1955,10 @@ int	afsrv_game(struct arcan_shmif_cont* cont, struct arg_arr* args)
  * testing by adding delays at various key synchronization points */
 		start = arcan_timemillis();
 			add_jitter(retro.jitterstep);
-			process_frames(1, false, false);
+			if (retro.runahead > 0 && retro.skipmode > TARGET_SKIP_ROLLBACK)
+				process_runahead();
+			else
+				process_frames(1, false, false);
 		stop = arcan_timemillis();
 		retro.framecost = stop - start;
 		if (retro.sync_data){
@@ -1888,7 +1967,7 @@ int	afsrv_game(struct arcan_shmif_cont* cont, struct arg_arr* args)
 		}
 
 #ifdef _DEBUG
-		if (testcounter != 1){
+		if (testcounter != 1 && testcounter != retro.runahead + 1){
 			static bool countwarn = 0;
 			if (!countwarn && (countwarn = true))
 				LOG("inconsistent core behavior, "
@@ -1936,12 +2015,23 @@ static void push_stats()
 	char scratch[512];
 	long long int timestamp = arcan_timemillis();
 
+/* state memory is the ring (or the single runahead copy) against what the
+ * same window would take as raw copies, the price for the difference is the
+ * push (delta encoding) part of the save cost */
+	struct rollback_stats rbs = {0};
+	if (retro.rollback)
+		rollback_stats(retro.rollback, &rbs);
+	else if (retro.runahead_state && retro.runahead > 0)
+		rbs.raw = rbs.used = retro.state_sz;
+
 	snprintf(scratch, 512, "%s, %s\n"
 		"%s, %f fps, %f Hz\n"
 		"Mode: %d, Preaudio: %d\n Jitter: %d/%d\n"
 		"(A,V - A/V) %lld, %lld - %lld\n"
 		"Real (Hz): %f\n"
-		"cost,wake,xfer: %d, %d, %d ms \n",
+		"cost,wake,xfer: %d, %d, %d ms \n"
+		"State: %zu/%zu KiB (%zu keys), Ahead: %d\n"
+		"save,push,load: %llu, %llu, %llu us\n",
 		(char*)retro.sysinfo.library_name,
 		(char*)retro.sysinfo.library_version,
 		(char*)retro.colorspace,
@@ -1953,7 +2043,9 @@ static void push_stats()
 		retro.aframecount / retro.vframecount,
 		1000.0f * (float)retro.aframecount /
 			(float)(timestamp - retro.basetime),
-		retro.framecost, retro.prewake, retro.transfercost
+		retro.framecost, retro.prewake, retro.transfercost,
+		rbs.used / 1024, rbs.raw / 1024, rbs.keyframes, retro.runahead,
+		retro.savecost, retro.pushcost, retro.loadcost
 	);
 
 	if (!retro.sync_data->update(
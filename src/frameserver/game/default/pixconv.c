@@ -0,0 +1,346 @@
+/*
+ * License: 3-Clause BSD, see COPYING file in arcan source repository.
+ * Reference: http://arcan-fe.com
+ * Description: libretro framebuffer to shmif pixel conversion kernels, see
+ * pixconv.h for the overall flow.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PIXCONV_X86
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "pixconv.h"
+
+#define OPAQUE 0xff000000
+
+/*
+ * 5/6 bit to 8 bit with rounding, (x * 255 + n / 2) / n, written so that
+ * all intermediates fit in 16 bits for the vector versions. These match the
+ * lookup tables the frameserver used to have exactly.
+ */
+#define EXPAND5(X) (((X) * 527 + 23) >> 6)
+#define EXPAND6(X) (((X) * 259 + 33) >> 6)
+
+static void rgb1555_scalar(const uint16_t* in, uint32_t* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++){
+		uint32_t v = in[i];
+		out[i] = OPAQUE |
+			(((v >> 10) & 0x1f) << 19) | (((v >> 5) & 0x1f) << 11) | ((v & 0x1f) << 3);
+	}
+}
+
+static void rgb565_scalar(const uint16_t* in, uint32_t* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++){
+		uint32_t v = in[i];
+		out[i] = OPAQUE |
+			(EXPAND5(v >> 11) << 16) | (EXPAND6((v >> 5) & 0x3f) << 8) |
+			EXPAND5(v & 0x1f);
+	}
+}
+
+static void xrgb8888_scalar(const uint32_t* in, uint32_t* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		out[i] = in[i] | OPAQUE;
+}
+
+#ifdef PIXCONV_X86
+/*
+ * The 16-bit variants all end the same way, [gb] holds (g << 8 | b) and
+ * [ar] (0xff00 | r) per pixel, and interleaving them gives 0xAARRGGBB.
+ */
+TARGET_SSE2 static void rgb1555_sse2(const uint16_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	__m128i m5 = _mm_set1_epi16(0x1f);
+	__m128i a = _mm_set1_epi16((short) 0xff00);
+
+	for (; i + 8 <= n; i += 8){
+		__m128i v = _mm_loadu_si128((const __m128i*) &in[i]);
+		__m128i r = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 10), m5), 3);
+		__m128i g = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 5), m5), 3);
+		__m128i b = _mm_slli_epi16(_mm_and_si128(v, m5), 3);
+		__m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+		__m128i ar = _mm_or_si128(a, r);
+		_mm_storeu_si128((__m128i*) &out[i], _mm_unpacklo_epi16(gb, ar));
+		_mm_storeu_si128((__m128i*) &out[i+4], _mm_unpackhi_epi16(gb, ar));
+	}
+
+	rgb1555_scalar(&in[i], &out[i], n - i);
+}
+
+TARGET_SSE2 static void rgb565_sse2(const uint16_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	__m128i m5 = _mm_set1_epi16(0x1f);
+	__m128i m6 = _mm_set1_epi16(0x3f);
+	__m128i k5 = _mm_set1_epi16(527);
+	__m128i k6 = _mm_set1_epi16(259);
+	__m128i r5 = _mm_set1_epi16(23);
+	__m128i r6 = _mm_set1_epi16(33);
+	__m128i a = _mm_set1_epi16((short) 0xff00);
+
+	for (; i + 8 <= n; i += 8){
+		__m128i v = _mm_loadu_si128((const __m128i*) &in[i]);
+		__m128i r = _mm_srli_epi16(v, 11);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(v, 5), m6);
+		__m128i b = _mm_and_si128(v, m5);
+		r = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(r, k5), r5), 6);
+		g = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(g, k6), r6), 6);
+		b = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(b, k5), r5), 6);
+		__m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+		__m128i ar = _mm_or_si128(a, r);
+		_mm_storeu_si128((__m128i*) &out[i], _mm_unpacklo_epi16(gb, ar));
+		_mm_storeu_si128((__m128i*) &out[i+4], _mm_unpackhi_epi16(gb, ar));
+	}
+
+	rgb565_scalar(&in[i], &out[i], n - i);
+}
+
+TARGET_SSE2 static void xrgb8888_sse2(const uint32_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	__m128i a = _mm_set1_epi32((int) OPAQUE);
+
+	for (; i + 8 <= n; i += 8){
+		__m128i v0 = _mm_loadu_si128((const __m128i*) &in[i]);
+		__m128i v1 = _mm_loadu_si128((const __m128i*) &in[i+4]);
+		_mm_storeu_si128((__m128i*) &out[i], _mm_or_si128(v0, a));
+		_mm_storeu_si128((__m128i*) &out[i+4], _mm_or_si128(v1, a));
+	}
+
+	xrgb8888_scalar(&in[i], &out[i], n - i);
+}
+
+/* unpack works within 128-bit lanes, so the halves need to be swapped back */
+#define AVX2_STORE(DST, GB, AR) do {\
+	__m256i lo = _mm256_unpacklo_epi16(GB, AR);\
+	__m256i hi = _mm256_unpackhi_epi16(GB, AR);\
+	_mm256_storeu_si256((__m256i*) (DST), _mm256_permute2x128_si256(lo, hi, 0x20));\
+	_mm256_storeu_si256((__m256i*) (DST) + 1, _mm256_permute2x128_si256(lo, hi, 0x31));\
+} while (0)
+
+TARGET_AVX2 static void rgb1555_avx2(const uint16_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	__m256i m5 = _mm256_set1_epi16(0x1f);
+	__m256i a = _mm256_set1_epi16((short) 0xff00);
+
+	for (; i + 16 <= n; i += 16){
+		__m256i v = _mm256_loadu_si256((const __m256i*) &in[i]);
+		__m256i r = _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(v, 10), m5), 3);
+		__m256i g = _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(v, 5), m5), 3);
+		__m256i b = _mm256_slli_epi16(_mm256_and_si256(v, m5), 3);
+		__m256i gb = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+		__m256i ar = _mm256_or_si256(a, r);
+		AVX2_STORE(&out[i], gb, ar);
+	}
+
+	rgb1555_scalar(&in[i], &out[i], n - i);
+}
+
+TARGET_AVX2 static void rgb565_avx2(const uint16_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	__m256i m5 = _mm256_set1_epi16(0x1f);
+	__m256i m6 = _mm256_set1_epi16(0x3f);
+	__m256i k5 = _mm256_set1_epi16(527);
+	__m256i k6 = _mm256_set1_epi16(259);
+	__m256i r5 = _mm256_set1_epi16(23);
+	__m256i r6 = _mm256_set1_epi16(33);
+	__m256i a = _mm256_set1_epi16((short) 0xff00);
+
+	for (; i + 16 <= n; i += 16){
+		__m256i v = _mm256_loadu_si256((const __m256i*) &in[i]);
+		__m256i r = _mm256_srli_epi16(v, 11);
+		__m256i g = _mm256_and_si256(_mm256_srli_epi16(v, 5), m6);
+		__m256i b = _mm256_and_si256(v, m5);
+		r = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(r, k5), r5), 6);
+		g = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(g, k6), r6), 6);
+		b = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(b, k5), r5), 6);
+		__m256i gb = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+		__m256i ar = _mm256_or_si256(a, r);
+		AVX2_STORE(&out[i], gb, ar);
+	}
+
+	rgb565_scalar(&in[i], &out[i], n - i);
+}
+
+TARGET_AVX2 static void xrgb8888_avx2(const uint32_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	__m256i a = _mm256_set1_epi32((int) OPAQUE);
+
+	for (; i + 16 <= n; i += 16){
+		__m256i v0 = _mm256_loadu_si256((const __m256i*) &in[i]);
+		__m256i v1 = _mm256_loadu_si256((const __m256i*) &in[i+8]);
+		_mm256_storeu_si256((__m256i*) &out[i], _mm256_or_si256(v0, a));
+		_mm256_storeu_si256((__m256i*) &out[i+8], _mm256_or_si256(v1, a));
+	}
+
+	xrgb8888_scalar(&in[i], &out[i], n - i);
+}
+#endif
+
+#ifdef __ARM_NEON
+/* narrow to bytes and let the interleaving store build B, G, R, A */
+static void rgb1555_neon(const uint16_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	uint16x8_t m5 = vdupq_n_u16(0x1f);
+
+	for (; i + 8 <= n; i += 8){
+		uint16x8_t v = vld1q_u16(&in[i]);
+		uint8x8x4_t px = {{
+			vmovn_u16(vshlq_n_u16(vandq_u16(v, m5), 3)),
+			vmovn_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(v, 5), m5), 3)),
+			vmovn_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(v, 10), m5), 3)),
+			vdup_n_u8(0xff)
+		}};
+		vst4_u8((uint8_t*) &out[i], px);
+	}
+
+	rgb1555_scalar(&in[i], &out[i], n - i);
+}
+
+static void rgb565_neon(const uint16_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	uint16x8_t m5 = vdupq_n_u16(0x1f);
+	uint16x8_t m6 = vdupq_n_u16(0x3f);
+	uint16x8_t r5 = vdupq_n_u16(23);
+	uint16x8_t r6 = vdupq_n_u16(33);
+
+	for (; i + 8 <= n; i += 8){
+		uint16x8_t v = vld1q_u16(&in[i]);
+		uint16x8_t r = vshrq_n_u16(v, 11);
+		uint16x8_t g = vandq_u16(vshrq_n_u16(v, 5), m6);
+		uint16x8_t b = vandq_u16(v, m5);
+		uint8x8x4_t px = {{
+			vmovn_u16(vshrq_n_u16(vmlaq_n_u16(r5, b, 527), 6)),
+			vmovn_u16(vshrq_n_u16(vmlaq_n_u16(r6, g, 259), 6)),
+			vmovn_u16(vshrq_n_u16(vmlaq_n_u16(r5, r, 527), 6)),
+			vdup_n_u8(0xff)
+		}};
+		vst4_u8((uint8_t*) &out[i], px);
+	}
+
+	rgb565_scalar(&in[i], &out[i], n - i);
+}
+
+static void xrgb8888_neon(const uint32_t* in, uint32_t* out, size_t n)
+{
+	size_t i = 0;
+	uint32x4_t a = vdupq_n_u32(OPAQUE);
+
+	for (; i + 8 <= n; i += 8){
+		vst1q_u32(&out[i], vorrq_u32(vld1q_u32(&in[i]), a));
+		vst1q_u32(&out[i+4], vorrq_u32(vld1q_u32(&in[i+4]), a));
+	}
+
+	xrgb8888_scalar(&in[i], &out[i], n - i);
+}
+#endif
+
+static const struct pixconv_kernels variants[] = {
+	[PIXCONV_SCALAR] = {
+		.name = "scalar",
+		.rgb1555 = rgb1555_scalar,
+		.rgb565 = rgb565_scalar,
+		.xrgb8888 = xrgb8888_scalar
+	},
+#ifdef PIXCONV_X86
+	[PIXCONV_SSE2] = {
+		.name = "sse2",
+		.rgb1555 = rgb1555_sse2,
+		.rgb565 = rgb565_sse2,
+		.xrgb8888 = xrgb8888_sse2
+	},
+	[PIXCONV_AVX2] = {
+		.name = "avx2",
+		.rgb1555 = rgb1555_avx2,
+		.rgb565 = rgb565_avx2,
+		.xrgb8888 = xrgb8888_avx2
+	},
+#endif
+#ifdef __ARM_NEON
+	[PIXCONV_NEON] = {
+		.name = "neon",
+		.rgb1555 = rgb1555_neon,
+		.rgb565 = rgb565_neon,
+		.xrgb8888 = xrgb8888_neon
+	},
+#endif
+};
+
+const struct pixconv_kernels* pixconv_variant(enum pixconv_simd simd)
+{
+	if (simd >= sizeof(variants) / sizeof(variants[0]) || !variants[simd].name)
+		return NULL;
+
+#ifdef PIXCONV_X86
+	__builtin_cpu_init();
+	if (simd == PIXCONV_SSE2 && !__builtin_cpu_supports("sse2"))
+		return NULL;
+
+	if (simd == PIXCONV_AVX2 && !__builtin_cpu_supports("avx2"))
+		return NULL;
+#endif
+
+	return &variants[simd];
+}
+
+const struct pixconv_kernels* pixconv_select()
+{
+	static const struct pixconv_kernels* best;
+	if (best)
+		return best;
+
+	const enum pixconv_simd order[] = {
+		PIXCONV_AVX2, PIXCONV_SSE2, PIXCONV_NEON, PIXCONV_SCALAR};
+
+	for (size_t i = 0; i < sizeof(order) / sizeof(order[0]) && !best; i++)
+		best = pixconv_variant(order[i]);
+
+	return best;
+}
+
+void pixconv_frame(const struct pixconv_kernels* k, enum pixconv_fmt fmt,
+	const void* in, size_t in_pitch,
+	uint32_t* out, size_t out_pitch, size_t w, size_t h)
+{
+	size_t bpp = fmt == PIXCONV_XRGB8888 ? 4 : 2;
+
+/* contiguous on both ends, treat as one long row */
+	if (in_pitch == w * bpp && out_pitch == w){
+		w *= h;
+		h = 1;
+	}
+
+	const uint8_t* src = in;
+	for (size_t y = 0; y < h; y++){
+		switch (fmt){
+		case PIXCONV_RGB1555:
+			k->rgb1555((const uint16_t*) src, out, w);
+		break;
+		case PIXCONV_RGB565:
+			k->rgb565((const uint16_t*) src, out, w);
+		break;
+		case PIXCONV_XRGB8888:
+			k->xrgb8888((const uint32_t*) src, out, w);
+		break;
+		}
+		src += in_pitch;
+		out += out_pitch;
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ * License: 3-Clause BSD, see COPYING file in arcan source repository.
+ * Reference: http://arcan-fe.com
+ */
+
+#ifndef HAVE_PIXCONV
+#define HAVE_PIXCONV
+
+/*
+ * Pixel format conversion from the libretro framebuffer formats to the
+ * shmif one (0xAARRGGBB, see SHMIF_RGBA) with alpha forced to opaque.
+ *
+ * There are scalar, SSE2, AVX2 and NEON versions of each kernel. The best
+ * one for the running CPU is picked on first use, AVX2 is only built and
+ * selected on x86 compilers that support per-function targets. All
+ * variants produce bit-identical output. There are no dependencies on the
+ * rest of the frameserver so that the kernels can be benchmarked and
+ * tested in isolation (see tests/benchmark/pixconv).
+ */
+
+enum pixconv_fmt {
+	PIXCONV_RGB1555 = 0,
+	PIXCONV_RGB565,
+	PIXCONV_XRGB8888
+};
+
+enum pixconv_simd {
+	PIXCONV_SCALAR = 0,
+	PIXCONV_SSE2,
+	PIXCONV_AVX2,
+	PIXCONV_NEON
+};
+
+struct pixconv_kernels {
+	const char* name;
+
+/* convert [n] pixels from [in] to [out], no alignment requirements */
+	void (*rgb1555)(const uint16_t* in, uint32_t* out, size_t n);
+	void (*rgb565)(const uint16_t* in, uint32_t* out, size_t n);
+	void (*xrgb8888)(const uint32_t* in, uint32_t* out, size_t n);
+};
+
+/* the fastest variant supported by the running CPU */
+const struct pixconv_kernels* pixconv_select();
+
+/*
+ * a specific variant, returns NULL if it was not built in or the running
+ * CPU lacks support for it
+ */
+const struct pixconv_kernels* pixconv_variant(enum pixconv_simd);
+
+/*
+ * convert a [w * h] frame where input rows are [in_pitch] bytes apart and
+ * output rows [out_pitch] pixels apart. If both are tightly packed the
+ * whole frame is converted as a single run.
+ */
+void pixconv_frame(const struct pixconv_kernels* k, enum pixconv_fmt fmt,
+	const void* in, size_t in_pitch,
+	uint32_t* out, size_t out_pitch, size_t w, size_t h);
+
+#endif
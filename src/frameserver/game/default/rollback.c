@@ -0,0 +1,316 @@
+/*
+ * License: 3-Clause BSD, see COPYING file in arcan source repository.
+ * Reference: http://arcan-fe.com
+ * Description: ring of core states used for input rollback, either raw
+ * copies or keyframe + XOR delta encoded, see rollback.h for the encoding.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rollback.h"
+
+/*
+ * a delta larger than 1/KEY_DIVISOR of the state makes the snapshot the
+ * next keyframe, if the previous keyframe is no longer referenced. The
+ * keyframe copy costs less than the encoding pass so this can be low, it
+ * keeps the deltas from drifting. With two keyframe buffers that happens at
+ * most once per [window] pushes, a higher divisor gives fewer keyframes but
+ * larger deltas to encode and decode, which costs more than the copies.
+ */
+#define KEY_DIVISOR 64
+
+/* words per delta block, the block mask in a token is this many bits */
+#define BLOCK_WORDS 16
+
+struct snapshot {
+/* tokens and literal words, [used] of [cap] words, or the raw copy */
+	uint64_t* buf;
+	size_t used, cap;
+
+/* which of the keyframe buffers the delta is against */
+	int key;
+};
+
+struct rollback_ring {
+	size_t state_sz;
+	size_t words;
+
+	uint64_t* scratch;
+	uint64_t* keys[2];
+	size_t refs[2];
+	int key;
+	size_t keyframes;
+
+/* scratch may have been written to since the last push */
+	bool dirty;
+
+/* slots hold deltas against the keyframes rather than raw copies */
+	bool delta;
+
+/* [front] is the slot the next push goes into */
+	size_t window, count, front;
+	struct snapshot slots[];
+};
+
+static bool reserve(struct snapshot* s, size_t words)
+{
+	if (words <= s->cap)
+		return true;
+
+	size_t cap = s->cap ? s->cap : 64;
+	while (cap < words)
+		cap <<= 1;
+
+	uint64_t* buf = realloc(s->buf, cap * sizeof(uint64_t));
+	if (!buf)
+		return false;
+
+	s->buf = buf;
+	s->cap = cap;
+	return true;
+}
+
+static bool encode(struct rollback_ring* r, struct snapshot* s)
+{
+	const uint64_t* key = r->keys[r->key];
+	const uint64_t* cur = r->scratch;
+	size_t last = 0;
+
+	s->used = 0;
+	s->key = r->key;
+
+	for (size_t ofs = 0; ofs < r->words; ofs += BLOCK_WORDS){
+		const uint64_t* c = &cur[ofs];
+		const uint64_t* k = &key[ofs];
+
+/* most of the state is unchanged, no early exit here so this vectorizes */
+		uint64_t acc = 0;
+		for (size_t i = 0; i < BLOCK_WORDS; i++)
+			acc |= c[i] ^ k[i];
+
+		if (!acc)
+			continue;
+
+		if (!reserve(s, s->used + BLOCK_WORDS + 1))
+			return false;
+
+/* store every word and only advance on a difference, avoids branching on
+ * each word as changes tend to be scattered */
+		uint64_t* tok = &s->buf[s->used++];
+		uint64_t* out = &s->buf[s->used];
+		uint32_t mask = 0;
+		size_t n = 0;
+
+		for (size_t i = 0; i < BLOCK_WORDS; i++){
+			uint64_t d = c[i] ^ k[i];
+			out[n] = d;
+			mask |= (uint32_t)(d != 0) << i;
+			n += d != 0;
+		}
+
+		*tok = ((uint64_t)(ofs / BLOCK_WORDS - last) << 32) | mask;
+		s->used += n;
+		last = ofs / BLOCK_WORDS;
+	}
+
+	return true;
+}
+
+/* the scratch contents are the same as the newest snapshot, reuse its delta */
+static bool repeat(struct rollback_ring* r, struct snapshot* s)
+{
+	const struct snapshot* prev =
+		&r->slots[(r->front + r->window - 1) % r->window];
+
+	if (prev == s)
+		return true;
+
+	if (!reserve(s, prev->used))
+		return false;
+
+	memcpy(s->buf, prev->buf, prev->used * sizeof(uint64_t));
+	s->used = prev->used;
+	s->key = prev->key;
+	return true;
+}
+
+static void decode(struct rollback_ring* r, const struct snapshot* s)
+{
+	uint64_t* out = r->scratch;
+	size_t block = 0;
+
+	memcpy(out, r->keys[s->key], r->words * sizeof(uint64_t));
+
+	for (size_t i = 0; i < s->used;){
+		uint64_t tok = s->buf[i++];
+		uint32_t mask = tok & 0xffffffff;
+		block += tok >> 32;
+
+		uint64_t* dst = &out[block * BLOCK_WORDS];
+		while (mask){
+			dst[__builtin_ctz(mask)] ^= s->buf[i++];
+			mask &= mask - 1;
+		}
+	}
+}
+
+static void make_key(struct rollback_ring* r, struct snapshot* s)
+{
+	r->key = r->keyframes ? !r->key : 0;
+	memcpy(r->keys[r->key], r->scratch, r->words * sizeof(uint64_t));
+	r->keyframes++;
+
+	s->used = 0;
+	s->key = r->key;
+}
+
+struct rollback_ring* rollback_alloc(
+	size_t state_sz, size_t window, bool delta)
+{
+/* padded to whole blocks, the token format limits skips to 32 bits */
+	size_t block_sz = BLOCK_WORDS * sizeof(uint64_t);
+	size_t words = (state_sz + block_sz - 1) / block_sz * BLOCK_WORDS;
+	if (!state_sz || !window || words / BLOCK_WORDS > UINT32_MAX)
+		return NULL;
+
+	struct rollback_ring* r = malloc(
+		sizeof(struct rollback_ring) + window * sizeof(struct snapshot));
+	if (!r)
+		return NULL;
+
+	*r = (struct rollback_ring){
+		.state_sz = state_sz,
+		.words = words,
+		.window = window,
+		.delta = delta
+	};
+	memset(r->slots, '\0', window * sizeof(struct snapshot));
+
+/* zeroed so that the padding after state_sz never shows up in a delta */
+	r->scratch = calloc(words, sizeof(uint64_t));
+	if (!r->scratch){
+		rollback_free(&r);
+		return NULL;
+	}
+
+	if (delta){
+		r->keys[0] = calloc(words, sizeof(uint64_t));
+		r->keys[1] = calloc(words, sizeof(uint64_t));
+		if (!r->keys[0] || !r->keys[1])
+			rollback_free(&r);
+		return r;
+	}
+
+	for (size_t i = 0; i < window; i++){
+		struct snapshot* s = &r->slots[i];
+		if (!(s->buf = malloc(words * sizeof(uint64_t)))){
+			rollback_free(&r);
+			return NULL;
+		}
+		s->used = s->cap = words;
+	}
+
+	return r;
+}
+
+void rollback_free(struct rollback_ring** ring)
+{
+	if (!ring || !*ring)
+		return;
+
+	struct rollback_ring* r = *ring;
+	for (size_t i = 0; i < r->window; i++)
+		free(r->slots[i].buf);
+
+	free(r->scratch);
+	free(r->keys[0]);
+	free(r->keys[1]);
+	free(r);
+	*ring = NULL;
+}
+
+void* rollback_scratch(struct rollback_ring* r)
+{
+	r->dirty = true;
+	return r->scratch;
+}
+
+bool rollback_push(struct rollback_ring* r)
+{
+	struct snapshot* s = &r->slots[r->front];
+
+	if (!r->delta){
+		memcpy(s->buf, r->scratch, r->state_sz);
+		if (r->count < r->window)
+			r->count++;
+		r->front = (r->front + 1) % r->window;
+		return true;
+	}
+
+	if (r->count == r->window)
+		r->refs[s->key]--;
+	else
+		r->count++;
+
+	if (!r->keyframes)
+		make_key(r, s);
+
+	else {
+		if (!(r->dirty ? encode(r, s) : repeat(r, s)))
+			return false;
+
+		if (s->used > r->words / KEY_DIVISOR && r->refs[!r->key] == 0)
+			make_key(r, s);
+
+/* don't let one large delta pin its buffer size forever */
+		if (s->cap > 64 && s->cap > 4 * s->used){
+			size_t cap = s->used > 32 ? 2 * s->used : 64;
+			uint64_t* buf = realloc(s->buf, cap * sizeof(uint64_t));
+			if (buf){
+				s->buf = buf;
+				s->cap = cap;
+			}
+		}
+	}
+
+	r->refs[s->key]++;
+	r->front = (r->front + 1) % r->window;
+	r->dirty = false;
+	return true;
+}
+
+const void* rollback_get(struct rollback_ring* r, size_t age)
+{
+	if (!r->count)
+		return NULL;
+
+	if (age >= r->count)
+		age = r->count - 1;
+
+	const struct snapshot* s =
+		&r->slots[(r->front + r->window - 1 - age) % r->window];
+
+	if (r->delta)
+		decode(r, s);
+	else
+		memcpy(r->scratch, s->buf, r->state_sz);
+
+	r->dirty = true;
+	return r->scratch;
+}
+
+void rollback_stats(struct rollback_ring* r, struct rollback_stats* out)
+{
+	*out = (struct rollback_stats){
+		.count = r->count,
+		.raw = r->count * r->state_sz,
+		.used = (r->delta ? 3 : 1) * r->words * sizeof(uint64_t),
+		.keyframes = r->keyframes
+	};
+
+	for (size_t i = 0; i < r->window; i++)
+		out->used += r->slots[i].cap * sizeof(uint64_t);
+}
@@ -0,0 +1,82 @@
+/*
+ * License: 3-Clause BSD, see COPYING file in arcan source repository.
+ * Reference: http://arcan-fe.com
+ */
+
+#ifndef HAVE_ROLLBACK
+#define HAVE_ROLLBACK
+
+/*
+ * Ring of serialized core states for input rollback.
+ *
+ * By default the ring keeps [window] raw copies. In delta mode it instead
+ * holds a keyframe and stores each snapshot as the XOR against it in blocks
+ * of 16 64-bit words. Only blocks that differ are stored, as a token (blocks
+ * skipped since the previous one in the upper 32 bits, a mask of the words
+ * that differ in the lower) followed by those words. Save states of most
+ * cores change very little from one frame to the next so the deltas tend to
+ * be a small fraction of the state size. When a delta grows too large and
+ * no snapshot in the ring references the previous keyframe any longer, the
+ * snapshot becomes the new keyframe and the two keyframe buffers switch
+ * roles.
+ *
+ * This trades CPU for memory: every push reads both the state and the
+ * keyframe, so it costs a few times a plain copy of the state (more the
+ * further the state has drifted from the keyframe) while the ring takes a
+ * fraction of the memory of [window] copies. That is only worth it for cores
+ * with large states, hence opt-in.
+ *
+ * Like pixconv, there are no dependencies on the rest of the frameserver
+ * (see tests/benchmark/rollback).
+ */
+
+struct rollback_ring;
+
+struct rollback_stats {
+/* number of snapshots in the ring and what they would take as raw copies */
+	size_t count;
+	size_t raw;
+
+/* bytes allocated for keyframes, scratch and deltas or copies */
+	size_t used;
+
+/* keyframes that has been taken since allocation, 0 without [delta] */
+	size_t keyframes;
+};
+
+/*
+ * allocate a ring for [window] snapshots of [state_sz] bytes each, delta
+ * encoded if [delta] is set, returns NULL on invalid arguments or if out of
+ * memory
+ */
+struct rollback_ring* rollback_alloc(
+	size_t state_sz, size_t window, bool delta);
+
+void rollback_free(struct rollback_ring**);
+
+/*
+ * buffer (at least state_sz bytes) to serialize the next snapshot into,
+ * the contents are replaced by rollback_get. Retrieve it again before each
+ * write, a push without a call to this since the last push or get repeats
+ * the previous snapshot without comparing the contents.
+ */
+void* rollback_scratch(struct rollback_ring*);
+
+/*
+ * add the contents of the scratch buffer as the newest snapshot, replacing
+ * the oldest if the ring is full. The scratch buffer is left intact so the
+ * same state can be pushed several times, cheaply. Returns false if out of memory,
+ * the ring should then be considered broken and be freed.
+ */
+bool rollback_push(struct rollback_ring*);
+
+/*
+ * decode the snapshot from [age] pushes ago (0 is the newest, clamped to
+ * the oldest one available) into the scratch buffer and return it, or NULL
+ * if the ring is empty.
+ */
+const void* rollback_get(struct rollback_ring*, size_t age);
+
+void rollback_stats(struct rollback_ring*, struct rollback_stats*);
+
+#endif
@@ -64,6 +64,32 @@ const char * defcvprg =
 " gl_Position = (projection * modelview) * vertex;\n"
 "}";
 
+static const char* definstvprg =
+"#version 120\n"
+"uniform mat4 projection;\n"
+"attribute mat4 instance_modelview;\n"
+"attribute float instance_opacity;\n"
+"attribute vec2 texcoord;\n"
+"attribute vec4 vertex;\n"
+"varying vec2 texco;\n"
+"varying float opacity;\n"
+"void main(){\n"
+"	gl_Position = (projection * instance_modelview) * vertex;\n"
+"	texco = texcoord;\n"
+"	opacity = instance_opacity;\n"
+"}";
+
+static const char* definstfprg =
+"#version 120\n"
+"uniform sampler2D map_diffuse;\n"
+"varying vec2 texco;\n"
+"varying float opacity;\n"
+"void main(){\n"
+"	vec4 col = texture2D(map_diffuse, texco);\n"
+"	col.a = col.a * opacity;\n"
+"	gl_FragColor = col;\n"
+"}";
+
 #ifdef _DEBUG
 #define DEBUG 1
 #else
@@ -81,7 +107,8 @@ const char * defcvprg =
 agp_shader_id agp_default_shader(enum SHADER_TYPES type)
 {
 	verbose_print("set shader: %s", type == BASIC_2D ? "basic_2d" :
-		(type == COLOR_2D ? "color_2d" : (type == BASIC_3D ? "basic_3d" : "invalid")));
+		(type == COLOR_2D ? "color_2d" : (type == BASIC_3D ? "basic_3d" :
+		(type == BASIC_3D_INSTANCED ? "basic_3d_instanced" : "invalid"))));
 
 	static agp_shader_id shids[SHADER_TYPE_ENDM];
 	static bool defshdr_build;
@@ -93,6 +120,8 @@ agp_shader_id agp_default_shader(enum SHADER_TYPES type)
 		shids[COLOR_2D] = agp_shader_build(
 			"DEFAULT_COLOR", NULL, defcvprg, defcfprg);
 		shids[BASIC_3D] = shids[BASIC_2D];
+		shids[BASIC_3D_INSTANCED] = agp_shader_build(
+			"DEFAULT_INSTANCED", NULL, definstvprg, definstfprg);
 		defshdr_build = true;
 	}
 
@@ -119,6 +148,11 @@ void agp_shader_source(enum SHADER_TYPES type,
 			*frag = defcfprg;
 		break;
 
+		case BASIC_3D_INSTANCED:
+			*vert = definstvprg;
+			*frag = definstfprg;
+		break;
+
 		default:
 			*vert = NULL;
 			*frag = NULL;
@@ -87,6 +87,34 @@ const char * defcvprg =
 " gl_Position = (projection * modelview) * vertex;\n"
 "}";
 
+static const char* definstvprg =
+"#version 100\n"
+"precision mediump float;\n"
+"uniform mat4 projection;\n"
+"attribute mat4 instance_modelview;\n"
+"attribute float instance_opacity;\n"
+"attribute vec2 texcoord;\n"
+"attribute vec4 vertex;\n"
+"varying vec2 texco;\n"
+"varying float opacity;\n"
+"void main(){\n"
+"	gl_Position = (projection * instance_modelview) * vertex;\n"
+"	texco = texcoord;\n"
+"	opacity = instance_opacity;\n"
+"}";
+
+static const char* definstfprg =
+"#version 100\n"
+"precision mediump float;\n"
+"uniform sampler2D map_diffuse;\n"
+"varying vec2 texco;\n"
+"varying float opacity;\n"
+"void main(){\n"
+"	vec4 col = texture2D(map_diffuse, texco);\n"
+"	col.a = col.a * opacity;\n"
+"	gl_FragColor = col;\n"
+"}";
+
 agp_shader_id agp_default_shader(enum SHADER_TYPES type)
 {
 	static agp_shader_id shids[SHADER_TYPE_ENDM];
@@ -99,6 +127,8 @@ agp_shader_id agp_default_shader(enum SHADER_TYPES type)
 		shids[COLOR_2D] = agp_shader_build(
 			"DEFAULT_COLOR", NULL, defcvprg, defcfprg);
 		shids[BASIC_3D] = shids[BASIC_2D];
+		shids[BASIC_3D_INSTANCED] = agp_shader_build(
+			"DEFAULT_INSTANCED", NULL, definstvprg, definstfprg);
 		defshdr_build = true;
 	}
 
@@ -142,6 +172,11 @@ void agp_shader_source(enum SHADER_TYPES type,
 		*frag = defcfprg;
 	break;
 
+	case BASIC_3D_INSTANCED:
+		*vert = definstvprg;
+		*frag = definstfprg;
+	break;
+
 	default:
 		*vert = NULL;
 		*frag = NULL;
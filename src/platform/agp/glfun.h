@@ -141,6 +141,13 @@ struct agp_fenv {
 	void (*stencil_op) (GLenum, GLenum, GLenum);
 	void (*draw_arrays) (GLenum, GLint, GLsizei);
 	void (*draw_elements) (GLenum, GLsizei, GLenum, const GLvoid*);
+
+/* instancing, all NULL unless the GL has both draw_instanced and divisors */
+	void (*draw_arrays_instanced) (GLenum, GLint, GLsizei, GLsizei);
+	void (*draw_elements_instanced) (
+		GLenum, GLsizei, GLenum, const GLvoid*, GLsizei);
+	void (*vertex_attrdivisor) (GLuint, GLuint);
+
 	void (*depth_mask) (GLboolean);
 	void (*depth_func) (GLenum);
 	void (*polygon_mode) (GLenum, GLenum);
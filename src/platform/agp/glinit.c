@@ -323,6 +323,40 @@ void agp_glinit_fenv(struct agp_fenv* dst,
 	dst->draw_elements =
 		(void(*)(GLenum, GLsizei, GLenum, const GLvoid*))
 			lookup(tag, "glDrawElements");
+
+/* core in GL3.3/GLES3, otherwise the ARB/EXT extensions, need all three */
+	dst->draw_arrays_instanced =
+		(void(*)(GLenum, GLint, GLsizei, GLsizei))
+			lookup_opt(tag, "glDrawArraysInstanced");
+	dst->draw_elements_instanced =
+		(void(*)(GLenum, GLsizei, GLenum, const GLvoid*, GLsizei))
+			lookup_opt(tag, "glDrawElementsInstanced");
+	dst->vertex_attrdivisor =
+		(void(*)(GLuint, GLuint))
+			lookup_opt(tag, "glVertexAttribDivisor");
+
+	if (!dst->draw_arrays_instanced && check_ext("GL_ARB_draw_instanced", ext)){
+		dst->draw_arrays_instanced =
+			(void(*)(GLenum, GLint, GLsizei, GLsizei))
+				lookup_opt(tag, "glDrawArraysInstancedARB");
+		dst->draw_elements_instanced =
+			(void(*)(GLenum, GLsizei, GLenum, const GLvoid*, GLsizei))
+				lookup_opt(tag, "glDrawElementsInstancedARB");
+	}
+
+	if (!dst->vertex_attrdivisor && check_ext("GL_ARB_instanced_arrays", ext)){
+		dst->vertex_attrdivisor =
+			(void(*)(GLuint, GLuint))
+				lookup_opt(tag, "glVertexAttribDivisorARB");
+	}
+
+	if (!dst->draw_arrays_instanced ||
+		!dst->draw_elements_instanced || !dst->vertex_attrdivisor){
+		dst->draw_arrays_instanced = NULL;
+		dst->draw_elements_instanced = NULL;
+		dst->vertex_attrdivisor = NULL;
+	}
+
 	dst->depth_mask =
 		(void(*)(GLboolean))
 			lookup(tag, "glDepthMask");
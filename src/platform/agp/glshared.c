@@ -1449,6 +1449,38 @@ void agp_draw_vobj(
 	agp_rendertarget_dirty(active_rendertarget, &(struct agp_region){});
 }
 
+void agp_draw_vobj_batch(const float* verts, const float* txcos, size_t n)
+{
+	verbose_print("draw-vobj-batch(%zu)", n);
+	struct agp_fenv* env = agp_env();
+
+	agp_shader_envv(MODELVIEW_MATR, ident, sizeof(float) * 16);
+
+	GLint attrindv = agp_shader_vattribute_loc(ATTRIBUTE_VERTEX);
+	GLint attrindt = agp_shader_vattribute_loc(ATTRIBUTE_TEXCORD0);
+
+	if (attrindv != -1){
+		bool settex = false;
+		env->enable_vertex_attrarray(attrindv);
+		env->vertex_attrpointer(attrindv, 2, GL_FLOAT, GL_FALSE, 0, verts);
+
+		if (txcos && attrindt != -1){
+			settex = true;
+			env->enable_vertex_attrarray(attrindt);
+			env->vertex_attrpointer(attrindt, 2, GL_FLOAT, GL_FALSE, 0, txcos);
+		}
+
+		env->draw_arrays(GL_TRIANGLES, 0, n * 6);
+
+		if (settex)
+			env->disable_vertex_attrarray(attrindt);
+
+		env->disable_vertex_attrarray(attrindv);
+	}
+
+	agp_rendertarget_dirty(active_rendertarget, &(struct agp_region){});
+}
+
 static void toggle_debugstates(float* modelview)
 {
 	struct agp_fenv* env = agp_env();
@@ -1488,7 +1520,50 @@ void agp_render_options(struct agp_render_options opts)
 	env->line_width(opts.line_width);
 }
 
-static void setup_transfer(struct agp_mesh_store* base, enum agp_mesh_flags fl)
+/*
+ * Bind the per-instance attributes, the modelview matrix takes four
+ * consecutive locations. Returns false if the program doesn't use them.
+ */
+static bool setup_instances(const float* inst, bool on)
+{
+	struct agp_fenv* env = agp_env();
+	int mvloc = agp_shader_vattribute_loc(ATTRIBUTE_INSTANCE_MODELVIEW);
+	int oploc = agp_shader_vattribute_loc(ATTRIBUTE_INSTANCE_OPACITY);
+	size_t stride = sizeof(float) * AGP_INSTANCE_STRIDE;
+
+	if (mvloc == -1)
+		return false;
+
+	for (size_t i = 0; i < 4; i++){
+		if (on){
+			env->enable_vertex_attrarray(mvloc + i);
+			env->vertex_attrpointer(mvloc + i,
+				4, GL_FLOAT, GL_FALSE, stride, &inst[i * 4]);
+			env->vertex_attrdivisor(mvloc + i, 1);
+		}
+		else {
+			env->vertex_attrdivisor(mvloc + i, 0);
+			env->disable_vertex_attrarray(mvloc + i);
+		}
+	}
+
+	if (oploc != -1){
+		if (on){
+			env->enable_vertex_attrarray(oploc);
+			env->vertex_attrpointer(oploc, 1, GL_FLOAT, GL_FALSE, stride, &inst[16]);
+			env->vertex_attrdivisor(oploc, 1);
+		}
+		else {
+			env->vertex_attrdivisor(oploc, 0);
+			env->disable_vertex_attrarray(oploc);
+		}
+	}
+
+	return true;
+}
+
+static void setup_transfer(struct agp_mesh_store* base,
+	enum agp_mesh_flags fl, const float* inst, size_t n_inst)
 {
 	struct agp_fenv* env = agp_env();
 	int attribs[] = {
@@ -1593,19 +1668,29 @@ static void setup_transfer(struct agp_mesh_store* base, enum agp_mesh_flags fl)
 			}
 			verbose_print(
 				"triangle-soup(indexed, %u indices)", (unsigned)base->n_indices);
-			env->draw_elements(GL_TRIANGLES,
-				base->n_indices, GL_UNSIGNED_INT, base->indices);
+			if (inst)
+				env->draw_elements_instanced(GL_TRIANGLES,
+					base->n_indices, GL_UNSIGNED_INT, base->indices, n_inst);
+			else
+				env->draw_elements(GL_TRIANGLES,
+					base->n_indices, GL_UNSIGNED_INT, base->indices);
 		}
 		else{
 			verbose_print(
 				"triangle-soup(vertices, %u vertices)", (unsigned)base->n_vertices);
-			env->draw_arrays(GL_TRIANGLES, 0, base->n_vertices);
+			if (inst)
+				env->draw_arrays_instanced(GL_TRIANGLES, 0, base->n_vertices, n_inst);
+			else
+				env->draw_arrays(GL_TRIANGLES, 0, base->n_vertices);
 		}
 	}
 	else if (base->type == AGP_MESH_POINTCLOUD){
 		verbose_print("point-cloud(%u points)", (unsigned)base->n_vertices);
 		env->enable(GL_VERTEX_PROGRAM_POINT_SIZE);
-		env->draw_arrays(GL_POINTS, 0, base->n_vertices);
+		if (inst)
+			env->draw_arrays_instanced(GL_POINTS, 0, base->n_vertices, n_inst);
+		else
+			env->draw_arrays(GL_POINTS, 0, base->n_vertices);
 		env->disable(GL_VERTEX_PROGRAM_POINT_SIZE);
 	}
 
@@ -1695,7 +1780,8 @@ static void setup_culling(struct agp_mesh_store* base, enum agp_mesh_flags fl)
 	verbose_print("depth func: %d, flags: %d", base->depth_func, fl);
 }
 
-void agp_submit_mesh(struct agp_mesh_store* base, enum agp_mesh_flags fl)
+static void submit_mesh(struct agp_mesh_store* base,
+	enum agp_mesh_flags fl, const float* inst, size_t n_inst)
 {
 /* make sure the current program actually uses the attributes from the mesh */
 	struct agp_fenv* env = agp_env();
@@ -1718,11 +1804,11 @@ void agp_submit_mesh(struct agp_mesh_store* base, enum agp_mesh_flags fl)
 #if !defined(GLES2) && !defined(GLES3)
 				env->polygon_mode(GL_FRONT_AND_BACK, GL_FILL);
 				env->color_mask(false, false, false, false);
-				setup_transfer(base, fl);
+				setup_transfer(base, fl, inst, n_inst);
 
 				env->polygon_mode(GL_FRONT_AND_BACK, GL_LINE);
 				env->color_mask(true, true, true, true);
-				setup_transfer(base, fl);
+				setup_transfer(base, fl, inst, n_inst);
 				env->polygon_mode(GL_FRONT_AND_BACK, GL_FILL);
 #else
 /* no wireframe support for GLES */
@@ -1740,10 +1826,30 @@ void agp_submit_mesh(struct agp_mesh_store* base, enum agp_mesh_flags fl)
 		env->model_flags = fl;
 	}
 
-	setup_transfer(base, fl);
+	setup_transfer(base, fl, inst, n_inst);
 	agp_rendertarget_dirty(active_rendertarget, &(struct agp_region){});
 }
 
+void agp_submit_mesh(struct agp_mesh_store* base, enum agp_mesh_flags fl)
+{
+	submit_mesh(base, fl, NULL, 0);
+}
+
+bool agp_submit_mesh_instanced(struct agp_mesh_store* base,
+	enum agp_mesh_flags fl, const float* inst, size_t n)
+{
+	struct agp_fenv* env = agp_env();
+	if (!env->vertex_attrdivisor || !inst || !n)
+		return false;
+
+	if (!setup_instances(inst, true))
+		return false;
+
+	submit_mesh(base, fl, inst, n);
+	setup_instances(inst, false);
+	return true;
+}
+
 /*
  * mark that the contents of the mesh has changed dynamically
  * and that possible GPU- side cache might need to be updated.
@@ -120,7 +120,7 @@ static char* symtbl[TBLSIZE] = {
 	"timestamp"
 };
 
-static char* attrsymtbl[9] = {
+static char* attrsymtbl[11] = {
 	"vertex",
 	"normal",
 	"color",
@@ -129,7 +129,9 @@ static char* attrsymtbl[9] = {
 	"tangent",
 	"bitangent",
 	"joints",
-	"weights"
+	"weights",
+	"instance_modelview",
+	"instance_opacity"
 };
 
 /* REFACTOR:
@@ -138,6 +140,7 @@ static char* attrsymtbl[9] = {
  * be much better. */
 struct shaderv {
 	GLint loc;
+	uint32_t hash;
 	char* label;
 	enum shdrutype type;
 	uint8_t data[64];
@@ -155,8 +158,16 @@ struct shader_cont {
 	char (* vertex), (* fragment);
 	GLuint prg_container, obj_vertex, obj_fragment;
 	GLint locations[sizeof(ofstbl) / sizeof(ofstbl[0])];
+
+/* generation of each global last uploaded to this program, compared
+ * against gentbl on activation so only changed values are pushed */
+	uint32_t seen[sizeof(ofstbl) / sizeof(ofstbl[0])];
+
+/* uniform group whose persistent values are currently loaded, -1 if none */
+	int pushed_group;
+
 /* match attrsymtbl */
-	GLint attributes[9];
+	GLint attributes[11];
 
 	struct arcan_strarr ugroups;
 };
@@ -176,6 +187,13 @@ static struct {
 	size_t ofs;
 	agp_shader_id active_prg;
 	struct shader_envts context;
+
+/* bumped whenever a global value actually changes */
+	uint32_t gen;
+	uint32_t gentbl[TBLSIZE];
+
+/* uniform uploads performed / avoided since the last agp_shader_stats */
+	size_t n_set, n_skip;
 	char guard;
 } shdr_global = {.active_prg = BROKEN_SHADER, .guard = 64};
 
@@ -221,6 +239,31 @@ static void setv(GLint loc, enum shdrutype kind, void* val,
 	env->unif_m4fv(loc, 1, false, (GLfloat*) val);
 	break;
 	}
+
+	shdr_global.n_set++;
+}
+
+/* FNV-1a, labels are short and the result is only compared against the
+ * hash stored with each persistent uniform before falling back to strcmp */
+static uint32_t label_hash(const char* label)
+{
+	uint32_t hash = 2166136261u;
+	for (; *label; label++){
+		hash ^= (uint8_t) *label;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void agp_shader_stats(size_t* set, size_t* skipped)
+{
+	if (set)
+		*set = shdr_global.n_set;
+
+	if (skipped)
+		*skipped = shdr_global.n_skip;
+
+	shdr_global.n_set = shdr_global.n_skip = 0;
 }
 
 static void destroy_shader(struct shader_cont* cur)
@@ -259,6 +302,7 @@ bool agp_shader_destroy(agp_shader_id shid)
 	if (!agp_shader_valid(shid) ||
 		shid == agp_default_shader(BASIC_2D) ||
 		shid == agp_default_shader(BASIC_3D) ||
+		shid == agp_default_shader(BASIC_3D_INSTANCED) ||
 		shid == agp_default_shader(COLOR_2D))
 		return false;
 
@@ -284,6 +328,9 @@ bool agp_shader_destroy(agp_shader_id shid)
 	}
 
 	cur->ugroups.count--;
+	if (cur->pushed_group == ind)
+		cur->pushed_group = -1;
+
 	while(sv){
 		struct shaderv* last = sv;
 		free(sv->label);
@@ -313,15 +360,19 @@ int agp_shader_activate(agp_shader_id shid)
 #endif
 
 /*
- * While we chould practically just update the uniforms that has actually
- * changed since the last push as we keep a cache, the incentive is rather
- * small (uniform- set on a bound shader is among the cheaper state changes
- * possible).
+ * Uniform values stay with the program, so only push the globals that have
+ * changed since this program last saw them. The counter still tracks use
+ * as the timestamp ones count towards dirty.
  */
 		for (size_t i = 0; i < sizeof(ofstbl) / sizeof(ofstbl[0]); i++){
 			if (cur->locations[i] >= 0){
-				setv(cur->locations[i], typetbl[i], (char*)(&shdr_global.context)
-					+ ofstbl[i], symtbl[i], cur->label);
+				if (cur->seen[i] != shdr_global.gentbl[i]){
+					setv(cur->locations[i], typetbl[i], (char*)(&shdr_global.context)
+						+ ofstbl[i], symtbl[i], cur->label);
+					cur->seen[i] = shdr_global.gentbl[i];
+				}
+				else
+					shdr_global.n_skip++;
 				counttbl[i]++;
 			}
 		}
@@ -334,11 +385,19 @@ int agp_shader_activate(agp_shader_id shid)
 		}
 		struct shaderv* current = cur->ugroups.cdata[GROUP_INDEX(shid)];
 
+/* same group as last time on this program, forceunif keeps it in synch */
+		if (cur->pushed_group == GROUP_INDEX(shid)){
+			for (; current; current = current->next)
+				shdr_global.n_skip++;
+			return ARCAN_OK;
+		}
+
 		while (current){
 			setv(current->loc, current->type, (void*) current->data,
 				current->label, cur->label);
 			current = current->next;
 		}
+		cur->pushed_group = GROUP_INDEX(shid);
 	}
 
 	return ARCAN_OK;
@@ -462,10 +521,14 @@ agp_shader_id agp_shader_build(const char* tag,
 		*cur = (struct shader_cont){};
 	}
 
-/* always reset locations tbl */
+/* always reset locations tbl, a new program has all uniforms zeroed which
+ * matches generation 0 of the (zero-initialized) context */
 	int global_lim = sizeof(ofstbl) / sizeof(ofstbl[0]);
-	for (int i = 0; i < global_lim; i++)
+	for (int i = 0; i < global_lim; i++){
 		cur->locations[i] = -1;
+		cur->seen[i] = 0;
+	}
+	cur->pushed_group = -1;
 
 	if (build_shader(tag, &cur->prg_container, &cur->obj_vertex,
 		&cur->obj_fragment, vert, frag) == false)
@@ -518,15 +581,21 @@ agp_shader_id agp_shader_build(const char* tag,
 
 int agp_shader_envv(enum agp_shader_envts slot, void* value, size_t size)
 {
-	memcpy((char*) (&shdr_global.context) + ofstbl[slot], value, size);
+	char* dst = (char*) (&shdr_global.context) + ofstbl[slot];
+	if (memcmp(dst, value, size) != 0){
+		memcpy(dst, value, size);
+		shdr_global.gentbl[slot] = ++shdr_global.gen;
+	}
+
 	int rv = counttbl[slot];
 	counttbl[slot] = 0;
 
 	if (BROKEN_SHADER == shdr_global.active_prg)
 		return rv;
 
-	int glloc = shdr_global.slots[
-		SHADER_INDEX(shdr_global.active_prg)].locations[slot];
+	struct shader_cont* cur = &shdr_global.slots[
+		SHADER_INDEX(shdr_global.active_prg)];
+	int glloc = cur->locations[slot];
 
 /*
  * reflect change in current active shader, the others will be changed on
@@ -534,8 +603,12 @@ int agp_shader_envv(enum agp_shader_envts slot, void* value, size_t size)
  */
 	if (glloc != -1){
 		assert(size == sizetbl[ typetbl[slot] ]);
-		setv(glloc, typetbl[slot], value, symtbl[slot],
-			shdr_global.slots[SHADER_INDEX(shdr_global.active_prg)].label );
+		if (cur->seen[slot] != shdr_global.gentbl[slot]){
+			setv(glloc, typetbl[slot], value, symtbl[slot], cur->label);
+			cur->seen[slot] = shdr_global.gentbl[slot];
+		}
+		else
+			shdr_global.n_skip++;
 		counttbl[slot]++;
 
 		return rv;
@@ -613,11 +686,12 @@ void agp_shader_forceunif(const char* label, enum shdrutype type, void* value)
 	struct shader_cont* slot = &shdr_global.slots[
 		SHADER_INDEX(shdr_global.active_prg)];
 
-/* linear search */
+/* groups are short, compare on hash and only then on label */
+	uint32_t hash = label_hash(label);
 	struct shaderv** current = (struct shaderv**) &(
 		slot->ugroups.cdata[GROUP_INDEX(shdr_global.active_prg)]);
 	for (; *current; current = &(*current)->next)
-		if (strcmp((*current)->label, label) == 0)
+		if ((*current)->hash == hash && strcmp((*current)->label, label) == 0)
 			break;
 
 /* found? then continue, else allocate new and return that loc */
@@ -626,12 +700,20 @@ void agp_shader_forceunif(const char* label, enum shdrutype type, void* value)
 		if ((*current)->type != type)
 			arcan_warning("agp_shader_forceunif(), type mismatch for "
 				"persistant shader uniform (%s:%i=>%i), ignored.\n", label, loc, type);
+
+/* already the value in the program */
+		else if (slot->pushed_group == GROUP_INDEX(shdr_global.active_prg) &&
+			memcmp((*current)->data, value, sizetbl[type]) == 0){
+			shdr_global.n_skip++;
+			return;
+		}
 	}
 	else {
 		loc = agp_env()->get_uniform_loc(slot->prg_container, label);
 		*current = arcan_alloc_mem(sizeof(struct shaderv),
 			ARCAN_MEM_VSTRUCT, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_NATURAL);
 		(*current)->label = strdup(label);
+		(*current)->hash  = hash;
 		(*current)->loc   = loc;
 		(*current)->type  = type;
 		(*current)->next  = NULL;
@@ -791,6 +873,12 @@ void agp_shader_rebuild_all()
 		if (cur->label == NULL)
 			continue;
 
+/* relinking zeroes all uniforms, so the globals and the group values need
+ * to be pushed again rather than be skipped as already seen */
+		for (size_t j = 0; j < sizeof(ofstbl) / sizeof(ofstbl[0]); j++)
+			cur->seen[j] = 0;
+		cur->pushed_group = -1;
+
 		build_shader(cur->label,
 			&cur->prg_container,
 			&cur->obj_vertex,
@@ -799,4 +887,7 @@ void agp_shader_rebuild_all()
 			cur->fragment
 		);
 	}
+
+/* the active program was replaced as well, force the next activate through */
+	shdr_global.active_prg = BROKEN_SHADER;
 }
@@ -167,10 +167,20 @@ void agp_draw_vobj(
 {
 }
 
+void agp_draw_vobj_batch(const float* verts, const float* txcos, size_t n)
+{
+}
+
 void agp_submit_mesh(struct agp_mesh_store* base, enum agp_mesh_flags fl)
 {
 }
 
+bool agp_submit_mesh_instanced(struct agp_mesh_store* base,
+	enum agp_mesh_flags fl, const float* inst, size_t n)
+{
+	return false;
+}
+
 void agp_invalidate_mesh(struct agp_mesh_store* base)
 {
 }
@@ -227,6 +237,15 @@ void agp_shader_forceunif(const char* label, enum shdrutype type, void* val)
 {
 }
 
+void agp_shader_stats(size_t* set, size_t* skipped)
+{
+	if (set)
+		*set = 0;
+
+	if (skipped)
+		*skipped = 0;
+}
+
 agp_shader_id agp_shader_lookup(const char* tag)
 {
 	return BROKEN_SHADER;
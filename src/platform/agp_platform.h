@@ -43,11 +43,13 @@ typedef uint32_t agp_shader_id;
  * Retrieve the default shader for a specific purpose,
  * BASIC_2D => single textured, alpha in obj_opacity
  * COLOR_2D => not textured, color channel in uniforms
+ * BASIC_3D_INSTANCED => as BASIC_3D, modelview and opacity per instance
  */
 enum SHADER_TYPES {
 	BASIC_2D = 0,
 	COLOR_2D,
 	BASIC_3D,
+	BASIC_3D_INSTANCED,
 	SHADER_TYPE_ENDM
 };
 agp_shader_id agp_default_shader(enum SHADER_TYPES);
@@ -329,6 +331,14 @@ void agp_blendstate(enum arcan_blendfunc);
 void agp_draw_vobj(float x1, float y1, float x2, float y2,
 	const float* txcos, const float* modelview);
 
+/*
+ * Draw [n] quads with the currently active vstore and shader in one call.
+ * [verts] and [txcos] hold 6 (two triangles) x/y pairs per quad, the
+ * vertices are already transformed and identity is used as modelview.
+ * [txcos] can be NULL.
+ */
+void agp_draw_vobj_batch(const float* verts, const float* txcos, size_t n);
+
 /*
  * Destination format for rendertargets. Note that we do not currently suport
  * floating point targets and that for some platforms, COLOR_DEPTH will map to
@@ -561,6 +571,20 @@ const char* agp_ident();
 
 void agp_submit_mesh(struct agp_mesh_store*, enum agp_mesh_flags);
 
+/*
+ * Draw [n] instances of the mesh in one call. [inst] holds
+ * AGP_INSTANCE_STRIDE floats per instance, a modelview matrix followed by
+ * the opacity, mapped to the instance_modelview and instance_opacity
+ * attributes of the active program.
+ *
+ * Returns false without drawing anything if the platform lacks instancing
+ * or the program does not use the attributes, the caller is then expected
+ * to submit the instances one by one.
+ */
+#define AGP_INSTANCE_STRIDE 17
+bool agp_submit_mesh_instanced(struct agp_mesh_store*,
+	enum agp_mesh_flags, const float* inst, size_t n);
+
 /*
  * Mark that the contents of the mesh has changed dynamically and that possible
  * GPU- side cache might need to be updated.
@@ -662,6 +686,13 @@ const char* agp_shader_symtype(enum agp_shader_envts env);
  */
 void agp_shader_forceunif(const char* label, enum shdrutype type, void* value);
 
+/*
+ * Retrieve the number of uniform uploads performed [set] and the number that
+ * were avoided [skipped] as the program already had the value, since the
+ * last call. Either can be NULL.
+ */
+void agp_shader_stats(size_t* set, size_t* skipped);
+
 struct agp_render_options {
 	int line_width;
 };
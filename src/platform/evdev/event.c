@@ -16,6 +16,7 @@
 #include <errno.h>
 #include <poll.h>
 #include <glob.h>
+#include <time.h>
 
 #include <sys/types.h>
 #include <sys/param.h>
@@ -87,6 +88,10 @@ static struct {
 	bool mute, init;
 	int tty, notify;
 	int pending;
+
+/* time window (ms) where consecutive mouse/touch motion samples are merged
+ * into one event, 0 disables coalescing */
+	int coalesce;
 }
 gstate = {
 
@@ -97,6 +102,8 @@ static const char* envopts[] = {
 	"scandir=path/to/folder", "Directory to monitor for device node hotplug "
 		"(Default: "NOTIFY_SCAN_DIR")",
 	"disable_ttyswap", "Disable tty- swapping signal handler",
+	"coalesce=ms", "Merge mouse/touch motion within a time window (1..32 ms, "
+		"Default: 0, disabled)",
 	"[evdev_type=label]", "suffix evdev_type with _n for (n = 2, 3, ...)",
 	"evdev_keyboard=label", "Force device matching 'label' as a keyboard",
 	"evdev_game=label", "Force device matching 'label' as a game device",
@@ -118,9 +125,30 @@ static const char* envopts[] = {
  */
 #define MAX_DEVICES 256
 
+/*
+ * upper bound for the coalescing window, this is limited by the span field
+ * in the outgoing event (int16_t, microseconds)
+ */
+#define MAX_COALESCE_MS 32
+
+/* subid base for touch samples, also the analogfilter axis for touch */
+#define TOUCH_AXIS 128
+
 struct devnode;
 #include "device_db.h"
 
+/*
+ * accumulated relative motion for one axis while coalescing, the timestamps
+ * are taken from the kernel event and the arrival time from the local clock
+ * (used to decide when the window has expired)
+ */
+struct motion_acc {
+	int32_t sum;
+	uint16_t count;
+	uint64_t first_ts, last_ts;
+	unsigned long long arrival;
+};
+
 struct axis_opts {
 /* none, avg, drop */
 	enum ARCAN_ANALOGFILTER_KIND mode;
@@ -180,6 +208,7 @@ struct devnode {
 			uint16_t mx;
 			uint16_t my;
 			struct axis_opts flt[2];
+			struct motion_acc acc[2];
 		} cursor;
 		struct {
 			unsigned state;
@@ -199,6 +228,10 @@ struct devnode {
 		int pressure;
 		int size;
 		int ind;
+		struct motion_acc acc;
+
+/* only the mode is used, exposed to analogfilter as TOUCH_AXIS */
+		struct axis_opts flt;
 	} touch;
 
 /* and also possible act as a LED controller */
@@ -211,6 +244,7 @@ struct devnode {
 };
 
 static void got_device(struct arcan_evctx* ctx, int fd, const char*);
+static void flush_coalesced(struct arcan_evctx* ctx);
 
 /* for other platforms and legacy, devid used to be allocated sequentially
  * and swept linear, even though this platform do not work like that and we
@@ -343,7 +377,9 @@ static inline bool process_axis(struct arcan_evctx* ctx,
 	if (daxis->mode == ARCAN_ANALOGFILTER_NONE)
 		return false;
 
-	if (daxis->mode == ARCAN_ANALOGFILTER_PASS)
+/* coalescing is performed by the device handler on the accepted sample */
+	if (daxis->mode == ARCAN_ANALOGFILTER_PASS ||
+		daxis->mode == ARCAN_ANALOGFILTER_COALESCE)
 		goto accept_sample;
 
 /* quickfilter deadzone */
@@ -429,6 +465,11 @@ static struct axis_opts* find_axis(int devid, unsigned axisid, bool* outn)
 	if (!node)
 		return NULL;
 
+/* touch samples are reported with subid from TOUCH_AXIS and up, on any
+ * kind of node, that id selects whether they are coalesced or not */
+	if (axisid == TOUCH_AXIS)
+		return &node->touch.flt;
+
 	switch(node->type){
 	case DEVNODE_SENSOR:
 		return axisid == 0 ? &node->sensor.data : NULL;
@@ -711,6 +752,7 @@ void platform_event_process(struct arcan_evctx* ctx)
 
 	int nr = poll(iodev.pollset, iodev.sz_nodes * 2, 0);
 	if (nr <= 0){
+		flush_coalesced(ctx);
 		TRACE_MARK_EXIT("event", "flush-pending-in", TRACE_SYS_FAST, 0, 0, "flush-in");
 		return;
 	}
@@ -742,6 +784,9 @@ void platform_event_process(struct arcan_evctx* ctx)
 		}
 	}
 
+/* always, the filter mode can be set per device even if the window is 0 */
+	flush_coalesced(ctx);
+
 	TRACE_MARK_EXIT("event", "flush-pending-in", TRACE_SYS_DEFAULT, 0, 0, "flush-in");
 }
 
@@ -1076,7 +1121,9 @@ static void got_device(struct arcan_evctx* ctx, int fd, const char* path)
 {
 	struct devnode node = {
 		.handle = fd,
-		.led.fds = {BADFD, BADFD}
+		.led.fds = {BADFD, BADFD},
+		.touch.flt.mode = gstate.coalesce ?
+			ARCAN_ANALOGFILTER_COALESCE : ARCAN_ANALOGFILTER_PASS
 	};
 
 	struct stat fdstat;
@@ -1134,6 +1181,10 @@ static void got_device(struct arcan_evctx* ctx, int fd, const char* path)
 		return;
 	}
 
+/* event timestamps on the same clock as arcan_timemillis, see event_pts */
+	int clk = CLOCK_MONOTONIC;
+	ioctl(fd, EVIOCSCLOCKID, &clk);
+
 	for (size_t bit = 0; bit < EV_MAX; bit++)
 		if ( 1ul & (prop[bit/bpl]) >> (bit & (bpl - 1)) )
 		switch(bit){
@@ -1174,8 +1225,8 @@ static void got_device(struct arcan_evctx* ctx, int fd, const char* path)
 	if (!eh.handler){
 		if (mouse_ax && mouse_btn){
 			node.type = DEVNODE_MOUSE;
-			node.cursor.flt[0].mode = ARCAN_ANALOGFILTER_PASS;
-			node.cursor.flt[1].mode = ARCAN_ANALOGFILTER_PASS;
+			node.cursor.flt[0].mode = node.cursor.flt[1].mode = gstate.coalesce ?
+				ARCAN_ANALOGFILTER_COALESCE : ARCAN_ANALOGFILTER_PASS;
 
 			if (!iodev.mouseid)
 				iodev.mouseid = node.devnum;
@@ -1406,6 +1457,19 @@ static void defhandler_kbd(struct arcan_evctx* out,
 	}
 }
 
+static inline uint64_t event_ts(struct input_event* ev)
+{
+	return (uint64_t)ev->time.tv_sec * 1000000 + ev->time.tv_usec;
+}
+
+/* kernel event time (us) to ms relative to the epoch of arcan_frametime */
+static uint64_t event_pts(uint64_t ts)
+{
+	int64_t ofs = arcan_timemillis() - arcan_frametime();
+	int64_t pts = (int64_t)(ts / 1000) - ofs;
+	return pts > 0 ? pts : 0;
+}
+
 static void flush_pending(
 	struct arcan_evctx* ctx, struct devnode* node)
 {
@@ -1414,7 +1478,7 @@ static void flush_pending(
 		.io = {
 		.label = "touch",
 		.devid = node->devnum,
-		.subid = node->touch.ind + 128,
+		.subid = node->touch.ind + TOUCH_AXIS,
 		.kind = EVENT_IO_TOUCH,
 		.devkind = EVENT_IDEVKIND_TOUCHDISP,
 		.datatype = EVENT_IDATATYPE_TOUCH
@@ -1429,9 +1493,111 @@ static void flush_pending(
 	newev.io.input.touch.pressure = node->touch.pressure;
 	newev.io.input.touch.size = node->touch.size;
 
+	if (node->touch.acc.count > 1){
+		newev.io.flags |= ARCAN_IOFL_COALESCED;
+		newev.io.input.touch.coalesced = node->touch.acc.count > UINT16_MAX ?
+			UINT16_MAX : node->touch.acc.count;
+		newev.io.pts = event_pts(node->touch.acc.last_ts);
+	}
+
 	arcan_event_enqueue(ctx, &newev);
 	node->touch.pending = false;
 	node->touch.active = true;
+	node->touch.acc.count = 0;
+}
+
+static void acc_sample(struct motion_acc* acc, int value, uint64_t ts)
+{
+	if (!acc->count){
+		acc->first_ts = ts;
+		acc->arrival = arcan_timemillis();
+	}
+
+	acc->sum += value;
+	acc->last_ts = ts;
+	acc->count++;
+}
+
+static bool acc_expired(struct motion_acc* acc, unsigned long long now)
+{
+	return acc->count && now - acc->arrival >= gstate.coalesce;
+}
+
+static void flush_motion(
+	struct arcan_evctx* ctx, struct devnode* node, int axis)
+{
+	struct motion_acc* acc = &node->cursor.acc[axis];
+	if (!acc->count)
+		return;
+
+	arcan_event newev = {
+		.category = EVENT_IO,
+		.io = {
+			.label = "mouse",
+			.devkind = EVENT_IDEVKIND_MOUSE,
+			.kind = EVENT_IO_AXIS_MOVE,
+			.datatype = EVENT_IDATATYPE_ANALOG,
+			.devid = node->devnum,
+			.subid = axis,
+			.input.analog.gotrel = true,
+			.input.analog.nvalues = 2
+		}
+	};
+
+	uint64_t span = acc->last_ts - acc->first_ts;
+	newev.io.input.analog.axisval[0] = acc->sum;
+	newev.io.input.analog.axisval[1] = axis ? node->cursor.my : node->cursor.mx;
+	newev.io.input.analog.axisval[2] = acc->count > INT16_MAX ?
+		INT16_MAX : acc->count;
+	newev.io.input.analog.axisval[3] = span > INT16_MAX ? INT16_MAX : span;
+	newev.io.pts = event_pts(acc->last_ts);
+
+	if (acc->count > 1)
+		newev.io.flags |= ARCAN_IOFL_COALESCED;
+
+	arcan_event_enqueue(ctx, &newev);
+	acc->sum = 0;
+	acc->count = 0;
+}
+
+/*
+ * merge a relative sample into the accumulator for the axis, this flushes
+ * first if the window has expired or the sum would no longer fit the event
+ */
+static void coalesce_motion(struct arcan_evctx* ctx,
+	struct devnode* node, int axis, int value, uint64_t ts)
+{
+	struct motion_acc* acc = &node->cursor.acc[axis];
+
+	if (acc->count && (abs(acc->sum + value) > INT16_MAX ||
+		ts - acc->first_ts >= (uint64_t) gstate.coalesce * 1000))
+		flush_motion(ctx, node, axis);
+
+	acc_sample(acc, value, ts);
+}
+
+/*
+ * run at the end of each processing pass, samples that are still inside of
+ * the window are kept for the next pass
+ */
+static void flush_coalesced(struct arcan_evctx* ctx)
+{
+	unsigned long long now = arcan_timemillis();
+
+	for (size_t i = 0; i < iodev.sz_nodes; i++){
+		struct devnode* node = &iodev.nodes[i];
+		if (node->handle <= 0)
+			continue;
+
+		if (node->type == DEVNODE_MOUSE){
+			for (size_t j = 0; j < 2; j++)
+				if (acc_expired(&node->cursor.acc[j], now))
+					flush_motion(ctx, node, j);
+		}
+
+		if (node->touch.pending && acc_expired(&node->touch.acc, now))
+			flush_pending(ctx, node);
+	}
 }
 
 static void decode_mt(struct arcan_evctx* ctx,
@@ -1653,8 +1819,15 @@ static void defhandler_game(struct arcan_evctx* ctx, struct devnode* node)
 
 		case EV_SYN:
 		case EV_REP:
-			if (node->touch.pending)
-				flush_pending(ctx, node);
+/* contact changes (slot switch, release) are flushed in decode_mt, so only
+ * motion on an already reported contact is deferred */
+			if (node->touch.pending){
+				if (node->touch.active &&
+					node->touch.flt.mode == ARCAN_ANALOGFILTER_COALESCE)
+					acc_sample(&node->touch.acc, 0, event_ts(&inev[i]));
+				else
+					flush_pending(ctx, node);
+			}
 		break;
 
 		default:
@@ -1706,6 +1879,11 @@ static void defhandler_mouse(struct arcan_evctx* ctx,
 			if (samplev < 0)
 				continue;
 
+/* pending motion need to go first so that the button lands on the
+ * right position */
+			flush_motion(ctx, node, 0);
+			flush_motion(ctx, node, 1);
+
 			newev.io.kind = EVENT_IO_BUTTON;
 			newev.io.datatype = EVENT_IDATATYPE_DIGITAL;
 			newev.io.input.digital.active = inev[i].value;
@@ -1718,6 +1896,8 @@ static void defhandler_mouse(struct arcan_evctx* ctx,
 			case REL_HWHEEL:
 				vofs += 2;
 			case REL_WHEEL:
+				flush_motion(ctx, node, 0);
+				flush_motion(ctx, node, 1);
 				newev.io.kind = EVENT_IO_BUTTON;
 				newev.io.datatype = EVENT_IDATATYPE_DIGITAL;
 				newev.io.input.digital.active = 1;
@@ -1734,6 +1914,11 @@ static void defhandler_mouse(struct arcan_evctx* ctx,
 					node->cursor.mx = ((int)node->cursor.mx + samplev < 0) ?
 						0 : node->cursor.mx + samplev;
 
+					if (node->cursor.flt[0].mode == ARCAN_ANALOGFILTER_COALESCE){
+						coalesce_motion(ctx, node, 0, samplev, event_ts(&inev[i]));
+						break;
+					}
+
 					newev.io.kind = EVENT_IO_AXIS_MOVE;
 					newev.io.datatype = EVENT_IDATATYPE_ANALOG;
 					newev.io.input.analog.gotrel = true;
@@ -1750,6 +1935,11 @@ static void defhandler_mouse(struct arcan_evctx* ctx,
 					node->cursor.my = ((int)node->cursor.my + samplev < 0) ?
 						0 : node->cursor.my + samplev;
 
+					if (node->cursor.flt[1].mode == ARCAN_ANALOGFILTER_COALESCE){
+						coalesce_motion(ctx, node, 1, samplev, event_ts(&inev[i]));
+						break;
+					}
+
 					newev.io.kind = EVENT_IO_AXIS_MOVE;
 					newev.io.datatype = EVENT_IDATATYPE_ANALOG;
 					newev.io.input.analog.gotrel = true;
@@ -1953,6 +2143,14 @@ void platform_event_init(arcan_evctx* ctx)
 		notify_scan_dir = newsd;
 	}
 
+	char* coalesce;
+	if (get_config("event_coalesce", 0, &coalesce, tag) && coalesce){
+		gstate.coalesce = strtoul(coalesce, NULL, 10);
+		if (gstate.coalesce > MAX_COALESCE_MS)
+			gstate.coalesce = MAX_COALESCE_MS;
+		free(coalesce);
+	}
+
 /* chances are the CREATE events are actually racey, but with the
  * _device_open refactor this won't really matter as the suid part
  * allows us access anyway */
@@ -50,6 +50,14 @@
 #include <xf86drm.h>
 #include <gbm.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifndef READBACK_SLOTS
+#define READBACK_SLOTS 3
+#endif
+
 static struct {
 	size_t width;
 	size_t height;
@@ -60,8 +68,16 @@ static struct {
 		bool check_output;
 		bool flip_y;
 		bool block;
+		bool sync_readback;
 	} encode;
 
+	struct {
+		unsigned pbo[READBACK_SLOTS];
+		size_t w, h;
+		size_t head, queued;
+		bool disabled;
+	} readback;
+
 	struct {
 		EGLDisplay disp;
 		EGLContext ctx;
@@ -124,6 +140,10 @@ static void spawn_encode_output()
 	if (!get_config("video_encode", 0, &enc_arg, tag))
 		return;
 
+/* opt out of the pipelined readback, trades a frame of latency for a stall */
+	global.encode.sync_readback =
+		get_config("video_encode_sync_readback", 0, NULL, tag);
+
 /*
  * spawn the actual process
  */
@@ -150,6 +170,13 @@ void platform_video_shutdown()
 	if (global.encode.outctx){
 		arcan_frameserver_free(global.encode.outctx);
 	}
+
+#ifdef GL_PIXEL_PACK_BUFFER
+	if (global.readback.w)
+		agp_env()->delete_buffers(READBACK_SLOTS, global.readback.pbo);
+#endif
+	global.readback.w = global.readback.h = 0;
+	global.readback.queued = 0;
 }
 
 void platform_video_prepare_external()
@@ -260,126 +287,279 @@ int headless_flush_encode_events()
 	return FRV_NOFRAME;
 }
 
-static int readback_encode()
-{
-/* other side is still encoding / synching so don't overwrite the buffer */
-	struct arcan_frameserver* out = global.encode.outctx;
-	TRAMP_GUARD(0, out);
-
-/* not finished, fake it until we finish */
-	if (out->shm.ptr->vready || global.encode.block){
-		platform_fsrv_leave();
-		return 0;
+/*
+ * Compare one row of [n] pixels between the last frame sent [dst] and the
+ * new one [src]. The scan runs forward in 4 pixel chunks until the first
+ * difference, then backward until the last one, so an unchanged row costs
+ * one pass and a changed one no more than that. The changed span is copied.
+ */
+static bool row_update(
+	shmif_pixel* restrict dst, const shmif_pixel* restrict src,
+	size_t n, size_t* x1, size_t* x2)
+{
+	size_t lo = 0;
+	size_t hi = n;
+
+#if defined(__SSE2__)
+	for (; lo + 4 <= n; lo += 4){
+		__m128i a = _mm_loadu_si128((const __m128i*) &src[lo]);
+		__m128i b = _mm_loadu_si128((const __m128i*) &dst[lo]);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xffff)
+			break;
 	}
+#else
+	for (; lo + 4 <= n; lo += 4)
+		if ((src[lo] ^ dst[lo]) | (src[lo+1] ^ dst[lo+1]) |
+			(src[lo+2] ^ dst[lo+2]) | (src[lo+3] ^ dst[lo+3]))
+			break;
+#endif
 
-/* even if the store sizes have changed for some reason, we crop to the smallest */
-	agp_activate_rendertarget(NULL);
+	while (lo < n && src[lo] == dst[lo])
+		lo++;
 
-	struct agp_vstore* vs = global.vstore ? global.vstore : arcan_vint_world();
-	size_t row_len = vs->w > out->desc.width ? out->desc.width : vs->w;
-	size_t row_sz = row_len * sizeof(av_pixel);
-	size_t n_rows = vs->h > out->desc.height ? out->desc.height : vs->h;
-	size_t buf_sz = vs->w * vs->h * sizeof(av_pixel);
+	if (lo == n)
+		return false;
 
-/* recall, alloc_mem is default FATAL unless flagged otherwise */
-	if (buf_sz != vs->vinf.text.s_raw){
-		arcan_mem_free(vs->vinf.text.raw);
-		vs->vinf.text.s_raw = buf_sz;
-		vs->vinf.text.raw = arcan_alloc_mem(vs->vinf.text.s_raw,
-			ARCAN_MEM_VBUFFER, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_PAGE
-		);
+#if defined(__SSE2__)
+	for (; hi >= lo + 4; hi -= 4){
+		__m128i a = _mm_loadu_si128((const __m128i*) &src[hi-4]);
+		__m128i b = _mm_loadu_si128((const __m128i*) &dst[hi-4]);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) != 0xffff)
+			break;
 	}
+#else
+	for (; hi >= lo + 4; hi -= 4)
+		if ((src[hi-1] ^ dst[hi-1]) | (src[hi-2] ^ dst[hi-2]) |
+			(src[hi-3] ^ dst[hi-3]) | (src[hi-4] ^ dst[hi-4]))
+			break;
+#endif
 
-/* don't really guarantee color format and coding here when it is
- * non-normal texture2D surfaces (where we statically pick formats
- * to avoid repack). */
-	agp_readback_synchronous(vs);
+	while (hi > lo && src[hi-1] == dst[hi-1])
+		hi--;
 
-	bool in_dirty = false;
-	size_t x1 = row_len - 1;
-	size_t x2 = 0, y1 = 0, y2 = 0;
+	memcpy(&dst[lo], &src[lo], (hi - lo) * sizeof(shmif_pixel));
 
-	shmif_pixel* dst = out->vbufs[0];
-	shmif_pixel* src = vs->vinf.text.raw;
+	*x1 = lo < *x1 ? lo : *x1;
+	*x2 = hi - 1 > *x2 ? hi - 1 : *x2;
+	return true;
+}
 
-	size_t dst_row = n_rows - 1;
-	int dst_step = -1;
+/*
+ * Update the encoder buffer with a [w]*[h] frame at [src], commit the dirty
+ * region and signal the encoder. The frame is processed in bands of rows to
+ * keep the source and destination rows in cache while scanning and copying.
+ */
+#ifndef READBACK_BAND
+#define READBACK_BAND 16
+#endif
 
-	if (!global.encode.flip_y){
-		dst_row = 0;
-		dst_step = 1;
-	}
+static void encode_frame(const shmif_pixel* src, size_t w, size_t h)
+{
+	struct arcan_frameserver* out = global.encode.outctx;
 
-	for (size_t row = 0; row < n_rows; row++, dst_row += dst_step){
-		av_pixel acc = 0;
+/* even if the store sizes have changed for some reason, we crop to the smallest */
+	size_t row_len = w > out->desc.width ? out->desc.width : w;
+	size_t n_rows = h > out->desc.height ? out->desc.height : h;
 
-		for (size_t px = 0; px < row_len; px++){
-			av_pixel a = src[row     * vs->w           + px];
-			av_pixel b = dst[dst_row * out->desc.width + px];
-			acc = acc | (a ^ b);
-		}
+	size_t x1 = row_len, x2 = 0;
+	size_t y1 = n_rows, y2 = 0;
+	shmif_pixel* dst = out->vbufs[0];
 
-		if (!acc)
-			continue;
+	for (size_t band = 0; band < n_rows; band += READBACK_BAND){
+		size_t band_end = band + READBACK_BAND;
+		band_end = band_end > n_rows ? n_rows : band_end;
 
-		if (!in_dirty){
-			in_dirty = true;
-			y1 = dst_row;
-			y2 = dst_row;
-		}
-		else
-			y1 = dst_row;
-
-/* grow / shrink the bounding volume */
-		for (size_t tx = 0; tx < x1; tx++){
-			if (
-					(dst[dst_row * out->desc.width + tx] ^
-					 src[row * out->desc.width + tx]) != 0){
-				x1 = tx;
-				break;
-			}
-		}
+		for (size_t row = band; row < band_end; row++){
+			size_t dst_row = global.encode.flip_y ? n_rows - 1 - row : row;
 
-		for (size_t tx = row_len-1; tx > x2; tx--){
-			if (
-					(dst[dst_row * out->desc.width + tx] ^
-					 src[row * out->desc.width + tx]) != 0){
-				x2 = tx;
-				break;
-			}
-		}
+			if (!row_update(&dst[dst_row * out->desc.width],
+				&src[row * w], row_len, &x1, &x2))
+				continue;
 
-		memcpy(&dst[dst_row * out->desc.width], &src[row * vs->w], row_sz);
+			y1 = dst_row < y1 ? dst_row : y1;
+			y2 = dst_row > y2 ? dst_row : y2;
+		}
 	}
 
-	if (!in_dirty){
-		platform_fsrv_leave();
-		return 1;
-	}
+	if (y1 == n_rows)
+		return;
 
 /* flag ok and commit dirty region */
-	global.encode.outctx->shm.ptr->hints |= SHMIF_RHINT_SUBREGION;
+	out->shm.ptr->hints |= SHMIF_RHINT_SUBREGION;
 
 	struct arcan_shmif_region dirty = {
 		.x1 = x1, .y1 = y1,
 		.x2 = x2, .y2 = y2
 	};
 
-	atomic_store(&global.encode.outctx->shm.ptr->dirty, dirty);
-	atomic_store_explicit(
-		&global.encode.outctx->shm.ptr->vready, true, memory_order_seq_cst);
+	atomic_store(&out->shm.ptr->dirty, dirty);
+	atomic_store_explicit(&out->shm.ptr->vready, true, memory_order_seq_cst);
 
 /* encode has more explicit frame signalling until we have futexes */
-	platform_fsrv_pushevent(global.encode.outctx, &(struct arcan_event){
+	platform_fsrv_pushevent(out, &(struct arcan_event){
 		.tgt.kind = TARGET_COMMAND_STEPFRAME,
 		.category = EVENT_TARGET,
-		.tgt.ioevs[0] = global.encode.outctx->vfcount++
+		.tgt.ioevs[0] = out->vfcount++
 	});
+}
+
+/*
+ * Pipelined readback: every rendered frame is queued as a read into the next
+ * pack buffer in a small ring, and the oldest one is mapped and sent to the
+ * encoder on the next synch. This lets frame N be collected while frame N+1
+ * renders instead of stalling on a synchronous read. Without pack buffer
+ * support this falls back to the synchronous path.
+ */
+static bool readback_setup(struct agp_vstore* vs)
+{
+#ifdef GL_PIXEL_PACK_BUFFER
+	struct agp_fenv* env = agp_env();
+	if (global.readback.disabled ||
+		!env->gen_buffers || !env->map_buffer || !env->get_tex_image){
+		global.readback.disabled = true;
+		return false;
+	}
+
+	if (global.readback.w == vs->w && global.readback.h == vs->h)
+		return true;
+
+/* size changed, anything in flight is lost */
+	if (global.readback.w)
+		env->delete_buffers(READBACK_SLOTS, global.readback.pbo);
+
+	env->gen_buffers(READBACK_SLOTS, global.readback.pbo);
+	for (size_t i = 0; i < READBACK_SLOTS; i++){
+		env->bind_buffer(GL_PIXEL_PACK_BUFFER, global.readback.pbo[i]);
+		env->buffer_data(GL_PIXEL_PACK_BUFFER,
+			vs->w * vs->h * sizeof(av_pixel), NULL, GL_STREAM_READ);
+	}
+	env->bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	global.readback.w = vs->w;
+	global.readback.h = vs->h;
+	global.readback.queued = 0;
+	debug_print("readback ring %zu*%zu*%d", vs->w, vs->h, READBACK_SLOTS);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * returns false if the frame could not be queued (store is not a plain 2D
+ * texture or there is no pack buffer support), the caller should then use
+ * the synchronous path for this frame
+ */
+static bool readback_queue()
+{
+#ifdef GL_PIXEL_PACK_BUFFER
+	struct agp_vstore* vs = global.vstore ? global.vstore : arcan_vint_world();
+	if (vs->txmapped != TXSTATE_TEX2D || !readback_setup(vs))
+		return false;
+
+	struct agp_fenv* env = agp_env();
+	size_t slot = (global.readback.head + global.readback.queued) % READBACK_SLOTS;
+
+	agp_activate_rendertarget(NULL);
+	env->bind_texture(GL_TEXTURE_2D, agp_resolve_texid(vs));
+	env->bind_buffer(GL_PIXEL_PACK_BUFFER, global.readback.pbo[slot]);
+	env->get_tex_image(GL_TEXTURE_2D, 0, GL_PIXEL_FORMAT, GL_UNSIGNED_BYTE, NULL);
+	env->bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+	env->bind_texture(GL_TEXTURE_2D, 0);
+
+	global.readback.queued++;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * returns 0 if the encoder is busy with the previous frame, 1 if the oldest
+ * queued frame was sent or there was nothing to do
+ */
+static int readback_collect()
+{
+	struct arcan_frameserver* out = global.encode.outctx;
+	TRAMP_GUARD(0, out);
+
+/* other side is still encoding / synching so don't overwrite the buffer */
+	if (out->shm.ptr->vready || global.encode.block){
+		platform_fsrv_leave();
+		return 0;
+	}
+
+	if (!global.readback.queued){
+		platform_fsrv_leave();
+		return 1;
+	}
+
+#ifdef GL_PIXEL_PACK_BUFFER
+	struct agp_fenv* env = agp_env();
+	env->bind_buffer(GL_PIXEL_PACK_BUFFER,
+		global.readback.pbo[global.readback.head]);
+
+	shmif_pixel* src = env->map_buffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (src){
+		encode_frame(src, global.readback.w, global.readback.h);
+		env->unmap_buffer(GL_PIXEL_PACK_BUFFER);
+	}
+	env->bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+
+	global.readback.head = (global.readback.head + 1) % READBACK_SLOTS;
+	global.readback.queued--;
+
+	platform_fsrv_leave();
+	return 1;
+}
+
+static int readback_encode()
+{
+/* other side is still encoding / synching so don't overwrite the buffer */
+	struct arcan_frameserver* out = global.encode.outctx;
+	TRAMP_GUARD(0, out);
+
+/* not finished, fake it until we finish */
+	if (out->shm.ptr->vready || global.encode.block){
+		platform_fsrv_leave();
+		return 0;
+	}
+
+	agp_activate_rendertarget(NULL);
+
+	struct agp_vstore* vs = global.vstore ? global.vstore : arcan_vint_world();
+	size_t buf_sz = vs->w * vs->h * sizeof(av_pixel);
+
+/* recall, alloc_mem is default FATAL unless flagged otherwise */
+	if (buf_sz != vs->vinf.text.s_raw){
+		arcan_mem_free(vs->vinf.text.raw);
+		vs->vinf.text.s_raw = buf_sz;
+		vs->vinf.text.raw = arcan_alloc_mem(vs->vinf.text.s_raw,
+			ARCAN_MEM_VBUFFER, ARCAN_MEM_BZERO, ARCAN_MEMALIGN_PAGE
+		);
+	}
+
+/* don't really guarantee color format and coding here when it is
+ * non-normal texture2D surfaces (where we statically pick formats
+ * to avoid repack). */
+	agp_readback_synchronous(vs);
+	encode_frame(vs->vinf.text.raw, vs->w, vs->h);
 
 	platform_fsrv_leave();
 	return 1;
 }
 
+static void synch_wait(int (*fun)(), unsigned long deadline)
+{
+	while (!fun()){
+		unsigned step = arcan_conductor_yield(NULL, 0);
+		if (arcan_timemillis() + step < deadline)
+			arcan_timesleep(step);
+	}
+}
+
 void platform_video_synch(uint64_t tick_count, float fract,
 	video_synchevent pre, video_synchevent post)
 {
@@ -405,6 +585,10 @@ void platform_video_synch(uint64_t tick_count, float fract,
  * if there is no encoder listening run with the estimated fake synch
  */
 	if (!nd || !global.encode.outctx){
+/* push out the frame that is still queued from the last update */
+		if (global.encode.outctx && global.readback.queued)
+			readback_collect();
+
 		arcan_conductor_fakesynch(global.deadline);
 	}
 
@@ -415,10 +599,22 @@ void platform_video_synch(uint64_t tick_count, float fract,
 	else{
 		unsigned long deadline = arcan_timemillis() + global.deadline;
 
-		while (!readback_encode()){
-			unsigned step = arcan_conductor_yield(NULL, 0);
-			if (arcan_timemillis() + step < deadline)
-				arcan_timesleep(step);
+/* queue this frame and send the previous one, block only if the ring is full
+ * or the encoder hasn't finished with the last frame */
+		if (global.encode.sync_readback || global.readback.disabled)
+			synch_wait(readback_encode, deadline);
+		else {
+			if (global.readback.queued == READBACK_SLOTS)
+				synch_wait(readback_collect, deadline);
+
+/* couldn't queue, flush what is in flight first to keep the frame order */
+			if (!readback_queue()){
+				while (global.readback.queued)
+					synch_wait(readback_collect, deadline);
+				synch_wait(readback_encode, deadline);
+			}
+			else if (global.readback.queued > 1)
+				synch_wait(readback_collect, deadline);
 		}
 	}
 
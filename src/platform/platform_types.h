@@ -249,7 +249,9 @@ enum shader_vertex_attributes {
 	ATTRIBUTE_TANGENT,
 	ATTRIBUTE_BITANGENT,
 	ATTRIBUTE_JOINTS0,
-	ATTRIBUTE_WEIGHTS1
+	ATTRIBUTE_WEIGHTS1,
+	ATTRIBUTE_INSTANCE_MODELVIEW,
+	ATTRIBUTE_INSTANCE_OPACITY
 };
 
 /*
@@ -261,7 +263,10 @@ enum ARCAN_ANALOGFILTER_KIND {
 	ARCAN_ANALOGFILTER_NONE = 0,
 	ARCAN_ANALOGFILTER_PASS = 1,
 	ARCAN_ANALOGFILTER_AVG  = 2,
- 	ARCAN_ANALOGFILTER_ALAST = 3
+ 	ARCAN_ANALOGFILTER_ALAST = 3,
+/* merge consecutive relative samples within a time window into one sample,
+ * platforms that lack support should treat this as PASS */
+	ARCAN_ANALOGFILTER_COALESCE = 4
 };
 
 /*
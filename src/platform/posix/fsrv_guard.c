@@ -37,8 +37,10 @@
 #include <arcan_audio.h>
 #include <arcan_frameserver.h>
 
-static struct arcan_frameserver* tag;
-static sigjmp_buf recover;
+/* thread local as the audio thread can be inside a feed at the same time as
+ * the main thread, SIGBUS is delivered to the thread that faulted */
+static _Thread_local struct arcan_frameserver* tag;
+static _Thread_local sigjmp_buf recover;
 
 static void bus_handler(int signo)
 {
@@ -60,7 +62,13 @@ void platform_fsrv_enter(struct arcan_frameserver* m, jmp_buf out)
 
 	if (sigsetjmp(recover, 0)){
 		arcan_warning("(posix/fsrv_guard) DoS attempt from client.\n");
-		platform_fsrv_dropshared(tag);
+
+/* the main thread owns the mapping, let it drop it on the next poll */
+		if (arcan_audio_isthread())
+			atomic_store(&tag->shm_fault, true);
+		else
+			platform_fsrv_dropshared(tag);
+
 		tag = NULL;
 		longjmp(out, -1);
 	}
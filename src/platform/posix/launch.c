@@ -306,10 +306,10 @@ struct arcan_frameserver* platform_launch_fork(
 		}
 		else if (strcmp(setup->args.builtin.mode, "encode") == 0){
 			ctx->segid = SEGID_ENCODER;
-			ctx->sz_audb = 65535;
+			ctx->sz_audb = 65536;
 			add_audio = false;
 			ctx->audb = arcan_alloc_mem(
-				65535, ARCAN_MEM_ABUFFER, 0, ARCAN_MEMALIGN_PAGE);
+				65536, ARCAN_MEM_ABUFFER, 0, ARCAN_MEMALIGN_PAGE);
 		}
 		else if (strcmp(setup->args.builtin.mode, "terminal") == 0){
 			ctx->segid = SEGID_TERMINAL;
@@ -1007,6 +1007,10 @@ enum ARCAN_TARGET_SKIPMODE {
 			float pressure, size;
 			uint16_t tilt_x, tilt_y;
 			uint8_t tool;
+	/* takes what was trailing padding, size and offsets are unchanged but
+	 * older producers may leave it uninitialized, only trust it when the
+	 * ARCAN_IOFL_COALESCED flag is set */
+			uint16_t coalesced;
 		} touch;
 
 /* presence indicates the presence of a user in front of the screen */
@@ -1056,6 +1060,14 @@ enum ARCAN_TARGET_SKIPMODE {
 		ARCAN_IOFL_GESTURE = 1,
 		ARCAN_IOFL_ENTER = 2,
 		ARCAN_IOFL_LEAVE = 4,
+
+	/* The sample is the merged result of several device samples within a time
+	 * window. For analog samples, axisval[2] carries the number of merged
+	 * samples and axisval[3] the span between the first and the last one in
+	 * microseconds (clamped to INT16_MAX). For touch samples, only the latest
+	 * position is kept and touch.coalesced carries the number of samples. In
+	 * both cases, pts is set to the time of the last sample. */
+		ARCAN_IOFL_COALESCED = 8
 	};
 
 	typedef struct {
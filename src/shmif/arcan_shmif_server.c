@@ -3,6 +3,17 @@
 #include <errno.h>
 #include <stdatomic.h>
 #include <math.h>
+#include <poll.h>
+
+#ifdef __LINUX
+#include <sys/epoll.h>
+#define GROUP_EPOLL
+#endif
+
+/* upper bound for shmifsrv_group_wait(-1) while there are connected clients */
+#ifndef GROUP_READY_TIMEOUT
+#define GROUP_READY_TIMEOUT 16
+#endif
 
 /*
  * This is needed in order to re-use some of the platform layer functions that
@@ -28,6 +39,15 @@ bool platform_video_auth(int cardn, unsigned token)
 	return false;
 }
 
+/*
+ * fsrv_guard defers dropping a faulted page when running on the engine audio
+ * thread, there is no such thread here.
+ */
+bool arcan_audio_isthread()
+{
+	return false;
+}
+
 /*
  * wrap the normal structure as we need to pass it to the platform frameserver
  * functions, but may need to have some tracking of our own.
@@ -46,6 +66,15 @@ struct shmifsrv_client {
 	enum connstatus status;
 	size_t errors;
 	uint64_t cookie;
+
+/* membership in a shmifsrv_group, [group_fd] is the handle as registered
+ * and [group_wake] is set when there was activity on it */
+	struct shmifsrv_group* group;
+	size_t group_ind;
+	void* group_tag;
+	int group_fd;
+	short group_events;
+	bool group_wake, group_hup;
 };
 
 static struct shmifsrv_client* alloc_client()
@@ -198,6 +227,12 @@ size_t shmifsrv_dequeue_events(
 			newev[count++] = cl->con->shm.ptr->parentevq.evqueue[front];
 			front = (front + 1) % PP_QUEUE_SZ;
 		}
+/* nothing to release, so don't wake the client */
+		if (!count){
+			shmifsrv_leave();
+			return 0;
+		}
+
 		asm volatile("": : :"memory");
 		__sync_synchronize();
 		cl->con->shm.ptr->parentevq.front = front;
@@ -255,6 +290,38 @@ bool shmifsrv_enqueue_event(
 		return platform_fsrv_pushevent(cl->con, ev) == ARCAN_OK;
 }
 
+/*
+ * The READY stage of shmifsrv_poll, with the event queue state added for
+ * groups. Check if resynch, else check if aready, vready or events.
+ */
+static int poll_ready(struct shmifsrv_client* cl)
+{
+	if (!shmifsrv_enter(cl)){
+		cl->status = BROKEN;
+		return CLIENT_NOT_READY;
+	}
+
+	struct arcan_shmif_page* page = cl->con->shm.ptr;
+	if (page->resized){
+		int rv = platform_fsrv_resynch(cl->con);
+		shmifsrv_leave();
+
+		if (-1 == rv){
+			cl->status = BROKEN;
+			return CLIENT_DEAD;
+		}
+		return CLIENT_NOT_READY;
+	}
+
+	int a = !!(atomic_load(&page->aready));
+	int v = !!(atomic_load(&page->vready));
+	int e = page->parentevq.front != page->parentevq.back;
+	shmifsrv_leave();
+
+	return (CLIENT_VBUFFER_READY * v) |
+		(CLIENT_ABUFFER_READY * a) | (CLIENT_EVENTS_READY * e);
+}
+
 int shmifsrv_poll(struct shmifsrv_client* cl)
 {
 	if (!cl || cl->status <= BROKEN){
@@ -288,24 +355,7 @@ int shmifsrv_poll(struct shmifsrv_client* cl)
 		}
 		cl->status = READY;
 	case READY:
-/* check if resynch, else check if aready or vready */
-		if (shmifsrv_enter(cl)){
-			if (cl->con->shm.ptr->resized){
-				if (-1 == platform_fsrv_resynch(cl->con)){
-					cl->status = BROKEN;
-					shmifsrv_leave();
-					return CLIENT_DEAD;
-				}
-				return CLIENT_NOT_READY;
-			}
-			int a = !!(atomic_load(&cl->con->shm.ptr->aready));
-			int v = !!(atomic_load(&cl->con->shm.ptr->vready));
-			shmifsrv_leave();
-			return
-				(CLIENT_VBUFFER_READY * v) | (CLIENT_ABUFFER_READY * a);
-		}
-		else
-			cl->status = BROKEN;
+		return poll_ready(cl) & ~CLIENT_EVENTS_READY;
 	break;
 	default:
 		return CLIENT_DEAD;
@@ -318,6 +368,8 @@ void shmifsrv_free(struct shmifsrv_client* cl, int mode)
 	if (!cl)
 		return;
 
+	shmifsrv_group_remove(cl);
+
 	if (cl->status == PENDING)
 		cl->con->dpipe = BADFD;
 
@@ -570,3 +622,295 @@ void shmifsrv_monotonic_rebase()
 	timebase = arcan_timemillis();
 	c_ticks = 0;
 }
+
+struct shmifsrv_group {
+	struct shmifsrv_client** members;
+	size_t count, cap;
+
+/* where the next wait / dequeue sweep starts */
+	size_t wait_ofs, deq_ofs;
+
+#ifdef GROUP_EPOLL
+	int epfd;
+#else
+	struct pollfd* pfds;
+	size_t pfds_cap;
+#endif
+};
+
+/* listening / authenticating clients need to be told about data on the
+ * handle, ready ones only about it breaking, data there is a descriptor
+ * that goes with an event and is picked up when that event is processed */
+static short group_mask(struct shmifsrv_client* cl)
+{
+	return cl->status < READY ? POLLIN : 0;
+}
+
+/* register, re-register or unregister the client handle as needed */
+static void group_sync(struct shmifsrv_client* cl)
+{
+	int fd = shmifsrv_client_handle(cl);
+	short events = fd == -1 ? 0 : group_mask(cl);
+
+	if (fd == cl->group_fd && events == cl->group_events)
+		return;
+
+#ifdef GROUP_EPOLL
+	struct epoll_event ev = {
+		.events = events & POLLIN ? EPOLLIN : 0,
+		.data.ptr = cl
+	};
+
+/* the old handle may already be closed, then it has left the set on its own */
+	if (fd != cl->group_fd){
+		if (-1 != cl->group_fd)
+			epoll_ctl(cl->group->epfd, EPOLL_CTL_DEL, cl->group_fd, NULL);
+
+		if (-1 != fd && -1 == epoll_ctl(cl->group->epfd, EPOLL_CTL_ADD, fd, &ev))
+			fd = -1;
+	}
+	else
+		epoll_ctl(cl->group->epfd, EPOLL_CTL_MOD, fd, &ev);
+#endif
+
+	cl->group_fd = fd;
+	cl->group_events = events;
+}
+
+struct shmifsrv_group* shmifsrv_group_alloc()
+{
+	struct shmifsrv_group* res = malloc(sizeof(struct shmifsrv_group));
+	if (!res)
+		return NULL;
+
+	*res = (struct shmifsrv_group){};
+
+#ifdef GROUP_EPOLL
+	res->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (-1 == res->epfd){
+		free(res);
+		return NULL;
+	}
+#endif
+
+	return res;
+}
+
+bool shmifsrv_group_add(
+	struct shmifsrv_group* grp, struct shmifsrv_client* cl, void* tag)
+{
+	if (!grp || !cl || cl->group)
+		return false;
+
+	if (grp->count == grp->cap){
+		size_t cap = grp->cap ? grp->cap * 2 : 32;
+		struct shmifsrv_client** members =
+			realloc(grp->members, cap * sizeof(struct shmifsrv_client*));
+		if (!members)
+			return false;
+
+		grp->members = members;
+		grp->cap = cap;
+	}
+
+	cl->group = grp;
+	cl->group_ind = grp->count;
+	cl->group_tag = tag;
+	cl->group_fd = -1;
+	cl->group_events = 0;
+	cl->group_hup = false;
+
+/* poll once so that already pending connections are picked up */
+	cl->group_wake = true;
+
+	grp->members[grp->count++] = cl;
+	group_sync(cl);
+
+	return true;
+}
+
+void shmifsrv_group_remove(struct shmifsrv_client* cl)
+{
+	if (!cl || !cl->group)
+		return;
+
+	struct shmifsrv_group* grp = cl->group;
+
+#ifdef GROUP_EPOLL
+	if (-1 != cl->group_fd)
+		epoll_ctl(grp->epfd, EPOLL_CTL_DEL, cl->group_fd, NULL);
+#endif
+
+/* swap in the last member to keep the set packed */
+	struct shmifsrv_client* last = grp->members[--grp->count];
+	grp->members[cl->group_ind] = last;
+	last->group_ind = cl->group_ind;
+
+	cl->group = NULL;
+	cl->group_fd = -1;
+}
+
+void shmifsrv_group_free(struct shmifsrv_group* grp)
+{
+	if (!grp)
+		return;
+
+	while (grp->count)
+		shmifsrv_group_remove(grp->members[0]);
+
+#ifdef GROUP_EPOLL
+	close(grp->epfd);
+#else
+	free(grp->pfds);
+#endif
+
+	free(grp->members);
+	free(grp);
+}
+
+static void group_mark(struct shmifsrv_client* cl, bool in, bool hup)
+{
+	cl->group_wake |= in;
+	cl->group_hup |= hup;
+}
+
+/* collect activity on the member handles, -1 on error */
+static int group_fdpoll(struct shmifsrv_group* grp, int timeout)
+{
+#ifdef GROUP_EPOLL
+	struct epoll_event evs[64];
+	int nr = epoll_wait(grp->epfd, evs, 64, timeout);
+
+	for (int i = 0; i < nr; i++)
+		group_mark(evs[i].data.ptr, evs[i].events & EPOLLIN,
+			evs[i].events & (EPOLLHUP | EPOLLERR));
+
+	return nr;
+#else
+	if (grp->pfds_cap < grp->count){
+		struct pollfd* pfds =
+			realloc(grp->pfds, grp->cap * sizeof(struct pollfd));
+		if (!pfds)
+			return -1;
+
+		grp->pfds = pfds;
+		grp->pfds_cap = grp->cap;
+	}
+
+	for (size_t i = 0; i < grp->count; i++)
+		grp->pfds[i] = (struct pollfd){
+			.fd = grp->members[i]->group_fd,
+			.events = grp->members[i]->group_events
+		};
+
+	int nr = poll(grp->pfds, grp->count, timeout);
+	for (size_t i = 0; nr > 0 && i < grp->count; i++)
+		if (grp->pfds[i].revents)
+			group_mark(grp->members[i], grp->pfds[i].revents & POLLIN,
+				grp->pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL));
+
+	return nr;
+#endif
+}
+
+static size_t group_sweep(struct shmifsrv_group* grp,
+	struct shmifsrv_group_entry* out, size_t limit)
+{
+	size_t nr = 0;
+	size_t count = grp->count;
+
+	for (size_t i = 0; i < count && nr < limit; i++){
+		size_t ind = (grp->wait_ofs + i) % count;
+		struct shmifsrv_client* cl = grp->members[ind];
+		int status = CLIENT_NOT_READY;
+		bool connected = false;
+
+/* the shared memory is only touched for clients that have gotten that far,
+ * the others are only polled when the handle says there is something */
+		if (cl->group_hup || cl->status <= BROKEN)
+			status = CLIENT_DEAD;
+
+		else if (cl->status == READY)
+			status = poll_ready(cl);
+
+		else if (cl->group_wake){
+			cl->group_wake = false;
+			status = shmifsrv_poll(cl);
+			connected = cl->status == READY;
+			group_sync(cl);
+		}
+
+		if (cl->status <= BROKEN)
+			status = CLIENT_DEAD;
+
+		if (status == CLIENT_NOT_READY && !connected)
+			continue;
+
+		out[nr++] = (struct shmifsrv_group_entry){
+			.client = cl,
+			.tag = cl->group_tag,
+			.status = status
+		};
+
+		if (nr == limit)
+			grp->wait_ofs = (ind + 1) % count;
+	}
+
+	return nr;
+}
+
+size_t shmifsrv_group_wait(struct shmifsrv_group* grp,
+	struct shmifsrv_group_entry* out, size_t limit, int timeout)
+{
+	if (!grp || !out || !limit || !grp->count)
+		return 0;
+
+	group_fdpoll(grp, 0);
+	size_t nr = group_sweep(grp, out, limit);
+
+/* buffer and event signalling from connected clients doesn't wake the
+ * handles, waiting forever would stall those until something else happens */
+	if (!nr && timeout < 0){
+		for (size_t i = 0; i < grp->count; i++)
+			if (grp->members[i]->status == READY){
+				timeout = GROUP_READY_TIMEOUT;
+				break;
+			}
+	}
+
+	if (!nr && timeout){
+		group_fdpoll(grp, timeout);
+		nr = group_sweep(grp, out, limit);
+	}
+
+	return nr;
+}
+
+size_t shmifsrv_group_dequeue(struct shmifsrv_group* grp,
+	struct arcan_event* evs, struct shmifsrv_group_entry* from, size_t limit)
+{
+	if (!grp || !evs || !from || !grp->count)
+		return 0;
+
+	size_t nr = 0;
+	size_t count = grp->count;
+
+	for (size_t i = 0; i < count && nr < limit; i++){
+		size_t ind = (grp->deq_ofs + i) % count;
+		struct shmifsrv_client* cl = grp->members[ind];
+
+		size_t got = shmifsrv_dequeue_events(cl, &evs[nr], limit - nr);
+		for (size_t j = 0; j < got; j++)
+			from[nr + j] = (struct shmifsrv_group_entry){
+				.client = cl,
+				.tag = cl->group_tag
+			};
+		nr += got;
+
+/* the next one goes first next time so a busy client can't starve the rest */
+		if (nr == limit)
+			grp->deq_ofs = (ind + 1) % count;
+	}
+
+	return nr;
+}
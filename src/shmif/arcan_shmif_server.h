@@ -185,7 +185,9 @@ enum shmifsrv_client_status {
 	CLIENT_DEAD = -1,
 	CLIENT_NOT_READY = 0,
 	CLIENT_VBUFFER_READY = 1,
-	CLIENT_ABUFFER_READY = 2
+	CLIENT_ABUFFER_READY = 2,
+/* only reported by shmifsrv_group_wait */
+	CLIENT_EVENTS_READY = 4
 };
 int shmifsrv_poll(struct shmifsrv_client*);
 
@@ -357,3 +359,94 @@ int shmifsrv_monotonic_tick(int* left);
  * pause, global suspend action and so on.
  */
 void shmifsrv_monotonic_rebase();
+
+/*
+ * Groups are for hosting many clients in one processing loop. Instead of
+ * polling every client handle and calling shmifsrv_poll on each client every
+ * iteration, the handles are kept in one epoll set (poll() where epoll is
+ * missing) and the wait call returns only the clients that need attention.
+ *
+ * Typical use:
+ *  struct shmifsrv_group* grp = shmifsrv_group_alloc();
+ *  shmifsrv_group_add(grp, cl, my_tag);
+ *
+ *  [loop]
+ *   size_t n = shmifsrv_group_wait(grp, ready, COUNT_OF(ready), 16);
+ *   for (size_t i = 0; i < n; i++)
+ *     ready[i].status & CLIENT_VBUFFER_READY -> shmifsrv_video(ready[i].client)
+ *     ...
+ *
+ *   while ((n = shmifsrv_group_dequeue(grp, evs, from, COUNT_OF(evs))))
+ *     ... evs[i] came from from[i].client ...
+ *
+ * A client can be a member of one group at a time. Freeing the client
+ * through shmifsrv_free removes it from its group.
+ */
+struct shmifsrv_group;
+
+struct shmifsrv_group_entry {
+	struct shmifsrv_client* client;
+	void* tag;
+
+/* bitmask of shmifsrv_client_status, or CLIENT_DEAD */
+	int status;
+};
+
+/*
+ * Allocate an empty group, returns NULL on failure.
+ */
+struct shmifsrv_group* shmifsrv_group_alloc();
+
+/*
+ * Add [cl] to the group with an opaque [tag] that will be returned in the
+ * entries referencing the client. Returns false if out of memory or if the
+ * client is already in a group.
+ */
+bool shmifsrv_group_add(
+	struct shmifsrv_group*, struct shmifsrv_client* cl, void* tag);
+
+/*
+ * Remove a client from the group it is a member of, if any.
+ */
+void shmifsrv_group_remove(struct shmifsrv_client* cl);
+
+/*
+ * Free the group. The members are removed, not freed.
+ */
+void shmifsrv_group_free(struct shmifsrv_group*);
+
+/*
+ * Fill out [out] with up to [limit] clients that have video, audio or
+ * events pending, have died or have just finished connecting. A client
+ * that just connected is returned once, with CLIENT_NOT_READY unless
+ * something else is pending. For a connection point this is the time to
+ * allocate the next one from its handle. Dead clients are returned until
+ * removed or freed.
+ *
+ * Clients that are still listening or authenticating are only polled when
+ * their handle is readable. If more than [limit] clients are ready, the
+ * next call starts with the ones that didn't fit.
+ *
+ * If no client is ready, this waits up to [timeout] milliseconds (-1,
+ * forever) for activity on the client handles. Buffer and event signalling
+ * goes through shared memory and does not wake the handles, so [timeout]
+ * also bounds the latency for those when the group is otherwise idle. For
+ * that reason -1 only waits forever while no member has finished
+ * connecting, otherwise it is treated as a short (16 ms) timeout.
+ *
+ * Returns the number of entries written.
+ */
+size_t shmifsrv_group_wait(struct shmifsrv_group*,
+	struct shmifsrv_group_entry* out, size_t limit, int timeout);
+
+/*
+ * [CRITICAL] (managed internally, call outside of enter/leave)
+ * Dequeue up to [limit] events across all members into [evs], with the
+ * client each event came from in the matching [from] entry (status is not
+ * set). Clients are visited round-robin, starting after the one that last
+ * filled the buffer so that one chatty client can't starve the others.
+ *
+ * Returns the number of events dequeued.
+ */
+size_t shmifsrv_group_dequeue(struct shmifsrv_group*,
+	struct arcan_event* evs, struct shmifsrv_group_entry* from, size_t limit);
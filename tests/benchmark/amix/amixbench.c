@@ -0,0 +1,149 @@
+/*
+ * Microbenchmark for the frameserver audio mixer kernels (arcan_amix.c).
+ *
+ * Mixes N synthetic 48kHz stereo sources for a number of seconds worth of
+ * audio in the same block sizes as the frameserver feed, once with the old
+ * per-sample float mixer and once with the planar ring/SIMD pipeline.
+ *
+ * Output (stdout, CSV): sources:seconds:reference_us:amix_us:speedup
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "arcan_amix.h"
+
+#define RATE 48000
+#define BLOCK 1024
+
+static unsigned long long micros()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+static int16_t* gen_source(size_t frames, float freq)
+{
+	int16_t* buf = malloc(frames * 2 * sizeof(int16_t));
+	for (size_t i = 0; i < frames; i++){
+		float v = sinf(2.0f * M_PI * freq * (float) i / (float) RATE);
+		buf[i * 2 + 0] = v * 16000;
+		buf[i * 2 + 1] = v * 12000;
+	}
+	return buf;
+}
+
+/* the mixer as it was before the planar rewrite, buffers and all */
+static void run_reference(int16_t** src,
+	size_t n, size_t frames, int16_t* out)
+{
+	float (*inbuf)[4096] = calloc(n, sizeof(float) * 4096);
+	size_t* inofs = calloc(n, sizeof(size_t));
+	size_t outofs = 0;
+
+	for (size_t ofs = 0; ofs < frames; ofs += BLOCK / 2){
+		size_t minv = SIZE_MAX;
+
+		for (size_t i = 0; i < n; i++){
+			int16_t* buf = &src[i][ofs * 2];
+			size_t count = 0;
+			size_t nsamples = BLOCK;
+			while (nsamples-- && inofs[i] < 4096){
+				float val = *buf++;
+				inbuf[i][inofs[i]++] = (count++ % 2 ? 1.0f : 0.8f) * (val / 32767.0f);
+			}
+			if (inofs[i] < minv)
+				minv = inofs[i];
+		}
+
+		if (minv <= 512)
+			continue;
+
+		for (size_t sc = 0; sc < minv; sc++){
+			float work = 0;
+			for (size_t i = 0; i < n; i++)
+				work += inbuf[i][sc] - work * inbuf[i][sc];
+			out[outofs++ % (frames * 2)] = work >= 1.0 ? 32767 :
+				(work < -1.0 ? -32768 : work * 32767);
+		}
+
+		for (size_t i = 0; i < n; i++){
+			memmove(inbuf[i], &inbuf[i][minv], (inofs[i] - minv) * sizeof(float));
+			inofs[i] -= minv;
+		}
+	}
+
+	free(inbuf);
+	free(inofs);
+}
+
+static void run_amix(int16_t** src, size_t n, size_t frames, int16_t* out)
+{
+	struct arcan_amix_ring* rings = calloc(n, sizeof(struct arcan_amix_ring));
+	float mix_l[512], mix_r[512];
+	float gain = 1.0f;
+	size_t outofs = 0;
+
+	for (size_t ofs = 0; ofs < frames; ofs += BLOCK / 2){
+		size_t minv = SIZE_MAX;
+
+		for (size_t i = 0; i < n; i++){
+			arcan_amix_ring_write_s16(&rings[i], &src[i][ofs * 2], BLOCK / 2, 0.8, 1.0);
+			size_t used = arcan_amix_ring_used(&rings[i]);
+			if (used < minv)
+				minv = used;
+		}
+
+		while (minv){
+			size_t step = minv > 512 ? 512 : minv;
+			memset(mix_l, '\0', step * sizeof(float));
+			memset(mix_r, '\0', step * sizeof(float));
+
+			for (size_t i = 0; i < n; i++)
+				arcan_amix_ring_accum(&rings[i], mix_l, mix_r, step);
+
+			float next = arcan_amix_limit(gain, arcan_amix_peak(mix_l, mix_r, step));
+			if ((outofs + step) * 2 > frames * 2)
+				outofs = 0;
+			arcan_amix_f32_s16(mix_l, mix_r,
+				step, next < gain ? next : gain, next, &out[outofs * 2]);
+			gain = next;
+			outofs += step;
+			minv -= step;
+		}
+	}
+
+	free(rings);
+}
+
+int main(int argc, char** argv)
+{
+	size_t seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : 10;
+	size_t maxsrc = argc > 2 ? strtoul(argv[2], NULL, 10) : 16;
+	size_t frames = RATE * seconds;
+
+	int16_t** src = malloc(sizeof(int16_t*) * maxsrc);
+	for (size_t i = 0; i < maxsrc; i++)
+		src[i] = gen_source(frames + BLOCK, 220.0f * (i + 1));
+
+	int16_t* out = malloc(frames * 2 * sizeof(int16_t));
+
+	for (size_t n = 1; n <= maxsrc; n *= 2){
+		unsigned long long start = micros();
+		run_reference(src, n, frames, out);
+		unsigned long long ref = micros() - start;
+
+		start = micros();
+		run_amix(src, n, frames, out);
+		unsigned long long amix = micros() - start;
+
+		printf("%zu:%zu:%llu:%llu:%.2f\n", n, seconds,
+			ref, amix, amix ? (double) ref / (double) amix : 0.0);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+--
+-- Animation stepping, a large number of small objects that all run cycling
+-- move, blend and scale transformations. Rendering is kept cheap (1x1
+-- surfaces, mostly outside of the screen) so that the tick cost is what is
+-- measured.
+--
+-- Arguments: objects (default 50000), seconds (default 10)
+--
+-- Output (one line per second):
+-- objects:ticks:avg_tick_ms:frames:avg_frame_ms
+--
+
+local count = 50000;
+local seconds = 10;
+
+local function avg(n, tbl)
+	local sum = 0;
+	for i=0,#tbl do
+		sum = sum + (tbl[i] and tbl[i] or 0);
+	end
+	n = n < 63 and n or 63;
+	return n > 0 and sum / n or 0;
+end
+
+function animate(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	seconds = tonumber(arguments[2]) and tonumber(arguments[2]) or seconds;
+
+-- the default context is too small, get a new one that fits
+	local lim = math.min(count + 16, 65536);
+	system_context_size(lim);
+	push_video_context();
+	count = lim - 16;
+
+	for i=1,count do
+		local vid = color_surface(1, 1,
+			math.random(255), math.random(255), math.random(255));
+		local t = math.random(10, 100);
+
+		show_image(vid);
+		move_image(vid, math.random(VRESW), math.random(VRESH), t);
+		move_image(vid, math.random(VRESW), math.random(VRESH), t);
+		blend_image(vid, 0.5, t);
+		blend_image(vid, 1.0, t);
+		resize_image(vid, math.random(4), math.random(4), t);
+		resize_image(vid, 1, 1, t);
+		image_transform_cycle(vid, 1);
+	end
+
+	benchmark_enable(true);
+	print("objects:ticks:avg_tick_ms:frames:avg_frame_ms");
+end
+
+function animate_clock_pulse()
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local nticks, ticks, nframes, frames = benchmark_data();
+
+	print(string.format("%d:%d:%.2f:%d:%.2f", count,
+		nticks, avg(nticks, ticks), nframes, avg(nframes, frames)));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
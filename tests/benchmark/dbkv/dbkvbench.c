@@ -0,0 +1,155 @@
+/*
+ * Latency benchmark for the appl key-value store in arcan_db.c
+ *
+ * Populates an appl table with a number of keys, then measures random
+ * get/set through three paths:
+ *  prepare - a statement prepared and finalized per call (the old behavior)
+ *  cached  - arcan_db_appl_val/kv with the prepared statement cache
+ *  mirror  - same, with the in-memory kv mirror enabled
+ *  wbehind - mirror and the write-behind worker, set measures the main
+ *            thread cost, the commit happens on the worker
+ *
+ * Output (stdout, CSV): mode:op:keys:count:ns_per_op
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sqlite3.h>
+
+#include "arcan_math.h"
+#include "arcan_general.h"
+#include "arcan_db.h"
+
+#define APPL "bench"
+
+static unsigned long long nanos()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void mkkey(char* buf, size_t buf_sz, size_t i)
+{
+	snprintf(buf, buf_sz, "window_%zu_settings", i);
+}
+
+static void populate(struct arcan_dbh* dbh, size_t n)
+{
+	char key[48], val[32];
+	arcan_db_begin_transaction(dbh, DVT_APPL, (union arcan_dbtrans_id){0});
+	for (size_t i = 0; i < n; i++){
+		mkkey(key, sizeof(key), i);
+		snprintf(val, sizeof(val), "%zu:%zu:640:480", i * 3, i * 7);
+		arcan_db_add_kvpair(dbh, key, val);
+	}
+	arcan_db_end_transaction(dbh);
+}
+
+static char* prepare_get(sqlite3* db, const char* key)
+{
+	sqlite3_stmt* stmt;
+	char* res = NULL;
+	sqlite3_prepare_v2(db, "SELECT val FROM appl_" APPL " WHERE key = ?;",
+		-1, &stmt, NULL);
+	sqlite3_bind_text(stmt, 1, key, -1, SQLITE_TRANSIENT);
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		res = strdup((const char*) sqlite3_column_text(stmt, 0));
+	sqlite3_finalize(stmt);
+	return res;
+}
+
+static void prepare_set(sqlite3* db, const char* key, const char* val)
+{
+	sqlite3_stmt* stmt;
+	sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO appl_" APPL
+		"(key, val) VALUES(?, ?);", -1, &stmt, NULL);
+	sqlite3_bind_text(stmt, 1, key, -1, SQLITE_TRANSIENT);
+	sqlite3_bind_text(stmt, 2, val, -1, SQLITE_TRANSIENT);
+	sqlite3_step(stmt);
+	sqlite3_finalize(stmt);
+}
+
+static void run(const char* mode, const char* fn,
+	struct arcan_dbh* dbh, size_t keys, size_t count)
+{
+	sqlite3* db = NULL;
+	if (strcmp(mode, "prepare") == 0){
+		sqlite3_open(fn, &db);
+		sqlite3_exec(db, "PRAGMA synchronous=OFF;", NULL, NULL, NULL);
+	}
+	else {
+		bool wbehind = strcmp(mode, "wbehind") == 0;
+		arcan_db_kvmirror(dbh, wbehind || strcmp(mode, "mirror") == 0);
+		if (wbehind)
+			arcan_db_writebehind(dbh, 250, DB_SYNCH_NORMAL);
+	}
+
+	char key[48], val[32];
+	unsigned seed = 1;
+
+	unsigned long long start = nanos();
+	for (size_t i = 0; i < count; i++){
+		mkkey(key, sizeof(key), rand_r(&seed) % keys);
+		char* res = db ? prepare_get(db, key) : arcan_db_appl_val(dbh, APPL, key);
+		free(res);
+	}
+	unsigned long long get = nanos() - start;
+
+	start = nanos();
+	for (size_t i = 0; i < count; i++){
+		mkkey(key, sizeof(key), rand_r(&seed) % keys);
+		snprintf(val, sizeof(val), "%zu", i);
+		if (db)
+			prepare_set(db, key, val);
+		else
+			arcan_db_appl_kv(dbh, APPL, key, val);
+	}
+	if (!db)
+		arcan_db_flush(dbh);
+	unsigned long long set = nanos() - start;
+
+	printf("%s:get:%zu:%zu:%.1f\n", mode, keys, count, (double) get / count);
+	printf("%s:set:%zu:%zu:%.1f\n", mode, keys, count, (double) set / count);
+
+	if (db)
+		sqlite3_close(db);
+	else {
+		arcan_db_sync(dbh);
+		arcan_db_writebehind(dbh, 0, DB_SYNCH_OFF);
+		arcan_db_kvmirror(dbh, false);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t keys = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+	size_t count = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+
+	char fn[] = "/tmp/dbkvbench_XXXXXX";
+	int fd = mkstemp(fn);
+	if (-1 == fd)
+		return EXIT_FAILURE;
+	close(fd);
+	unlink(fn);
+
+	struct arcan_dbh* dbh = arcan_db_open(fn, APPL);
+	if (!dbh){
+		fprintf(stderr, "couldn't open database at %s\n", fn);
+		return EXIT_FAILURE;
+	}
+	populate(dbh, keys);
+
+	run("prepare", fn, dbh, keys, count);
+	run("cached", fn, dbh, keys, count);
+	run("mirror", fn, dbh, keys, count);
+	run("wbehind", fn, dbh, keys, count);
+
+	arcan_db_close(&dbh);
+	unlink(fn);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+--
+-- Frustum culling, a large number of boxes spread out around a camera that
+-- keeps turning so that only a part of the scene is in view at any time.
+-- The boxes alternate between a few textures and have blending disabled to
+-- give the sorting pass something to group.
+--
+-- Arguments: boxes (default 5000), textures (default 4), seconds (default 10)
+--
+-- Output (one line per second):
+-- boxes:frames:avg_frame_ms:drawn_per_frame:culled_per_frame
+--
+
+local count = 5000;
+local ntex = 4;
+local seconds = 10;
+
+local function avg(n, tbl)
+	local sum = 0;
+	for i=0,#tbl do
+		sum = sum + (tbl[i] and tbl[i] or 0);
+	end
+	n = n < 63 and n or 63;
+	return n > 0 and sum / n or 0;
+end
+
+function frustum(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	ntex = tonumber(arguments[2]) and tonumber(arguments[2]) or ntex;
+	seconds = tonumber(arguments[3]) and tonumber(arguments[3]) or seconds;
+
+	local lim = math.min(count + 16 + ntex, 65536);
+	system_context_size(lim);
+	push_video_context();
+	count = lim - 16 - ntex;
+
+	local camera = null_surface(1, 1);
+	camtag_model(camera, 0.1, 100.0, 45.0, VRESW / VRESH, 1, 1);
+	rotate3d_model(camera, 0, 0, 360, 200);
+	rotate3d_model(camera, 0, 0, 0, 200);
+	image_transform_cycle(camera, 1);
+
+	local textures = {};
+	for i=1,ntex do
+		textures[i] = random_surface(32, 32);
+	end
+
+	for i=1,count do
+		local box = build_3dbox(0.5, 0.5, 0.5, 1);
+		image_sharestorage(textures[(i % ntex) + 1], box);
+		force_image_blend(box, BLEND_NONE);
+		local ang = math.random() * math.pi * 2;
+		local dist = 5 + math.random() * 50;
+		move3d_model(box,
+			math.cos(ang) * dist, math.random() * 10 - 5, math.sin(ang) * dist);
+		show_image(box);
+	end
+
+	benchmark_enable(true);
+	print("boxes:frames:avg_frame_ms:drawn_per_frame:culled_per_frame");
+end
+
+function frustum_clock_pulse()
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, nframes, frames, _, _, counters = benchmark_data();
+	local drawn, culled = counters.drawn3d, counters.culled3d;
+
+	print(string.format("%d:%d:%.2f:%.1f:%.1f", count, nframes,
+		avg(nframes, frames),
+		nframes > 0 and drawn / nframes or 0,
+		nframes > 0 and culled / nframes or 0));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
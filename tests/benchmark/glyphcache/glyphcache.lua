@@ -0,0 +1,117 @@
+--
+-- Glyph cache, render a large mixed-script corpus (latin, greek, cyrillic,
+-- CJK, hangul, emoji) with bold and italic switches through render_text so
+-- that the rendering cost is dominated by glyph lookups rather than by the
+-- number of strings. Use a font that covers the ranges (or a fallback chain
+-- set through system_defaultfont) to exercise the full set.
+--
+-- Arguments: font (default: the default font), size (default 18), lines per
+-- tick (default 20), seconds (default 10)
+--
+-- Output (one line per second), hits and misses are glyph cache lookups:
+-- lines:glyphs:usec_total:usec_per_line:hits:misses
+--
+
+local font = nil;
+local size = 18;
+local lines = 20;
+local seconds = 10;
+local corpus = {};
+local used = 0;
+local glyphs = 0;
+local total = 0;
+local vid = nil;
+
+local ranges = {
+	{0x0041, 0x007a},
+	{0x0391, 0x03c9},
+	{0x0410, 0x044f},
+	{0x4e00, 0x62ff},
+	{0xac00, 0xb7ff},
+	{0x1f300, 0x1f5ff}
+};
+
+local function utf8(cp)
+	if (cp < 0x80) then
+		return string.char(cp);
+	elseif (cp < 0x800) then
+		return string.char(0xc0 + math.floor(cp / 0x40), 0x80 + cp % 0x40);
+	elseif (cp < 0x10000) then
+		return string.char(0xe0 + math.floor(cp / 0x1000),
+			0x80 + math.floor(cp / 0x40) % 0x40, 0x80 + cp % 0x40);
+	end
+	return string.char(0xf0 + math.floor(cp / 0x40000),
+		0x80 + math.floor(cp / 0x1000) % 0x40,
+		0x80 + math.floor(cp / 0x40) % 0x40, 0x80 + cp % 0x40);
+end
+
+-- words from a random range, a few style switches per line
+local function build_line()
+	local res = {};
+	local n = 0;
+	for i=1,8 do
+		local r = ranges[math.random(#ranges)];
+		local word = {};
+		for j=1,math.random(2, 8) do
+			table.insert(word, utf8(math.random(r[1], r[2])));
+			n = n + 1;
+		end
+		local style = ({"", "\\b", "\\i", "\\!b\\!i"})[math.random(4)];
+		table.insert(res, style .. table.concat(word) .. " ");
+	end
+	return table.concat(res), n;
+end
+
+function glyphcache(arguments)
+	font = arguments[1] and #arguments[1] > 0 and arguments[1] or nil;
+	size = tonumber(arguments[2]) and tonumber(arguments[2]) or size;
+	lines = tonumber(arguments[3]) and tonumber(arguments[3]) or lines;
+	seconds = tonumber(arguments[4]) and tonumber(arguments[4]) or seconds;
+
+	if (font) then
+		system_defaultfont(font, size, 0);
+	end
+
+	for i=1,1000 do
+		local line, n = build_line();
+		corpus[i] = {string.format("\\f,%d", size) .. line, n};
+	end
+
+	benchmark_enable(true);
+	print("lines:glyphs:usec_total:usec_per_line:hits:misses");
+end
+
+function glyphcache_clock_pulse()
+	local start = benchmark_timestamp(-1);
+	for i=1,lines do
+		local ent = corpus[math.random(#corpus)];
+		if (vid) then
+			render_text(vid, ent[1]);
+		else
+			vid = render_text(ent[1]);
+		end
+		glyphs = glyphs + ent[2];
+	end
+	total = total + benchmark_timestamp(-1) - start;
+	used = used + lines;
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, _, _, _, _, counters = benchmark_data();
+	local hit, miss = counters.glyphhit, counters.glyphmiss;
+
+	print(string.format("%d:%d:%d:%.2f:%d:%d",
+		used, glyphs, total, used > 0 and total / used or 0, hit, miss));
+	benchmark_enable(false);
+	benchmark_enable(true);
+	used = 0;
+	glyphs = 0;
+	total = 0;
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
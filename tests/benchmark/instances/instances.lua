@@ -0,0 +1,89 @@
+--
+-- Instancing, a grid of boxes in front of the camera that are either
+-- instances of one model or separate models with the same texture. The
+-- draws column shows the number of mesh draw calls needed per frame, with
+-- instancing it should stay at one regardless of the number of boxes.
+--
+-- Arguments: boxes (default 5000), mode (instance or copy, default
+-- instance), seconds (default 10)
+--
+-- Output (one line per second):
+-- boxes:frames:avg_frame_ms:drawn_per_frame:draws_per_frame
+--
+
+local count = 5000;
+local mode = "instance";
+local seconds = 10;
+local boxes = {};
+
+local function avg(n, tbl)
+	local sum = 0;
+	for i=0,#tbl do
+		sum = sum + (tbl[i] and tbl[i] or 0);
+	end
+	n = n < 63 and n or 63;
+	return n > 0 and sum / n or 0;
+end
+
+function instances(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	mode = arguments[2] and arguments[2] or mode;
+	seconds = tonumber(arguments[3]) and tonumber(arguments[3]) or seconds;
+
+	local lim = math.min(count + 16, 65536);
+	system_context_size(lim);
+	push_video_context();
+	count = lim - 16;
+
+	local camera = null_surface(1, 1);
+	camtag_model(camera, 0.1, 200.0, 45.0, VRESW / VRESH, 1, 1);
+	forward3d_model(camera, -60.0);
+
+	local texture = random_surface(32, 32);
+	local source = build_3dbox(0.2, 0.2, 0.2, 1);
+	image_sharestorage(texture, source);
+
+	local side = math.ceil(math.sqrt(count));
+	for i=1,count do
+		local box;
+		if (mode == "copy") then
+			box = build_3dbox(0.2, 0.2, 0.2, 1);
+			image_sharestorage(texture, box);
+		else
+			box = instance_3dmodel(source);
+		end
+
+		local x = (i - 1) % side;
+		local y = math.floor((i - 1) / side);
+		move3d_model(box, (x - side * 0.5) * 0.5, (y - side * 0.5) * 0.5, 0);
+		rotate3d_model(box, 0, 0, 360, 100 + i % 100);
+		rotate3d_model(box, 0, 0, 0, 100 + i % 100);
+		image_transform_cycle(box, 1);
+		show_image(box);
+		boxes[i] = box;
+	end
+
+	benchmark_enable(true);
+	print("boxes:frames:avg_frame_ms:drawn_per_frame:draws_per_frame");
+end
+
+function instances_clock_pulse()
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, nframes, frames, _, _, counters = benchmark_data();
+	local drawn, draws = counters.drawn3d, counters.draws3d;
+
+	print(string.format("%d:%d:%.2f:%.1f:%.1f", count, nframes,
+		avg(nframes, frames),
+		nframes > 0 and drawn / nframes or 0,
+		nframes > 0 and draws / nframes or 0));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
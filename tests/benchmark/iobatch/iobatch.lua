@@ -0,0 +1,60 @@
+--
+-- Input delivery throughput, measures events/ms through the scripting
+-- boundary using the engine side io counters in benchmark_data. Needs an
+-- input source that produces a lot of samples, e.g. the mreplay tool in
+-- the iocoalesce benchmark folder.
+--
+-- Arguments: mode (batch or single, default batch), seconds (default 10)
+--
+-- Output (one line per second):
+-- mode:events:usec:events_per_ms:lua_kb
+--
+
+local mode = "batch";
+local seconds = 10;
+local sum_x = 0;
+
+function iobatch(arguments)
+	if (arguments[1]) then
+		mode = arguments[1];
+	end
+	seconds = tonumber(arguments[2]) and tonumber(arguments[2]) or seconds;
+
+	if (mode == "batch") then
+		iobatch_input_batch = function(tbl, n)
+			for i=1,n do
+				if (tbl.kind[i] == "analog") then
+					sum_x = sum_x + tbl.a1[i];
+				end
+			end
+		end
+	else
+		iobatch_input = function(iotbl)
+			if (iotbl.analog) then
+				sum_x = sum_x + iotbl.samples[1];
+			end
+		end
+	end
+
+	inputanalog_toggle(true);
+	benchmark_enable(true);
+	print("mode:events:usec:events_per_ms:lua_kb");
+end
+
+function iobatch_clock_pulse()
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, _, _, _, _, counters = benchmark_data();
+	local count, time = counters.iocount, counters.iotime;
+	print(string.format("%s:%d:%d:%.2f:%d", mode, count, time,
+		time > 0 and count / (time / 1000) or 0, collectgarbage("count")));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
@@ -0,0 +1,44 @@
+--
+-- Input queue pressure test, counts the number of io events that reach the
+-- appl and the number of device samples they carry. Pair with the mreplay
+-- tool (same folder) that replays a 8kHz mouse trace through uinput, and
+-- run once with and once without ARCAN_EVENT_COALESCE=n set.
+--
+-- Output (one line per second):
+-- events:samples:samples_per_event
+--
+
+local events = 0;
+local samples = 0;
+local seconds = 0;
+
+function iocoalesce(arguments)
+	seconds = tonumber(arguments[1]) and tonumber(arguments[1]) or 10;
+	inputanalog_toggle(true);
+	print("events:samples:samples_per_event");
+end
+
+function iocoalesce_input(iotbl)
+	if (not iotbl.analog and not iotbl.touch) then
+		return;
+	end
+
+	events = events + 1;
+	samples = samples + (iotbl.coalesced and iotbl.coalesced or 1);
+end
+
+function iocoalesce_clock_pulse()
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	print(string.format("%d:%d:%.2f", events, samples,
+		events > 0 and samples / events or 0));
+	events = 0;
+	samples = 0;
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
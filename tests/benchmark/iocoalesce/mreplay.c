@@ -0,0 +1,116 @@
+/*
+ * Replay a mouse motion trace through a uinput device, used together with
+ * the iocoalesce benchmark to measure input queue pressure.
+ *
+ * Usage: mreplay [seconds] [trace]
+ *
+ * The trace is a text file with one 'usec dx dy' tuple per line, where usec
+ * is the delay since the previous sample. Without a trace, a synthetic 8kHz
+ * circular motion is generated.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <math.h>
+#include <time.h>
+#include <linux/uinput.h>
+
+static void emit(int fd, int type, int code, int val)
+{
+	struct input_event ev = {
+		.type = type,
+		.code = code,
+		.value = val
+	};
+
+	if (-1 == write(fd, &ev, sizeof(ev)))
+		fprintf(stderr, "write failed\n");
+}
+
+static void sleep_until(struct timespec* ts, long usec)
+{
+	ts->tv_nsec += usec * 1000;
+	while (ts->tv_nsec >= 1000000000){
+		ts->tv_nsec -= 1000000000;
+		ts->tv_sec++;
+	}
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, ts, NULL);
+}
+
+int main(int argc, char** argv)
+{
+	int seconds = argc > 1 ? strtoul(argv[1], NULL, 10) : 10;
+	FILE* trace = NULL;
+
+	if (argc > 2 && !(trace = fopen(argv[2], "r"))){
+		fprintf(stderr, "couldn't open trace: %s\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+	if (-1 == fd){
+		fprintf(stderr, "couldn't open /dev/uinput\n");
+		return EXIT_FAILURE;
+	}
+
+	ioctl(fd, UI_SET_EVBIT, EV_KEY);
+	ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
+	ioctl(fd, UI_SET_EVBIT, EV_REL);
+	ioctl(fd, UI_SET_RELBIT, REL_X);
+	ioctl(fd, UI_SET_RELBIT, REL_Y);
+
+	struct uinput_setup usetup = {
+		.id = {
+			.bustype = BUS_USB,
+			.vendor = 0x1234,
+			.product = 0x5678
+		},
+		.name = "arcan-mreplay"
+	};
+
+	ioctl(fd, UI_DEV_SETUP, &usetup);
+	ioctl(fd, UI_DEV_CREATE);
+
+/* give the engine a chance to discover the device */
+	sleep(1);
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	size_t count = 0;
+	size_t limit = (size_t) seconds * 8000;
+
+	while (count < limit){
+		long usec = 125;
+		int dx, dy;
+
+		if (trace){
+			if (3 != fscanf(trace, "%ld %d %d", &usec, &dx, &dy)){
+				rewind(trace);
+				continue;
+			}
+		}
+		else {
+			float ang = (float)count / 8000.0 * M_PI * 2.0;
+			dx = roundf(cosf(ang) * 2.0);
+			dy = roundf(sinf(ang) * 2.0);
+		}
+
+		emit(fd, EV_REL, REL_X, dx);
+		emit(fd, EV_REL, REL_Y, dy);
+		emit(fd, EV_SYN, SYN_REPORT, 0);
+		count++;
+
+		sleep_until(&ts, usec);
+	}
+
+	printf("%zu samples\n", count);
+	ioctl(fd, UI_DEV_DESTROY);
+	close(fd);
+
+	return EXIT_SUCCESS;
+}
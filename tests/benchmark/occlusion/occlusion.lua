@@ -0,0 +1,78 @@
+--
+-- Occlusion culling, a stack of window-like surfaces with a lot of small
+-- decorations on each, where only the topmost windows are actually visible.
+-- Compare with the video_noocclusion config key set to see the difference
+-- in frame time.
+--
+-- Arguments: windows (default 32), decorations per window (default 16),
+-- seconds (default 10)
+--
+-- Output (one line per second):
+-- frames:avg_ms:culled_per_frame
+--
+
+local windows = 32;
+local decor = 16;
+local seconds = 10;
+local wnds = {};
+
+function occlusion(arguments)
+	windows = tonumber(arguments[1]) and tonumber(arguments[1]) or windows;
+	decor = tonumber(arguments[2]) and tonumber(arguments[2]) or decor;
+	seconds = tonumber(arguments[3]) and tonumber(arguments[3]) or seconds;
+
+	for i=1,windows do
+		local full = i % 4 == 0;
+		local w = full and VRESW or math.random(VRESW * 0.25, VRESW * 0.75);
+		local h = full and VRESH or math.random(VRESH * 0.25, VRESH * 0.75);
+		local wnd = color_surface(w, h,
+			math.random(255), math.random(255), math.random(255));
+		move_image(wnd,
+			full and 0 or math.random(VRESW - w), full and 0 or math.random(VRESH - h));
+		order_image(wnd, i * (decor + 1));
+		show_image(wnd);
+
+		for j=1,decor do
+			local d = color_surface(math.random(8, 32), math.random(8, 32),
+				math.random(255), math.random(255), math.random(255));
+			link_image(d, wnd);
+			image_inherit_order(d, true);
+			order_image(d, j);
+			move_image(d, math.random(w - 32), math.random(h - 32));
+			show_image(d);
+		end
+
+		table.insert(wnds, wnd);
+	end
+
+	benchmark_enable(true);
+	print("frames:avg_ms:culled_per_frame");
+end
+
+function occlusion_clock_pulse()
+-- keep the scene dirty
+	local wnd = wnds[math.random(#wnds)];
+	blend_image(wnd, 1.0, 1);
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, nframes, frames, _, _, counters = benchmark_data();
+	local culled = counters.culled;
+	local sum = 0;
+	for i=0,#frames do
+		sum = sum + (frames[i] and frames[i] or 0);
+	end
+	local n = nframes < 63 and nframes or 63;
+
+	print(string.format("%d:%.2f:%.2f", nframes,
+		n > 0 and sum / n or 0, nframes > 0 and culled / nframes or 0));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
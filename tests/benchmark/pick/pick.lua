@@ -0,0 +1,77 @@
+--
+-- Hit testing, a large number of small objects scattered over the screen
+-- and a fixed number of pick_items calls per tick at random positions.
+-- A fraction of the objects are kept moving to exercise index updates.
+-- Compare with the video_nopickindex config key set for the linear version.
+--
+-- Arguments: objects (default 10000), picks per tick (default 100),
+-- moving objects (default 100), seconds (default 10)
+--
+-- Output (one line per second):
+-- objects:picks:hits:usec:usec_per_pick
+--
+
+local count = 10000;
+local picks = 100;
+local moving = 100;
+local seconds = 10;
+local objs = {};
+local hits = 0;
+local total = 0;
+local usec = 0;
+
+function pick(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	picks = tonumber(arguments[2]) and tonumber(arguments[2]) or picks;
+	moving = tonumber(arguments[3]) and tonumber(arguments[3]) or moving;
+	seconds = tonumber(arguments[4]) and tonumber(arguments[4]) or seconds;
+
+-- the default context is too small, get a new one that fits
+	local lim = math.min(count + 16, 65536);
+	system_context_size(lim);
+	push_video_context();
+	count = lim - 16;
+
+	for i=1,count do
+		local vid = color_surface(math.random(8, 48), math.random(8, 48),
+			math.random(255), math.random(255), math.random(255));
+		move_image(vid, math.random(VRESW), math.random(VRESH));
+		order_image(vid, math.random(1000));
+		if (i % 10 == 0) then
+			rotate_image(vid, math.random(359));
+		end
+		show_image(vid);
+		table.insert(objs, vid);
+	end
+
+	print("objects:picks:hits:usec:usec_per_pick");
+end
+
+function pick_clock_pulse()
+	for i=1,moving do
+		local vid = objs[math.random(#objs)];
+		move_image(vid, math.random(VRESW), math.random(VRESH), 10);
+	end
+
+	local start = benchmark_timestamp(-1);
+	for i=1,picks do
+		hits = hits + #pick_items(math.random(VRESW), math.random(VRESH), 8);
+	end
+	usec = usec + benchmark_timestamp(-1) - start;
+	total = total + picks;
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	print(string.format("%d:%d:%d:%d:%.2f",
+		count, total, hits, usec, total > 0 and usec / total or 0));
+	hits = 0;
+	total = 0;
+	usec = 0;
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
@@ -0,0 +1,63 @@
+--
+-- Headless readback, the whole screen is changed every frame so that each
+-- synch has to read back and send a full frame to the encoder. Run with the
+-- headless platform and an encode output configured (video_encode), and
+-- compare against video_encode_sync_readback set to see the cost of the
+-- synchronous path.
+--
+-- Arguments: seconds (default 10), dirty (full or partial, default full)
+--
+-- Output (one line per second):
+-- frames:avg_frame_ms:ticks:avg_tick_ms
+--
+
+local seconds = 10;
+local partial = false;
+local bg;
+local box;
+
+local function avg(n, tbl)
+	local sum = 0;
+	for i=0,#tbl do
+		sum = sum + (tbl[i] and tbl[i] or 0);
+	end
+	n = n < 63 and n or 63;
+	return n > 0 and sum / n or 0;
+end
+
+function readback(arguments)
+	seconds = tonumber(arguments[1]) and tonumber(arguments[1]) or seconds;
+	partial = arguments[2] == "partial";
+
+	bg = color_surface(VRESW, VRESH, 0, 0, 0);
+	box = color_surface(64, 64, 255, 255, 255);
+	show_image({bg, box});
+	order_image(box, 2);
+
+	benchmark_enable(true);
+	print("frames:avg_frame_ms:ticks:avg_tick_ms");
+end
+
+function readback_clock_pulse()
+-- full: new background color every tick, partial: only the box moves
+	if (not partial) then
+		image_color(bg, CLOCK % 256, (CLOCK * 3) % 256, (CLOCK * 7) % 256);
+	end
+	move_image(box, CLOCK % (VRESW - 64), (CLOCK * 2) % (VRESH - 64));
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local nticks, ticks, nframes, frames = benchmark_data();
+
+	print(string.format("%d:%.2f:%d:%.2f",
+		nframes, avg(nframes, frames), nticks, avg(nticks, ticks)));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
@@ -0,0 +1,77 @@
+--
+-- Restacking, a large number of objects where a subset gets a new order
+-- every tick, both one at a time and as a single table call, similar to a
+-- window manager raising windows or rebuilding a long menu.
+--
+-- Arguments: objects (default 20000), reorders per tick (default 500),
+-- seconds (default 10)
+--
+-- Output (one line per second):
+-- objects:reorders:usec_single:usec_bulk:usec_per_reorder
+--
+
+local count = 20000;
+local reorders = 500;
+local seconds = 10;
+local objs = {};
+local single = 0;
+local bulk = 0;
+local total = 0;
+
+function restack(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	reorders = tonumber(arguments[2]) and tonumber(arguments[2]) or reorders;
+	seconds = tonumber(arguments[3]) and tonumber(arguments[3]) or seconds;
+
+-- the default context is too small, get a new one that fits
+	local lim = math.min(count + 16, 65536);
+	system_context_size(lim);
+	push_video_context();
+	count = lim - 16;
+
+	for i=1,count do
+		local vid = color_surface(8, 8,
+			math.random(255), math.random(255), math.random(255));
+		move_image(vid, math.random(VRESW), math.random(VRESH));
+		order_image(vid, math.random(65535));
+		show_image(vid);
+		table.insert(objs, vid);
+	end
+
+	print("objects:reorders:usec_single:usec_bulk:usec_per_reorder");
+end
+
+function restack_clock_pulse()
+	local start = benchmark_timestamp(-1);
+	for i=1,reorders do
+		order_image(objs[math.random(count)], math.random(65535));
+	end
+	single = single + benchmark_timestamp(-1) - start;
+
+	local set = {};
+	local orders = {};
+	for i=1,reorders do
+		set[i] = objs[math.random(count)];
+		orders[i] = math.random(65535);
+	end
+
+	start = benchmark_timestamp(-1);
+	order_image(set, orders);
+	bulk = bulk + benchmark_timestamp(-1) - start;
+	total = total + reorders * 2;
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	print(string.format("%d:%d:%d:%d:%.2f", count, total,
+		single, bulk, total > 0 and (single + bulk) / total or 0));
+	single = 0;
+	bulk = 0;
+	total = 0;
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
@@ -0,0 +1,113 @@
+/*
+ * Microbenchmark for the libretro rollback ring (rollback.c).
+ *
+ * Simulates a core save state where a small, random set of regions change
+ * every frame (counters, object tables, a bit of work RAM) and pushes one
+ * snapshot per frame, once into a plain array of copies as a reference and
+ * once into the ring. Every frame the oldest snapshot is retrieved from the
+ * ring and compared against the reference.
+ *
+ * Arguments: state size in KiB (default 256), window (default 10),
+ * frames (default 2000), changed bytes per frame (default 512),
+ * ring mode (raw or delta, default delta)
+ *
+ * Output (stdout, CSV):
+ * mode:state_kib:window:raw_kib:used_kib:keyframes:usec_raw:usec_push:usec_get
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "rollback.h"
+
+static unsigned long long micros()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+/* mutate a few hot regions and some scattered bytes */
+static void step(uint8_t* state, size_t sz, size_t changes)
+{
+	for (size_t i = 0; i < changes; i++){
+		size_t ofs = (i & 1) ? (size_t)rand() % sz : (size_t)rand() % (sz / 16);
+		state[ofs] = rand();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t sz = (argc > 1 ? strtoul(argv[1], NULL, 10) : 256) * 1024;
+	size_t window = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;
+	size_t frames = argc > 3 ? strtoul(argv[3], NULL, 10) : 2000;
+	size_t changes = argc > 4 ? strtoul(argv[4], NULL, 10) : 512;
+	const char* mode = argc > 5 ? argv[5] : "delta";
+	bool delta = strcmp(mode, "delta") == 0;
+
+	struct rollback_ring* ring = NULL;
+	if (delta || strcmp(mode, "raw") == 0)
+		ring = rollback_alloc(sz, window, delta);
+	uint8_t* state = malloc(sz);
+	uint8_t* raw = malloc(sz * window);
+
+	if (!ring || !state || !raw || frames < window){
+		fprintf(stderr, "usage: rollbackbench "
+			"[state_kib] [window] [frames >= window] [changes] [raw|delta]\n");
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < sz; i++)
+		state[i] = rand();
+
+	unsigned long long raw_us = 0, push_us = 0, get_us = 0;
+	size_t front = 0;
+
+	for (size_t i = 0; i < frames; i++){
+		step(state, sz, changes);
+
+/* the serialize cost is the same for both, so time the storage only */
+		unsigned long long start = micros();
+		memcpy(raw + front * sz, state, sz);
+		raw_us += micros() - start;
+		front = (front + 1) % window;
+
+		memcpy(rollback_scratch(ring), state, sz);
+		start = micros();
+		if (!rollback_push(ring)){
+			fprintf(stderr, "push failed at frame %zu\n", i);
+			return EXIT_FAILURE;
+		}
+		push_us += micros() - start;
+
+		if (i + 1 < window)
+			continue;
+
+		start = micros();
+		const uint8_t* old = rollback_get(ring, window - 1);
+		get_us += micros() - start;
+
+		if (memcmp(old, raw + front * sz, sz) != 0){
+			fprintf(stderr, "mismatch at frame %zu\n", i);
+			return EXIT_FAILURE;
+		}
+	}
+
+	struct rollback_stats stats;
+	rollback_stats(ring, &stats);
+
+	printf("mode:state_kib:window:raw_kib:used_kib:keyframes:"
+		"usec_raw:usec_push:usec_get\n");
+	printf("%s:%zu:%zu:%zu:%zu:%zu:%.2f:%.2f:%.2f\n", mode, sz / 1024, window,
+		stats.raw / 1024, stats.used / 1024, stats.keyframes,
+		(double) raw_us / frames, (double) push_us / frames,
+		(double) get_us / (frames - window + 1));
+
+	rollback_free(&ring);
+	free(state);
+	free(raw);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,251 @@
+/*
+ * Microbenchmark for hosting many shmif clients in one server loop, either
+ * by scanning every client each iteration (poll() on all handles, then
+ * shmifsrv_poll and shmifsrv_dequeue_events per client) or through a
+ * shmifsrv_group (shmifsrv_group_wait, shmifsrv_group_dequeue).
+ *
+ * A forked child opens [clients] synthetic connections to the 'srvgroup'
+ * connection point, then each client sends [evrate] events and [vrate]
+ * video frames per second. Clients are spread out over the second, like a
+ * set of independent applications would be. Only the CPU time of the server
+ * process is measured.
+ *
+ * Arguments: mode (scan or group, default group), clients (default 256),
+ * seconds (default 5), evrate (default 60), vrate (default 30)
+ *
+ * Output (one line per second):
+ * mode:clients:events:frames:cpu_usec:usec_per_item
+ */
+#include <arcan_shmif.h>
+#include <arcan_shmif_server.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#define CONNPOINT "srvgroup"
+
+static unsigned long long micros(clockid_t clk)
+{
+	struct timespec ts;
+	clock_gettime(clk, &ts);
+	return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+static void run_clients(size_t count, int seconds, int evrate, int vrate)
+{
+	struct arcan_shmif_cont* cl = malloc(sizeof(struct arcan_shmif_cont) * count);
+	if (!cl)
+		exit(EXIT_FAILURE);
+
+	setenv("ARCAN_CONNPATH", CONNPOINT, 1);
+	for (size_t i = 0; i < count; i++)
+		cl[i] = arcan_shmif_open(SEGID_APPLICATION, SHMIF_ACQUIRE_FATALFAIL, NULL);
+
+/* 1ms steps, each client gets its own phase within the second */
+	unsigned long long end = micros(CLOCK_MONOTONIC) + seconds * 1000000ull;
+	size_t evstep = evrate > 0 ? 1000 / evrate : 0;
+	size_t vstep = vrate > 0 ? 1000 / vrate : 0;
+
+	for (size_t ms = 0; micros(CLOCK_MONOTONIC) < end; ms++){
+		for (size_t i = 0; i < count; i++){
+			if (evstep && (ms + i) % evstep == 0){
+				struct arcan_event ev = {
+					.category = EVENT_EXTERNAL,
+					.ext.kind = ARCAN_EVENT(MESSAGE),
+					.ext.message.data = "ping"
+				};
+				arcan_shmif_tryenqueue(&cl[i], &ev);
+			}
+
+			if (vstep && (ms + i) % vstep == 0)
+				arcan_shmif_signal(&cl[i], SHMIF_SIGVID | SHMIF_SIGBLK_NONE);
+
+/* drain what the server sends so that its queue never saturates */
+			struct arcan_event ev;
+			while (arcan_shmif_poll(&cl[i], &ev) > 0){}
+		}
+		usleep(1000);
+	}
+
+	for (size_t i = 0; i < count; i++)
+		arcan_shmif_drop(&cl[i]);
+	exit(EXIT_SUCCESS);
+}
+
+struct stats {
+	size_t events, frames;
+};
+
+static void on_event(
+	struct shmifsrv_client* cl, struct arcan_event* ev, struct stats* st)
+{
+	st->events++;
+
+/* PREROLL stage, need to send ACTIVATE */
+	if (ev->ext.kind == EVENT_EXTERNAL_REGISTER)
+		shmifsrv_enqueue_event(cl, &(struct arcan_event){
+			.category = EVENT_TARGET,
+			.tgt.kind = TARGET_COMMAND_ACTIVATE
+		}, -1);
+	else
+		shmifsrv_process_event(cl, ev);
+}
+
+static void on_status(struct shmifsrv_client* cl, int sv, struct stats* st)
+{
+	if (sv == CLIENT_DEAD)
+		return;
+
+	if (sv & CLIENT_VBUFFER_READY){
+		shmifsrv_video(cl);
+		shmifsrv_video_step(cl);
+		st->frames++;
+	}
+
+	if (sv & CLIENT_ABUFFER_READY)
+		shmifsrv_audio(cl, NULL, NULL);
+}
+
+int main(int argc, char** argv)
+{
+	bool group = argc > 1 ? strcmp(argv[1], "scan") != 0 : true;
+	size_t count = argc > 2 ? strtoul(argv[2], NULL, 10) : 256;
+	int seconds = argc > 3 ? strtoul(argv[3], NULL, 10) : 5;
+	int evrate = argc > 4 ? strtoul(argv[4], NULL, 10) : 60;
+	int vrate = argc > 5 ? strtoul(argv[5], NULL, 10) : 30;
+
+	if (!count || seconds <= 0){
+		fprintf(stderr, "usage: srvgroupbench "
+			"[scan | group] [clients] [seconds] [evrate] [vrate]\n");
+		return EXIT_FAILURE;
+	}
+
+	struct shmifsrv_client* pending =
+		shmifsrv_allocate_connpoint(CONNPOINT, NULL, S_IRWXU, -1);
+	if (!pending){
+		fprintf(stderr, "couldn't allocate connection point\n");
+		return EXIT_FAILURE;
+	}
+	int listen_fd = shmifsrv_client_handle(pending);
+
+	pid_t child = fork();
+	if (0 == child)
+		run_clients(count, seconds, evrate, vrate);
+	else if (-1 == child){
+		fprintf(stderr, "couldn't fork client process\n");
+		return EXIT_FAILURE;
+	}
+
+	struct shmifsrv_client** clients =
+		malloc(sizeof(struct shmifsrv_client*) * (count + 1));
+	size_t n_clients = 0;
+	size_t connected = 0;
+
+	struct shmifsrv_group* grp = shmifsrv_group_alloc();
+	struct shmifsrv_group_entry ready[64];
+	struct shmifsrv_group_entry from[64];
+	struct arcan_event evs[64];
+	struct pollfd* pfds = malloc(sizeof(struct pollfd) * (count + 1));
+
+	if (!clients || !grp || !pfds)
+		return EXIT_FAILURE;
+
+	if (group)
+		shmifsrv_group_add(grp, pending, NULL);
+	clients[n_clients++] = pending;
+
+	printf("mode:clients:events:frames:cpu_usec:usec_per_item\n");
+	struct stats st = {0};
+	unsigned long long next = micros(CLOCK_MONOTONIC) + 1000000;
+	unsigned long long cpu = micros(CLOCK_PROCESS_CPUTIME_ID);
+
+	while (connected < count || n_clients > 0){
+		if (group){
+			size_t nr = shmifsrv_group_wait(grp, ready, 64, 4);
+			for (size_t i = 0; i < nr; i++){
+				on_status(ready[i].client, ready[i].status, &st);
+
+				if (ready[i].status == CLIENT_DEAD){
+					shmifsrv_free(ready[i].client, SHMIFSRV_FREE_FULL);
+					n_clients--;
+				}
+			}
+
+			while ((nr = shmifsrv_group_dequeue(grp, evs, from, 64)))
+				for (size_t i = 0; i < nr; i++)
+					on_event(from[i].client, &evs[i], &st);
+		}
+		else {
+			for (size_t i = 0; i < n_clients; i++)
+				pfds[i] = (struct pollfd){
+					.fd = shmifsrv_client_handle(clients[i]),
+					.events = POLLIN | POLLERR | POLLHUP
+				};
+			poll(pfds, n_clients, 4);
+
+			for (size_t i = 0; i < n_clients; i++){
+				int sv = shmifsrv_poll(clients[i]);
+				if (sv == CLIENT_DEAD ||
+					(clients[i] != pending && (pfds[i].revents & (POLLHUP | POLLERR)))){
+					shmifsrv_free(clients[i], SHMIFSRV_FREE_FULL);
+					clients[i--] = clients[--n_clients];
+					continue;
+				}
+				on_status(clients[i], sv, &st);
+
+				size_t nr;
+				while ((nr = shmifsrv_dequeue_events(clients[i], evs, 64)))
+					for (size_t j = 0; j < nr; j++)
+						on_event(clients[i], &evs[j], &st);
+			}
+		}
+
+/* the connection point was consumed, open the next one on the same handle */
+		if (connected < count && shmifsrv_client_handle(pending) != listen_fd){
+			connected++;
+			if (connected < count){
+				pending = shmifsrv_allocate_connpoint(
+					CONNPOINT, NULL, S_IRWXU, listen_fd);
+				if (!pending){
+					fprintf(stderr, "couldn't re-open connection point\n");
+					break;
+				}
+				if (group)
+					shmifsrv_group_add(grp, pending, NULL);
+				clients[n_clients++] = pending;
+			}
+			else
+				pending = NULL;
+		}
+
+		unsigned long long now = micros(CLOCK_MONOTONIC);
+		if (now < next)
+			continue;
+
+/* the client process failed before all connections were made */
+		if (connected < count && waitpid(child, NULL, WNOHANG) == child){
+			fprintf(stderr, "client process died after %zu connections\n", connected);
+			return EXIT_FAILURE;
+		}
+
+		unsigned long long used = micros(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+		size_t items = st.events + st.frames;
+		printf("%s:%zu:%zu:%zu:%llu:%.2f\n", group ? "group" : "scan",
+			connected, st.events, st.frames, used, items ? (double) used / items : 0);
+
+		st = (struct stats){0};
+		next = now + 1000000;
+		cpu = micros(CLOCK_PROCESS_CPUTIME_ID);
+	}
+
+	close(listen_fd);
+	shmifsrv_group_free(grp);
+	kill(child, SIGTERM);
+	waitpid(child, NULL, 0);
+
+	return EXIT_SUCCESS;
+}
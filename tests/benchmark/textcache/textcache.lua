@@ -0,0 +1,81 @@
+--
+-- Rendered text cache, a set of labels (menu entries, titlebars and a clock
+-- where only the seconds change) that are re-rendered into the same objects
+-- every tick, similar to a UI that redraws its decorations without keeping
+-- track of what actually changed.
+--
+-- Arguments: labels (default 200), renders per tick (default 100),
+-- seconds (default 10)
+--
+-- Output (one line per second):
+-- renders:usec_total:usec_per_render:hits:misses
+--
+
+local count = 200;
+local renders = 100;
+local seconds = 10;
+local labels = {};
+local vids = {};
+local total = 0;
+local used = 0;
+
+function textcache(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	renders = tonumber(arguments[2]) and tonumber(arguments[2]) or renders;
+	seconds = tonumber(arguments[3]) and tonumber(arguments[3]) or seconds;
+
+	for i=1,count do
+		local kind = i % 3;
+		if (kind == 0) then
+			labels[i] = string.format("\\f,12\\#ffffff Menu Entry %d\\t\\#aaaaaa Ctrl+%d", i, i);
+		elseif (kind == 1) then
+			labels[i] = string.format("\\f,14\\b Window Title %d - Document.txt\\!b", i);
+		else
+			labels[i] = string.format("\\f,12\\#cccccc Status %d\\n\\i Idle\\!i", i);
+		end
+	end
+
+	for i=1,renders do
+		vids[i] = render_text(labels[1]);
+		show_image(vids[i]);
+		move_image(vids[i], (i % 10) * 100, math.floor(i / 10) * 20);
+	end
+
+	benchmark_enable(true);
+	print("renders:usec_total:usec_per_render:hits:misses");
+end
+
+function textcache_clock_pulse()
+	local clock = string.format("\\f,12\\#ffffff %02d:%02d:%02d",
+		math.floor(CLOCK / 90000) % 24, math.floor(CLOCK / 1500) % 60,
+		math.floor(CLOCK / 25) % 60);
+
+	local start = benchmark_timestamp(-1);
+	for i=1,renders do
+		if (i == 1) then
+			render_text(vids[i], clock);
+		else
+			render_text(vids[i], labels[math.random(count)]);
+		end
+	end
+	total = total + benchmark_timestamp(-1) - start;
+	used = used + renders;
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, _, _, _, _, counters = benchmark_data();
+	local hit, miss = counters.texthit, counters.textmiss;
+	print(string.format("%d:%d:%.2f:%d:%d", used, total,
+		used > 0 and total / used or 0, hit, miss));
+	benchmark_enable(false);
+	benchmark_enable(true);
+	used = 0;
+	total = 0;
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end
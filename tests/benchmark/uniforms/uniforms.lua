@@ -0,0 +1,96 @@
+--
+-- Uniform uploads, a number of objects that alternate between a few custom
+-- shaders with per-object uniform groups so that every draw switches program
+-- or group. Only a small part of the objects change each tick, so most of
+-- the uniform state is identical between frames.
+--
+-- Arguments: objects (default 500), shaders (default 4), seconds (default 10)
+--
+-- Output (one line per second):
+-- frames:avg_frame_ms:unif_set_per_frame:unif_skip_per_frame
+--
+
+local count = 500;
+local nshaders = 4;
+local seconds = 10;
+local objs = {};
+
+local frag = [[
+uniform sampler2D map_tu0;
+uniform float obj_opacity;
+uniform vec3 tint;
+uniform float weight;
+varying vec2 texco;
+
+void main()
+{
+	vec4 col = texture2D(map_tu0, texco);
+	gl_FragColor = vec4(mix(col.rgb, tint, weight), col.a * obj_opacity);
+}
+]];
+
+local function avg(n, tbl)
+	local sum = 0;
+	for i=0,#tbl do
+		sum = sum + (tbl[i] and tbl[i] or 0);
+	end
+	n = n < 63 and n or 63;
+	return n > 0 and sum / n or 0;
+end
+
+function uniforms(arguments)
+	count = tonumber(arguments[1]) and tonumber(arguments[1]) or count;
+	nshaders = tonumber(arguments[2]) and tonumber(arguments[2]) or nshaders;
+	seconds = tonumber(arguments[3]) and tonumber(arguments[3]) or seconds;
+
+	local lim = math.min(count + 16, 65536);
+	system_context_size(lim);
+	push_video_context();
+	count = lim - 16;
+
+	local shaders = {};
+	for i=1,nshaders do
+		shaders[i] = build_shader(nil, frag, "uniforms_" .. tostring(i));
+		shader_uniform(shaders[i], "weight", "f", 0.5);
+	end
+
+	local img = random_surface(64, 64);
+	for i=1,count do
+		local vid = null_surface(32, 32);
+		image_sharestorage(img, vid);
+		local shid = shader_ugroup(shaders[(i % nshaders) + 1]);
+		shader_uniform(shid, "tint", "fff",
+			math.random(), math.random(), math.random());
+		image_shader(vid, shid);
+		move_image(vid, math.random(VRESW - 32), math.random(VRESH - 32));
+		show_image(vid);
+		objs[i] = vid;
+	end
+
+	benchmark_enable(true);
+	print("frames:avg_frame_ms:unif_set_per_frame:unif_skip_per_frame");
+end
+
+function uniforms_clock_pulse()
+	for i=1,10 do
+		blend_image(objs[math.random(count)], math.random());
+	end
+
+	if (CLOCK % 25 ~= 0) then
+		return;
+	end
+
+	local _, _, nframes, frames, _, _, counters = benchmark_data();
+	local unifset, unifskip = counters.unifset, counters.unifskip;
+
+	print(string.format("%d:%.2f:%.1f:%.1f", nframes, avg(nframes, frames),
+		nframes > 0 and unifset / nframes or 0,
+		nframes > 0 and unifskip / nframes or 0));
+	benchmark_enable(false);
+	benchmark_enable(true);
+
+	seconds = seconds - 1;
+	if (seconds <= 0) then
+		return shutdown();
+	end
+end